@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_rom_crc.h"
+#include "nvs.h"
+#include "checkpoint.h"
+
+#define TAG "CHECKPOINT"
+
+#define CHECKPOINT_MAGIC 0x4B504344  // "DCPK"
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    GameState state;
+    int64_t saved_us;   // System time when saved, kept by the RTC timer across resets
+    uint32_t crc;       // CRC-32 over everything above
+} checkpoint_t;
+
+/* Not cleared by the bootloader on watchdog / panic / software resets */
+static RTC_NOINIT_ATTR checkpoint_t rtc_checkpoint;
+
+static portMUX_TYPE checkpoint_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t checkpoint_task_handle = NULL;
+static volatile bool nvs_dirty = false;
+static nvs_handle_t nvs_rw = 0;     // Kept open, nvs_open allocates
+
+static int64_t system_time_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static uint32_t checkpoint_crc(const checkpoint_t *cp) {
+    return esp_rom_crc32_le(0, (const uint8_t *)cp, offsetof(checkpoint_t, crc));
+}
+
+static bool checkpoint_valid(const checkpoint_t *cp) {
+    return cp->magic == CHECKPOINT_MAGIC &&
+           cp->version == CHECKPOINT_VERSION &&
+           cp->size == sizeof(checkpoint_t) &&
+           cp->crc == checkpoint_crc(cp);
+}
+
+static void checkpoint_fill(checkpoint_t *cp) {
+    memset(cp, 0, sizeof(*cp));
+    cp->magic = CHECKPOINT_MAGIC;
+    cp->version = CHECKPOINT_VERSION;
+    cp->size = sizeof(checkpoint_t);
+    time_tracker_get_state(&cp->state);
+    cp->saved_us = system_time_us();
+    cp->crc = checkpoint_crc(cp);
+}
+
+static bool load_nvs(checkpoint_t *cp) {
+    nvs_handle_t handle;
+    if (nvs_open(CHECKPOINT_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    size_t len = sizeof(*cp);
+    esp_err_t err = nvs_get_blob(handle, CHECKPOINT_NVS_KEY, cp, &len);
+    nvs_close(handle);
+    return err == ESP_OK && len == sizeof(*cp) && checkpoint_valid(cp);
+}
+
+static void save_nvs(void) {
+    checkpoint_t cp;
+    portENTER_CRITICAL(&checkpoint_lock);
+    cp = rtc_checkpoint;
+    portEXIT_CRITICAL(&checkpoint_lock);
+
+    if (nvs_rw == 0 && nvs_open(CHECKPOINT_NVS_NAMESPACE, NVS_READWRITE, &nvs_rw) != ESP_OK) {
+        nvs_rw = 0;
+        return;
+    }
+    esp_err_t err = nvs_set_blob(nvs_rw, CHECKPOINT_NVS_KEY, &cp, sizeof(cp));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_rw);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "NVS snapshot failed: %s", esp_err_to_name(err));
+    }
+}
+
+/* @brief Restores a running match before the display is set up
+ * @param N/A
+ * @return Where the match came from, CHECKPOINT_NONE on a clean boot
+ * @note Must run before any time_tracker listener is registered
+ */
+checkpoint_source_t checkpoint_restore(void) {
+    checkpoint_t cp;
+    checkpoint_source_t source = CHECKPOINT_NONE;
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    // Opened at boot rather than on every save, so snapshots do not allocate
+    if (nvs_open(CHECKPOINT_NVS_NAMESPACE, NVS_READWRITE, &nvs_rw) != ESP_OK) {
+        nvs_rw = 0;
+    }
+
+    if (reason != ESP_RST_POWERON && checkpoint_valid(&rtc_checkpoint)) {
+        cp = rtc_checkpoint;
+        source = CHECKPOINT_RTC;
+    } else if (load_nvs(&cp)) {
+        source = CHECKPOINT_NVS;
+    }
+
+    if (source == CHECKPOINT_NONE || !cp.state.all_timers_active) {
+        return CHECKPOINT_NONE;
+    }
+
+    time_tracker_set_state(&cp.state);
+    if (source == CHECKPOINT_RTC) {
+        // The RTC timer kept running through the reset, catch up on missed seconds
+        int64_t elapsed_us = system_time_us() - cp.saved_us;
+        uint32_t missed = (elapsed_us > 0) ? (uint32_t)(elapsed_us / 1000000) : 0;
+        for (uint32_t i = 0; i < missed; i++) {
+            time_tracker_tick();
+        }
+        ESP_LOGI(TAG, "Resumed match from RTC memory (reset reason %d), %lu s elapsed",
+                 reason, missed);
+    } else {
+        game_timer_active = 0;
+        ESP_LOGI(TAG, "Resumed match from NVS (reset reason %d), paused at %02ld:%02d",
+                 reason, game_timer_minutes, game_timer_seconds);
+    }
+    return source;
+}
+
+/* @brief Copies the state into RTC memory on every change
+ * @param event tt_event_t
+ * @param arg N/A
+ */
+void checkpoint_listener(uint8_t event, uint8_t arg) {
+    static uint32_t ticks_unsaved = 0;
+    checkpoint_t cp;
+    checkpoint_fill(&cp);
+
+    portENTER_CRITICAL(&checkpoint_lock);
+    rtc_checkpoint = cp;
+    portEXIT_CRITICAL(&checkpoint_lock);
+
+    // A tick only moves the clock, not worth a flash write every interval
+    if (event != TT_EVT_TICK || ++ticks_unsaved >= CHECKPOINT_NVS_TICK_S) {
+        ticks_unsaved = 0;
+        nvs_dirty = true;
+    }
+    // Match start/end are worth persisting right away
+    if ((event == TT_EVT_MATCH_START || event == TT_EVT_MATCH_END) && checkpoint_task_handle != NULL) {
+        xTaskNotifyGive(checkpoint_task_handle);
+    }
+}
+
+/* @brief Writes the NVS snapshot, at most once per CHECKPOINT_NVS_INTERVAL_MS
+ * @param pvParameters N/A
+ */
+void checkpoint_task(void *pvParameters) {
+    checkpoint_task_handle = xTaskGetCurrentTaskHandle();
+    TickType_t last_save = 0;
+    bool saved_once = false;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CHECKPOINT_NVS_INTERVAL_MS));
+        TickType_t now = xTaskGetTickCount();
+        if (saved_once && now - last_save < pdMS_TO_TICKS(CHECKPOINT_NVS_INTERVAL_MS)) {
+            vTaskDelay(pdMS_TO_TICKS(CHECKPOINT_NVS_INTERVAL_MS) - (now - last_save));
+        }
+        if (nvs_dirty) {
+            nvs_dirty = false;
+            save_nvs();
+            last_save = xTaskGetTickCount();
+            saved_once = true;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../main/time_tracker.h"
+
+/* Match state checkpoints
+ *
+ * Every state change is copied into RTC memory, which survives watchdog,
+ * panic and software resets. A CRC protected copy is also written to NVS
+ * at most every CHECKPOINT_NVS_INTERVAL_MS so a match survives power loss.
+ * Clock ticks alone only rewrite NVS every CHECKPOINT_NVS_TICK_S: a match
+ * restored from NVS resumes paused anyway, its clock is fixed by hand.
+ */
+
+#define CHECKPOINT_NVS_NAMESPACE    "checkpoint"
+#define CHECKPOINT_NVS_KEY          "match"
+#define CHECKPOINT_NVS_INTERVAL_MS  10000
+#define CHECKPOINT_NVS_TICK_S       120     // Game seconds the NVS clock may lag
+#define CHECKPOINT_VERSION          1
+
+typedef enum {
+    CHECKPOINT_NONE = 0,
+    CHECKPOINT_RTC,     // Restored with the time elapsed during the reset
+    CHECKPOINT_NVS,     // Restored paused, elapsed time is unknown after power loss
+} checkpoint_source_t;
+
+checkpoint_source_t checkpoint_restore(void);
+void checkpoint_listener(uint8_t event, uint8_t arg);
+void checkpoint_task(void *pvParameters);
+
+#endif
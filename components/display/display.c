@@ -9,11 +9,24 @@
 #include "esp_timer.h"
 #include "lvgl.h"
 #include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "nvs.h"
 
 #include "../gpio_setup/gpio_setup.h"
 #include "display.h"
+#include "display_stats.h"
+#include "lcd_stream.h"
+#include "ui_cmd.h"
+#include "frame_budget.h"
+#include "frame_capture.h"
+#include "spi_clock.h"
+#include "lcd_diff.h"
+#include "ui_theme.h"
+#include "../static_mem/static_mem.h"
+#include "../serial_link/serial_link.h"
 
 #include "../../main/time_tracker.h"
+#include "../../main/latency_trace.h"
 
 uint8_t *buf1 = NULL;
 lv_obj_t * tabview = NULL;
@@ -22,6 +35,56 @@ lv_obj_t * label1 = NULL;
 lv_obj_t * label2 = NULL;
 lv_obj_t * hero_labels[HERO_COUNT];
 
+/* Label text that changes every second lives here (lv_label_set_text_static), not in the LVGL heap */
+static char hero_text[HERO_COUNT][24];
+static char footer_text[48];
+
+static lv_obj_t * toast = NULL;
+static bool ui_suspended = false;
+static lv_timer_t * toast_timer = NULL;
+static lv_timer_t * flash_timers[HERO_COUNT];
+
+/* Buyback row highlights, effect picked by the frame-budget governor */
+typedef enum {
+	ROW_NORMAL = 0,
+	ROW_WARN,		// Cooldown ends within UI_WARN_S
+	ROW_EXPIRED,	// Ended less than UI_EXPIRED_MS ago
+} row_state_t;
+
+static frame_budget_t frame_budget;
+static int64_t frame_start_us;
+static uint32_t frame_px;
+static uint32_t expired_at[HERO_COUNT];		// lv_tick_get() of UI_CMD_EXPIRED_ROW, 0 = none
+static uint8_t row_fx[HERO_COUNT];			// fb_fx_t
+static uint8_t row_fx_state[HERO_COUNT];	// row_state_t the effect was set up for
+static uint8_t row_status[HERO_COUNT];		// ui_status_t of the row's text colour
+static int8_t row_blink_on[HERO_COUNT];		// -1 = not blinking
+
+static char capture_name[CAPTURE_NAME_LEN];	// Set by "cap" before UI_CMD_CAPTURE is posted
+
+#define TAG "DISPLAY"
+#define LCD_RAMRD			0x2E
+#define LCD_RAMRD_SWAP_RB	0		// Set if RAMRD returns blue first (depends on MADCTL BGR)
+#define LCD_NVS_NAMESPACE	"lcd"
+#define LCD_NVS_SPI_HZ		"spi_hz"	// Calibrated write clock, 0 = search at the next boot
+
+static spi_clock_t spi_clock;
+static uint32_t probe_hz;				// Write clock of the running probe
+static uint32_t spi_check_at;			// lv_tick_get() of the next spot check
+static struct {
+	lv_area_t area;
+	int count;							// 0: nothing sampled this frame
+	uint16_t px[SPI_CLOCK_CHECK_PIXELS];
+} spot;									// Flushed pixels waiting for lcd_spot_check()
+
+#if LCD_DIFF
+static EXT_RAM_BSS_ATTR uint16_t lcd_shadow[MY_DISP_HOR_RES * MY_DISP_VER_RES];	// What the panel shows, 300 KB
+static lcd_diff_t lcd_diff;
+static bool lcd_diff_on = true;
+static uint32_t window_us_avg8;			// lcd_set_cursor() time, moving average x8
+static int64_t lcd_diff_since_us;		// Start of the "diff" byte rates
+#endif
+
 
 #define BUFFER_LINES 20  // Number of lines to buffer (adjust as needed)
 #define MAX_SPI_TRANSFER_SIZE 1024
@@ -30,6 +93,7 @@ lv_obj_t * hero_labels[HERO_COUNT];
 void lcd_reset(void);
 void lcd_write_data_byte(spi_device_handle_t spi, const uint8_t data);
 void lcd_write_data_word(spi_device_handle_t spi, const uint16_t data);
+void lcd_write_data(spi_device_handle_t spi, const uint8_t *data, int len);
 void lcd_write_register(spi_device_handle_t spi, const uint8_t data);
 void lcd_init(spi_device_handle_t spi);
 
@@ -87,6 +151,26 @@ void lcd_write_data_word(spi_device_handle_t spi, uint16_t data) {
     gpio_set_level(LCD_CS, 1);
 }
 
+/* @brief Writes several data bytes to LCD in one SPI transaction
+ * @param SPI device (spi_device_handle_t)
+ * @param data Bytes, sent in order
+ * @param len Up to 4 (tx_data, no DMA)
+ * @note CS starts LOW and ends HIGH
+ * @note DC is HIGH
+ */
+void lcd_write_data(spi_device_handle_t spi, const uint8_t *data, int len) {
+    spi_transaction_t t;
+    memset(&t, 0, sizeof(t));
+    t.length = len * 8;
+    t.flags = SPI_TRANS_USE_TXDATA;
+    memcpy(t.tx_data, data, len);
+    gpio_set_level(LCD_CS, 0);
+    gpio_set_level(LCD_DC, 1);
+
+    ESP_ERROR_CHECK(spi_device_polling_transmit(spi, &t));
+    gpio_set_level(LCD_CS, 1);
+}
+
 void lcd_fast_word(spi_device_handle_t spi, uint16_t data) {
     spi_transaction_t t;
     memset(&t, 0, sizeof(t));
@@ -362,19 +446,15 @@ void lcd_init(spi_device_handle_t spi) {
  * @param xEnd  :   End word coordinates
  */
 void lcd_set_cursor(uint16_t xStart, uint16_t yStart, uint16_t xEnd, uint16_t yEnd) {
-  // Set Column Address (X-axis)
+  // Set Column Address (X-axis), start and end high byte first, one transaction
+  uint8_t columns[4] = { xStart >> 8, xStart & 0xFF, xEnd >> 8, xEnd & 0xFF };
   lcd_write_register(spi, 0x2A); // Column address set
-  lcd_write_data_byte(spi, (xStart >> 8) & 0xFF); // Start high byte
-  lcd_write_data_byte(spi, xStart & 0xFF);        // Start low byte
-  lcd_write_data_byte(spi, (xEnd >> 8) & 0xFF);   // End high byte
-  lcd_write_data_byte(spi, xEnd & 0xFF);          // End low byte
+  lcd_write_data(spi, columns, sizeof(columns));
 
   // Set Page Address (Y-axis)
+  uint8_t pages[4] = { yStart >> 8, yStart & 0xFF, yEnd >> 8, yEnd & 0xFF };
   lcd_write_register(spi, 0x2B); // Page address set
-  lcd_write_data_byte(spi, (yStart >> 8) & 0xFF); // Start high byte
-  lcd_write_data_byte(spi, yStart & 0xFF);        // Start low byte
-  lcd_write_data_byte(spi, (yEnd >> 8) & 0xFF);   // End high byte
-  lcd_write_data_byte(spi, yEnd & 0xFF);          // End low byte
+  lcd_write_data(spi, pages, sizeof(pages));
 
   // Memory Write (ready for pixel data)
   lcd_write_register(spi, 0x2C);
@@ -489,70 +569,321 @@ uint32_t my_tick_get_cb(void) {
     return esp_timer_get_time() / 1000;
 }
 
-void my_flush_cb(lv_display_t * display, const lv_area_t * area, uint8_t * px_map)
+/* @brief Sends one byte-swapped chunk and waits for it, lcd_stream_send_t */
+static void lcd_send_chunk(const uint16_t *chunk, int pixels, void *ctx)
 {
-    esp_err_t ret;
-    int chunk_size = MAX_SPI_TRANSFER_SIZE / 2; // Each pixel is 2 bytes (RGB565)
+    spi_transaction_t trans = {
+        .length = pixels * 2 * 8, // bits
+        .tx_buffer = chunk,
+        .flags = 0,
+        .user = (void*)1
+    };
+
+    esp_err_t ret = spi_device_queue_trans(spi, &trans, portMAX_DELAY);
+    assert(ret == ESP_OK);
+
+    spi_transaction_t *ret_trans;
+    ret = spi_device_get_trans_result(spi, &ret_trans, portMAX_DELAY);
+    assert(ret == ESP_OK);
+}
+
+/* @brief Reads pixels back from the current GRAM window (RAMRD) at SPI_CLOCK_READ_HZ
+ * @param px RGB565 out
+ * @param count At most SPI_CLOCK_TEST_PIXELS
+ * @param write_hz Clock to switch back to afterwards
+ */
+static bool lcd_read_pixels(uint16_t *px, int count, uint32_t write_hz)
+{
+	static DMA_ATTR WORD_ALIGNED_ATTR uint8_t rx[SPI_CLOCK_TEST_PIXELS * 3];
+	spi_transaction_ext_t t = {
+		.base = {
+			.flags = SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_DUMMY,
+			.cmd = LCD_RAMRD,
+			.rxlength = count * 3 * 8,	// 18-bit colour, one byte per channel
+			.rx_buffer = rx,
+		},
+		.command_bits = 8,
+		.dummy_bits = 8,				// One dummy byte before the first pixel
+	};
+
+	if (count > SPI_CLOCK_TEST_PIXELS || !spi_set_clock(SPI_CLOCK_READ_HZ)) {
+		return false;
+	}
+	gpio_set_level(LCD_DC, 0);			// Command byte, the data that follows ignores DC
+	esp_err_t err = spi_device_polling_transmit(spi, &t.base);
+	if (!spi_set_clock(write_hz) || err != ESP_OK) {
+		return false;
+	}
+	for (int i = 0; i < count; i++) {
+		const uint8_t *p = &rx[i * 3];
+		uint8_t rgb[3] = { p[LCD_RAMRD_SWAP_RB ? 2 : 0], p[1], p[LCD_RAMRD_SWAP_RB ? 0 : 2] };
+		px[i] = spi_clock_rgb666_to_565(rgb);
+	}
+	return true;
+}
 
-    // Set the cursor to the area being flushed
-    lcd_set_cursor(area->x1, area->y1, area->x2, area->y2);
+/* spi_clock_bus_t on the panel, the test window is the top left corner */
+static bool cal_set_clock(void *ctx, uint32_t hz)
+{
+	probe_hz = hz;
+	return spi_set_clock(hz);
+}
 
-    gpio_set_level(LCD_CS, 0);  // Select LCD
-    gpio_set_level(LCD_DC, 1);  // Set to data mode
+static bool cal_write(void *ctx, const uint16_t *px, int count)
+{
+	lcd_set_cursor(0, 0, SPI_CLOCK_TEST_W - 1, SPI_CLOCK_TEST_H - 1);
+	gpio_set_level(LCD_DC, 1);
+	lcd_stream_pixels(px, count, lcd_send_chunk, NULL);
+	return true;
+}
+
+static bool cal_read(void *ctx, uint16_t *px, int count)
+{
+	lcd_set_cursor(0, 0, SPI_CLOCK_TEST_W - 1, SPI_CLOCK_TEST_H - 1);
+	return lcd_read_pixels(px, count, probe_hz);
+}
+
+/* @brief Sets the fastest SPI clock that reads back without errors, see spi_clock.h
+ * @note Boot (after lcd_init) and UI_CMD_SPI_CAL, the test window is overwritten
+ */
+void lcd_calibrate_clock(void)
+{
+	static bool loaded = false;
+	spi_clock_bus_t bus = { cal_set_clock, cal_write, cal_read, NULL };
+	nvs_handle_t handle;
+	int64_t start = esp_timer_get_time();
+
+	if (!loaded) {
+		uint32_t cached = 0;
+		if (nvs_open(LCD_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+			nvs_get_u32(handle, LCD_NVS_SPI_HZ, &cached);
+			nvs_close(handle);
+		}
+		spi_clock_init(&spi_clock, cached);
+		loaded = true;
+	}
+	uint32_t before = spi_clock.cached_hz;
+	uint32_t hz = spi_clock_calibrate(&spi_clock, &bus);
+	if (spi_clock.probes_failed > 0) {
+		lcd_init(spi);	// A garbled command byte at a failing clock can change panel modes
+	}
+	if (spi_clock.cached_hz != before && nvs_open(LCD_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+		nvs_set_u32(handle, LCD_NVS_SPI_HZ, spi_clock.cached_hz);
+		nvs_commit(handle);
+		nvs_close(handle);
+	}
+	if (hz == 0) {
+		ESP_LOGW(TAG, "GRAM readback failed at every clock, staying at %lu Hz", (unsigned long)spi_clock.hz);
+	}
+	ESP_LOGI(TAG, "SPI clock %lu Hz (%s), %lu probes in %lld us", (unsigned long)spi_clock.hz,
+	         spi_clock.from_cache ? "cached" : "searched", (unsigned long)spi_clock.probes,
+	         (long long)(esp_timer_get_time() - start));
+	spi_check_at = my_tick_get_cb() + SPI_CLOCK_CHECK_PERIOD_MS;
+}
+
+/* @brief Keeps the start of a flushed area for lcd_spot_check(), every SPI_CLOCK_CHECK_PERIOD_MS
+ * @note Only a copy here: the readback changes the SPI clock, which must not happen mid-flush
+ */
+static void lcd_spot_sample(const lv_area_t * area, const uint16_t * px_map, int num_pixels)
+{
+	if (spi_clock.calibrations == 0 || spot.count > 0 || (int32_t)(my_tick_get_cb() - spi_check_at) < 0) {
+		return;
+	}
+	spi_check_at = my_tick_get_cb() + SPI_CLOCK_CHECK_PERIOD_MS;
+	spot.area = *area;
+	spot.count = num_pixels < SPI_CLOCK_CHECK_PIXELS ? num_pixels : SPI_CLOCK_CHECK_PIXELS;
+	memcpy(spot.px, px_map, spot.count * sizeof(uint16_t));
+}
+
+/* @brief Compares the sampled area with its readback, after the last flush of a frame
+ * @note Errors that persist post UI_CMD_SPI_CAL, calibration runs between frames
+ */
+static void lcd_spot_check(void)
+{
+	static uint16_t back[SPI_CLOCK_CHECK_PIXELS];
+	bool ok;
+
+	if (spot.count == 0) {
+		return;
+	}
+	lcd_set_cursor(spot.area.x1, spot.area.y1, spot.area.x2, spot.area.y2);
+	ok = lcd_read_pixels(back, spot.count, spi_clock.hz) &&
+	     memcmp(back, spot.px, spot.count * sizeof(uint16_t)) == 0;
+	spot.count = 0;
+	if (spi_clock_check(&spi_clock, ok)) {
+		ui_cmd_post(UI_CMD_SPI_CAL, 0);
+	}
+}
+
+#if LCD_DIFF
+/* @brief Sends one changed rectangle in its own window, lcd_diff_send_t */
+static void lcd_send_rect(const lcd_diff_rect_t *rect, const uint16_t *px, int stride, void *ctx)
+{
+	int64_t start = esp_timer_get_time();
+	lcd_set_cursor(rect->x1, rect->y1, rect->x2, rect->y2);
+	// What a window costs follows the measured setup time at the current clock
+	uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+	window_us_avg8 = window_us_avg8 == 0 ? us * 8 : window_us_avg8 + us - window_us_avg8 / 8;
+	lcd_diff.window_cost = (uint32_t)((uint64_t)window_us_avg8 * (spi_clock.hz / 8) / 8 / 1000000);
+
+	gpio_set_level(LCD_CS, 0);
+	gpio_set_level(LCD_DC, 1);
+	lcd_stream_rect(px, stride, rect->x2 - rect->x1 + 1, rect->y2 - rect->y1 + 1, lcd_send_chunk, NULL);
+}
+#endif
+
+void my_flush_cb(lv_display_t * display, const lv_area_t * area, uint8_t * px_map)
+{
+    DISPLAY_STATS_FLUSH_BEGIN();
 
     // Compute number of pixels in flush area
     int width = area->x2 - area->x1 + 1;
     int height = area->y2 - area->y1 + 1;
     int num_pixels = width * height;
 
-    // Cast source buffer to uint16_t (LVGL gives RGB565 data)
-    uint16_t *buf16 = (uint16_t *)px_map;
+#if LCD_DIFF
+    if (lcd_diff_on) {
+        // Only what differs from the shadow, in as few windows as pay off
+        lcd_diff_area(&lcd_diff, area->x1, area->y1, area->x2, area->y2, (const uint16_t *)px_map,
+                      lcd_send_rect, NULL);
+    } else
+#endif
+    {
+        // Set the cursor to the area being flushed
+        lcd_set_cursor(area->x1, area->y1, area->x2, area->y2);
+
+        gpio_set_level(LCD_CS, 0);  // Select LCD
+        gpio_set_level(LCD_DC, 1);  // Set to data mode
+
+        // Cast source buffer to uint16_t (LVGL gives RGB565 data), sent in byte-swapped chunks
+        lcd_stream_pixels((const uint16_t *)px_map, num_pixels, lcd_send_chunk, NULL);
+    }
+    DISPLAY_STATS_FLUSH_END(num_pixels);
+    frame_px += num_pixels;
+    lcd_spot_sample(area, (const uint16_t *)px_map, num_pixels);
+    frame_capture_area(area->x1, area->y1, area->x2, area->y2, (const uint16_t *)px_map);
+    latency_trace_flush_done(area->x1, area->y1, area->x2, area->y2);
+    // Notify LVGL that the flush is complete
+    lv_display_flush_ready(display);
+}
 
-    // Allocate small working buffer for one SPI chunk
-    uint16_t COLOR_BUFFER[chunk_size];
+static row_state_t row_state(int hero)
+{
+	if (expired_at[hero] != 0) {
+		if (lv_tick_elaps(expired_at[hero]) < UI_EXPIRED_MS && !hero_timers[hero].active) {
+			return ROW_EXPIRED;
+		}
+		expired_at[hero] = 0;
+	}
+	if (all_timers_active && hero_timers[hero].active &&
+	    hero_timers[hero].minutes == 0 && hero_timers[hero].seconds <= UI_WARN_S) {
+		return ROW_WARN;
+	}
+	return ROW_NORMAL;
+}
 
-    // Send buffer in chunks
-    for (int i = 0; i < num_pixels; i += chunk_size) {
-        int current_chunk_size = (num_pixels - i < chunk_size) ? (num_pixels - i) : chunk_size;
+static void row_fade_exec_cb(void * obj, int32_t value)
+{
+	lv_obj_set_style_bg_opa(obj, (lv_opa_t)value, 0);
+}
 
-        // Swap bytes and fill COLOR_BUFFER
-        for (int j = 0; j < current_chunk_size; j++) {
-            uint16_t color = buf16[i + j];
-            COLOR_BUFFER[j] = (color >> 8) | (color << 8); // RGB565 byte swap
-        }
+/* @brief Sets up a row's highlight effect, only called when the effect or state changes */
+static void row_fx_set(int hero, fb_fx_t fx, row_state_t state)
+{
+	lv_obj_t * row = hero_labels[hero];
 
-        spi_transaction_t trans = {
-            .length = current_chunk_size * 2 * 8, // bits
-            .tx_buffer = COLOR_BUFFER,
-            .flags = 0,
-            .user = (void*)1
-        };
+	lv_anim_delete(row, row_fade_exec_cb);
+	row_fx[hero] = fx;
+	row_fx_state[hero] = state;
+	row_blink_on[hero] = -1;
 
-        ret = spi_device_queue_trans(spi, &trans, portMAX_DELAY);
-        assert(ret == ESP_OK);
+	if (fx == FB_FX_NONE) {
+		lv_obj_set_style_bg_opa(row, LV_OPA_TRANSP, 0);
+		return;
+	}
+	ui_theme_set_highlight(row, state == ROW_WARN ? UI_HIGHLIGHT_WARN : UI_HIGHLIGHT_EXPIRED);
+	if (fx == FB_FX_STEADY) {
+		lv_obj_set_style_bg_opa(row, LV_OPA_50, 0);
+	} else if (fx == FB_FX_FADE) {
+		lv_anim_t a;
+		lv_anim_init(&a);
+		lv_anim_set_var(&a, row);
+		lv_anim_set_exec_cb(&a, row_fade_exec_cb);
+		lv_anim_set_values(&a, LV_OPA_TRANSP, LV_OPA_60);
+		lv_anim_set_duration(&a, FB_BLINK_MS);
+		lv_anim_set_playback_duration(&a, FB_BLINK_MS);
+		lv_anim_set_repeat_count(&a, LV_ANIM_REPEAT_INFINITE);
+		lv_anim_start(&a);
+	}
+	// FB_FX_BLINK is stepped by row_highlight_update()
+}
 
-        spi_transaction_t *ret_trans;
-        ret = spi_device_get_trans_result(spi, &ret_trans, portMAX_DELAY);
-        assert(ret == ESP_OK);
-    }
-    // Notify LVGL that the flush is complete
-    lv_display_flush_ready(display);
+/* @brief Picks each row's effect within the frame budget
+ * @note Fades go to rows in order while their area fits frame_budget_anim_px(),
+ *       the rest blink (two invalidations per second instead of one per frame)
+ */
+static void row_highlight_update(void)
+{
+	uint32_t anim_px = frame_budget_anim_px(&frame_budget);
+	int8_t blink_on = (lv_tick_get() / FB_BLINK_MS) & 1;
+
+	for (int i = 0; i < HERO_COUNT; i++) {
+		if (flash_timers[i] != NULL) {
+			continue;	// UI_CMD_FLASH_ROW owns the row until flash_end_cb
+		}
+		row_state_t state = row_state(i);
+		fb_fx_t fx = FB_FX_NONE;
+
+		if (state != ROW_NORMAL) {
+			lv_area_t coords;
+			lv_obj_get_coords(hero_labels[i], &coords);
+			fx = frame_budget_pick_fx(&frame_budget, lv_area_get_size(&coords), &anim_px);
+		}
+		if (fx != row_fx[i] || state != row_fx_state[i]) {
+			row_fx_set(i, fx, state);
+		}
+		if (fx == FB_FX_BLINK && row_blink_on[i] != blink_on) {
+			lv_obj_set_style_bg_opa(hero_labels[i], blink_on ? LV_OPA_60 : LV_OPA_TRANSP, 0);
+			row_blink_on[i] = blink_on;
+		}
+	}
 }
 
 void hero_timer(lv_timer_t * hero_1_t)
 {
+	char text[sizeof(hero_text[0])];
+
 	for (int i = 0; i < HERO_COUNT; i++) {
+        ui_status_t status;
         if (!all_timers_active) {
-            lv_label_set_text_fmt(hero_labels[i], "Hero #%d: -------", i + 1);
+            snprintf(text, sizeof(text), "Hero #%d: -------", i + 1);
+            status = UI_STATUS_NONE;
         }
         else if (!hero_timers[i].active) {
-            lv_label_set_text_fmt(hero_labels[i], "Hero #%d: Available", i + 1);
+            snprintf(text, sizeof(text), "Hero #%d: Available", i + 1);
+            status = UI_STATUS_AVAILABLE;
         }
         else {
-            lv_label_set_text_fmt(hero_labels[i], "Hero #%d: %02d:%02d", i + 1,
-                                  hero_timers[i].minutes, hero_timers[i].seconds);
+            snprintf(text, sizeof(text), "Hero #%d: %02d:%02d", i + 1,
+                     hero_timers[i].minutes, hero_timers[i].seconds);
+            status = game_timer_active ? UI_STATUS_COOLDOWN : UI_STATUS_PAUSED;
+        }
+        // Shared style swap, restyles the row only when its status changed
+        if (status != row_status[i]) {
+            ui_theme_set_status(hero_labels[i], status);
+            row_status[i] = status;
         }
+        // Runs every 250 ms, only rows whose text changed are invalidated (frame budget)
+        if (strcmp(text, hero_text[i]) == 0) {
+            continue;
+        }
+        memcpy(hero_text[i], text, sizeof(text));
+        lv_label_set_text_static(hero_labels[i], hero_text[i]);
+        lv_area_t coords;
+        lv_obj_get_coords(hero_labels[i], &coords);
+        latency_trace_invalidate(i, coords.x1, coords.y1, coords.x2, coords.y2);
     }
+    row_highlight_update();
 }
 
 
@@ -561,20 +892,290 @@ void hero_timer(lv_timer_t * hero_1_t)
 void my_timer(lv_timer_t * timer)
 {
 	if (!all_timers_active) {
-        lv_label_set_text(footer, "In-game Timer: --:--");
+        lv_label_set_text_static(footer, "In-game Timer: --:--");
         return;
     }
 
     if (!game_timer_active) {
-        lv_label_set_text_fmt(footer, "In-game Timer: %02ld:%02d\nTimer is paused.", game_timer_minutes, game_timer_seconds);
+        snprintf(footer_text, sizeof(footer_text), "In-game Timer: %02ld:%02d\nTimer is paused.",
+                 game_timer_minutes, game_timer_seconds);
     } else {
-        lv_label_set_text_fmt(footer, "In-game Timer: %02ld:%02d", game_timer_minutes, game_timer_seconds);
+        snprintf(footer_text, sizeof(footer_text), "In-game Timer: %02ld:%02d",
+                 game_timer_minutes, game_timer_seconds);
     }
+    lv_label_set_text_static(footer, footer_text);
 }
 
-void index_timer(lv_timer_t * timer)
+/* @brief Samples the LVGL pool for "mem", lv_mem_monitor is only safe on lvgl_task */
+static void lvgl_mem_timer(lv_timer_t * timer)
 {
-	lv_tabview_set_act(tabview, indexing, LV_ANIM_OFF);
+	lv_mem_monitor_t mon;
+	lv_mem_monitor(&mon);
+	static_mem_note_lvgl(mon.total_size, mon.total_size - mon.free_size, mon.max_used, mon.frag_pct);
+}
+
+/* @brief Tab selected by touch, keeps indexing in step for K11 */
+static void tab_changed_cb(lv_event_t * e)
+{
+	indexing = lv_tabview_get_tab_active(tabview);
+}
+
+/* @brief Ends a UI_CMD_FLASH_ROW highlight (one-shot timer) */
+static void flash_end_cb(lv_timer_t * timer)
+{
+	int hero = (int)(intptr_t)lv_timer_get_user_data(timer);
+	lv_obj_set_style_bg_opa(hero_labels[hero], LV_OPA_TRANSP, 0);
+	flash_timers[hero] = NULL;
+	row_fx[hero] = FB_FX_NONE;		// Highlight is set up again on the next hero_timer
+}
+
+/* @brief Hides the toast again (one-shot timer) */
+static void toast_end_cb(lv_timer_t * timer)
+{
+	lv_obj_add_flag(toast, LV_OBJ_FLAG_HIDDEN);
+	toast_timer = NULL;
+}
+
+static void show_toast(const char * text)
+{
+	if (toast == NULL) {
+		toast = lv_label_create(lv_layer_top());
+		ui_theme_apply(toast, UI_CLASS_TOAST);
+		lv_obj_align(toast, LV_ALIGN_BOTTOM_MID, 0, -40);	// Above the footer
+	}
+	lv_label_set_text_static(toast, text);	// Toast text is a literal
+	lv_obj_remove_flag(toast, LV_OBJ_FLAG_HIDDEN);
+	if (toast_timer != NULL) {
+		lv_timer_reset(toast_timer);
+	} else {
+		toast_timer = lv_timer_create(toast_end_cb, UI_TOAST_MS, NULL);
+		lv_timer_set_repeat_count(toast_timer, 1);
+	}
+}
+
+static void flash_row(int hero)
+{
+	lv_anim_delete(hero_labels[hero], row_fade_exec_cb);
+	ui_theme_set_highlight(hero_labels[hero], UI_HIGHLIGHT_FLASH);
+	lv_obj_set_style_bg_opa(hero_labels[hero], LV_OPA_50, 0);
+	if (flash_timers[hero] != NULL) {
+		lv_timer_reset(flash_timers[hero]);
+	} else {
+		flash_timers[hero] = lv_timer_create(flash_end_cb, UI_FLASH_MS, (void *)(intptr_t)hero);
+		lv_timer_set_repeat_count(flash_timers[hero], 1);
+	}
+}
+
+static void ui_cmd_apply(const ui_cmd_t * cmd)
+{
+	uint32_t tabs = lv_tabview_get_tab_count(tabview);
+
+	switch (cmd->type) {
+	case UI_CMD_SWITCH_TAB:
+		if (cmd->arg < tabs) {
+			lv_tabview_set_act(tabview, cmd->arg, LV_ANIM_OFF);
+			indexing = cmd->arg;
+		}
+		break;
+	case UI_CMD_NEXT_TAB:
+		indexing = (lv_tabview_get_tab_active(tabview) + 1) % tabs;
+		lv_tabview_set_act(tabview, indexing, LV_ANIM_OFF);
+		break;
+	case UI_CMD_FLASH_ROW:
+		if (cmd->arg < HERO_COUNT) {
+			flash_row(cmd->arg);
+		}
+		break;
+	case UI_CMD_EXPIRED_ROW:
+		if (cmd->arg < HERO_COUNT) {
+			expired_at[cmd->arg] = lv_tick_get() | 1;	// Never 0
+		}
+		break;
+	case UI_CMD_CAPTURE:
+		if (cmd->arg == 0) {
+			frame_capture_stop();
+		} else {
+			frame_capture_start(capture_name, cmd->arg);
+			lv_obj_invalidate(lv_screen_active());	// Keyframe: the next frame flushes everything
+		}
+		break;
+	case UI_CMD_SPI_CAL:
+		if (cmd->arg != 0) {
+			spi_clock.cached_hz = 0;	// Full search
+		}
+		lcd_calibrate_clock();
+#if LCD_DIFF
+		lcd_diff_invalidate(&lcd_diff);
+#endif
+		lv_obj_invalidate(lv_screen_active());	// Test patterns and a possible lcd_init
+		break;
+#if LCD_DIFF
+	case UI_CMD_LCD_DIFF:
+		if (cmd->arg != 0 && !lcd_diff_on) {
+			lcd_diff_invalidate(&lcd_diff);	// Flushes went around the shadow while off
+			lv_obj_invalidate(lv_screen_active());
+		}
+		lcd_diff_on = cmd->arg != 0;
+		break;
+#endif
+	case UI_CMD_THEME:
+		ui_theme_set((ui_theme_id_t)cmd->arg);
+		break;
+	case UI_CMD_TOAST:
+		if (cmd->text != NULL) {
+			show_toast(cmd->text);
+		}
+		break;
+	case UI_CMD_BRIGHTNESS:
+		set_backlight_brightness((cmd->arg > 100 ? 100 : cmd->arg) / 100.0f);
+		break;
+	case UI_CMD_SUSPEND:
+		lv_timer_enable(false);
+		ui_suspended = true;
+		break;
+	case UI_CMD_RESUME:
+		lv_timer_enable(true);		// Overdue timers run on the next pass, labels are current in one frame
+		ui_suspended = false;
+		break;
+	}
+}
+
+/* @brief Applies the commands other tasks posted, lvgl_task only
+ * @note Called once per lv_timer_handler() pass, so one batch lands in one frame
+ */
+void display_apply_ui_commands(void)
+{
+	ui_cmd_t cmd;
+	uint32_t count = 0;
+
+	if (tabview == NULL) {
+		return;		// UI not built yet, keep the commands queued
+	}
+	// Bounded, producers posting faster than a frame cannot starve rendering
+	while (count < UI_CMD_QUEUE_LEN && ui_cmd_take(&cmd)) {
+		ui_cmd_apply(&cmd);
+		count++;
+	}
+	ui_cmd_batch_done(count);
+}
+
+/* @brief LVGL timers are stopped (power idle), lvgl_task can block until a command arrives */
+bool display_ui_suspended(void)
+{
+	return ui_suspended;
+}
+
+/* @brief Console: ui [tab <n>|bl <0-100>|theme <light|dark>], posts through the queue like any other task */
+static void ui_command(int argc, char **argv)
+{
+	if (argc == 3 && strcmp(argv[1], "tab") == 0) {
+		ui_cmd_post(UI_CMD_SWITCH_TAB, (uint8_t)atoi(argv[2]));
+		return;
+	}
+	if (argc == 3 && strcmp(argv[1], "bl") == 0) {
+		ui_cmd_post(UI_CMD_BRIGHTNESS, (uint8_t)atoi(argv[2]));
+		return;
+	}
+	if (argc == 3 && strcmp(argv[1], "theme") == 0) {
+		for (int t = 0; t < UI_THEMES; t++) {
+			if (strcmp(argv[2], ui_theme_names[t]) == 0) {
+				ui_cmd_post(UI_CMD_THEME, (uint8_t)t);
+				return;
+			}
+		}
+		printf("ui theme light|dark\n");
+		return;
+	}
+	ui_cmd_stats_t stats;
+	ui_cmd_get_stats(&stats);
+	printf("posted %lu, dropped %lu, batches %lu, largest batch %lu\n", (unsigned long)stats.posted,
+	       (unsigned long)stats.dropped, (unsigned long)stats.batches, (unsigned long)stats.max_batch);
+}
+
+/* @brief Console: fb [reset], frame-budget governor level and frame times */
+static void fb_command(int argc, char **argv)
+{
+	if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+		frame_budget_reset_stats(&frame_budget);	// Racy against lvgl_task, counters only
+		return;
+	}
+	frame_budget_print(&frame_budget);
+}
+
+/* @brief Console: spi [cal], SPI clock calibration and readback spot checks */
+static void spi_command(int argc, char **argv)
+{
+	if (argc == 2 && strcmp(argv[1], "cal") == 0) {
+		ui_cmd_post(UI_CMD_SPI_CAL, 1);	// lvgl_task owns the SPI device
+		return;
+	}
+	spi_clock_print(&spi_clock);
+}
+
+#if LCD_DIFF
+/* @brief Console: diff [on|off|reset], bytes the shadow-framebuffer diff kept off the SPI bus */
+static void diff_command(int argc, char **argv)
+{
+	if (argc == 2 && (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0)) {
+		ui_cmd_post(UI_CMD_LCD_DIFF, strcmp(argv[1], "on") == 0);
+		return;
+	}
+	if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+		lcd_diff_reset_stats(&lcd_diff);	// Racy against lvgl_task, counters only
+		lcd_diff_since_us = esp_timer_get_time();
+		return;
+	}
+	// Racy against lvgl_task, counters only
+	double seconds = (esp_timer_get_time() - lcd_diff_since_us) / 1e6;
+	uint64_t saved = lcd_diff.bytes_in - lcd_diff.bytes_out;
+	printf("%s, %s, window worth %lu bytes\n", lcd_diff_on ? "on" : "off",
+	       lcd_diff.synced ? "synced" : "resyncing", (unsigned long)lcd_diff.window_cost);
+	printf("areas %lu (%lu unchanged), windows %lu\n", (unsigned long)lcd_diff.areas,
+	       (unsigned long)lcd_diff.areas_clean, (unsigned long)lcd_diff.windows);
+	printf("flushed %llu bytes, sent %llu, saved %.1f%%, %.0f bytes/s saved over %.0f s\n",
+	       (unsigned long long)lcd_diff.bytes_in, (unsigned long long)lcd_diff.bytes_out,
+	       lcd_diff.bytes_in ? 100.0 * saved / lcd_diff.bytes_in : 0.0, seconds > 0 ? saved / seconds : 0.0, seconds);
+}
+#endif
+
+/* @brief Console: cap [name|on|off|stats], frame capture on the telemetry UART
+ * @note tools/capture/capture_decode.py rebuilds the frames and compares them with golden images
+ */
+static void capture_command(int argc, char **argv)
+{
+	if (argc == 2 && strcmp(argv[1], "stats") == 0) {
+		capture_stats_t s;
+		frame_capture_get_stats(&s);
+		uint32_t frames = s.frames ? s.frames : 1;
+		printf("frames %lu, areas %lu, packets %lu, %llu px -> %llu bytes (%.1f:1)\n",
+		       (unsigned long)s.frames, (unsigned long)s.areas, (unsigned long)s.packets,
+		       (unsigned long long)s.pixels, (unsigned long long)s.bytes,
+		       s.bytes ? (double)s.pixels * 2 / s.bytes : 0.0);
+		printf("per frame %llu bytes, capture %llu us avg, %lu us max, last %lu bytes %lu us\n",
+		       (unsigned long long)(s.bytes / frames), (unsigned long long)(s.capture_us / frames),
+		       (unsigned long)s.max_capture_us, (unsigned long)s.last_bytes, (unsigned long)s.last_capture_us);
+		return;
+	}
+	if (argc == 2 && strcmp(argv[1], "off") == 0) {
+		ui_cmd_post(UI_CMD_CAPTURE, 0);
+		return;
+	}
+	if (argc == 2 && strcmp(argv[1], "on") == 0) {
+		capture_name[0] = '\0';
+		ui_cmd_post(UI_CMD_CAPTURE, CAPTURE_CONTINUOUS);
+		return;
+	}
+	snprintf(capture_name, sizeof(capture_name), "%s", argc == 2 ? argv[1] : "");
+	ui_cmd_post(UI_CMD_CAPTURE, 1);
+}
+
+/* @brief Tapping a hero row acts like its key (K1 - K5)
+ * @note Runs on lvgl_task, process_key() takes the game state lock like the key scan does
+ */
+static void hero_clicked_cb(lv_event_t * e)
+{
+	int hero = (int)(intptr_t)lv_event_get_user_data(e);
+	process_key(0, hero);
 }
 
 void lv_example_tabview_1(void)
@@ -586,15 +1187,14 @@ void lv_example_tabview_1(void)
     lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_COLUMN);
 
     // REMOVE default styling (important!)
-    lv_obj_set_style_pad_all(parent, 0, 0);
-    lv_obj_set_style_border_width(parent, 0, 0);
-    lv_obj_set_style_bg_opa(parent, LV_OPA_TRANSP, 0);  // Optional: transparent background
+    ui_theme_apply(parent, UI_CLASS_PLAIN);
 
     // Create the tabview
     tabview = lv_tabview_create(parent);
     lv_obj_set_width(tabview, LV_PCT(100));
     lv_obj_set_height(tabview, 270); // Manually leave space for footer
     lv_obj_set_flex_grow(tabview, 1);
+    lv_obj_add_event_cb(tabview, tab_changed_cb, LV_EVENT_VALUE_CHANGED, NULL);
 
     // Add tabs
     lv_obj_t * tab1 = lv_tabview_add_tab(tabview, "Ult Cooldowns");
@@ -607,11 +1207,11 @@ void lv_example_tabview_1(void)
 
 	/* Tab #1 */
 	lv_label_set_text(label1, "Filler Text\nReserved for later use.");
-	lv_obj_set_style_text_font(label1, &lv_font_montserrat_38, 0);
+	ui_theme_apply(label1, UI_CLASS_HEADER);
 
 	/* Tab #2 */
     lv_label_set_text(label2, "Filler Text\nReserved for later use.");
-	lv_obj_set_style_text_font(label2, &lv_font_montserrat_38, 0);
+	ui_theme_apply(label2, UI_CLASS_HEADER);
 
 	/* Tab #3 */
 	lv_timer_t * heroes_t = lv_timer_create(hero_timer, 250, NULL);
@@ -621,17 +1221,17 @@ void lv_example_tabview_1(void)
 	lv_obj_set_size(hero_container, LV_PCT(100), LV_SIZE_CONTENT);
 	lv_obj_set_layout(hero_container, LV_LAYOUT_FLEX);
 	lv_obj_set_flex_flow(hero_container, LV_FLEX_FLOW_COLUMN); // Stack vertically
-	lv_obj_set_style_pad_column(hero_container, 8, 0); // Optional spacing between labels
-	lv_obj_set_style_pad_all(hero_container, 0, 0); // No padding around the container
+	ui_theme_apply(hero_container, UI_CLASS_LIST); // No padding, border or background, spacing between labels
 	lv_obj_set_scrollbar_mode(hero_container, LV_SCROLLBAR_MODE_OFF); // Optional
-	lv_obj_set_style_border_width(hero_container, 0, 0);   // Remove border
-	lv_obj_set_style_bg_opa(hero_container, LV_OPA_TRANSP, 0); // Make background transparent
 
 	// Now create and add labels into the container
 	for (int i = 0; i < HERO_COUNT; i++) {
 		hero_labels[i] = lv_label_create(hero_container); // Add to container, not directly to tab
 		lv_label_set_text_fmt(hero_labels[i], "Hero #%d: -------", i + 1); // No newline needed!
-		lv_obj_set_style_text_font(hero_labels[i], &lv_font_montserrat_24, 0);
+		ui_theme_apply(hero_labels[i], UI_CLASS_ROW);
+		lv_obj_set_width(hero_labels[i], LV_PCT(100));	// Whole row is the touch target
+		lv_obj_add_flag(hero_labels[i], LV_OBJ_FLAG_CLICKABLE);
+		lv_obj_add_event_cb(hero_labels[i], hero_clicked_cb, LV_EVENT_CLICKED, (void *)(intptr_t)i);
 	}
 
     /* FOOTER */
@@ -640,14 +1240,46 @@ void lv_example_tabview_1(void)
     lv_timer_t * timer = lv_timer_create(my_timer, 100, NULL);
 	lv_obj_set_width(footer, LV_PCT(100));
     lv_obj_set_flex_grow(footer, 0); // Ensure it doesn't expand
-    lv_obj_set_style_text_align(footer, LV_TEXT_ALIGN_CENTER, 0);
-    lv_obj_set_style_pad_all(footer, 2, 0);
-    lv_obj_set_style_bg_color(footer, lv_color_white(), 0);
-    lv_obj_set_style_text_color(footer, lv_color_black(), 0);
-	lv_obj_set_style_text_font(footer, &lv_font_montserrat_24, 0);
+    ui_theme_apply(footer, UI_CLASS_FOOTER);
 
 	lv_tabview_set_act(tabview, indexing, LV_ANIM_OFF);
-	lv_timer_t * timer2 = lv_timer_create(index_timer, 50, NULL);
+}
+
+/* @brief Refresh start, for the key-to-photon trace */
+static void latency_refr_cb(lv_event_t * e)
+{
+	latency_trace_render_start();
+}
+
+/* @brief LV_EVENT_REFR_START / LV_EVENT_REFR_READY, feeds the frame-budget governor and the capture stream */
+static void frame_refr_cb(lv_event_t * e)
+{
+	lv_display_t * display = lv_event_get_target(e);
+
+	if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+		frame_start_us = esp_timer_get_time();
+		frame_px = 0;
+#if LCD_DIFF
+		lcd_diff_frame_begin(&lcd_diff);
+#endif
+		frame_capture_frame_begin(lv_display_get_horizontal_resolution(display),
+		                          lv_display_get_vertical_resolution(display));
+		return;
+	}
+	int64_t now = esp_timer_get_time();
+	uint32_t frame_us = now - frame_start_us;
+	// Capture time is left out, a capture must not change the effects it records
+	uint32_t capture_us = frame_capture_frame_end(frame_us);
+#if LCD_DIFF
+	lcd_diff_frame_end(&lcd_diff);
+#endif
+	if (frame_budget_frame(&frame_budget, now, frame_us - capture_us, frame_px)) {
+		// Slower refresh when over budget, the animations then step less often too
+		lv_timer_set_period(lv_display_get_refr_timer(display),
+		                    frame_budget.level == FB_FULL ? FB_REFR_PERIOD_FULL_MS : FB_REFR_PERIOD_SLOW_MS);
+		// Row effects follow on the next hero_timer
+	}
+	lcd_spot_check();	// No flush in flight, outside the frame time above
 }
 
 void lvgl_setup(void) {
@@ -673,5 +1305,24 @@ void lvgl_setup(void) {
     /* Set tick callback (required for animations, delays, etc.) */
     lv_tick_set_cb(my_tick_get_cb); 
 
+    display_stats_init(display1);
+    lv_display_add_event_cb(display1, latency_refr_cb, LV_EVENT_REFR_START, NULL);
+    frame_budget_init(&frame_budget, FB_BUDGET_US);
+#if LCD_DIFF
+    lcd_diff_init(&lcd_diff, lcd_shadow, MY_DISP_HOR_RES, MY_DISP_VER_RES);	// First frame is full, syncs it
+    lcd_diff_since_us = esp_timer_get_time();
+    serial_link_register_command("diff", "Shadow-framebuffer diff bytes saved, diff [on|off|reset]", diff_command);
+#endif
+    lv_display_add_event_cb(display1, frame_refr_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(display1, frame_refr_cb, LV_EVENT_REFR_READY, NULL);
+
+	ui_theme_init(display1);	// Shared styles, before any object uses them
 	lv_example_tabview_1();
+	lv_timer_create(lvgl_mem_timer, 1000, NULL);
+	serial_link_register_command("cap", "Frame capture on the telemetry UART, cap [name|on|off|stats]",
+	                             capture_command);
+	serial_link_register_command("spi", "SPI clock and readback checks, spi cal searches again", spi_command);
+	serial_link_register_command("fb", "Frame budget level and frame times, fb reset", fb_command);
+	serial_link_register_command("ui", "UI command queue stats, ui tab <n>, ui bl <0-100>, ui theme <light|dark>",
+	                             ui_command);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include <stdbool.h>
 #include "driver/spi_master.h"
 #include "lvgl.h"
 
@@ -21,6 +22,14 @@ void lcd_clear2(uint16_t color);
 void lcd_clear_window(uint16_t xStart, uint16_t yStart, uint16_t xEnd, uint16_t yEnd, uint16_t color);
 void lcd_set_window_color(uint16_t xStart, uint16_t yStart, uint16_t xEnd, uint16_t yEnd, uint16_t color);
 void lcd_set_pixel(uint16_t x, uint16_t y, uint16_t color);
+void lcd_calibrate_clock(void);
+#define UI_FLASH_MS 300    // UI_CMD_FLASH_ROW highlight
+#define UI_TOAST_MS 1500   // UI_CMD_TOAST on screen
+#define UI_WARN_S 10       // Buyback row highlighted this long before it ends
+#define UI_EXPIRED_MS 5000 // and this long after (UI_CMD_EXPIRED_ROW)
+
 void lvgl_setup(void);
+void display_apply_ui_commands(void);
+bool display_ui_suspended(void);
 
 #endif
\ No newline at end of file
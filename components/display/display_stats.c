@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+
+#include "../serial_link/serial_link.h"
+#include "display_stats.h"
+#include "ui_theme.h"
+
+#if DISPLAY_STATS
+
+static display_stats_t stats;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Current refresh, only touched from the LVGL task */
+static int64_t refr_start_us = 0;
+static int64_t refr_flush_us = 0;
+static uint32_t refr_flushes = 0;
+static int64_t fps_window_us = 0;
+static uint32_t fps_frames = 0;
+
+static lv_obj_t *overlay = NULL;
+static volatile bool overlay_requested = false;
+
+static void display_hist_add(display_hist_t *hist, uint32_t value) {
+    uint32_t bucket = value ? 32 - __builtin_clz(value) : 0;
+    if (bucket >= DISPLAY_STATS_BUCKETS) {
+        bucket = DISPLAY_STATS_BUCKETS - 1;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->total += value;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+/* @brief Upper bound of the bucket holding the given percentile
+ * @param percent 0-100
+ */
+uint32_t display_hist_percentile(const display_hist_t *hist, uint32_t percent) {
+    uint32_t target = (uint32_t)(((uint64_t)hist->count * percent + 99) / 100);
+    uint32_t seen = 0;
+
+    for (int b = 0; b < DISPLAY_STATS_BUCKETS; b++) {
+        seen += hist->buckets[b];
+        if (seen >= target && seen > 0) {
+            uint32_t upper = b ? (1u << b) - 1 : 0;
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+/* @brief Records one flush, called at the end of my_flush_cb
+ * @param start_us esp_timer time the flush started
+ * @param pixels Pixels in the flushed area
+ */
+void display_stats_flush(int64_t start_us, uint32_t pixels) {
+    int64_t duration = esp_timer_get_time() - start_us;
+
+    refr_flush_us += duration;
+    refr_flushes++;
+    portENTER_CRITICAL(&stats_mux);
+    display_hist_add(&stats.flush_us, (uint32_t)duration);
+    display_hist_add(&stats.flush_px, pixels);
+    stats.flushes++;
+    stats.pixels += pixels;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+/* @brief LV_EVENT_REFR_START / LV_EVENT_REFR_READY of the display */
+static void display_stats_refr_cb(lv_event_t *e) {
+    int64_t now = esp_timer_get_time();
+
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        refr_start_us = now;
+        refr_flush_us = 0;
+        refr_flushes = 0;
+        return;
+    }
+    if (refr_flushes == 0) {
+        return;     // Nothing was invalidated, not a frame
+    }
+    int64_t render = (now - refr_start_us) - refr_flush_us;
+
+    portENTER_CRITICAL(&stats_mux);
+    display_hist_add(&stats.areas, refr_flushes);
+    display_hist_add(&stats.render_us, render > 0 ? (uint32_t)render : 0);
+    stats.frames++;
+    if (now - fps_window_us >= 1000000) {
+        if (fps_frames > 0) {
+            display_hist_add(&stats.fps, fps_frames);
+        }
+        fps_window_us = now;
+        fps_frames = 0;
+    }
+    fps_frames++;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void display_stats_get(display_stats_t *out) {
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void display_stats_reset(void) {
+    portENTER_CRITICAL(&stats_mux);
+    memset(&stats, 0, sizeof(stats));
+    stats.since_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+static void display_hist_print(const char *name, const char *unit, const display_hist_t *hist) {
+    printf("%-10s n=%-7lu avg=%-7lu p50<=%-7lu p99<=%-7lu max=%lu %s\n", name,
+           (unsigned long)hist->count,
+           (unsigned long)(hist->count ? hist->total / hist->count : 0),
+           (unsigned long)display_hist_percentile(hist, 50),
+           (unsigned long)display_hist_percentile(hist, 99),
+           (unsigned long)hist->max, unit);
+    for (int b = 0; b < DISPLAY_STATS_BUCKETS; b++) {
+        if (hist->buckets[b]) {
+            printf("    <%-8lu %lu\n", (unsigned long)(1ul << b), (unsigned long)hist->buckets[b]);
+        }
+    }
+}
+
+/* @brief Console: dstats [reset] */
+static void display_stats_command(int argc, char **argv) {
+    static display_stats_t s;   // Too big for the serial_link_task stack
+
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        display_stats_reset();
+        printf("display stats reset\n");
+        return;
+    }
+    display_stats_get(&s);
+    printf("%lu frames, %lu flushes, %llu px in %lld ms\n", (unsigned long)s.frames,
+           (unsigned long)s.flushes, (unsigned long long)s.pixels,
+           (esp_timer_get_time() - s.since_us) / 1000);
+    display_hist_print("flush", "us", &s.flush_us);
+    display_hist_print("pixels", "px/flush", &s.flush_px);
+    display_hist_print("areas", "flushes/frame", &s.areas);
+    display_hist_print("render", "us/frame", &s.render_us);
+    display_hist_print("fps", "frames/s", &s.fps);
+}
+
+/* @brief Shows, hides and updates the overlay from the LVGL task */
+static void display_stats_overlay_timer(lv_timer_t *timer) {
+    if (!overlay_requested) {
+        if (overlay != NULL) {
+            lv_obj_delete(overlay);
+            overlay = NULL;
+        }
+        return;
+    }
+    if (overlay == NULL) {
+        overlay = lv_label_create(lv_layer_top());
+        ui_theme_apply(overlay, UI_CLASS_OVERLAY);
+        lv_obj_align(overlay, LV_ALIGN_TOP_RIGHT, 0, 0);
+    }
+
+    display_stats_t s;
+    display_stats_get(&s);
+    uint32_t flush_avg = s.flush_us.count ? (uint32_t)(s.flush_us.total / s.flush_us.count) : 0;
+    uint32_t render_avg = s.render_us.count ? (uint32_t)(s.render_us.total / s.render_us.count) : 0;
+    uint32_t areas_x10 = s.frames ? (uint32_t)((uint64_t)s.flushes * 10 / s.frames) : 0;
+    lv_label_set_text_fmt(overlay, "fps %lu (max %lu)\nflush %lu us (max %lu)\nrender %lu us\nareas %lu.%lu",
+                          (unsigned long)display_hist_percentile(&s.fps, 50), (unsigned long)s.fps.max,
+                          (unsigned long)flush_avg, (unsigned long)s.flush_us.max,
+                          (unsigned long)render_avg,
+                          (unsigned long)(areas_x10 / 10), (unsigned long)(areas_x10 % 10));
+}
+
+void display_stats_toggle_overlay(void) {
+    overlay_requested = !overlay_requested;
+}
+
+/* @brief Hooks the refresh events of the display and registers "dstats"
+ * @param display LVGL display driven by my_flush_cb
+ */
+void display_stats_init(lv_display_t *display) {
+    display_stats_reset();
+    lv_display_add_event_cb(display, display_stats_refr_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(display, display_stats_refr_cb, LV_EVENT_REFR_READY, NULL);
+    lv_timer_create(display_stats_overlay_timer, DISPLAY_STATS_OVERLAY_MS, NULL);
+    serial_link_register_command("dstats", "Display flush/render histograms, dstats reset", display_stats_command);
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef DISPLAY_STATS_H
+#define DISPLAY_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+
+/* Display pipeline telemetry
+ *
+ * Log2 histograms of flush duration, pixels per flush, flushes (areas) per
+ * frame, render time per refresh (refresh time minus time spent flushing)
+ * and frames per second. Read with the "dstats" console command, or toggle
+ * the on-screen overlay with K11 + K8 (the overlay itself adds a small
+ * frame every DISPLAY_STATS_OVERLAY_MS while shown).
+ *
+ * With DISPLAY_STATS 0 the hooks expand to nothing.
+ */
+
+#define DISPLAY_STATS               1
+#define DISPLAY_STATS_BUCKETS       20      // Bucket b holds values in [2^(b-1), 2^b), bucket 0 holds 0
+#define DISPLAY_STATS_OVERLAY_MS    500     // Overlay refresh period
+
+typedef struct {
+    uint32_t buckets[DISPLAY_STATS_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+} display_hist_t;
+
+typedef struct {
+    display_hist_t flush_us;
+    display_hist_t flush_px;
+    display_hist_t areas;           // Flushes per frame
+    display_hist_t render_us;       // Per frame, without the flushes
+    display_hist_t fps;             // One sample per second with frames
+    uint32_t frames;
+    uint32_t flushes;
+    uint64_t pixels;
+    int64_t since_us;
+} display_stats_t;
+
+#if DISPLAY_STATS
+
+#define DISPLAY_STATS_FLUSH_BEGIN()     int64_t display_stats_flush_start = esp_timer_get_time()
+#define DISPLAY_STATS_FLUSH_END(px)     display_stats_flush(display_stats_flush_start, (px))
+
+void display_stats_init(lv_display_t *display);
+void display_stats_flush(int64_t start_us, uint32_t pixels);
+void display_stats_get(display_stats_t *out);
+void display_stats_reset(void);
+uint32_t display_hist_percentile(const display_hist_t *hist, uint32_t percent);
+void display_stats_toggle_overlay(void);
+
+#else
+
+#define DISPLAY_STATS_FLUSH_BEGIN()     do { } while (0)
+#define DISPLAY_STATS_FLUSH_END(px)     do { } while (0)
+
+static inline void display_stats_init(lv_display_t *display) { }
+static inline void display_stats_toggle_overlay(void) { }
+
+#endif
+
+#endif
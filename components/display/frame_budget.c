@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include "frame_budget.h"
+
+const char *const fb_level_names[FB_LEVELS] = { "full", "reduced", "minimal" };
+
+void frame_budget_init(frame_budget_t *fb, uint32_t budget_us) {
+    memset(fb, 0, sizeof(*fb));
+    fb->budget_us = budget_us;
+    fb->avg_ns_per_px = 250;    // ~SPI at 80 MHz plus rendering, until measured
+    fb->window_start_us = -1;
+}
+
+/* @brief Closes a load window and moves the level
+ * @return true if the level changed
+ */
+static bool frame_budget_window(frame_budget_t *fb, int64_t elapsed_us) {
+    uint8_t before = fb->level;
+
+    fb->load_us = (uint32_t)((int64_t)fb->window_busy_us * (FB_REFR_PERIOD_FULL_MS * 1000) / elapsed_us);
+    fb->windows++;
+    if (fb->load_us > fb->max_load_us) {
+        fb->max_load_us = fb->load_us;
+    }
+
+    if (fb->load_us > fb->budget_us) {
+        fb->windows_over++;
+        fb->under_run = 0;
+        if (++fb->over_run >= FB_OVER_WINDOWS && fb->level < FB_MINIMAL) {
+            fb->level++;
+            fb->over_run = 0;
+        }
+    } else if (fb->load_us < fb->budget_us * FB_RECOVER_PCT / 100) {
+        fb->over_run = 0;
+        if (++fb->under_run >= FB_RECOVER_WINDOWS && fb->level > FB_FULL) {
+            fb->level--;
+            fb->under_run = 0;
+        }
+    } else {
+        fb->over_run = 0;
+        fb->under_run = 0;
+    }
+
+    if (fb->level != before) {
+        fb->level_changes++;
+        return true;
+    }
+    return false;
+}
+
+/* @brief Accounts one refresh
+ * @param now_us Time the refresh finished
+ * @param frame_us Render start to the last flush done
+ * @param pixels Pixels flushed in this refresh
+ * @return true if the level changed
+ */
+bool frame_budget_frame(frame_budget_t *fb, int64_t now_us, uint32_t frame_us, uint32_t pixels) {
+    if (pixels > 0) {
+        int32_t ns_per_px = (int32_t)((uint64_t)frame_us * 1000 / pixels);
+        fb->avg_ns_per_px += (ns_per_px - (int32_t)fb->avg_ns_per_px) / 8;
+    }
+
+    fb->frames++;
+    fb->frames_at[fb->level]++;
+    if (frame_us > fb->budget_us) {
+        fb->frames_over++;
+    }
+    if (frame_us > fb->max_frame_us) {
+        fb->max_frame_us = frame_us;
+    }
+    uint32_t bucket = frame_us ? 32 - __builtin_clz(frame_us) : 0;
+    fb->hist[bucket < FB_HIST_BUCKETS ? bucket : FB_HIST_BUCKETS - 1]++;
+
+    // Frames are judged by the load, one slow flush does not drop a level
+    if (fb->window_start_us < 0) {
+        fb->window_start_us = now_us - frame_us;
+    }
+    fb->window_busy_us += frame_us;
+    int64_t elapsed = now_us - fb->window_start_us;
+    if (elapsed < FB_WINDOW_MS * 1000) {
+        return false;
+    }
+    bool changed = frame_budget_window(fb, elapsed);
+    fb->window_start_us = now_us;
+    fb->window_busy_us = 0;
+    return changed;
+}
+
+/* @brief Pixels per frame fades may invalidate, 0 unless FB_FULL */
+uint32_t frame_budget_anim_px(const frame_budget_t *fb) {
+    if (fb->level != FB_FULL || fb->avg_ns_per_px == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)fb->budget_us * FB_ANIM_SHARE_PCT / 100 * 1000 / fb->avg_ns_per_px);
+}
+
+/* @brief Effect for one highlighted row
+ * @param row_px Area of the row
+ * @param anim_px_left Start with frame_budget_anim_px(), fades are taken out of it
+ *        in the order rows are picked
+ */
+fb_fx_t frame_budget_pick_fx(const frame_budget_t *fb, uint32_t row_px, uint32_t *anim_px_left) {
+    if (fb->level == FB_MINIMAL) {
+        return FB_FX_STEADY;
+    }
+    if (fb->level == FB_FULL && row_px <= *anim_px_left) {
+        *anim_px_left -= row_px;
+        return FB_FX_FADE;
+    }
+    return FB_FX_BLINK;
+}
+
+void frame_budget_reset_stats(frame_budget_t *fb) {
+    fb->frames = 0;
+    fb->frames_over = 0;
+    fb->max_frame_us = 0;
+    fb->windows = 0;
+    fb->windows_over = 0;
+    fb->max_load_us = 0;
+    fb->level_changes = 0;
+    memset(fb->frames_at, 0, sizeof(fb->frames_at));
+    memset(fb->hist, 0, sizeof(fb->hist));
+}
+
+void frame_budget_print(const frame_budget_t *fb) {
+    printf("level %s, budget %lu us/frame, load %lu us/frame, %lu ns/px, fades %lu px/frame\n",
+           fb_level_names[fb->level], (unsigned long)fb->budget_us, (unsigned long)fb->load_us,
+           (unsigned long)fb->avg_ns_per_px, (unsigned long)frame_budget_anim_px(fb));
+    printf("windows %lu, over budget %lu (%.1f%%), max load %lu us/frame, level changes %lu\n",
+           (unsigned long)fb->windows, (unsigned long)fb->windows_over,
+           fb->windows ? 100.0 * fb->windows_over / fb->windows : 0.0,
+           (unsigned long)fb->max_load_us, (unsigned long)fb->level_changes);
+    printf("frames %lu, longer than budget %lu, max %lu us\n",
+           (unsigned long)fb->frames, (unsigned long)fb->frames_over, (unsigned long)fb->max_frame_us);
+    for (int i = 0; i < FB_LEVELS; i++) {
+        printf("  %-8s %lu frames\n", fb_level_names[i], (unsigned long)fb->frames_at[i]);
+    }
+    for (int i = 0; i < FB_HIST_BUCKETS; i++) {
+        if (fb->hist[i] != 0) {
+            printf("  < %7lu us %lu\n", 1UL << i, (unsigned long)fb->hist[i]);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef FRAME_BUDGET_H
+#define FRAME_BUDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Frame-budget governor for row highlights
+ *
+ * Fed with the render + flush time and flushed pixels of every LVGL refresh,
+ * it measures the render load (busy time per FB_WINDOW_MS, scaled to one
+ * FB_REFR_PERIOD_FULL_MS frame) and the cost per pixel, and picks how
+ * expensive the highlight effects may be:
+ *
+ *   FB_FULL     fades (an animation invalidates its row every frame), as many
+ *               rows as frame_budget_anim_px() allows, the rest as FB_REDUCED
+ *   FB_REDUCED  colour swap every FB_BLINK_MS instead of a fade, slower refresh
+ *   FB_MINIMAL  steady colour, changes only when the row's state does
+ *
+ * A level is dropped after FB_OVER_WINDOWS windows over budget in a row and
+ * restored after FB_RECOVER_WINDOWS windows under FB_RECOVER_PCT of it, so the
+ * key scan and the 1 s tick keep their share of the core.
+ *
+ * No LVGL or ESP-IDF dependencies, builds on a host (tools/frame_budget).
+ */
+
+#define FB_BUDGET_US            10000   // Render + flush per 33 ms frame, ~30 % of the core
+#define FB_ANIM_SHARE_PCT       50      // Part of the budget fades may use
+#define FB_WINDOW_MS            250
+#define FB_OVER_WINDOWS         2       // 0.5 s over budget drops a level
+#define FB_RECOVER_WINDOWS      8       // 2 s under FB_RECOVER_PCT restores one
+#define FB_RECOVER_PCT          60
+#define FB_BLINK_MS             500
+#define FB_REFR_PERIOD_FULL_MS  33
+#define FB_REFR_PERIOD_SLOW_MS  66      // FB_REDUCED and FB_MINIMAL
+#define FB_HIST_BUCKETS         20      // log2 of frame us
+
+typedef enum {
+    FB_FULL = 0,
+    FB_REDUCED,
+    FB_MINIMAL,
+    FB_LEVELS
+} fb_level_t;
+
+/* Highlight effect of one row */
+typedef enum {
+    FB_FX_NONE = 0,
+    FB_FX_STEADY,                   // FB_MINIMAL
+    FB_FX_BLINK,                    // FB_REDUCED, or FB_FULL rows past the animation cap
+    FB_FX_FADE                      // FB_FULL, invalidates the row every frame
+} fb_fx_t;
+
+typedef struct {
+    uint32_t budget_us;
+    uint32_t load_us;               // Busy time of the last window per 33 ms frame
+    uint32_t avg_ns_per_px;         // Moving average, 1/8 weight
+    uint8_t level;                  // fb_level_t
+    uint8_t over_run;               // Consecutive windows over budget
+    uint8_t under_run;              // Consecutive windows under FB_RECOVER_PCT
+    int64_t window_start_us;
+    uint32_t window_busy_us;
+
+    /* Statistics */
+    uint32_t frames;
+    uint32_t frames_over;           // Single frames longer than the budget
+    uint32_t max_frame_us;
+    uint32_t windows;
+    uint32_t windows_over;          // Load over budget, what the governor acts on
+    uint32_t max_load_us;
+    uint32_t level_changes;
+    uint32_t frames_at[FB_LEVELS];
+    uint32_t hist[FB_HIST_BUCKETS];
+} frame_budget_t;
+
+extern const char *const fb_level_names[FB_LEVELS];
+
+void frame_budget_init(frame_budget_t *fb, uint32_t budget_us);
+bool frame_budget_frame(frame_budget_t *fb, int64_t now_us, uint32_t frame_us, uint32_t pixels);
+uint32_t frame_budget_anim_px(const frame_budget_t *fb);
+fb_fx_t frame_budget_pick_fx(const frame_budget_t *fb, uint32_t row_px, uint32_t *anim_px_left);
+void frame_budget_reset_stats(frame_budget_t *fb);
+void frame_budget_print(const frame_budget_t *fb);
+
+#endif
@@ -0,0 +1,228 @@
+#include <string.h>
+#include "frame_capture.h"
+
+#define CAPTURE_SYNC0       0xD2
+#define CAPTURE_SYNC1       0x7B
+#define CAPTURE_HEADER      8
+#define CAPTURE_RUN_MAX     128
+
+static uint8_t packet[CAPTURE_HEADER + CAPTURE_PAYLOAD_MAX + 2];
+static capture_sink_t sink = NULL;
+static void *sink_ctx = NULL;
+static int64_t (*clock_us)(void) = NULL;
+
+static uint16_t next_seq;
+static uint32_t next_frame;
+static uint8_t frames_left;         // CAPTURE_CONTINUOUS = until stopped
+static bool key_pending;
+static char frame_name[CAPTURE_NAME_LEN];
+
+/* Frame in progress, only sent once something is flushed */
+static bool frame_open;
+static uint16_t frame_width, frame_height;
+static capture_end_t frame_end;
+static capture_stats_t stats;
+
+/* @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), as telemetry.c */
+static uint16_t capture_crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* @brief Completes the packet header and CRC around `len` payload bytes and sends it
+ * @return Packet size
+ */
+static size_t capture_send(uint8_t type, size_t len) {
+    uint16_t seq = next_seq++;
+    packet[0] = CAPTURE_SYNC0;
+    packet[1] = CAPTURE_SYNC1;
+    packet[2] = CAPTURE_VERSION;
+    packet[3] = type;
+    memcpy(&packet[4], &seq, 2);
+    packet[6] = len & 0xFF;
+    packet[7] = len >> 8;
+    uint16_t crc = capture_crc16(&packet[2], CAPTURE_HEADER - 2 + len);
+    memcpy(&packet[CAPTURE_HEADER + len], &crc, 2);
+
+    size_t total = CAPTURE_HEADER + len + 2;
+    sink(packet, total, sink_ctx);
+    stats.packets++;
+    return total;
+}
+
+/* @brief RLE-encodes pixels until they or the space run out
+ * @param consumed Pixels encoded
+ * @return Bytes written to dst
+ */
+size_t capture_rle_encode(const uint16_t *px, size_t count, uint8_t *dst, size_t dst_len, size_t *consumed) {
+    size_t i = 0, out = 0;
+
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && run < CAPTURE_RUN_MAX && px[i + run] == px[i]) {
+            run++;
+        }
+        if (run >= 2) {
+            if (out + 3 > dst_len) {
+                break;
+            }
+            dst[out++] = 0x80 | (uint8_t)(run - 1);
+            memcpy(&dst[out], &px[i], 2);
+            out += 2;
+            i += run;
+            continue;
+        }
+
+        // Literal up to the next pair of equal pixels
+        if (out + 3 > dst_len) {
+            break;
+        }
+        size_t max = (dst_len - out - 1) / 2;
+        if (max > CAPTURE_RUN_MAX) {
+            max = CAPTURE_RUN_MAX;
+        }
+        size_t n = 1;
+        while (n < max && i + n < count && !(i + n + 1 < count && px[i + n] == px[i + n + 1])) {
+            n++;
+        }
+        dst[out++] = (uint8_t)(n - 1);
+        memcpy(&dst[out], &px[i], n * 2);
+        out += n * 2;
+        i += n;
+    }
+    *consumed = i;
+    return out;
+}
+
+/* @brief Sets where packets go
+ * @param now_us Clock for the overhead figures
+ */
+void frame_capture_init(capture_sink_t out, void *ctx, int64_t (*now_us)(void)) {
+    sink = out;
+    sink_ctx = ctx;
+    clock_us = now_us;
+}
+
+/* @brief Captures the next frames, the first as a keyframe
+ * @param name Label of the frames for the decoder, NULL or "" numbers them
+ * @param frames Number of frames, CAPTURE_CONTINUOUS until frame_capture_stop()
+ * @note The caller invalidates the whole screen so a keyframe is complete
+ */
+void frame_capture_start(const char *name, uint8_t frames) {
+    memset(frame_name, 0, sizeof(frame_name));
+    if (name != NULL) {
+        strncpy(frame_name, name, sizeof(frame_name) - 1);
+    }
+    if (!frame_capture_active()) {
+        key_pending = true;     // A running capture goes on with deltas, only the name changes
+    }
+    frames_left = frames;
+}
+
+void frame_capture_stop(void) {
+    frames_left = 0;
+}
+
+bool frame_capture_active(void) {
+    return sink != NULL && frames_left != 0;
+}
+
+/* @brief Refresh start, the frame is opened by its first area */
+void frame_capture_frame_begin(uint16_t width, uint16_t height) {
+    frame_width = width;
+    frame_height = height;
+    frame_open = false;
+}
+
+static void capture_open_frame(void) {
+    capture_frame_t hdr = {
+        .frame = next_frame,
+        .time_ms = clock_us ? (uint32_t)(clock_us() / 1000) : 0,
+        .width = frame_width,
+        .height = frame_height,
+        .flags = key_pending ? CAPTURE_FLAG_KEY : 0,
+    };
+    memcpy(hdr.name, frame_name, sizeof(hdr.name));
+    memset(&frame_end, 0, sizeof(frame_end));
+    frame_end.frame = next_frame;
+    memcpy(&packet[CAPTURE_HEADER], &hdr, sizeof(hdr));
+    frame_end.bytes += capture_send(CAPTURE_PKT_FRAME, sizeof(hdr));
+    key_pending = false;
+    frame_open = true;
+}
+
+/* @brief Flushed area, called from the flush callback with LVGL's pixels
+ * @param px (x2 - x1 + 1) * (y2 - y1 + 1) RGB565 pixels, row by row
+ */
+void frame_capture_area(int x1, int y1, int x2, int y2, const uint16_t *px) {
+    if (!frame_capture_active()) {
+        return;
+    }
+    int64_t start = clock_us ? clock_us() : 0;
+    if (!frame_open) {
+        capture_open_frame();
+    }
+
+    size_t count = (size_t)(x2 - x1 + 1) * (y2 - y1 + 1);
+    size_t done = 0;
+    capture_area_t area = { .x1 = x1, .y1 = y1, .x2 = x2, .y2 = y2 };
+    while (done < count) {
+        size_t consumed;
+        size_t len = capture_rle_encode(&px[done], count - done,
+                                        &packet[CAPTURE_HEADER + sizeof(area)],
+                                        CAPTURE_PAYLOAD_MAX - sizeof(area), &consumed);
+        area.offset = done;
+        area.pixels = consumed;
+        memcpy(&packet[CAPTURE_HEADER], &area, sizeof(area));
+        frame_end.bytes += capture_send(CAPTURE_PKT_AREA, sizeof(area) + len);
+        done += consumed;
+    }
+
+    frame_end.areas++;
+    frame_end.pixels += count;
+    if (clock_us) {
+        frame_end.capture_us += (uint32_t)(clock_us() - start);
+    }
+}
+
+/* @brief Refresh ready, closes the frame with its size and overhead figures
+ * @param frame_us Render + flush time of the frame
+ * @return Capture time spent in the frame, 0 if it was not captured
+ */
+uint32_t frame_capture_frame_end(uint32_t frame_us) {
+    if (!frame_open) {
+        return 0;
+    }
+    frame_open = false;
+    frame_end.frame_us = frame_us;
+    frame_end.bytes += CAPTURE_HEADER + sizeof(frame_end) + 2;  // This packet too
+    memcpy(&packet[CAPTURE_HEADER], &frame_end, sizeof(frame_end));
+    capture_send(CAPTURE_PKT_END, sizeof(frame_end));
+
+    stats.frames++;
+    stats.areas += frame_end.areas;
+    stats.pixels += frame_end.pixels;
+    stats.bytes += frame_end.bytes;
+    stats.capture_us += frame_end.capture_us;
+    if (frame_end.capture_us > stats.max_capture_us) {
+        stats.max_capture_us = frame_end.capture_us;
+    }
+    stats.last_bytes = frame_end.bytes;
+    stats.last_capture_us = frame_end.capture_us;
+
+    next_frame++;
+    if (frames_left != CAPTURE_CONTINUOUS && frames_left > 0) {
+        frames_left--;
+    }
+    return frame_end.capture_us;
+}
+
+void frame_capture_get_stats(capture_stats_t *out) {
+    *out = stats;
+}
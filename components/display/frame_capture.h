@@ -0,0 +1,92 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Framebuffer capture stream for golden-image tests
+ *
+ * Hooks the flush path: every area LVGL flushes while a capture runs is
+ * RLE-compressed (the UI is mostly flat colour and text) and handed to a
+ * sink, the telemetry UART on the device or a file in tools/bench. The first
+ * frame of a capture is a full-screen keyframe, later ones only carry the
+ * flushed areas. Decoder and golden compare: tools/capture/capture_decode.py
+ *
+ * Packet (little endian):
+ *   0  sync       0xD2 0x7B (telemetry records use 0xD2 0x7A)
+ *   2  version    CAPTURE_VERSION
+ *   3  type       CAPTURE_PKT_*
+ *   4  seq        u16, increments per packet
+ *   6  len        u16, payload bytes
+ *   8  payload    see capture_frame_t, capture_area_t + RLE, capture_end_t
+ *   .. crc        u16 CRC-16/CCITT-FALSE over version .. end of payload
+ *
+ * RLE of RGB565 pixels in LVGL (CPU) byte order, tokens of one byte:
+ *   0x80 | (n - 1), pixel       n = 1 - 128 copies of one pixel
+ *   (n - 1), n pixels           n = 1 - 128 literal pixels
+ * An area larger than one packet continues in the next one at `offset`.
+ *
+ * No LVGL or ESP-IDF dependencies, builds on a host (tools/bench).
+ */
+
+#define CAPTURE_VERSION         1
+#define CAPTURE_PAYLOAD_MAX     1024    // One packet, one sink write
+#define CAPTURE_NAME_LEN        16
+#define CAPTURE_CONTINUOUS      0xFF    // frame_capture_start(): until stopped
+
+#define CAPTURE_PKT_FRAME       1
+#define CAPTURE_PKT_AREA        2
+#define CAPTURE_PKT_END         3
+
+#define CAPTURE_FLAG_KEY        (1 << 0)    // Full screen, the decoder starts here
+
+typedef struct __attribute__((packed)) {
+    uint32_t frame;
+    uint32_t time_ms;
+    uint16_t width;
+    uint16_t height;
+    uint8_t flags;              // CAPTURE_FLAG_*
+    char name[CAPTURE_NAME_LEN];    // NUL padded, empty = number the frame
+} capture_frame_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t x1, y1, x2, y2;
+    uint32_t offset;            // First pixel of this packet within the area
+    uint16_t pixels;            // Pixels encoded in this packet
+} capture_area_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t frame;
+    uint16_t areas;
+    uint32_t pixels;
+    uint32_t bytes;             // Everything sent for the frame, headers included
+    uint32_t capture_us;        // Encoding and sink writes, the capture overhead
+    uint32_t frame_us;          // Render + flush, capture included
+} capture_end_t;
+
+typedef void (*capture_sink_t)(const void *data, size_t len, void *ctx);
+
+typedef struct {
+    uint32_t frames;
+    uint32_t areas;
+    uint32_t packets;
+    uint64_t pixels;
+    uint64_t bytes;
+    uint64_t capture_us;
+    uint32_t max_capture_us;    // Per frame
+    uint32_t last_bytes;
+    uint32_t last_capture_us;
+} capture_stats_t;
+
+void frame_capture_init(capture_sink_t sink, void *ctx, int64_t (*now_us)(void));
+void frame_capture_start(const char *name, uint8_t frames);
+void frame_capture_stop(void);
+bool frame_capture_active(void);
+void frame_capture_frame_begin(uint16_t width, uint16_t height);
+void frame_capture_area(int x1, int y1, int x2, int y2, const uint16_t *px);
+uint32_t frame_capture_frame_end(uint32_t frame_us);
+void frame_capture_get_stats(capture_stats_t *out);
+size_t capture_rle_encode(const uint16_t *px, size_t count, uint8_t *dst, size_t dst_len, size_t *consumed);
+
+#endif
@@ -0,0 +1,148 @@
+#include <string.h>
+#include "lcd_diff.h"
+
+void lcd_diff_init(lcd_diff_t *d, uint16_t *shadow, uint16_t width, uint16_t height) {
+    memset(d, 0, sizeof(*d));
+    d->shadow = shadow;
+    d->width = width;
+    d->height = height;
+    d->window_cost = LCD_DIFF_WINDOW_COST_BYTES;
+    d->synced = false;      // Whatever was on the panel before LVGL
+}
+
+/* @brief The panel no longer matches the shadow, the caller redraws the whole screen */
+void lcd_diff_invalidate(lcd_diff_t *d) {
+    d->synced = false;
+    d->resync_frame = false;
+}
+
+void lcd_diff_frame_begin(lcd_diff_t *d) {
+    if (!d->synced) {
+        d->resync_frame = true;
+    }
+}
+
+void lcd_diff_frame_end(lcd_diff_t *d) {
+    if (d->resync_frame) {
+        d->synced = true;   // Every area of the full redraw went out whole
+        d->resync_frame = false;
+    }
+}
+
+/* @brief Sends one rectangle of the area and copies it into the shadow
+ * @param ax1 ay1 aw Origin and width of the flushed area px belongs to
+ */
+static uint32_t lcd_diff_send(lcd_diff_t *d, const lcd_diff_rect_t *r, int ax1, int ay1, int aw,
+                              const uint16_t *px, lcd_diff_send_t send, void *ctx) {
+    const uint16_t *src = px + (r->y1 - ay1) * aw + (r->x1 - ax1);
+    int w = r->x2 - r->x1 + 1;
+    int h = r->y2 - r->y1 + 1;
+
+    for (int y = 0; y < h; y++) {
+        memcpy(&d->shadow[(r->y1 + y) * d->width + r->x1], src + y * aw, w * sizeof(uint16_t));
+    }
+    send(r, src, aw, ctx);
+    d->windows++;
+    d->bytes_out += (uint64_t)w * h * 2 + LCD_DIFF_WINDOW_CMD_BYTES;
+    return (uint32_t)(w * h);
+}
+
+/* @brief Sends the changed parts of one flushed area
+ * @param x1 y1 x2 y2 Area, inclusive
+ * @param px Rendered pixels of the area, row by row
+ * @param send Called once per rectangle, in the order they are closed
+ * @return Pixels sent
+ */
+uint32_t lcd_diff_area(lcd_diff_t *d, int x1, int y1, int x2, int y2, const uint16_t *px,
+                       lcd_diff_send_t send, void *ctx) {
+    lcd_diff_rect_t open[LCD_DIFF_MAX_RECTS];
+    int count = 0;
+    int aw = x2 - x1 + 1;
+    uint32_t gap_px = d->window_cost / 2;  // Unchanged pixels worth one window setup
+    uint32_t windows = d->windows;
+    uint32_t sent = 0;
+
+    d->areas++;
+    d->bytes_in += (uint64_t)aw * (y2 - y1 + 1) * 2;
+    if (!d->synced) {
+        lcd_diff_rect_t whole = { x1, y1, x2, y2 };
+        return lcd_diff_send(d, &whole, x1, y1, aw, px, send, ctx);
+    }
+
+    for (int y = y1; y <= y2; y++) {
+        const uint16_t *row = px + (y - y1) * aw;
+        const uint16_t *shadow = &d->shadow[y * d->width + x1];
+        int i = 0;
+
+        while (i < aw) {
+            while (i < aw && row[i] == shadow[i]) {
+                i++;
+            }
+            if (i == aw) {
+                break;
+            }
+            // A span ends after more unchanged pixels than a window is worth
+            int first = i, last = i;
+            for (i++; i < aw && (uint32_t)(i - last) <= gap_px; i++) {
+                if (row[i] != shadow[i]) {
+                    last = i;
+                }
+            }
+            int s1 = x1 + first, s2 = x1 + last;
+
+            // Grow the rectangle that takes the span for the fewest unchanged pixels
+            int best = -1;
+            uint32_t best_extra = gap_px + 1;
+            for (int k = 0; k < count; k++) {
+                lcd_diff_rect_t *r = &open[k];
+                int ux1 = r->x1 < s1 ? r->x1 : s1;
+                int ux2 = r->x2 > s2 ? r->x2 : s2;
+                int inside = r->y2 == y ? (s2 < r->x2 ? s2 : r->x2) - (s1 > r->x1 ? s1 : r->x1) + 1 : 0;
+                uint32_t area = (uint32_t)(ux2 - ux1 + 1) * (y - r->y1 + 1);
+                uint32_t used = (uint32_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1) + (s2 - s1 + 1) -
+                                (inside > 0 ? inside : 0);  // Part already in the rectangle's last row
+                if (area - used < best_extra) {
+                    best = k;
+                    best_extra = area - used;
+                }
+            }
+            if (best >= 0) {
+                lcd_diff_rect_t *r = &open[best];
+                r->x1 = r->x1 < s1 ? r->x1 : s1;
+                r->x2 = r->x2 > s2 ? r->x2 : s2;
+                r->y2 = y;
+                continue;
+            }
+            if (count == LCD_DIFF_MAX_RECTS) {
+                sent += lcd_diff_send(d, &open[0], x1, y1, aw, px, send, ctx);
+                memmove(&open[0], &open[1], --count * sizeof(open[0]));
+            }
+            open[count++] = (lcd_diff_rect_t){ s1, y, s2, y };
+        }
+
+        // Rectangles the unchanged rows below them already make too expensive to grow
+        for (int k = 0; k < count; ) {
+            if ((uint32_t)(y - open[k].y2) * (open[k].x2 - open[k].x1 + 1) > gap_px) {
+                sent += lcd_diff_send(d, &open[k], x1, y1, aw, px, send, ctx);
+                open[k] = open[--count];
+            } else {
+                k++;
+            }
+        }
+    }
+    for (int k = 0; k < count; k++) {
+        sent += lcd_diff_send(d, &open[k], x1, y1, aw, px, send, ctx);
+    }
+    if (d->windows == windows) {
+        d->areas_clean++;
+    }
+    return sent;
+}
+
+void lcd_diff_reset_stats(lcd_diff_t *d) {
+    d->areas = 0;
+    d->areas_clean = 0;
+    d->windows = 0;
+    d->bytes_in = 0;
+    d->bytes_out = 0;
+}
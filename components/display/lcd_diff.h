@@ -0,0 +1,64 @@
+#ifndef LCD_DIFF_H
+#define LCD_DIFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Shadow-framebuffer diff for my_flush_cb
+ *
+ * LVGL flushes a whole label when one digit of it changed. The shadow holds
+ * what the panel shows; each flushed area is compared with it scanline by
+ * scanline and only the changed spans are sent, each in its own CASET/RASET
+ * window. Spans are grown into rectangles over the following rows, and two
+ * pieces are merged whenever the unchanged pixels that merging sends cost
+ * less than setting up one more window (window_cost, in bytes).
+ *
+ *   row 0:  ....XX......X....     one span: the gap is cheaper than a window
+ *   row 1:  .....X...........     extends the rectangle of row 0
+ *   row 2:  .................
+ *   row 3:  ..............XX.     new rectangle once the gap rows cost more
+ *
+ * After lcd_diff_invalidate() (panel content unknown) areas are sent whole
+ * until a frame that started invalid ends; the caller redraws the whole
+ * screen in that frame.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/bench).
+ */
+
+#define LCD_DIFF                    1       // Shadow framebuffer in PSRAM, 0 = every flushed pixel is sent
+#define LCD_DIFF_WINDOW_COST_BYTES  200     // Until measured: CASET/RASET/RAMWR as 5 transactions at 80 MHz
+#define LCD_DIFF_WINDOW_CMD_BYTES   11      // Bytes on the wire per window
+#define LCD_DIFF_MAX_RECTS          8       // Open rectangles per area, more are sent early
+
+typedef struct {
+    uint16_t x1, y1, x2, y2;                // Inclusive, screen coordinates
+} lcd_diff_rect_t;
+
+/* Sends one rectangle: set the window, then stream width x height pixels of px (row pitch stride) */
+typedef void (*lcd_diff_send_t)(const lcd_diff_rect_t *rect, const uint16_t *px, int stride, void *ctx);
+
+typedef struct {
+    uint16_t *shadow;                       // width x height, what the panel shows
+    uint16_t width;
+    uint16_t height;
+    uint32_t window_cost;                   // Bytes a window setup is worth
+    bool synced;                            // Shadow matches the panel
+    bool resync_frame;                      // Frame started unsynced, sent whole
+
+    /* Statistics */
+    uint32_t areas;
+    uint32_t areas_clean;                   // Nothing changed, nothing sent
+    uint32_t windows;
+    uint64_t bytes_in;                      // Pixels flushed by LVGL, 2 bytes each
+    uint64_t bytes_out;                     // Pixels sent plus window commands
+} lcd_diff_t;
+
+void lcd_diff_init(lcd_diff_t *d, uint16_t *shadow, uint16_t width, uint16_t height);
+void lcd_diff_invalidate(lcd_diff_t *d);
+void lcd_diff_frame_begin(lcd_diff_t *d);
+void lcd_diff_frame_end(lcd_diff_t *d);
+uint32_t lcd_diff_area(lcd_diff_t *d, int x1, int y1, int x2, int y2, const uint16_t *px,
+                       lcd_diff_send_t send, void *ctx);
+void lcd_diff_reset_stats(lcd_diff_t *d);
+
+#endif
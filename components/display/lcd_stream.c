@@ -0,0 +1,47 @@
+#include "lcd_stream.h"
+
+/* @brief Sends pixels in byte-swapped chunks
+ * @param px RGB565 pixels as rendered by LVGL
+ * @param num_pixels Pixel count
+ * @param send Called once per chunk, the chunk is reused after it returns
+ * @param ctx Passed to send
+ */
+void lcd_stream_pixels(const uint16_t *px, int num_pixels, lcd_stream_send_t send, void *ctx) {
+    uint16_t chunk[LCD_STREAM_CHUNK_PIXELS];
+
+    for (int i = 0; i < num_pixels; i += LCD_STREAM_CHUNK_PIXELS) {
+        int count = (num_pixels - i < LCD_STREAM_CHUNK_PIXELS) ? (num_pixels - i) : LCD_STREAM_CHUNK_PIXELS;
+
+        for (int j = 0; j < count; j++) {
+            uint16_t color = px[i + j];
+            chunk[j] = (color >> 8) | (color << 8); // RGB565 byte swap
+        }
+        send(chunk, count, ctx);
+    }
+}
+
+/* @brief Sends a rectangle out of a larger pixel map in byte-swapped chunks, rows back to back
+ * @param px First pixel of the rectangle
+ * @param stride Pixels per row of the map px points into
+ * @param width Rectangle width
+ * @param height Rectangle height
+ */
+void lcd_stream_rect(const uint16_t *px, int stride, int width, int height, lcd_stream_send_t send, void *ctx) {
+    uint16_t chunk[LCD_STREAM_CHUNK_PIXELS];
+    int count = 0;
+
+    for (int y = 0; y < height; y++) {
+        const uint16_t *row = px + y * stride;
+        for (int x = 0; x < width; x++) {
+            uint16_t color = row[x];
+            chunk[count++] = (color >> 8) | (color << 8);
+            if (count == LCD_STREAM_CHUNK_PIXELS) {
+                send(chunk, count, ctx);
+                count = 0;
+            }
+        }
+    }
+    if (count > 0) {
+        send(chunk, count, ctx);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef LCD_STREAM_H
+#define LCD_STREAM_H
+
+#include <stdint.h>
+
+/* Pixel streaming for my_flush_cb
+ *
+ * LVGL renders RGB565 in CPU byte order, the ST7796 wants it big-endian.
+ * Pixels are byte-swapped into a small chunk buffer and handed to the send
+ * callback (an SPI transaction on the device, a null sink in tools/bench).
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/bench).
+ */
+
+#define LCD_STREAM_CHUNK_BYTES  1024    // One SPI transaction
+#define LCD_STREAM_CHUNK_PIXELS (LCD_STREAM_CHUNK_BYTES / 2)
+
+typedef void (*lcd_stream_send_t)(const uint16_t *chunk, int pixels, void *ctx);
+
+void lcd_stream_pixels(const uint16_t *px, int num_pixels, lcd_stream_send_t send, void *ctx);
+void lcd_stream_rect(const uint16_t *px, int stride, int width, int height, lcd_stream_send_t send, void *ctx);
+
+#endif
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+#include "spi_clock.h"
+
+void spi_clock_init(spi_clock_t *sc, uint32_t cached_hz) {
+    memset(sc, 0, sizeof(*sc));
+    sc->hz = SPI_CLOCK_SAFE_HZ;
+    sc->cached_hz = cached_hz;
+}
+
+/* @brief Clock of a candidate
+ * @param div 1 (fastest) - SPI_CLOCK_MAX_DIV
+ */
+uint32_t spi_clock_candidate_hz(int div) {
+    return SPI_CLOCK_APB_HZ / div;
+}
+
+/* @brief Fills a test pattern: alternating bits, walking one, full swings, then pseudo-random
+ * @param round Pattern number, any value
+ */
+void spi_clock_pattern(int round, uint16_t *px, int count) {
+    uint32_t x = 0x9E3779B9u * (uint32_t)(round + 1);
+
+    for (int i = 0; i < count; i++) {
+        switch (round) {
+        case 0:
+            px[i] = (i & 1) ? 0x5555 : 0xAAAA;
+            break;
+        case 1:
+            px[i] = (uint16_t)(1u << (i % 16));
+            break;
+        case 2:
+            px[i] = (i & 1) ? 0x0000 : 0xFFFF;
+            break;
+        default:
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            px[i] = (uint16_t)x;
+            break;
+        }
+    }
+}
+
+/* @brief RAMRD pixel to RGB565, the panel returns 6 bits per colour in the top of each byte
+ * @param rgb 3 bytes: R, G, B
+ */
+uint16_t spi_clock_rgb666_to_565(const uint8_t *rgb) {
+    return (uint16_t)(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3));
+}
+
+/* @brief Writes and reads back test patterns at one clock
+ * @param rounds Patterns to try, all must read back exactly
+ */
+bool spi_clock_probe(spi_clock_t *sc, const spi_clock_bus_t *bus, uint32_t hz, int rounds) {
+    static uint16_t out[SPI_CLOCK_TEST_PIXELS];
+    static uint16_t in[SPI_CLOCK_TEST_PIXELS];
+    bool ok = bus->set_clock(bus->ctx, hz);
+
+    sc->probes++;
+    for (int r = 0; ok && r < rounds; r++) {
+        spi_clock_pattern(r, out, SPI_CLOCK_TEST_PIXELS);
+        memset(in, 0, sizeof(in));
+        if (!bus->write(bus->ctx, out, SPI_CLOCK_TEST_PIXELS) || !bus->read(bus->ctx, in, SPI_CLOCK_TEST_PIXELS)) {
+            ok = false;
+            break;
+        }
+        sc->pixels_tested += SPI_CLOCK_TEST_PIXELS;
+        for (int i = 0; i < SPI_CLOCK_TEST_PIXELS; i++) {
+            if (in[i] != out[i]) {
+                sc->pixels_bad++;
+                ok = false;
+            }
+        }
+    }
+    if (!ok) {
+        sc->probes_failed++;
+    }
+    return ok;
+}
+
+/* @brief Finds the fastest clock that reads back without errors and switches to it
+ * @return The clock, 0 if even the slowest candidate failed (SPI_CLOCK_SAFE_HZ is set then)
+ */
+uint32_t spi_clock_calibrate(spi_clock_t *sc, const spi_clock_bus_t *bus) {
+    int lo = 1, hi = SPI_CLOCK_MAX_DIV;
+
+    sc->probes = sc->probes_failed = sc->pixels_tested = sc->pixels_bad = 0;
+    sc->from_cache = false;
+    sc->fail_run = 0;
+    sc->calibrations++;
+
+    if (sc->cached_hz != 0 && spi_clock_probe(sc, bus, sc->cached_hz, SPI_CLOCK_CONFIRM_ROUNDS)) {
+        sc->hz = sc->cached_hz;
+        sc->from_cache = true;
+        return sc->hz;
+    }
+    if (!spi_clock_probe(sc, bus, spi_clock_candidate_hz(hi), SPI_CLOCK_SEARCH_ROUNDS)) {
+        sc->hz = SPI_CLOCK_SAFE_HZ;
+        sc->cached_hz = 0;
+        bus->set_clock(bus->ctx, sc->hz);
+        return 0;
+    }
+    // Errors only grow with the clock: divider hi passes, find the smallest that does
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (spi_clock_probe(sc, bus, spi_clock_candidate_hz(mid), SPI_CLOCK_SEARCH_ROUNDS)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    // Marginal clocks can pass a few rounds, step slower until the long run passes
+    while (hi < SPI_CLOCK_MAX_DIV && !spi_clock_probe(sc, bus, spi_clock_candidate_hz(hi), SPI_CLOCK_CONFIRM_ROUNDS)) {
+        hi++;
+    }
+    sc->hz = spi_clock_candidate_hz(hi);
+    sc->cached_hz = sc->hz;
+    bus->set_clock(bus->ctx, sc->hz);
+    return sc->hz;
+}
+
+/* @brief Result of one spot check (flushed pixels against their readback)
+ * @return true when the clock should be calibrated again
+ */
+bool spi_clock_check(spi_clock_t *sc, bool ok) {
+    sc->checks++;
+    if (ok) {
+        sc->fail_run = 0;
+        return false;
+    }
+    sc->checks_failed++;
+    if (++sc->fail_run < SPI_CLOCK_RECHECK_ERRORS) {
+        return false;
+    }
+    sc->fail_run = 0;
+    sc->cached_hz = 0;     // Search again, the cached clock is what failed
+    return true;
+}
+
+void spi_clock_print(const spi_clock_t *sc) {
+    const char *source = sc->calibrations == 0 ? "default" : sc->from_cache ? "cached" : "searched";
+
+    printf("clock %.2f MHz (%s), read %.2f MHz, calibrations %lu\n", sc->hz / 1e6, source,
+           SPI_CLOCK_READ_HZ / 1e6, (unsigned long)sc->calibrations);
+    printf("last: %lu probes, %lu failed, %lu of %lu px bad\n", (unsigned long)sc->probes,
+           (unsigned long)sc->probes_failed, (unsigned long)sc->pixels_bad, (unsigned long)sc->pixels_tested);
+    printf("spot checks %lu, failed %lu\n", (unsigned long)sc->checks, (unsigned long)sc->checks_failed);
+}
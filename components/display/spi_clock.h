@@ -0,0 +1,76 @@
+#ifndef SPI_CLOCK_H
+#define SPI_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* SPI clock calibration against GRAM readback
+ *
+ * The fastest usable write clock depends on the panel, the cable and the
+ * board, so it is measured instead of hardcoded. A probe sets a candidate
+ * clock, writes test patterns into a small GRAM window and reads them back
+ * with RAMRD (at a fixed, slow read clock: the ST7796 reads far slower than
+ * it writes). Any mismatched pixel fails the probe.
+ *
+ * Candidates are the clocks the SPI peripheral can make, SPI_CLOCK_APB_HZ / n.
+ * spi_clock_calibrate() checks the slowest one, binary-searches for the
+ * fastest that passes SPI_CLOCK_SEARCH_ROUNDS, then confirms it with
+ * SPI_CLOCK_CONFIRM_ROUNDS, stepping slower until the confirmation passes.
+ * A clock cached from an earlier boot is only confirmed.
+ *
+ * While running, spi_clock_check() takes the result of comparing a flushed
+ * area with its readback, and asks for a new calibration after
+ * SPI_CLOCK_RECHECK_ERRORS failed checks in a row.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/spi_clock).
+ */
+
+#define SPI_CLOCK_APB_HZ            80000000
+#define SPI_CLOCK_MAX_DIV           16          // Slowest candidate, 5 MHz
+#define SPI_CLOCK_SAFE_HZ           10000000    // lcd_init and fallback when every probe fails
+#define SPI_CLOCK_READ_HZ           6000000     // RAMRD, ST7796 read cycle >= 150 ns
+#define SPI_CLOCK_TEST_W            32          // GRAM test window
+#define SPI_CLOCK_TEST_H            8
+#define SPI_CLOCK_TEST_PIXELS       (SPI_CLOCK_TEST_W * SPI_CLOCK_TEST_H)
+#define SPI_CLOCK_SEARCH_ROUNDS     4           // Patterns per probe while searching
+#define SPI_CLOCK_CONFIRM_ROUNDS    16          // Patterns on the chosen clock
+#define SPI_CLOCK_CHECK_PIXELS      64          // Readback per spot check of a flush
+#define SPI_CLOCK_CHECK_PERIOD_MS   5000
+#define SPI_CLOCK_RECHECK_ERRORS    2           // Failed spot checks in a row
+
+/* Panel access for the probes, the SPI device on target, a simulation in tools/spi_clock */
+typedef struct {
+    bool (*set_clock)(void *ctx, uint32_t hz);                      // Write clock
+    bool (*write)(void *ctx, const uint16_t *px, int count);        // RAMWR into the test window
+    bool (*read)(void *ctx, uint16_t *px, int count);               // RAMRD from the test window
+    void *ctx;
+} spi_clock_bus_t;
+
+typedef struct {
+    uint32_t hz;                    // Write clock in use
+    uint32_t cached_hz;             // Loaded from NVS, 0 = none
+
+    /* Last calibration */
+    uint32_t probes;
+    uint32_t probes_failed;
+    uint32_t pixels_tested;
+    uint32_t pixels_bad;
+    bool from_cache;                // Cached clock confirmed, no search
+
+    /* Spot checks of flushed areas */
+    uint32_t checks;
+    uint32_t checks_failed;
+    uint8_t fail_run;               // Consecutive failed checks
+    uint32_t calibrations;
+} spi_clock_t;
+
+void spi_clock_init(spi_clock_t *sc, uint32_t cached_hz);
+uint32_t spi_clock_candidate_hz(int div);
+void spi_clock_pattern(int round, uint16_t *px, int count);
+uint16_t spi_clock_rgb666_to_565(const uint8_t *rgb);
+bool spi_clock_probe(spi_clock_t *sc, const spi_clock_bus_t *bus, uint32_t hz, int rounds);
+uint32_t spi_clock_calibrate(spi_clock_t *sc, const spi_clock_bus_t *bus);
+bool spi_clock_check(spi_clock_t *sc, bool ok);
+void spi_clock_print(const spi_clock_t *sc);
+
+#endif
@@ -0,0 +1,98 @@
+#include <string.h>
+#include "timer_list.h"
+#include "ui_theme.h"
+
+/* @brief vlist_bind_t: the label of slot shows item index, or is hidden */
+static void timer_list_bind(int slot, int32_t index, void *ctx)
+{
+    timer_list_t *tl = ctx;
+    lv_obj_t *row = tl->rows[slot];
+    char text[TIMER_LIST_TEXT_LEN];
+
+    if (index < 0) {
+        lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+        tl->text[slot][0] = '\0';
+        return;
+    }
+    // Same item again (timer_list_refresh): only a changed text invalidates the label
+    tl->text_cb(index, text, sizeof(text));
+    if (strcmp(text, tl->text[slot]) != 0) {
+        memcpy(tl->text[slot], text, sizeof(text));
+        lv_label_set_text_static(row, tl->text[slot]);
+    }
+    lv_obj_set_y(row, index * tl->vl.row_h);
+    lv_obj_remove_flag(row, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void timer_list_scroll_cb(lv_event_t * e)
+{
+    timer_list_t *tl = lv_event_get_user_data(e);
+    vlist_scroll_to(&tl->vl, lv_obj_get_scroll_y(tl->obj));
+}
+
+/* @brief Creates the list filling parent, empty until timer_list_set_count()
+ * @param row_h Pixels per row
+ * @param text_cb Text of an item, called for the bound rows only
+ */
+void timer_list_create(timer_list_t *tl, lv_obj_t *parent, int32_t row_h, timer_list_text_t text_cb)
+{
+    memset(tl, 0, sizeof(*tl));
+    tl->text_cb = text_cb;
+
+    tl->obj = lv_obj_create(parent);
+    lv_obj_set_size(tl->obj, LV_PCT(100), LV_PCT(100));
+    ui_theme_apply(tl->obj, UI_CLASS_PLAIN);
+    lv_obj_set_scroll_dir(tl->obj, LV_DIR_VER);
+    lv_obj_add_event_cb(tl->obj, timer_list_scroll_cb, LV_EVENT_SCROLL, tl);
+
+    // Slots for the height the list gets
+    lv_obj_update_layout(tl->obj);
+    vlist_init(&tl->vl, row_h, lv_obj_get_content_height(tl->obj), timer_list_bind, tl);
+
+    tl->spacer = lv_obj_create(tl->obj);
+    lv_obj_remove_style_all(tl->spacer);
+    lv_obj_set_size(tl->spacer, 1, 1);
+    lv_obj_remove_flag(tl->spacer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(tl->spacer, LV_OBJ_FLAG_HIDDEN);
+
+    for (int s = 0; s < tl->vl.slots; s++) {
+        tl->rows[s] = lv_label_create(tl->obj);
+        lv_obj_set_size(tl->rows[s], LV_PCT(100), row_h);
+        ui_theme_apply(tl->rows[s], UI_CLASS_ROW);
+        lv_label_set_long_mode(tl->rows[s], LV_LABEL_LONG_CLIP);
+        lv_label_set_text_static(tl->rows[s], tl->text[s]);
+        lv_obj_add_flag(tl->rows[s], LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+/* @brief Sets the number of items, binds the rows in view again */
+void timer_list_set_count(timer_list_t *tl, int32_t count)
+{
+    int32_t content_h = count * tl->vl.row_h;
+
+    // Hidden objects do not count for the scroll range, the spacer must show
+    if (count > 0) {
+        lv_obj_set_y(tl->spacer, content_h - 1);
+        lv_obj_remove_flag(tl->spacer, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(tl->spacer, LV_OBJ_FLAG_HIDDEN);
+    }
+    vlist_set_count(&tl->vl, count);
+    if (lv_obj_get_scroll_y(tl->obj) != tl->vl.scroll_y) {
+        lv_obj_scroll_to_y(tl->obj, tl->vl.scroll_y, LV_ANIM_OFF);  // The list got shorter
+    }
+}
+
+/* @brief Item data changed, re-texts its row if it is bound */
+void timer_list_refresh(timer_list_t *tl, int32_t index)
+{
+    vlist_refresh(&tl->vl, index);
+}
+
+/* @brief Re-texts every bound row, e.g. after a game tick */
+void timer_list_refresh_visible(timer_list_t *tl)
+{
+    for (int32_t i = tl->vl.first; i < tl->vl.end; i++) {
+        vlist_refresh(&tl->vl, i);
+    }
+}
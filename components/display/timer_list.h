@@ -0,0 +1,43 @@
+#ifndef TIMER_LIST_H
+#define TIMER_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "lvgl.h"
+#include "vlist.h"
+
+/* Scrolling list of timers for long rosters, virtualized with vlist
+ *
+ * One label per slot (the viewport plus VLIST_OVERSCAN rows above and below),
+ * positioned absolutely inside a scrolling container; a 1 px spacer at the
+ * end of the content gives LVGL the full scroll range. On LV_EVENT_SCROLL the
+ * labels that left the window are rebound to the items that entered it, by
+ * index through the text callback. No flex layout, so the objects, the LVGL
+ * pool use and the layout work stay the same for 10 or 10000 items.
+ *
+ * The container and the rows take the shared ui_theme styles (PLAIN, ROW).
+ *
+ * timer_list_refresh_visible() re-texts the bound rows (once per game second),
+ * only labels whose text changed are invalidated.
+ */
+
+#define TIMER_LIST_TEXT_LEN     32
+
+/* Text of item index, e.g. "Dire #3: 04:12" */
+typedef void (*timer_list_text_t)(int32_t index, char *buf, size_t len);
+
+typedef struct {
+    lv_obj_t *obj;                  // Scrolling container
+    lv_obj_t *spacer;               // Last pixel of the content
+    lv_obj_t *rows[VLIST_MAX_SLOTS];
+    char text[VLIST_MAX_SLOTS][TIMER_LIST_TEXT_LEN];
+    timer_list_text_t text_cb;
+    vlist_t vl;
+} timer_list_t;
+
+void timer_list_create(timer_list_t *tl, lv_obj_t *parent, int32_t row_h, timer_list_text_t text_cb);
+void timer_list_set_count(timer_list_t *tl, int32_t count);
+void timer_list_refresh(timer_list_t *tl, int32_t index);
+void timer_list_refresh_visible(timer_list_t *tl);
+
+#endif
@@ -0,0 +1,84 @@
+#include <stddef.h>
+#include <string.h>
+#include "ui_cmd.h"
+
+_Static_assert(offsetof(ui_cmd_t, seq) == 0, "mpsc_ring keeps the sequence number first");
+
+static ui_cmd_t slots[UI_CMD_QUEUE_LEN];
+static mpsc_ring_t queue = MPSC_RING_INIT(slots);     // Read by lvgl_task only
+static TaskHandle_t owner = NULL;
+static ui_cmd_stats_t stats;
+
+/* @brief Sets the task woken by ui_cmd_post, called by lvgl_task itself
+ * @param task lvgl_task
+ */
+void ui_cmd_set_owner(TaskHandle_t task) {
+    __atomic_store_n(&owner, task, __ATOMIC_RELEASE);
+}
+
+/* @brief Queues a command for lvgl_task, safe from any task on either core, never blocks
+ * @return false if the queue was full and the command was dropped
+ */
+static bool ui_cmd_push(uint8_t type, uint8_t arg, const char *text) {
+    uint32_t ticket;
+    ui_cmd_t *cmd = mpsc_ring_reserve(&queue, &ticket);
+
+    if (cmd == NULL) {
+        return false;
+    }
+    cmd->type = type;
+    cmd->arg = arg;
+    cmd->text = text;
+    mpsc_ring_publish(&queue, cmd, ticket);
+
+    TaskHandle_t task = __atomic_load_n(&owner, __ATOMIC_ACQUIRE);
+    if (task != NULL) {
+        xTaskNotifyGive(task);
+    }
+    return true;
+}
+
+/* @param type Any command without text
+ * @param arg Tab, hero index or brightness, see ui_cmd_type_t
+ */
+bool ui_cmd_post(ui_cmd_type_t type, uint8_t arg) {
+    return ui_cmd_push(type, arg, NULL);
+}
+
+/* @param text String literal, only the pointer is queued */
+bool ui_cmd_post_text(ui_cmd_type_t type, const char *text) {
+    return ui_cmd_push(type, 0, text);
+}
+
+/* @brief Takes the oldest published command, lvgl_task only
+ * @return false if nothing is pending or the oldest command is still being written
+ */
+bool ui_cmd_take(ui_cmd_t *out) {
+    const ui_cmd_t *cmd = mpsc_ring_peek(&queue);
+
+    if (cmd == NULL) {
+        return false;
+    }
+    *out = *cmd;
+    mpsc_ring_release(&queue);
+    return true;
+}
+
+/* @brief Batch statistics, lvgl_task only
+ * @param count Commands applied in this drain
+ */
+void ui_cmd_batch_done(uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    stats.batches++;
+    if (count > stats.max_batch) {
+        stats.max_batch = count;
+    }
+}
+
+void ui_cmd_get_stats(ui_cmd_stats_t *out) {
+    memcpy(out, &stats, sizeof(*out));
+    out->posted = queue.written;
+    out->dropped = queue.dropped;
+}
@@ -0,0 +1,57 @@
+#ifndef UI_CMD_H
+#define UI_CMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../mpsc_ring/mpsc_ring.h"
+
+/* UI command queue
+ *
+ * LVGL is only touched by lvgl_task. Other tasks (key scan, time tracker,
+ * serial link) post small commands here instead; the queue is an mpsc_ring,
+ * so posting never takes a lock or blocks, and lvgl_task is woken with a
+ * task notification. lvgl_task applies everything pending in one batch
+ * before each lv_timer_handler() pass, see display_apply_ui_commands().
+ */
+
+#define UI_CMD_QUEUE_LEN    32      // Power of two
+
+typedef enum {
+    UI_CMD_SWITCH_TAB = 1,  // arg = tab index
+    UI_CMD_NEXT_TAB,        // K11, wraps around
+    UI_CMD_FLASH_ROW,       // arg = hero index, highlights the row for UI_FLASH_MS
+    UI_CMD_TOAST,           // text = static string, shown for UI_TOAST_MS
+    UI_CMD_BRIGHTNESS,      // arg = backlight 0 - 100 %
+    UI_CMD_SUSPEND,         // Power idle: stop LVGL timers, lvgl_task blocks
+    UI_CMD_RESUME,
+    UI_CMD_EXPIRED_ROW,     // arg = hero index, cooldown ended, highlighted for UI_EXPIRED_MS
+    UI_CMD_CAPTURE,         // arg = frames to capture (keyframe first), 0 = stop
+    UI_CMD_SPI_CAL,         // Calibrate the SPI clock again, arg = 1 ignores the cached clock
+    UI_CMD_LCD_DIFF,        // arg = 1 sends only changed pixels (LCD_DIFF), 0 = whole areas
+    UI_CMD_THEME,           // arg = ui_theme_id_t
+} ui_cmd_type_t;
+
+typedef struct {
+    volatile uint32_t seq;  // Slot index + 1 once the command is complete, first for mpsc_ring
+    uint8_t type;           // ui_cmd_type_t
+    uint8_t arg;
+    const char *text;       // Must outlive the command (string literal)
+} ui_cmd_t;
+
+typedef struct {
+    uint32_t posted;
+    uint32_t dropped;       // Queue was full
+    uint32_t batches;       // Non-empty drains
+    uint32_t max_batch;     // Most commands applied in one drain
+} ui_cmd_stats_t;
+
+void ui_cmd_set_owner(TaskHandle_t task);
+bool ui_cmd_post(ui_cmd_type_t type, uint8_t arg);
+bool ui_cmd_post_text(ui_cmd_type_t type, const char *text);
+bool ui_cmd_take(ui_cmd_t *out);
+void ui_cmd_batch_done(uint32_t count);
+void ui_cmd_get_stats(ui_cmd_stats_t *out);
+
+#endif
@@ -0,0 +1,154 @@
+#include <stdbool.h>
+#include "ui_theme.h"
+
+const char *const ui_theme_names[UI_THEMES] = { "light", "dark" };
+
+/* Colours that differ between themes, the rest is the LVGL default theme's */
+typedef struct {
+    bool dark;
+    uint32_t footer_bg;
+    uint32_t footer_text;
+    uint32_t popup_bg;              // Toast and overlay
+    uint32_t popup_text;
+    uint32_t available;
+    uint32_t cooldown;
+    uint32_t paused;
+} ui_palette_t;
+
+static const ui_palette_t palettes[UI_THEMES] = {
+    [UI_THEME_LIGHT] = { false, 0xFFFFFF, 0x000000, 0x000000, 0xFFFFFF, 0x2E7D32, 0x212121, 0x9E9E9E },
+    [UI_THEME_DARK]  = { true,  0x000000, 0xFFFFFF, 0xFFFFFF, 0x000000, 0x66BB6A, 0xFAFAFA, 0x757575 },
+};
+
+static lv_style_t class_styles[UI_CLASSES];
+static lv_style_t status_styles[UI_STATUSES];         // [UI_STATUS_NONE] stays empty
+static lv_style_t highlight_styles[UI_HIGHLIGHTS];    // [UI_HIGHLIGHT_NONE] stays empty
+static ui_theme_id_t current = UI_THEME_DEFAULT;
+static lv_display_t *theme_display = NULL;
+static bool built = false;
+
+/* @brief Empties a style for (re)building, objects keep pointing at it */
+static lv_style_t *ui_style_begin(lv_style_t *style)
+{
+    if (built) {
+        lv_style_reset(style);
+    } else {
+        lv_style_init(style);
+    }
+    return style;
+}
+
+/* @brief Sets every shared style for the current theme */
+static void ui_theme_build(void)
+{
+    const ui_palette_t *p = &palettes[current];
+    lv_style_t *s;
+
+    s = ui_style_begin(&class_styles[UI_CLASS_PLAIN]);
+    lv_style_set_pad_all(s, 0);
+    lv_style_set_border_width(s, 0);
+    lv_style_set_bg_opa(s, LV_OPA_TRANSP);
+
+    s = ui_style_begin(&class_styles[UI_CLASS_LIST]);
+    lv_style_set_pad_column(s, 8);
+
+    s = ui_style_begin(&class_styles[UI_CLASS_ROW]);
+    lv_style_set_text_font(s, &lv_font_montserrat_24);
+
+    s = ui_style_begin(&class_styles[UI_CLASS_HEADER]);
+    lv_style_set_text_font(s, &lv_font_montserrat_38);
+
+    s = ui_style_begin(&class_styles[UI_CLASS_FOOTER]);
+    lv_style_set_text_align(s, LV_TEXT_ALIGN_CENTER);
+    lv_style_set_pad_all(s, 2);
+    lv_style_set_bg_color(s, lv_color_hex(p->footer_bg));
+    lv_style_set_text_color(s, lv_color_hex(p->footer_text));
+    lv_style_set_text_font(s, &lv_font_montserrat_24);
+
+    s = ui_style_begin(&class_styles[UI_CLASS_TOAST]);
+    lv_style_set_bg_color(s, lv_color_hex(p->popup_bg));
+    lv_style_set_bg_opa(s, LV_OPA_80);
+    lv_style_set_text_color(s, lv_color_hex(p->popup_text));
+    lv_style_set_text_font(s, &lv_font_montserrat_24);
+    lv_style_set_pad_all(s, 8);
+    lv_style_set_radius(s, 6);
+
+    s = ui_style_begin(&class_styles[UI_CLASS_OVERLAY]);
+    lv_style_set_bg_color(s, lv_color_hex(p->popup_bg));
+    lv_style_set_bg_opa(s, LV_OPA_70);
+    lv_style_set_text_color(s, lv_color_hex(p->popup_text));
+    lv_style_set_pad_all(s, 4);
+
+    ui_style_begin(&status_styles[UI_STATUS_NONE]);
+    lv_style_set_text_color(ui_style_begin(&status_styles[UI_STATUS_AVAILABLE]), lv_color_hex(p->available));
+    lv_style_set_text_color(ui_style_begin(&status_styles[UI_STATUS_COOLDOWN]), lv_color_hex(p->cooldown));
+    lv_style_set_text_color(ui_style_begin(&status_styles[UI_STATUS_PAUSED]), lv_color_hex(p->paused));
+
+    // Same in both themes, the opacity over the row is set per row
+    ui_style_begin(&highlight_styles[UI_HIGHLIGHT_NONE]);
+    lv_style_set_bg_color(ui_style_begin(&highlight_styles[UI_HIGHLIGHT_WARN]), lv_palette_main(LV_PALETTE_ORANGE));
+    lv_style_set_bg_color(ui_style_begin(&highlight_styles[UI_HIGHLIGHT_EXPIRED]), lv_palette_main(LV_PALETTE_GREEN));
+    lv_style_set_bg_color(ui_style_begin(&highlight_styles[UI_HIGHLIGHT_FLASH]), lv_palette_main(LV_PALETTE_AMBER));
+
+    built = true;
+}
+
+/* @brief Builds the styles, before any object uses them
+ * @param display Its default theme is switched along
+ */
+void ui_theme_init(lv_display_t *display)
+{
+    theme_display = display;
+    ui_theme_set(UI_THEME_DEFAULT);
+}
+
+/* @brief Switches the whole UI, lvgl_task only */
+void ui_theme_set(ui_theme_id_t id)
+{
+    if (id >= UI_THEMES) {
+        return;
+    }
+    current = id;
+    // Re-initialises the default theme's styles in place
+    lv_theme_t *theme = lv_theme_default_init(theme_display, lv_palette_main(LV_PALETTE_BLUE),
+                                              lv_palette_main(LV_PALETTE_RED), palettes[id].dark, LV_FONT_DEFAULT);
+    lv_display_set_theme(theme_display, theme);
+    ui_theme_build();
+    lv_obj_report_style_change(NULL);  // Every object, restyled and redrawn once
+}
+
+ui_theme_id_t ui_theme_get(void)
+{
+    return current;
+}
+
+/* @brief Adds the shared styles of a class, after the default theme's so they win */
+void ui_theme_apply(lv_obj_t *obj, ui_class_t cls)
+{
+    if (cls == UI_CLASS_LIST) {
+        lv_obj_add_style(obj, &class_styles[UI_CLASS_PLAIN], 0);
+    }
+    lv_obj_add_style(obj, &class_styles[cls], 0);
+}
+
+/* @brief Replaces a row's status style, callers only call it when the status changed */
+void ui_theme_set_status(lv_obj_t *obj, ui_status_t status)
+{
+    for (int s = UI_STATUS_NONE + 1; s < UI_STATUSES; s++) {
+        lv_obj_remove_style(obj, &status_styles[s], 0);
+    }
+    if (status != UI_STATUS_NONE) {
+        lv_obj_add_style(obj, &status_styles[status], 0);
+    }
+}
+
+/* @brief Replaces a row's highlight colour, its bg_opa (local, animated) decides if it shows */
+void ui_theme_set_highlight(lv_obj_t *obj, ui_highlight_t highlight)
+{
+    for (int h = UI_HIGHLIGHT_NONE + 1; h < UI_HIGHLIGHTS; h++) {
+        lv_obj_remove_style(obj, &highlight_styles[h], 0);
+    }
+    if (highlight != UI_HIGHLIGHT_NONE) {
+        lv_obj_add_style(obj, &highlight_styles[highlight], 0);
+    }
+}
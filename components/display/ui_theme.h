@@ -0,0 +1,75 @@
+#ifndef UI_THEME_H
+#define UI_THEME_H
+
+#include <stdint.h>
+#include "lvgl.h"
+
+/* Shared styles for the UI, applied by class
+ *
+ * Every object of a class gets the same static lv_style_t objects with
+ * lv_obj_add_style(), instead of its own lv_obj_set_style_*() calls. Local
+ * styles cost each object an allocated property list, and every property
+ * lookup of a redraw walks it first; shared styles are stored once. The
+ * styles are added after the default theme's, so they override it.
+ *
+ *   PLAIN    no padding, border or background (layout containers)
+ *   LIST     PLAIN, plus the gap between hero rows
+ *   ROW      hero rows, roster rows
+ *   HEADER   large filler text of the reserved tabs
+ *   FOOTER   in-game timer
+ *   TOAST    UI_CMD_TOAST popup
+ *   OVERLAY  "dstats" overlay
+ *
+ * Rows also carry one status style (text colour: available, on cooldown,
+ * paused) and one highlight style (background colour: warn, expired, key
+ * flash). The highlight opacity stays local, it is animated per row.
+ *
+ * ui_theme_set() switches at runtime: the LVGL default theme and these
+ * styles are initialised again in place and every object is refreshed.
+ */
+
+#define UI_THEME_DEFAULT    UI_THEME_LIGHT
+
+typedef enum {
+    UI_THEME_LIGHT = 0,             // LVGL default theme look, as before themes
+    UI_THEME_DARK,
+    UI_THEMES
+} ui_theme_id_t;
+
+typedef enum {
+    UI_CLASS_PLAIN = 0,
+    UI_CLASS_LIST,
+    UI_CLASS_ROW,
+    UI_CLASS_HEADER,
+    UI_CLASS_FOOTER,
+    UI_CLASS_TOAST,
+    UI_CLASS_OVERLAY,
+    UI_CLASSES
+} ui_class_t;
+
+typedef enum {
+    UI_STATUS_NONE = 0,             // Match not started
+    UI_STATUS_AVAILABLE,
+    UI_STATUS_COOLDOWN,
+    UI_STATUS_PAUSED,
+    UI_STATUSES
+} ui_status_t;
+
+typedef enum {
+    UI_HIGHLIGHT_NONE = 0,
+    UI_HIGHLIGHT_WARN,              // Cooldown ends within UI_WARN_S
+    UI_HIGHLIGHT_EXPIRED,
+    UI_HIGHLIGHT_FLASH,             // Key press, UI_CMD_FLASH_ROW
+    UI_HIGHLIGHTS
+} ui_highlight_t;
+
+extern const char *const ui_theme_names[UI_THEMES];
+
+void ui_theme_init(lv_display_t *display);
+void ui_theme_set(ui_theme_id_t id);
+ui_theme_id_t ui_theme_get(void);
+void ui_theme_apply(lv_obj_t *obj, ui_class_t cls);
+void ui_theme_set_status(lv_obj_t *obj, ui_status_t status);
+void ui_theme_set_highlight(lv_obj_t *obj, ui_highlight_t highlight);
+
+#endif
@@ -0,0 +1,104 @@
+#include <string.h>
+#include "vlist.h"
+
+/* @brief Binds every slot whose item changed with the window
+ * @return Slots bound
+ */
+static int vlist_rebind(vlist_t *vl) {
+    int32_t first = vl->scroll_y / vl->row_h - VLIST_OVERSCAN;
+    int bound = 0;
+
+    if (first < 0) {
+        first = 0;
+    }
+    vl->first = first;
+    vl->end = first + vl->slots < vl->count ? first + vl->slots : vl->count;
+
+    for (int s = 0; s < vl->slots; s++) {
+        // The one item of [first, first + slots) that maps to this slot
+        int32_t index = first + (s - first % vl->slots + vl->slots) % vl->slots;
+        if (index >= vl->end) {
+            index = -1;
+        }
+        if (vl->slot_index[s] != index) {
+            vl->slot_index[s] = index;
+            vl->bind(s, index, vl->ctx);
+            bound++;
+        }
+    }
+    vl->binds += bound;
+    return bound;
+}
+
+/* @param row_h Row height in pixels, every row the same
+ * @param view_h Visible height, sets how many slots there are
+ */
+void vlist_init(vlist_t *vl, int32_t row_h, int32_t view_h, vlist_bind_t bind, void *ctx) {
+    memset(vl, 0, sizeof(*vl));
+    vl->row_h = row_h;
+    vl->view_h = view_h;
+    vl->bind = bind;
+    vl->ctx = ctx;
+    // Viewport rows, one more when both ends show part of a row, and the overscan
+    vl->slots = (view_h + row_h - 1) / row_h + 1 + 2 * VLIST_OVERSCAN;
+    if (vl->slots > VLIST_MAX_SLOTS) {
+        vl->slots = VLIST_MAX_SLOTS;
+    }
+    for (int s = 0; s < VLIST_MAX_SLOTS; s++) {
+        vl->slot_index[s] = -1;
+    }
+}
+
+/* @brief Sets the item count, every bound row is bound again (items may have moved) */
+void vlist_set_count(vlist_t *vl, int32_t count) {
+    vl->count = count;
+    for (int s = 0; s < vl->slots; s++) {
+        if (vl->slot_index[s] >= 0) {
+            vl->slot_index[s] = -2;     // Neither an item nor "unused", forces bind()
+        }
+    }
+    vlist_scroll_to(vl, vl->scroll_y);
+}
+
+/* @brief Moves the window, clamped to the content
+ * @return Slots bound, at most the rows scrolled past
+ */
+int vlist_scroll_to(vlist_t *vl, int32_t scroll_y) {
+    int32_t max_y = vlist_content_h(vl) - vl->view_h;
+
+    if (scroll_y > max_y) {
+        scroll_y = max_y;
+    }
+    if (scroll_y < 0) {
+        scroll_y = 0;
+    }
+    vl->scroll_y = scroll_y;
+    vl->scrolls++;
+    return vlist_rebind(vl);
+}
+
+/* @brief Item data changed, binds it again if it has a slot
+ * @return false if the item is not bound (nothing to redraw)
+ */
+bool vlist_refresh(vlist_t *vl, int32_t index) {
+    int slot = vlist_slot_of(vl, index);
+
+    if (slot < 0) {
+        return false;
+    }
+    vl->bind(slot, index, vl->ctx);
+    vl->binds++;
+    return true;
+}
+
+/* @return Slot of a bound item, -1 if it is outside the window */
+int vlist_slot_of(const vlist_t *vl, int32_t index) {
+    if (index < vl->first || index >= vl->end) {
+        return -1;
+    }
+    return index % vl->slots;
+}
+
+int32_t vlist_content_h(const vlist_t *vl) {
+    return vl->count * vl->row_h;
+}
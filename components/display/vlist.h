@@ -0,0 +1,56 @@
+#ifndef VLIST_H
+#define VLIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Virtualized list: which items are bound to which row objects
+ *
+ * A list of count items with fixed row_h keeps only the rows in the viewport
+ * plus VLIST_OVERSCAN above and below as objects (slots). Item i always goes
+ * to slot i % slots, so scrolling by k rows rebinds exactly k slots and the
+ * rest keep their text and position:
+ *
+ *   items   0 1 2 3 4 5 6 7 8 9 ...          slots = 4
+ *   bound       [2 3 4 5]                    scroll_y in row 3, overscan 1
+ *   slot        2 3 0 1                      scrolling one row down rebinds
+ *                                            slot 2 from item 2 to item 6
+ *
+ * The bind callback fills a slot from an item and moves it to index * row_h,
+ * or hides it (index -1). Everything is O(slots) whatever the item count.
+ *
+ * No ESP-IDF or LVGL dependencies, builds on a host (tools/bench).
+ * timer_list.c puts LVGL labels behind it.
+ */
+
+#define VLIST_OVERSCAN      2       // Rows bound above and below the viewport
+#define VLIST_MAX_SLOTS     24
+
+/* Binds item index to slot, index -1 = slot unused (hide it) */
+typedef void (*vlist_bind_t)(int slot, int32_t index, void *ctx);
+
+typedef struct {
+    int32_t count;                  // Items
+    int32_t row_h;                  // Pixels per row
+    int32_t view_h;                 // Viewport height
+    int32_t scroll_y;
+    int32_t first;                  // Bound items, first <= i < end
+    int32_t end;
+    int slots;
+    int32_t slot_index[VLIST_MAX_SLOTS];    // Item in each slot, -1 = none
+    vlist_bind_t bind;
+    void *ctx;
+
+    /* Statistics */
+    uint32_t binds;                 // bind() calls
+    uint32_t scrolls;
+} vlist_t;
+
+void vlist_init(vlist_t *vl, int32_t row_h, int32_t view_h, vlist_bind_t bind, void *ctx);
+void vlist_set_count(vlist_t *vl, int32_t count);
+int vlist_scroll_to(vlist_t *vl, int32_t scroll_y);
+bool vlist_refresh(vlist_t *vl, int32_t index);
+int vlist_slot_of(const vlist_t *vl, int32_t index);
+int32_t vlist_content_h(const vlist_t *vl);
+
+#endif
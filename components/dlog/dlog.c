@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+
+#include "../serial_link/serial_link.h"
+#include "dlog.h"
+
+#define TAG "DLOG"
+
+#define DLOG_BENCH_CALLS        100
+#define DLOG_BENCH_PRINT_CALLS  10      // ESP_LOGI calls that really print
+
+static dlog_ring_t rings[DLOG_CORES];
+static uint32_t printed = 0;
+static uint32_t reported_dropped = 0;
+
+/* @brief Stores one record in the calling core's ring, use the DLOG* macros */
+void dlog_write(uint8_t level, const char *tag, const char *fmt, const uint32_t *args, uint32_t nargs) {
+    dlog_ring_write(&rings[xPortGetCoreID()], level, (uint32_t)esp_timer_get_time(), tag, fmt, args, nargs);
+}
+
+void dlog_get_stats(dlog_stats_t *out) {
+    for (int core = 0; core < DLOG_CORES; core++) {
+        out->written[core] = rings[core].ring.written;
+        out->dropped[core] = rings[core].ring.dropped;
+        out->high_water[core] = rings[core].ring.high_water;
+    }
+    out->printed = printed;
+}
+
+static void dlog_print(const dlog_record_t *rec) {
+    static const char letters[] = "?EWID";
+    const uint32_t *a = rec->args;
+
+    printf("%c (%lu) %s: ", letters[rec->level <= DLOG_DEBUG ? rec->level : 0],
+           (unsigned long)(rec->time_us / 1000), rec->tag);
+    // Unused trailing arguments are ignored by printf
+    printf(rec->fmt, a[0], a[1], a[2], a[3]);
+    putchar('\n');
+    printed++;
+}
+
+static int dlog_discard_vprintf(const char *fmt, va_list args) {
+    char buf[128];
+    return vsnprintf(buf, sizeof(buf), fmt, args);
+}
+
+/* @brief Console: dlog [bench]. Stats, or per-call cost of DLOGI against ESP_LOGI */
+static void dlog_command(int argc, char **argv) {
+    if (argc < 2 || strcmp(argv[1], "bench") != 0) {
+        dlog_stats_t s;
+        dlog_get_stats(&s);
+        for (int core = 0; core < DLOG_CORES; core++) {
+            printf("core %d: %lu written, %lu dropped, high water %lu/%d\n", core,
+                   (unsigned long)s.written[core], (unsigned long)s.dropped[core],
+                   (unsigned long)s.high_water[core], DLOG_RING_RECORDS);
+        }
+        printf("%lu printed\n", (unsigned long)s.printed);
+        return;
+    }
+
+    uint32_t cycles[3] = { 0 }, worst[3] = { 0 };
+    int calls[3] = { DLOG_BENCH_CALLS, DLOG_BENCH_CALLS, DLOG_BENCH_PRINT_CALLS };
+
+    for (int i = 0; i < DLOG_BENCH_CALLS; i++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        DLOGI(TAG, "bench %d of %d, value 0x%08lx", i, DLOG_BENCH_CALLS, (uint32_t)start);
+        uint32_t c = esp_cpu_get_cycle_count() - start;
+        cycles[0] += c;
+        worst[0] = c > worst[0] ? c : worst[0];
+    }
+    // ESP_LOGI formatting only, output discarded
+    vprintf_like_t prev = esp_log_set_vprintf(dlog_discard_vprintf);
+    for (int i = 0; i < DLOG_BENCH_CALLS; i++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        ESP_LOGI(TAG, "bench %d of %d, value 0x%08lx", i, DLOG_BENCH_CALLS, (unsigned long)start);
+        uint32_t c = esp_cpu_get_cycle_count() - start;
+        cycles[1] += c;
+        worst[1] = c > worst[1] ? c : worst[1];
+    }
+    esp_log_set_vprintf(prev);
+    // ESP_LOGI to the console, as the setup code does
+    for (int i = 0; i < DLOG_BENCH_PRINT_CALLS; i++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        ESP_LOGI(TAG, "bench %d of %d, value 0x%08lx", i, DLOG_BENCH_PRINT_CALLS, (unsigned long)start);
+        uint32_t c = esp_cpu_get_cycle_count() - start;
+        cycles[2] += c;
+        worst[2] = c > worst[2] ? c : worst[2];
+    }
+
+    static const char *names[3] = { "DLOGI", "ESP_LOGI (no output)", "ESP_LOGI (console)" };
+    uint32_t mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    for (int k = 0; k < 3; k++) {
+        uint32_t avg = cycles[k] / calls[k];
+        printf("%-22s avg %6lu cycles (%5lu.%02lu us), worst %7lu cycles\n", names[k],
+               (unsigned long)avg, (unsigned long)(avg / mhz), (unsigned long)(avg % mhz * 100 / mhz),
+               (unsigned long)worst[k]);
+    }
+}
+
+void dlog_init(void) {
+    for (int core = 0; core < DLOG_CORES; core++) {
+        dlog_ring_init(&rings[core]);
+    }
+    serial_link_register_command("dlog", "Deferred log stats, dlog bench for per-call cost", dlog_command);
+}
+
+/* @brief Formats and prints the records of both rings, reports drops
+ * @param pvParameters N/A
+ */
+void dlog_task(void *pvParameters) {
+    dlog_record_t rec;
+
+    while (1) {
+        bool any = false;
+        for (int core = 0; core < DLOG_CORES; core++) {
+            while (dlog_ring_read(&rings[core], &rec)) {
+                dlog_print(&rec);
+                any = true;
+            }
+        }
+        uint32_t dropped = rings[0].ring.dropped + rings[1].ring.dropped;
+        if (dropped != reported_dropped) {
+            printf("W DLOG: %lu records dropped\n", (unsigned long)(dropped - reported_dropped));
+            reported_dropped = dropped;
+        }
+        if (!any) {
+            vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_MS));
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+#include "dlog_ring.h"
+
+/* Deferred logging for hot paths
+ *
+ * DLOGI(TAG, "key %u at %lu", key, time) stores the format string pointer and
+ * up to DLOG_MAX_ARGS 32-bit arguments in the ring of the calling core;
+ * dlog_task formats and prints them later. Arguments are converted to
+ * uint32_t, so only integer formats work; pass pointers and %s strings cast
+ * to uint32_t, and the strings must outlive the record (literals).
+ * Messages below DLOG_LEVEL compile to nothing.
+ */
+
+#define DLOG_ERROR  1
+#define DLOG_WARN   2
+#define DLOG_INFO   3
+#define DLOG_DEBUG  4
+
+#define DLOG_LEVEL      DLOG_INFO
+#define DLOG_DRAIN_MS   20      // dlog_task polls the rings this often when idle
+#define DLOG_CORES      2
+
+#define DLOG(level, tag, fmt, ...) do { \
+        if ((level) <= DLOG_LEVEL) { \
+            const uint32_t dlog_args_[] = { 0, ##__VA_ARGS__ }; \
+            _Static_assert(sizeof(dlog_args_) / sizeof(uint32_t) - 1 <= DLOG_MAX_ARGS, "too many DLOG arguments"); \
+            dlog_write((level), (tag), (fmt), &dlog_args_[1], sizeof(dlog_args_) / sizeof(uint32_t) - 1); \
+        } \
+    } while (0)
+
+#define DLOGE(tag, fmt, ...) DLOG(DLOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define DLOGW(tag, fmt, ...) DLOG(DLOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define DLOGI(tag, fmt, ...) DLOG(DLOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define DLOGD(tag, fmt, ...) DLOG(DLOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+typedef struct {
+    uint32_t written[DLOG_CORES];
+    uint32_t dropped[DLOG_CORES];
+    uint32_t high_water[DLOG_CORES];
+    uint32_t printed;
+} dlog_stats_t;
+
+void dlog_init(void);
+void dlog_write(uint8_t level, const char *tag, const char *fmt, const uint32_t *args, uint32_t nargs);
+void dlog_get_stats(dlog_stats_t *out);
+void dlog_task(void *pvParameters);
+
+#endif
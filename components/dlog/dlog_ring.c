@@ -0,0 +1,49 @@
+#include <stddef.h>
+#include "dlog_ring.h"
+
+_Static_assert(offsetof(dlog_record_t, seq) == 0, "mpsc_ring keeps the sequence number first");
+
+void dlog_ring_init(dlog_ring_t *ring) {
+    mpsc_ring_init(&ring->ring, ring->records, DLOG_RING_RECORDS, sizeof(dlog_record_t));
+}
+
+/* @brief Appends a record, never blocks
+ * @param args Arguments, at most DLOG_MAX_ARGS are kept
+ * @return false if the ring was full and the record was dropped
+ */
+bool dlog_ring_write(dlog_ring_t *ring, uint8_t level, uint32_t time_us, const char *tag,
+                     const char *fmt, const uint32_t *args, uint32_t nargs) {
+    uint32_t ticket;
+    dlog_record_t *rec = mpsc_ring_reserve(&ring->ring, &ticket);
+
+    if (rec == NULL) {
+        return false;
+    }
+    if (nargs > DLOG_MAX_ARGS) {
+        nargs = DLOG_MAX_ARGS;
+    }
+    rec->time_us = time_us;
+    rec->tag = tag;
+    rec->fmt = fmt;
+    rec->level = level;
+    rec->nargs = (uint8_t)nargs;
+    for (uint32_t i = 0; i < nargs; i++) {
+        rec->args[i] = args[i];
+    }
+    mpsc_ring_publish(&ring->ring, rec, ticket);
+    return true;
+}
+
+/* @brief Takes the oldest published record, single reader only
+ * @return false if the ring is empty or the oldest record is still being written
+ */
+bool dlog_ring_read(dlog_ring_t *ring, dlog_record_t *out) {
+    const dlog_record_t *rec = mpsc_ring_peek(&ring->ring);
+
+    if (rec == NULL) {
+        return false;
+    }
+    *out = *rec;
+    mpsc_ring_release(&ring->ring);
+    return true;
+}
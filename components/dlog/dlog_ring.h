@@ -0,0 +1,39 @@
+#ifndef DLOG_RING_H
+#define DLOG_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../mpsc_ring/mpsc_ring.h"
+
+/* Lock-free ring of binary log records, one per core, on mpsc_ring
+ *
+ * Writers never wait: a record that finds the ring full is dropped and
+ * counted. One reader (dlog_task) takes the records in order.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/dlog).
+ */
+
+#define DLOG_RING_RECORDS   128     // Power of two
+#define DLOG_MAX_ARGS       4
+
+typedef struct {
+    volatile uint32_t seq;      // Slot index + 1 once the record is complete, first for mpsc_ring
+    uint32_t time_us;
+    const char *tag;
+    const char *fmt;            // Format string in flash, doubles as the message ID
+    uint8_t level;
+    uint8_t nargs;
+    uint32_t args[DLOG_MAX_ARGS];
+} dlog_record_t;
+
+typedef struct {
+    mpsc_ring_t ring;           // written, dropped and high_water are the ring's statistics
+    dlog_record_t records[DLOG_RING_RECORDS];
+} dlog_ring_t;
+
+void dlog_ring_init(dlog_ring_t *ring);
+bool dlog_ring_write(dlog_ring_t *ring, uint8_t level, uint32_t time_us, const char *tag,
+                     const char *fmt, const uint32_t *args, uint32_t nargs);
+bool dlog_ring_read(dlog_ring_t *ring, dlog_record_t *out);
+
+#endif
@@ -3,10 +3,13 @@
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
 #include "driver/ledc.h"
 #include "../display/display.h"
+#include "../display/spi_clock.h"
+#include "../static_mem/static_mem.h"
 #include "gpio_setup.h"
 
 /* GPIOs for Display
@@ -42,8 +45,8 @@
 /* Defines for configuring GPIOs */
 #define GPIO_OUTPUT_PIN_SEL  (  (1ULL<<LCD_CS) | \ 
                                 (1ULL<<LCD_DC) | \
-                                (1ULL<<LCD_RESET))
-                                // (1ULL<<TP_RESET))
+                                (1ULL<<LCD_RESET) | \
+                                (1ULL<<TP_RESET))
 
 #define GPIO_INPUT_PIN_SEL  1ULL<<TP_INT
 
@@ -55,20 +58,28 @@ static const char *TAG = "GPIO_SETUP";
 
 /* Initialize global variables for SPI */
 spi_device_handle_t spi = NULL;
+static uint32_t spi_hz;     // Clock spi was added with
 
 /* Initialize global variable for isr handler queue*/
 QueueHandle_t gpio_evt_queue = NULL;
 
 void IRAM_ATTR gpio_isr_handler(void* arg);
 void output_setup(void);
-void gpio_setup(void);
+void gpio_setup(bool fast_boot);
 
 /* @brief Handler for ISR
  * @param arg GPIO9 TP_INT. Detects user gesture/touch 
  */
 void IRAM_ATTR gpio_isr_handler(void* arg) {
-    uint32_t gpio_num = (uint32_t) arg;
-    xQueueSendFromISR(gpio_evt_queue, &gpio_num, NULL);
+    BaseType_t woken = pdFALSE;
+    gpio_evt_t evt = {
+        .gpio_num = (uint32_t) arg,
+        .time_us = esp_timer_get_time(),    // For interrupt-to-event latency
+    };
+    xQueueSendFromISR(gpio_evt_queue, &evt, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
 }
 
 /* @brief Sets up Output GPIOs
@@ -94,16 +105,42 @@ void output_setup() {
     ESP_LOGI(TAG, "Output_setup completed");
 }
 
+/* @brief Sets up TP_INT as a falling edge interrupt feeding gpio_evt_queue
+ * @param N/A
+ */
+void input_setup() {
+#if STATIC_ALLOC
+    static StaticQueue_t gpio_evt_queue_buf;
+    static uint8_t gpio_evt_queue_storage[GPIO_EVT_QUEUE_LEN * sizeof(gpio_evt_t)];
+    gpio_evt_queue = xQueueCreateStatic(GPIO_EVT_QUEUE_LEN, sizeof(gpio_evt_t),
+                                        gpio_evt_queue_storage, &gpio_evt_queue_buf);
+#else
+    gpio_evt_queue = xQueueCreate(GPIO_EVT_QUEUE_LEN, sizeof(gpio_evt_t));
+#endif
+
+    gpio_config_t io_conf = {};
+    io_conf.intr_type = GPIO_INTR_NEGEDGE;  // Touch controller pulls INT low on new data
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pin_bit_mask = GPIO_INPUT_PIN_SEL;
+    io_conf.pull_down_en = 0;
+    io_conf.pull_up_en = 1;
+    gpio_config(&io_conf);
+
+    gpio_install_isr_service(ESP_INTR_FLAG_DEFAULT);
+    gpio_isr_handler_add(TP_INT, gpio_isr_handler, (void*) TP_INT);
+    ESP_LOGI(TAG, "Input_setup completed");
+}
+
 /* @brief Configures PWM for BL (backlight) screen brightness
  * @param N/A 
  */
 void pwm_setup() {
     ledc_timer_config_t ledc_timer = {
         .duty_resolution = LEDC_RESOLUTION,  // Set resolution to 13-bit
-        .freq_hz = LEDC_FREQUENCY,          // Set frequency to 5kHz
+        .freq_hz = LEDC_FREQUENCY,          // Set frequency to 4kHz
         .speed_mode = LEDC_LOW_SPEED_MODE,  // High-speed mode
         .timer_num = LEDC_TIMER,             // Timer index
-        .clk_cfg = LEDC_AUTO_CLK,
+        .clk_cfg = LEDC_USE_XTAL_CLK,       // Not scaled by DFS like APB
     };
     ESP_ERROR_CHECK(ledc_timer_config(&ledc_timer));
 
@@ -133,8 +170,45 @@ void pre_transfer_callback(spi_transaction_t *t)
     // do nothing, required I guess
 }
 
+/* @brief Adds the panel to the SPI bus
+ * @param hz Write clock, the driver rounds it down to APB / n
+ */
+static esp_err_t spi_add_lcd(uint32_t hz) {
+    spi_device_interface_config_t devcfg = {
+        .clock_speed_hz = hz,
+        .mode = 0,                              //SPI mode 0
+        .spics_io_num = LCD_CS,                 //CS pin
+        .queue_size = 7,                        //We want to be able to queue 7 transactions at a time
+        .pre_cb = pre_transfer_callback, //Specify pre-transfer callback to handle D/C line
+        .flags = SPI_DEVICE_HALFDUPLEX,         //RAMRD: command, dummy, then read
+    };
+    esp_err_t err = spi_bus_add_device(SPI2_HOST, &devcfg, &spi);
+    if (err == ESP_OK) {
+        spi_hz = hz;
+    }
+    return err;
+}
+
+/* @brief Changes the SPI clock of the panel (re-adds the device)
+ * @param hz New clock
+ * @return false if the device stays at the old clock
+ * @note Same task as the flushes, between frames: no transaction may be in flight
+ */
+bool spi_set_clock(uint32_t hz) {
+    if (spi_bus_remove_device(spi) != ESP_OK) {
+        return false;
+    }
+    if (spi_add_lcd(hz) == ESP_OK) {
+        return true;
+    }
+    // The slot was just freed, the old clock gets it back so spi is never left dangling
+    ESP_ERROR_CHECK(spi_add_lcd(spi_hz));
+    return false;
+}
+
 /* @brief Configures SPI driver
  * @param N/A 
+ * @note Starts at SPI_CLOCK_SAFE_HZ, lcd_calibrate_clock() raises it after lcd_init
  */
 void spi_setup() {
     spi_bus_config_t buscfg = {
@@ -145,39 +219,38 @@ void spi_setup() {
         .quadhd_io_num = -1,
         .max_transfer_sz = 4096,
     };
-    spi_device_interface_config_t devcfg = {
-        .clock_speed_hz = 80 * 1000 * 1000,     //Clock out at 10 MHz
-        .mode = 0,                              //SPI mode 0
-        .spics_io_num = LCD_CS,                 //CS pin
-        .queue_size = 7,                        //We want to be able to queue 7 transactions at a time
-        .pre_cb = pre_transfer_callback, //Specify pre-transfer callback to handle D/C line
-        .flags = SPI_DEVICE_HALFDUPLEX,
-    };
     //Initialize the SPI bus
     ESP_ERROR_CHECK(spi_bus_initialize(SPI2_HOST, &buscfg, SPI_DMA_CH_AUTO));
 
     //Attach the LCD to the SPI bus
-    ESP_ERROR_CHECK(spi_bus_add_device(SPI2_HOST, &devcfg, &spi));
+    ESP_ERROR_CHECK(spi_add_lcd(SPI_CLOCK_SAFE_HZ));
 
     ESP_LOGI(TAG, "spi_setup completed");
 }
 
-void test_display(void) {
+/* @brief Initializes the panel and LVGL
+ * @param fast_boot Skip the colour test screens (resuming a match)
+ */
+void test_display(bool fast_boot) {
     lcd_init(spi);
     printf("lcd_init\n");
-    vTaskDelay(700 / portTICK_PERIOD_MS);
-    lcd_clear2(0xFF04);
-    vTaskDelay(700 / portTICK_PERIOD_MS);
-    lcd_clear2(0x4504);
+    lcd_calibrate_clock();    // Before the colour test screens, they overwrite the test window
+    if (!fast_boot) {
+        vTaskDelay(700 / portTICK_PERIOD_MS);
+        lcd_clear2(0xFF04);
+        vTaskDelay(700 / portTICK_PERIOD_MS);
+        lcd_clear2(0x4504);
+    }
     lvgl_setup();
     printf("lvgl_setup();");
 }
 
 /* @brief Sets up all configurations: SPI/I2C/PWM
- * @param N/A 
+ * @param fast_boot Skip the display test screens (resuming a match)
  */
-void gpio_setup() {
+void gpio_setup(bool fast_boot) {
     output_setup();
+    input_setup();
     printf("spi_setup();\n");
     spi_setup();
     printf("output_setup\n");
@@ -185,6 +258,6 @@ void gpio_setup() {
     printf("pwm_setup();\n");
     set_backlight_brightness(0.5);
     printf(" set_backlight_brightness(0.1);\n");
-    test_display();
+    test_display(fast_boot);
     printf("test_display();");
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef GPIO_SETUP_H
 #define GPIO_SETUP_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "driver/spi_master.h"
 
 /* GPIOs for Display
@@ -91,14 +93,26 @@ D2, D3, D4, D5, D6, D7, D8, D9
 #define LEDC_CHANNEL        LEDC_CHANNEL_0
 #define LEDC_TIMER          LEDC_TIMER_0
 #define LEDC_GPIO           LCD_BL  // GPIO where the backlight is connected
-#define LEDC_FREQUENCY      5000  // PWM frequency (Hz)
+#define LEDC_FREQUENCY      4000  // PWM frequency (Hz), 13 bits fit the 40 MHz XTAL clock
 #define LEDC_RESOLUTION      LEDC_TIMER_13_BIT  // 13-bit resolution (8192 steps)
 
+#define GPIO_EVT_QUEUE_LEN  10
+
+/* Queued by gpio_isr_handler */
+typedef struct {
+    uint32_t gpio_num;
+    int64_t time_us;    // esp_timer time of the interrupt
+} gpio_evt_t;
+
 extern spi_device_handle_t spi;
 
 extern QueueHandle_t gpio_evt_queue;
 
-void gpio_setup(void);
+void gpio_setup(bool fast_boot);
 void pwm_setup(void);
+void input_setup(void);
+void gpio_isr_handler(void *arg);
+void set_backlight_brightness(float brightness);
+bool spi_set_clock(uint32_t hz);
 
 #endif
\ No newline at end of file
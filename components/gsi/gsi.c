@@ -0,0 +1,116 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "serial_link.h"
+#include "dlog.h"
+#include "gsi.h"
+
+#include "../../main/time_tracker.h"
+#include "../../main/clock_discipline.h"
+
+#define TAG "GSI"
+
+static gsi_parser_t parser;
+static gsi_stats_t stats;
+static int32_t last_clock = -1;
+
+static void gsi_frame_begin(void) {
+    gsi_parser_reset(&parser);
+}
+
+static void gsi_frame_data(const uint8_t *data, size_t len) {
+    int64_t start = esp_timer_get_time();
+    gsi_parser_feed(&parser, data, len);
+    uint32_t elapsed = esp_timer_get_time() - start;
+
+    stats.bytes += len;
+    stats.parse_us_total += elapsed;
+    if (elapsed > stats.parse_us_max) {
+        stats.parse_us_max = elapsed;
+    }
+}
+
+/* @brief Applies the enemy team's buyback cooldowns to the hero timers
+ * @param values Parsed payload
+ */
+static void gsi_apply_buybacks(const gsi_values_t *values) {
+    // Player slots 0-4 are Radiant (team2), 5-9 Dire (team3)
+    int first;
+    if (values->team == GSI_TEAM_RADIANT) {
+        first = 5;
+    } else if (values->team == GSI_TEAM_DIRE) {
+        first = 0;
+    } else {
+        first = (GSI_SPECTATOR_ENEMY == GSI_TEAM_RADIANT) ? 0 : 5;  // Spectators have no side
+    }
+    for (int i = 0; i < HERO_COUNT; i++) {
+        int slot = first + i;
+        if (values->buyback_present & (1 << slot)) {
+            int32_t cooldown = values->buyback_cooldown[slot];
+            time_tracker_set_hero(i, cooldown > 0 ? (uint16_t)cooldown : 0);
+        }
+    }
+}
+
+static void gsi_frame_end(void) {
+    int64_t start = esp_timer_get_time();
+
+    if (!gsi_parser_finish(&parser)) {
+        stats.errors++;
+        DLOGW(TAG, "Malformed payload ignored (%lu so far)", stats.errors);
+        return;
+    }
+    stats.payloads++;
+
+    const gsi_values_t *values = &parser.values;
+#if GSI_APPLY_CLOCK
+    if ((values->present & GSI_HAS_CLOCK) && values->clock_time >= 0) {
+        time_tracker_lock();    // The clock is read, compared and set in one go
+        bool running = game_timer_active;
+        if (!all_timers_active || values->paused == running) {
+            // Match start or pause change, set the clock directly
+            time_tracker_sync(values->clock_time, values->paused);
+            clock_discipline_stepped(&game_clock);
+            stats.syncs++;
+        } else if (!values->paused && values->clock_time == last_clock + 1) {
+            // The game clock just ticked over, so the reference sits on a whole second
+            int64_t now = esp_timer_get_time();
+            uint32_t seconds = game_timer_minutes * 60 + game_timer_seconds;
+            int64_t local = clock_discipline_local_us(&game_clock, seconds, true, now);
+            int64_t reference = (int64_t)values->clock_time * 1000000 + GSI_DELIVERY_US;
+            if (clock_discipline_sample(&game_clock, reference, local, now) == CD_STEP) {
+                time_tracker_sync(values->clock_time, false);
+                clock_discipline_stepped(&game_clock);
+                stats.syncs++;
+            }
+        }
+        last_clock = values->clock_time;
+        gsi_apply_buybacks(values);
+        time_tracker_unlock();
+    }
+#endif
+
+    uint32_t elapsed = esp_timer_get_time() - start;
+    if (elapsed > stats.apply_us_max) {
+        stats.apply_us_max = elapsed;
+    }
+}
+
+static const serial_link_frame_handler_t gsi_handler = {
+    .begin = gsi_frame_begin,
+    .data = gsi_frame_data,
+    .end = gsi_frame_end,
+};
+
+/* @brief Registers the GSI payload handler with the serial link
+ * @param N/A
+ */
+void gsi_init(void) {
+    gsi_parser_reset(&parser);
+    serial_link_set_frame_handler(&gsi_handler);
+    ESP_LOGI(TAG, "gsi_init completed (parser state %u bytes)", (unsigned)sizeof(parser));
+}
+
+void gsi_get_stats(gsi_stats_t *out) {
+    memcpy(out, &stats, sizeof(stats));
+}
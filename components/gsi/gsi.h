@@ -0,0 +1,36 @@
+#ifndef GSI_H
+#define GSI_H
+
+#include <stdint.h>
+
+#include "gsi_parser.h"
+
+/* Automatic clock sync from Dota 2 Game State Integration
+ *
+ * The game POSTs JSON to tools/gsi/gsi_relay.py on the PC, which forwards each
+ * body to the native USB port framed by STX/ETX (see serial_link.h). Payloads
+ * are parsed as the bytes arrive and applied to the game state on ETX:
+ *   map.clock_time / map.paused            -> in-game timer (slewed, see clock_discipline.h)
+ *   hero.teamN.playerM.buyback_cooldown    -> hero timers of the enemy team
+ * Buyback cooldowns are only sent to spectators, a player's own payload has
+ * just the clock.
+ */
+
+#define GSI_APPLY_CLOCK     1       // Set to 0 to only parse and count payloads
+#define GSI_DELIVERY_US     10000   // Shortest delay from a clock change to its payload arriving
+#define GSI_SPECTATOR_ENEMY GSI_TEAM_DIRE  // Team shown on the hero timers when spectating
+
+typedef struct {
+    uint32_t payloads;          // Frames parsed successfully
+    uint32_t errors;            // Malformed frames, ignored
+    uint32_t bytes;
+    uint32_t syncs;             // Payloads that set the clock directly (start, pause, step)
+    uint32_t parse_us_max;      // Longest single feed call
+    uint64_t parse_us_total;
+    uint32_t apply_us_max;      // ETX to state updated
+} gsi_stats_t;
+
+void gsi_init(void);
+void gsi_get_stats(gsi_stats_t *out);
+
+#endif
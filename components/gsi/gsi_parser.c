@@ -0,0 +1,233 @@
+#include <string.h>
+#include <stdlib.h>
+#include "gsi_parser.h"
+
+enum {
+    ST_VALUE,           // Expecting a value
+    ST_KEY_OR_END,      // After '{' or ',' in an object
+    ST_KEY,             // Inside a key string
+    ST_COLON,
+    ST_STRING,          // Inside a string value
+    ST_SCALAR,          // Number / true / false / null
+    ST_AFTER_VALUE,     // Expecting ',' or a closing bracket
+    ST_DONE,
+};
+
+static bool is_space(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool key_is(const gsi_parser_t *p, int level, const char *name) {
+    return strcmp(p->keys[level], name) == 0;
+}
+
+/* @brief Maps "team2"/"team3" + "playerN" to a slot 0-9
+ * @return -1 if the keys are not a player slot
+ */
+static int player_slot(const char *team, const char *player) {
+    if (strncmp(team, "team", 4) != 0 || strncmp(player, "player", 6) != 0) {
+        return -1;
+    }
+    int t = atoi(team + 4);
+    int n = atoi(player + 6);
+    if ((t != 2 && t != 3) || n < 0 || n >= GSI_MAX_PLAYERS) {
+        return -1;
+    }
+    return n;
+}
+
+/* @brief Stores a completed scalar if its path is one we care about */
+static void match_value(gsi_parser_t *p) {
+    gsi_values_t *v = &p->values;
+    const char *tok = p->token;
+
+    if (p->depth == 2 && key_is(p, 1, "map")) {
+        if (key_is(p, 2, "clock_time") && !p->token_is_string) {
+            v->clock_time = (int32_t)strtol(tok, NULL, 10);
+            v->present |= GSI_HAS_CLOCK;
+        } else if (key_is(p, 2, "paused") && !p->token_is_string) {
+            v->paused = (strcmp(tok, "true") == 0);
+            v->present |= GSI_HAS_PAUSED;
+        } else if (key_is(p, 2, "game_state") && p->token_is_string) {
+            v->in_progress = (strcmp(tok, "DOTA_GAMERULES_STATE_GAME_IN_PROGRESS") == 0);
+            v->present |= GSI_HAS_GAME_STATE;
+        }
+    } else if (p->depth == 2 && key_is(p, 1, "player") && key_is(p, 2, "team_name") && p->token_is_string) {
+        v->team = (strcmp(tok, "radiant") == 0) ? GSI_TEAM_RADIANT :
+                  (strcmp(tok, "dire") == 0) ? GSI_TEAM_DIRE : GSI_TEAM_UNKNOWN;
+        v->present |= GSI_HAS_TEAM;
+    } else if (p->depth == 4 && key_is(p, 1, "hero") && key_is(p, 4, "buyback_cooldown") && !p->token_is_string) {
+        // Spectator payloads: hero.team2.player0.buyback_cooldown
+        int slot = player_slot(p->keys[2], p->keys[3]);
+        if (slot >= 0) {
+            v->buyback_cooldown[slot] = (int32_t)strtol(tok, NULL, 10);
+            v->buyback_present |= 1 << slot;
+        }
+    }
+}
+
+static void push(gsi_parser_t *p, bool object) {
+    if (p->depth == GSI_MAX_NESTING) {
+        p->failed = true;
+        return;
+    }
+    p->depth++;
+    if (object) {
+        p->object_mask |= 1u << p->depth;
+    } else {
+        p->object_mask &= ~(1u << p->depth);
+    }
+    if (p->depth <= GSI_MAX_DEPTH) {
+        p->keys[p->depth][0] = '\0';
+    }
+}
+
+static bool in_object(const gsi_parser_t *p) {
+    return p->depth > 0 && (p->object_mask & (1u << p->depth));
+}
+
+static void pop(gsi_parser_t *p, bool object) {
+    if (p->depth == 0 || in_object(p) != object) {
+        p->failed = true;
+        return;
+    }
+    p->depth--;
+    p->state = (p->depth == 0) ? ST_DONE : ST_AFTER_VALUE;
+}
+
+void gsi_parser_reset(gsi_parser_t *p) {
+    memset(p, 0, sizeof(*p));
+    p->state = ST_VALUE;
+}
+
+/* @brief Feeds the next bytes of the payload
+ * @param p Parser
+ * @param data Bytes received
+ * @param len Number of bytes
+ */
+void gsi_parser_feed(gsi_parser_t *p, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len && !p->failed; i++) {
+        uint8_t c = data[i];
+
+        switch (p->state) {
+        case ST_KEY:
+        case ST_STRING:
+            if (p->escape) {
+                p->escape = false;
+            } else if (c == '\\') {
+                p->escape = true;
+                continue;
+            } else if (c == '"') {
+                if (p->state == ST_KEY) {
+                    if (p->depth <= GSI_MAX_DEPTH) {
+                        p->keys[p->depth][p->key_len] = '\0';
+                    }
+                    p->state = ST_COLON;
+                } else {
+                    p->token[p->token_len] = '\0';
+                    p->token_is_string = true;
+                    match_value(p);
+                    p->state = ST_AFTER_VALUE;
+                }
+                continue;
+            }
+            // Escaped characters are stored as-is, no field we match uses them
+            if (p->state == ST_KEY) {
+                if (p->depth <= GSI_MAX_DEPTH && p->key_len < GSI_MAX_KEY - 1) {
+                    p->keys[p->depth][p->key_len++] = c;
+                }
+            } else if (p->token_len < GSI_MAX_TOKEN - 1) {
+                p->token[p->token_len++] = c;
+            }
+            break;
+
+        case ST_SCALAR:
+            if (c == ',' || c == '}' || c == ']' || is_space(c)) {
+                p->token[p->token_len] = '\0';
+                p->token_is_string = false;
+                match_value(p);
+                p->state = ST_AFTER_VALUE;
+                i--;  // Let ST_AFTER_VALUE handle the delimiter
+            } else if (p->token_len < GSI_MAX_TOKEN - 1) {
+                p->token[p->token_len++] = c;
+            }
+            break;
+
+        case ST_VALUE:
+            if (is_space(c)) {
+                break;
+            }
+            if (c == '{') {
+                push(p, true);
+                p->state = ST_KEY_OR_END;
+            } else if (c == '[') {
+                push(p, false);
+                p->state = ST_VALUE;
+            } else if (c == ']') {
+                pop(p, false);   // Empty array
+            } else if (c == '"') {
+                p->token_len = 0;
+                p->state = ST_STRING;
+            } else {
+                p->token_len = 0;
+                p->token[p->token_len++] = c;
+                p->state = ST_SCALAR;
+            }
+            break;
+
+        case ST_KEY_OR_END:
+            if (is_space(c)) {
+                break;
+            }
+            if (c == '"') {
+                p->key_len = 0;
+                p->state = ST_KEY;
+            } else if (c == '}') {
+                pop(p, true);
+            } else {
+                p->failed = true;
+            }
+            break;
+
+        case ST_COLON:
+            if (is_space(c)) {
+                break;
+            }
+            if (c == ':') {
+                p->state = ST_VALUE;
+            } else {
+                p->failed = true;
+            }
+            break;
+
+        case ST_AFTER_VALUE:
+            if (is_space(c)) {
+                break;
+            }
+            if (c == ',') {
+                p->state = in_object(p) ? ST_KEY_OR_END : ST_VALUE;
+            } else if (c == '}') {
+                pop(p, true);
+            } else if (c == ']') {
+                pop(p, false);
+            } else {
+                p->failed = true;
+            }
+            break;
+
+        case ST_DONE:
+            if (!is_space(c)) {
+                p->failed = true;
+            }
+            break;
+        }
+    }
+}
+
+/* @brief Ends the payload
+ * @param p Parser
+ * @return true if a complete JSON document was parsed; p->values holds the fields found
+ */
+bool gsi_parser_finish(gsi_parser_t *p) {
+    return !p->failed && p->state == ST_DONE;
+}
@@ -0,0 +1,62 @@
+#ifndef GSI_PARSER_H
+#define GSI_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Streaming parser for Dota 2 Game State Integration payloads
+ *
+ * Bytes can be fed in any chunking as they arrive. Only the fields below are
+ * kept, everything else is skipped without being stored, so the parser uses
+ * a fixed amount of memory (no allocation) whatever the payload size.
+ *
+ * No ESP-IDF dependencies, builds on a host for benchmarking.
+ */
+
+#define GSI_MAX_DEPTH       6       // Levels whose keys are kept for matching
+#define GSI_MAX_NESTING     31      // Deeper documents are rejected
+#define GSI_MAX_KEY         24      // Longer keys are truncated (never matched)
+#define GSI_MAX_TOKEN       48      // Longer string values are truncated
+#define GSI_MAX_PLAYERS     10
+
+#define GSI_HAS_CLOCK       (1 << 0)
+#define GSI_HAS_PAUSED      (1 << 1)
+#define GSI_HAS_GAME_STATE  (1 << 2)
+#define GSI_HAS_TEAM        (1 << 3)
+
+typedef enum {
+    GSI_TEAM_UNKNOWN = 0,
+    GSI_TEAM_RADIANT,       // "radiant" / team2
+    GSI_TEAM_DIRE,          // "dire" / team3
+} gsi_team_t;
+
+typedef struct {
+    uint8_t present;            // GSI_HAS_* fields seen in this payload
+    int32_t clock_time;         // map.clock_time, negative before the horn
+    bool paused;                // map.paused
+    bool in_progress;           // map.game_state == DOTA_GAMERULES_STATE_GAME_IN_PROGRESS
+    gsi_team_t team;            // player.team_name (spectators have none)
+    uint16_t buyback_present;   // Bit per player slot 0-9 (team2 player0-4, team3 player5-9)
+    int32_t buyback_cooldown[GSI_MAX_PLAYERS];  // hero.teamN.playerM.buyback_cooldown
+} gsi_values_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t depth;
+    uint8_t key_len;
+    uint8_t token_len;
+    bool escape;
+    bool token_is_string;
+    bool failed;
+    uint32_t object_mask;                       // Bit per level, set for objects
+    char keys[GSI_MAX_DEPTH + 1][GSI_MAX_KEY];  // Current key per object level
+    char token[GSI_MAX_TOKEN];
+    gsi_values_t values;
+} gsi_parser_t;
+
+void gsi_parser_reset(gsi_parser_t *p);
+void gsi_parser_feed(gsi_parser_t *p, const uint8_t *data, size_t len);
+bool gsi_parser_finish(gsi_parser_t *p);
+
+#endif
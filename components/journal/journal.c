@@ -0,0 +1,451 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "journal.h"
+#include "../static_mem/static_mem.h"
+
+#define TAG "JOURNAL"
+
+#define JOURNAL_MAGIC           0x4E524A44  // "DJRN"
+#define JOURNAL_PENDING_SIZE    (JOURNAL_PAGE_RECORDS * JOURNAL_RAM_PAGES)
+#define JOURNAL_ERASED_SEQ      0xFFFFFFFF
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t sector_seq;        // Increments every time a sector is (re)opened
+    uint32_t first_record_seq;
+    uint32_t reserved;
+} journal_sector_header_t;
+
+typedef struct {
+    uint32_t seq;
+    uint16_t sector;
+    uint16_t slot;
+} journal_match_t;
+
+static const journal_flash_t *flash_dev = NULL;
+static journal_flash_t partition_flash;
+static bool mounted = false;
+
+/* Flash write position, only touched with flash_lock held */
+static uint32_t sector_count;
+static uint32_t head_sector;
+static uint32_t head_slot;
+static uint32_t head_sector_seq;
+static SemaphoreHandle_t flash_lock = NULL;
+
+/* RAM pages filled by journal_log() */
+static journal_record_t pending[JOURNAL_PENDING_SIZE];
+static uint32_t pending_head;
+static uint32_t pending_tail;
+static uint32_t next_seq;
+static portMUX_TYPE pending_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t journal_task_handle = NULL;
+
+/* Index of match start records, oldest first */
+static journal_match_t match_index[JOURNAL_MAX_MATCHES];
+static int match_count;
+
+static journal_stats_t stats;
+
+/* @brief CRC-8 (poly 0x07) used to reject torn records
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ */
+static uint8_t journal_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static bool record_is_erased(const journal_record_t *record) {
+    const uint8_t *bytes = (const uint8_t *)record;
+    for (int i = 0; i < JOURNAL_RECORD_SIZE; i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool record_is_valid(const journal_record_t *record) {
+    return journal_crc8((const uint8_t *)record, JOURNAL_RECORD_SIZE - 1) == record->crc;
+}
+
+static size_t record_offset(uint32_t sector, uint32_t slot) {
+    return sector * JOURNAL_SECTOR_SIZE + sizeof(journal_sector_header_t) + slot * JOURNAL_RECORD_SIZE;
+}
+
+/* Partition backend */
+static esp_err_t partition_read(void *ctx, size_t offset, void *dst, size_t len) {
+    return esp_partition_read((const esp_partition_t *)ctx, offset, dst, len);
+}
+
+static esp_err_t partition_write(void *ctx, size_t offset, const void *src, size_t len) {
+    return esp_partition_write((const esp_partition_t *)ctx, offset, src, len);
+}
+
+static esp_err_t partition_erase(void *ctx, size_t offset, size_t len) {
+    return esp_partition_erase_range((const esp_partition_t *)ctx, offset, len);
+}
+
+static void match_index_add(uint32_t seq, uint32_t sector, uint32_t slot) {
+    if (match_count == JOURNAL_MAX_MATCHES) {
+        memmove(&match_index[0], &match_index[1], (JOURNAL_MAX_MATCHES - 1) * sizeof(journal_match_t));
+        match_count--;
+    }
+    match_index[match_count].seq = seq;
+    match_index[match_count].sector = (uint16_t)sector;
+    match_index[match_count].slot = (uint16_t)slot;
+    match_count++;
+}
+
+/* @brief Drops index entries that pointed into a sector that is about to be erased
+ * @param sector Sector index
+ */
+static void match_index_drop_sector(uint32_t sector) {
+    int kept = 0;
+    for (int i = 0; i < match_count; i++) {
+        if (match_index[i].sector != sector) {
+            match_index[kept++] = match_index[i];
+        }
+    }
+    match_count = kept;
+}
+
+/* @brief Erases the next sector in the ring and writes its header
+ * @param first_seq Sequence number of the first record that will go in it
+ */
+static esp_err_t open_next_sector(uint32_t first_seq) {
+    uint32_t sector = (head_sector + 1) % sector_count;
+    esp_err_t err = flash_dev->erase(flash_dev->ctx, sector * JOURNAL_SECTOR_SIZE, JOURNAL_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    stats.sectors_erased++;
+    match_index_drop_sector(sector);
+
+    journal_sector_header_t header = {
+        .magic = JOURNAL_MAGIC,
+        .sector_seq = head_sector_seq + 1,
+        .first_record_seq = first_seq,
+        .reserved = 0xFFFFFFFF,
+    };
+    err = flash_dev->write(flash_dev->ctx, sector * JOURNAL_SECTOR_SIZE, &header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+    stats.bytes_written += sizeof(header);
+
+    head_sector = sector;
+    head_sector_seq = header.sector_seq;
+    head_slot = 0;
+    return ESP_OK;
+}
+
+/* @brief Moves pending RAM records to flash, one write per page or sector boundary
+ * @note flash_lock must be held
+ */
+static esp_err_t journal_commit(void) {
+    journal_record_t batch[JOURNAL_PAGE_RECORDS];
+    int64_t start = esp_timer_get_time();
+    bool wrote = false;
+
+    while (1) {
+        if (head_slot >= JOURNAL_RECORDS_PER_SECTOR) {
+            uint32_t first_seq;
+            portENTER_CRITICAL(&pending_lock);
+            bool empty = (pending_head == pending_tail);
+            first_seq = pending[pending_tail % JOURNAL_PENDING_SIZE].seq;
+            portEXIT_CRITICAL(&pending_lock);
+            if (empty) {
+                break;
+            }
+            esp_err_t err = open_next_sector(first_seq);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Sector open failed: %s", esp_err_to_name(err));
+                return err;
+            }
+        }
+
+        uint32_t room = JOURNAL_RECORDS_PER_SECTOR - head_slot;
+        uint32_t n = 0;
+        portENTER_CRITICAL(&pending_lock);
+        while (pending_tail != pending_head && n < JOURNAL_PAGE_RECORDS && n < room) {
+            batch[n++] = pending[pending_tail % JOURNAL_PENDING_SIZE];
+            pending_tail++;
+        }
+        portEXIT_CRITICAL(&pending_lock);
+        if (n == 0) {
+            break;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            batch[i].crc = journal_crc8((const uint8_t *)&batch[i], JOURNAL_RECORD_SIZE - 1);
+        }
+        esp_err_t err = flash_dev->write(flash_dev->ctx, record_offset(head_sector, head_slot),
+                                         batch, n * JOURNAL_RECORD_SIZE);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Record write failed: %s", esp_err_to_name(err));
+            return err;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (batch[i].type == TT_EVT_MATCH_START) {
+                match_index_add(batch[i].seq, head_sector, head_slot + i);
+            }
+        }
+        head_slot += n;
+        stats.bytes_written += n * JOURNAL_RECORD_SIZE;
+        wrote = true;
+    }
+
+    if (wrote) {
+        uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+        stats.commits++;
+        stats.commit_us_total += elapsed;
+        if (elapsed > stats.commit_us_max) {
+            stats.commit_us_max = elapsed;
+        }
+    }
+    return ESP_OK;
+}
+
+/* @brief Scans the records of one sector
+ * @param sector Sector index
+ * @param limit Number of slots to scan
+ * @param index_matches Add match starts to the index
+ * @return Number of used slots (first erased slot)
+ */
+static uint32_t scan_sector(uint32_t sector, uint32_t limit, bool index_matches) {
+    journal_record_t batch[JOURNAL_PAGE_RECORDS];
+
+    for (uint32_t slot = 0; slot < limit; slot += JOURNAL_PAGE_RECORDS) {
+        uint32_t n = (limit - slot < JOURNAL_PAGE_RECORDS) ? (limit - slot) : JOURNAL_PAGE_RECORDS;
+        if (flash_dev->read(flash_dev->ctx, record_offset(sector, slot), batch, n * JOURNAL_RECORD_SIZE) != ESP_OK) {
+            return slot;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (record_is_erased(&batch[i])) {
+                return slot + i;
+            }
+            if (!record_is_valid(&batch[i])) {
+                continue;  // Torn write, slot is still consumed
+            }
+            if (batch[i].seq >= next_seq) {
+                next_seq = batch[i].seq + 1;
+            }
+            if (index_matches && batch[i].type == TT_EVT_MATCH_START) {
+                match_index_add(batch[i].seq, sector, slot + i);
+            }
+        }
+    }
+    return limit;
+}
+
+/* @brief Recovers the write position and match index from flash
+ * @param flash Backend to use (partition or stand-in)
+ */
+esp_err_t journal_mount(const journal_flash_t *flash) {
+    flash_dev = flash;
+    sector_count = flash->size / JOURNAL_SECTOR_SIZE;
+    if (sector_count < 2) {
+        ESP_LOGE(TAG, "Journal needs at least 2 sectors");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (flash_lock == NULL) {
+#if STATIC_ALLOC
+        static StaticSemaphore_t flash_lock_buf;
+        flash_lock = xSemaphoreCreateMutexStatic(&flash_lock_buf);
+#else
+        flash_lock = xSemaphoreCreateMutex();
+#endif
+    }
+
+    bool found = false;
+    journal_sector_header_t header;
+    for (uint32_t s = 0; s < sector_count; s++) {
+        if (flash->read(flash->ctx, s * JOURNAL_SECTOR_SIZE, &header, sizeof(header)) != ESP_OK) {
+            continue;
+        }
+        if (header.magic == JOURNAL_MAGIC && (!found || header.sector_seq > head_sector_seq)) {
+            head_sector = s;
+            head_sector_seq = header.sector_seq;
+            next_seq = header.first_record_seq;
+            found = true;
+        }
+    }
+
+    match_count = 0;
+    if (!found) {
+        // Empty journal: the first commit opens sector 0
+        head_sector = sector_count - 1;
+        head_slot = JOURNAL_RECORDS_PER_SECTOR;
+        head_sector_seq = 0;
+        next_seq = 0;
+    } else {
+        // Walk the ring oldest -> newest so the index stays in order
+        for (uint32_t i = 1; i <= sector_count; i++) {
+            uint32_t s = (head_sector + i) % sector_count;
+            if (flash->read(flash->ctx, s * JOURNAL_SECTOR_SIZE, &header, sizeof(header)) != ESP_OK ||
+                header.magic != JOURNAL_MAGIC) {
+                continue;
+            }
+            uint32_t used = scan_sector(s, JOURNAL_RECORDS_PER_SECTOR, true);
+            if (s == head_sector) {
+                head_slot = used;
+            }
+        }
+    }
+
+    pending_head = pending_tail = 0;
+    mounted = true;
+    ESP_LOGI(TAG, "Mounted %lu sectors, head %lu slot %lu, next seq %lu, %d matches",
+             sector_count, head_sector, head_slot, next_seq, match_count);
+    return ESP_OK;
+}
+
+/* @brief Mounts the journal on the "journal" data partition
+ * @param N/A
+ */
+esp_err_t journal_init(void) {
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY,
+                                                           JOURNAL_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "No '%s' partition, journal disabled", JOURNAL_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    partition_flash.read = partition_read;
+    partition_flash.write = partition_write;
+    partition_flash.erase = partition_erase;
+    partition_flash.size = part->size;
+    partition_flash.ctx = (void *)part;
+    return journal_mount(&partition_flash);
+}
+
+/* @brief Appends a record to the RAM page. Never waits on flash.
+ * @param type tt_event_t
+ * @param arg Event argument (key code, hero index, ...)
+ */
+void journal_log(uint8_t type, uint8_t arg) {
+    if (!mounted) {
+        return;
+    }
+
+    journal_record_t record = {
+        .time_ms = (uint32_t)(esp_timer_get_time() / 1000),
+        .game_seconds = game_timer_minutes * 60 + game_timer_seconds,
+        .type = type,
+        .arg = arg,
+        .flags = (all_timers_active ? JOURNAL_FLAG_MATCH : 0) | (game_timer_active ? JOURNAL_FLAG_RUNNING : 0),
+    };
+    bool page_full = false;
+
+    portENTER_CRITICAL(&pending_lock);
+    if (pending_head - pending_tail >= JOURNAL_PENDING_SIZE) {
+        stats.records_dropped++;
+    } else {
+        record.seq = next_seq++;
+        pending[pending_head % JOURNAL_PENDING_SIZE] = record;
+        pending_head++;
+        stats.records_logged++;
+        stats.bytes_logged += JOURNAL_RECORD_SIZE;
+        page_full = ((pending_head - pending_tail) % JOURNAL_PAGE_RECORDS) == 0;
+    }
+    portEXIT_CRITICAL(&pending_lock);
+
+    if (page_full && journal_task_handle != NULL) {
+        xTaskNotifyGive(journal_task_handle);
+    }
+}
+
+/* @brief Commits every pending record to flash
+ * @param N/A
+ */
+esp_err_t journal_flush(void) {
+    if (!mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(flash_lock, portMAX_DELAY);
+    esp_err_t err = journal_commit();
+    xSemaphoreGive(flash_lock);
+    return err;
+}
+
+/* @brief Reads back the records of the last N matches, oldest first
+ * @param count Number of matches
+ * @param cb Called for every valid record
+ * @param ctx Passed to cb
+ * @return Number of records read
+ */
+int journal_read_matches(int count, journal_read_cb_t cb, void *ctx) {
+    if (journal_flush() != ESP_OK) {
+        return 0;
+    }
+
+    journal_record_t batch[JOURNAL_PAGE_RECORDS];
+    int records = 0;
+
+    xSemaphoreTake(flash_lock, portMAX_DELAY);
+    if (match_count > 0 && count > 0) {
+        int first = (count >= match_count) ? 0 : match_count - count;
+        uint32_t sector = match_index[first].sector;
+        uint32_t slot = match_index[first].slot;
+
+        while (1) {
+            uint32_t limit = (sector == head_sector) ? head_slot : JOURNAL_RECORDS_PER_SECTOR;
+            if (slot >= limit) {
+                if (sector == head_sector) {
+                    break;
+                }
+                sector = (sector + 1) % sector_count;
+                slot = 0;
+                continue;
+            }
+            uint32_t n = (limit - slot < JOURNAL_PAGE_RECORDS) ? (limit - slot) : JOURNAL_PAGE_RECORDS;
+            esp_err_t err = flash_dev->read(flash_dev->ctx, record_offset(sector, slot), batch,
+                                            n * JOURNAL_RECORD_SIZE);
+            if (err != ESP_OK) {
+                break;
+            }
+            for (uint32_t i = 0; i < n; i++) {
+                if (record_is_valid(&batch[i])) {
+                    cb(&batch[i], ctx);
+                    records++;
+                }
+            }
+            slot += n;
+        }
+    }
+    xSemaphoreGive(flash_lock);
+    return records;
+}
+
+void journal_get_stats(journal_stats_t *out) {
+    portENTER_CRITICAL(&pending_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&pending_lock);
+}
+
+/* @brief Commits RAM pages when one fills up or every JOURNAL_COMMIT_PERIOD_MS
+ * @param pvParameters N/A
+ */
+void journal_task(void *pvParameters) {
+    journal_task_handle = xTaskGetCurrentTaskHandle();
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(JOURNAL_COMMIT_PERIOD_MS));
+        if (mounted) {
+            journal_flush();
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#include "../../main/time_tracker.h"
+
+/* Append-only match journal
+ *
+ * Fixed-size 16 byte records are appended into RAM pages from the hot path
+ * (key scan / tick) and committed to a ring of flash sectors by journal_task.
+ *
+ * Sector layout (4096 bytes):
+ *   [header 16 bytes][record 0] ... [record 254]
+ */
+
+#define JOURNAL_PARTITION_LABEL   "journal"
+#define JOURNAL_SECTOR_SIZE       4096
+#define JOURNAL_RECORD_SIZE       16
+#define JOURNAL_RECORDS_PER_SECTOR ((JOURNAL_SECTOR_SIZE / JOURNAL_RECORD_SIZE) - 1)
+#define JOURNAL_PAGE_RECORDS      16      // Records per RAM page (one flash write when full)
+#define JOURNAL_RAM_PAGES         4       // Pages buffered before records are dropped
+#define JOURNAL_COMMIT_PERIOD_MS  5000    // Partial pages are committed at least this often
+#define JOURNAL_MAX_MATCHES       32      // Match starts kept in the RAM index
+
+
+#define JOURNAL_FLAG_MATCH   (1 << 0)   // all_timers_active
+#define JOURNAL_FLAG_RUNNING (1 << 1)   // game_timer_active
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;           // Monotonic record number
+    uint32_t time_ms;       // Milliseconds since boot
+    uint32_t game_seconds;  // In-game timer at the time of the event
+    uint8_t type;           // tt_event_t
+    uint8_t arg;
+    uint8_t flags;          // JOURNAL_FLAG_*
+    uint8_t crc;            // CRC-8 over the first 15 bytes
+} journal_record_t;
+
+/* Flash backend, so the journal can run on a partition or any stand-in */
+typedef struct {
+    esp_err_t (*read)(void *ctx, size_t offset, void *dst, size_t len);
+    esp_err_t (*write)(void *ctx, size_t offset, const void *src, size_t len);
+    esp_err_t (*erase)(void *ctx, size_t offset, size_t len);
+    size_t size;
+    void *ctx;
+} journal_flash_t;
+
+typedef struct {
+    uint32_t records_logged;
+    uint32_t records_dropped;       // RAM pages were full
+    uint32_t bytes_logged;          // Record payload bytes accepted
+    uint32_t bytes_written;         // Bytes written to flash (records + sector headers)
+    uint32_t sectors_erased;
+    uint32_t commits;
+    uint32_t commit_us_max;
+    uint64_t commit_us_total;
+} journal_stats_t;
+
+typedef void (*journal_read_cb_t)(const journal_record_t *record, void *ctx);
+
+esp_err_t journal_init(void);
+esp_err_t journal_mount(const journal_flash_t *flash);
+void journal_log(uint8_t type, uint8_t arg);
+esp_err_t journal_flush(void);
+int journal_read_matches(int count, journal_read_cb_t cb, void *ctx);
+void journal_get_stats(journal_stats_t *out);
+void journal_task(void *pvParameters);
+
+#endif
@@ -20,9 +20,17 @@
 #include "esp_log.h"
 #include "lvgl.h"
 #include "../../components/display/display.h"
+#include "../../components/display/display_stats.h"
+#include "../../components/display/ui_cmd.h"
+#include "../../components/gpio_setup/gpio_setup.h"
 #include "esp_rom_sys.h"
+#include "esp_attr.h"
+#include "../dlog/dlog.h"
+#include "keymap.h"
 
 #include "../../main/time_tracker.h"
+#include "../../main/history.h"
+#include "../../main/latency_trace.h"
 
 #define TAG "KEYSCAN"
 
@@ -42,7 +50,11 @@
 static int64_t last_key_press_time[2][5] = {0};
 
 static bool key_states[2][5] = { false };
+static bool key_seen_down[2][5] = { false };   // Raw level, for the latency trace
 static bool standalone_state = false;
+static bool combo_used = false;    // A matrix key was pressed while K11 was held
+static bool hold_pending[KEYMAP_KEYS] = { false };  // Tap deferred to the release, hold fires first if long
+static int64_t key_down_time[KEYMAP_KEYS] = { 0 };
 
 static const gpio_num_t row_pins[2] = {ROW1, ROW2};
 static const gpio_num_t col_pins[5] = {COL1, COL2, COL3, COL4, COL5};
@@ -76,6 +88,8 @@ void init_keys(void)
     gpio_reset_pin(STANDALONE_KEY);
     gpio_set_direction(STANDALONE_KEY, GPIO_MODE_INPUT);
     gpio_pullup_en(STANDALONE_KEY);
+
+    keymap_init();
 }
 
 static gpio_mode_t col_pin_modes[5] = {
@@ -89,141 +103,124 @@ void set_col_pin_mode(int col, gpio_mode_t mode) {
     }
 }
 
-void switch_tab_cb(void *arg) {
-    lv_tabview_set_act(tabview, (uint8_t)(uintptr_t)arg, LV_ANIM_OFF);
-}
+static TaskHandle_t wake_task = NULL;
+static volatile bool wake_fired = false;
 
-void start_hero_timer(int index) {
-    hero_timers[index].minutes = HERO_START_MIN;
-    hero_timers[index].seconds = HERO_START_SEC;
-    hero_timers[index].active = true;
-}
+/* @brief Any wake pin: mask them all (level interrupts) and wake the key scan task */
+static void IRAM_ATTR key_wake_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
 
-void end_hero_timer(int index) {
-    hero_timers[index].minutes = 0;
-    hero_timers[index].seconds = 0;
-    hero_timers[index].active = false;
+    for (int row = 0; row < 2; row++) {
+        gpio_intr_disable(row_pins[row]);
+    }
+    gpio_intr_disable(STANDALONE_KEY);
+    gpio_intr_disable(TP_INT);
+    wake_fired = true;
+    vTaskNotifyGiveFromISR(wake_task, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
 }
 
-void process_key(uint8_t row, uint8_t col) {        
-    /*
-    {"K1", "K2", "K3", "K4", "K5"},
-    {"K6", "K7", "K8", "K9", "K10"}
-                "k11" - standalone key
-    */
-
-    // K1 - Hero #1 timer 
-    if (row == 0 && col == 0) {
-        if (!hero_timers[0].active && all_timers_active) {
-            start_hero_timer(0);
-        } else {
-            end_hero_timer(0);
-        }  
-    }
-    // K2 - Hero #2 timer 
-    if (row == 0 && col == 1) {
-        if (!hero_timers[1].active && all_timers_active) {
-            start_hero_timer(1);
-        } else {
-            end_hero_timer(1);
-        }  
+/* @brief Power idle: interrupts (and light sleep wakeups) instead of polling
+ * @return false if a key or the touch panel is still down, nothing is armed:
+ *         its level interrupt would fire at once, keep scanning until it is released
+ * @note Call right after scan_keys(). All columns are driven high so any matrix
+ *       key raises its row; K11 and the touch panel (TP_INT, handed over from
+ *       gpio_isr_handler) wake on low
+ */
+bool keys_arm_wakeup(void)
+{
+    for (int row = 0; row < 2; row++) {
+        for (int col = 0; col < 5; col++) {
+            if (key_seen_down[row][col]) {
+                return false;
+            }
+        }
     }
-    // K3 - Hero #3 timer 
-    if (row == 0 && col == 2) {
-        if (!hero_timers[2].active && all_timers_active) {
-            start_hero_timer(2);
-        } else {
-            end_hero_timer(2);
-        }  
+    if (gpio_get_level(STANDALONE_KEY) == 0 || gpio_get_level(TP_INT) == 0) {
+        return false;
     }
-    // K4 - Hero #4 timer 
-    if (row == 0 && col == 3) {
-        if (!hero_timers[3].active && all_timers_active) {
-            start_hero_timer(3);
-        } else {
-            end_hero_timer(3);
-        }  
+
+    wake_task = xTaskGetCurrentTaskHandle();
+    wake_fired = false;
+    for (int col = 0; col < 5; col++) {
+        gpio_set_direction(col_pins[col], GPIO_MODE_OUTPUT);
+        gpio_set_level(col_pins[col], 1);
     }
-    // K5 - Hero #5 timer 
-    if (row == 0 && col == 4) {
-        if (!hero_timers[4].active && all_timers_active) {
-            start_hero_timer(4);
-        } else {
-            end_hero_timer(4);
-        }  
+    for (int row = 0; row < 2; row++) {
+        gpio_isr_handler_add(row_pins[row], key_wake_isr, NULL);
+        gpio_wakeup_enable(row_pins[row], GPIO_INTR_HIGH_LEVEL);
+        gpio_intr_enable(row_pins[row]);
     }
-    // K6 - Remove/Close in-game timer
-    if (row == 1 && col == 0) {
-        all_timers_active = 0;
-        game_timer_active = 0;
-        game_timer_minutes = 0;
-        game_timer_seconds = 0;
+    gpio_isr_handler_add(STANDALONE_KEY, key_wake_isr, NULL);
+    gpio_wakeup_enable(STANDALONE_KEY, GPIO_INTR_LOW_LEVEL);
+    gpio_intr_enable(STANDALONE_KEY);
+
+    gpio_isr_handler_remove(TP_INT);
+    gpio_isr_handler_add(TP_INT, key_wake_isr, NULL);
+    gpio_wakeup_enable(TP_INT, GPIO_INTR_LOW_LEVEL);
+    gpio_intr_enable(TP_INT);
+    return true;
+}
+
+/* @brief Back to scanning, TP_INT returns to gpio_isr_handler on its falling edge
+ * @return true if a wake pin fired while armed (the task may be notified for other reasons)
+ */
+bool keys_disarm_wakeup(void)
+{
+    for (int row = 0; row < 2; row++) {
+        gpio_wakeup_disable(row_pins[row]);
+        gpio_set_intr_type(row_pins[row], GPIO_INTR_DISABLE);
+        gpio_isr_handler_remove(row_pins[row]);
     }
-    // K7 - Decrease in-game timer (if active)
-    if (row == 1 && col == 1) {
-        if (all_timers_active && !game_timer_active) {
-            if (game_timer_minutes > 0 || game_timer_seconds > 0) {
-                if (game_timer_seconds == 0) {
-                    game_timer_minutes--;
-                    game_timer_seconds = 59;
-                } else {
-                    game_timer_seconds--;
-                }
-            }
-            // Increase all active hero timers (but cap at 8:00)
-            for (int i = 0; i < HERO_COUNT; i++) {
-                if (hero_timers[i].active) {
-                    uint16_t total_secs = hero_timers[i].minutes * 60 + hero_timers[i].seconds;
-                    if (total_secs < 8 * 60) {
-                        hero_timers[i].seconds++;
-                        if (hero_timers[i].seconds >= 60) {
-                            hero_timers[i].seconds = 0;
-                            hero_timers[i].minutes++;
-                        }
-                    }
-                }
-            }
-        }
+    gpio_wakeup_disable(STANDALONE_KEY);
+    gpio_set_intr_type(STANDALONE_KEY, GPIO_INTR_DISABLE);
+    gpio_isr_handler_remove(STANDALONE_KEY);
+
+    gpio_wakeup_disable(TP_INT);
+    gpio_isr_handler_remove(TP_INT);
+    gpio_set_intr_type(TP_INT, GPIO_INTR_NEGEDGE);
+    gpio_isr_handler_add(TP_INT, gpio_isr_handler, (void *)TP_INT);
+    gpio_intr_enable(TP_INT);
+
+    for (int col = 0; col < 5; col++) {
+        gpio_set_direction(col_pins[col], GPIO_MODE_INPUT);
     }
-    // K8 - Pause/Resume in-game timer (if active)
-    if (row == 1 && col == 2) {
-        if (all_timers_active) {
-            game_timer_active = !game_timer_active;
-        }
+    return wake_fired;
+}
+
+/* @brief Accepted press of a matrix key, tap right away unless the key also has a long press
+ * @param key 0-9
+ * @param now Milliseconds
+ */
+static void key_pressed(uint8_t key, int64_t now) {
+    if (standalone_state) {
+        combo_used = true;
+        keymap_dispatch(KM_CHORD, key);     // K11 held + matrix key
+    } else if (keymap_has_hold(key)) {
+        hold_pending[key] = true;
+        key_down_time[key] = now;
+    } else {
+        latency_trace_stamp(keymap_game_key(key), LT_PROCESS);
+        keymap_dispatch(KM_TAP, key);
     }
-    // K9 - Increase in-game timer (if active)
-    if (row == 1 && col == 3) {
-        if (all_timers_active && !game_timer_active) {
-            game_timer_seconds++;
-            if (game_timer_seconds >= 60) {
-                game_timer_seconds = 0;
-                game_timer_minutes++;
-            }
-            // Decrease all active hero timers
-            for (int i = 0; i < HERO_COUNT; i++) {
-                if (hero_timers[i].active) {
-                    if (hero_timers[i].seconds == 0) {
-                        if (hero_timers[i].minutes == 0) {
-                            hero_timers[i].active = false; // timer expires
-                        } else {
-                            hero_timers[i].minutes--;
-                            hero_timers[i].seconds = 59;
-                        }
-                    } else {
-                        hero_timers[i].seconds--;
-                    }
-                }
-            }
-        }
+}
+
+/* @brief Long press reached while the key is still down, the tap is dropped */
+static void key_held(uint8_t key, int64_t now) {
+    if (hold_pending[key] && now - key_down_time[key] >= KEYMAP_LONG_MS) {
+        hold_pending[key] = false;
+        keymap_dispatch(KM_HOLD, key);
     }
-    // K10 - Starts in-game timer (if in-active) 
-    if (row == 1 && col == 4) {
-        if (!all_timers_active) {
-            all_timers_active = 1;
-            game_timer_minutes = 0;
-            game_timer_seconds = 0;
-            game_timer_active = 1;
-        }
+}
+
+static void key_released(uint8_t key) {
+    if (hold_pending[key]) {
+        hold_pending[key] = false;
+        latency_trace_stamp(keymap_game_key(key), LT_PROCESS);
+        keymap_dispatch(KM_TAP, key);
     }
 }
 
@@ -239,21 +236,36 @@ void scan_keys(void)
         for (int row = 0; row < 2; row++) {
             int level = gpio_get_level(row_pins[row]);
             bool is_pressed = (level == 1);
+            uint8_t key = row * 5 + col;
             if (is_pressed && !key_states[row][col]) {
+                // Traced by the game key it sends, the trace ends on that hero's row
+                if (!key_seen_down[row][col] && !standalone_state) {
+                    latency_trace_begin(keymap_game_key(key));
+                }
+                key_seen_down[row][col] = true;
                 // Check debounce
                 if (now - last_key_press_time[row][col] > DEBOUNCE_TIME_MS) {
                     last_key_press_time[row][col] = now;
                     key_states[row][col] = true;
-                    process_key(row, col);
+                    latency_trace_stamp(keymap_game_key(key), LT_DEBOUNCE);
+                    DLOGD(TAG, "K%u accepted", key + 1);
+                    key_pressed(key, now);
                 }
-            } else if (!is_pressed && key_states[row][col]) {
+            } else if (is_pressed) {
+                key_held(key, now);
+            } else if (key_states[row][col]) {
                 key_states[row][col] = false;
+                key_released(key);
+            }
+            if (!is_pressed) {
+                key_seen_down[row][col] = false;
             }
         }
         gpio_set_direction(col_pins[col], GPIO_MODE_INPUT);
     }
 
     // Debounce for standalone key
+    // K11 doubles as the chord modifier, so its tap only fires on release without a chord
     static int64_t last_standalone_time = 0;
     int standalone_level = gpio_get_level(STANDALONE_KEY);
     bool standalone_pressed = (standalone_level == 0);
@@ -261,10 +273,18 @@ void scan_keys(void)
         if (now - last_standalone_time > DEBOUNCE_TIME_MS) {
             last_standalone_time = now;
             standalone_state = true;
-            indexing = (indexing + 1) % 3;
-            //lv_tabview_set_act(tabview, indexing, LV_ANIM_OFF);
+            combo_used = false;
+            hold_pending[KEYMAP_K11] = keymap_has_hold(KEYMAP_K11);
+            key_down_time[KEYMAP_K11] = now;
         }
+    } else if (standalone_pressed && hold_pending[KEYMAP_K11] && !combo_used) {
+        key_held(KEYMAP_K11, now);
+        combo_used = !hold_pending[KEYMAP_K11];    // Long press fired, no tap on release
     } else if (!standalone_pressed && standalone_state) {
         standalone_state = false;
+        hold_pending[KEYMAP_K11] = false;
+        if (!combo_used) {
+            keymap_dispatch(KM_TAP, KEYMAP_K11);
+        }
     }
 }
\ No newline at end of file
@@ -1,7 +1,11 @@
 #ifndef KEYBOARD_H
 #define KEYBOARD_H
 
+#include <stdbool.h>
+
 void init_keys(void);
 void scan_keys(void);
+bool keys_arm_wakeup(void);
+bool keys_disarm_wakeup(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "keymap.h"
+#include "../../components/display/ui_cmd.h"
+#include "../../components/display/display_stats.h"
+#include "../serial_link/serial_link.h"
+
+#include "../../main/time_tracker.h"
+#include "../../main/history.h"
+
+#define TAG "KEYMAP"
+
+#define GAME(code)  { KM_GAME_KEY, code }
+#define ACT(a, arg) { a, arg }
+#define NONE        { KM_NONE, 0 }
+
+/* Chords shared by every built-in profile: K11 + K7 undo, K11 + K8 stats overlay, K11 + K10 next profile */
+#define CHORDS { NONE, NONE, NONE, NONE, NONE, NONE, ACT(KM_UNDO, 0), ACT(KM_STATS_OVERLAY, 0), \
+                 NONE, ACT(KM_NEXT_PROFILE, 0), NONE }
+
+static const keymap_profile_t builtin_profiles[] = {
+    {   // As labelled on the keys, no hold bindings so every tap acts on press
+        .name = "default",
+        .bind = {
+            [KM_TAP] = { GAME(0), GAME(1), GAME(2), GAME(3), GAME(4),
+                         GAME(5), GAME(6), GAME(7), GAME(8), GAME(9), ACT(KM_NEXT_TAB, 0) },
+            [KM_CHORD] = CHORDS,
+        },
+    },
+    {   // Hero timers and match start only, ending the match needs a long press
+        .name = "buyback",
+        .bind = {
+            [KM_TAP] = { GAME(0), GAME(1), GAME(2), GAME(3), GAME(4),
+                         NONE, NONE, NONE, NONE, GAME(9), ACT(KM_NEXT_TAB, 0) },
+            [KM_HOLD] = { NONE, NONE, NONE, NONE, NONE, GAME(5) },
+            [KM_CHORD] = CHORDS,
+        },
+    },
+    {   // K6 - K8 jump to a tab, K9 pauses
+        .name = "caster",
+        .bind = {
+            [KM_TAP] = { GAME(0), GAME(1), GAME(2), GAME(3), GAME(4),
+                         ACT(KM_TAB, 0), ACT(KM_TAB, 1), ACT(KM_TAB, 2), GAME(7), GAME(9), ACT(KM_NEXT_TAB, 0) },
+            [KM_HOLD] = { NONE, NONE, NONE, NONE, NONE, GAME(5) },
+            [KM_CHORD] = CHORDS,
+        },
+    },
+    {   // Clock adjust while paused, long K7 undoes, long K6 ends the match
+        .name = "coach",
+        .bind = {
+            [KM_TAP] = { GAME(0), GAME(1), GAME(2), GAME(3), GAME(4),
+                         NONE, GAME(6), GAME(7), GAME(8), GAME(9), ACT(KM_NEXT_TAB, 0) },
+            [KM_HOLD] = { NONE, NONE, NONE, NONE, NONE, GAME(5), ACT(KM_UNDO, 0) },
+            [KM_CHORD] = CHORDS,
+        },
+    },
+};
+
+_Static_assert(sizeof(builtin_profiles) / sizeof(builtin_profiles[0]) <= KEYMAP_MAX_PROFILES,
+               "too many built-in profiles");
+
+static const char *const action_names[KM_ACTIONS] = {
+    "none", "key", "next_tab", "tab", "undo", "overlay", "next_profile"
+};
+static const char *const kind_names[KM_KINDS] = { "tap", "hold", "chord" };
+
+static keymap_blob_t keymap;
+static keymap_profile_t *active = &keymap.profiles[0];
+static esp_timer_handle_t save_timer;           // One-shot, restarted by every keymap_select()
+
+static void km_none(uint8_t arg) {
+}
+
+static void km_game_key(uint8_t arg) {
+    process_key(arg / 5, arg % 5);
+}
+
+static void km_next_tab(uint8_t arg) {
+    ui_cmd_post(UI_CMD_NEXT_TAB, 0);   // LVGL belongs to lvgl_task
+    time_tracker_emit(TT_EVT_KEY, KEYMAP_K11);
+}
+
+static void km_tab(uint8_t arg) {
+    ui_cmd_post(UI_CMD_SWITCH_TAB, arg);
+}
+
+static void km_undo(uint8_t arg) {
+    history_undo_last_key();
+}
+
+static void km_stats_overlay(uint8_t arg) {
+    display_stats_toggle_overlay();
+}
+
+static void km_next_profile(uint8_t arg) {
+    keymap_select((keymap.active + 1) % keymap.count);
+    ui_cmd_post_text(UI_CMD_TOAST, active->name);
+}
+
+static void (*const handlers[KM_ACTIONS])(uint8_t arg) = {
+    [KM_NONE] = km_none,
+    [KM_GAME_KEY] = km_game_key,
+    [KM_NEXT_TAB] = km_next_tab,
+    [KM_TAB] = km_tab,
+    [KM_UNDO] = km_undo,
+    [KM_STATS_OVERLAY] = km_stats_overlay,
+    [KM_NEXT_PROFILE] = km_next_profile,
+};
+
+static void keymap_load_builtin(keymap_blob_t *blob) {
+    memset(blob, 0, sizeof(*blob));
+    blob->version = KEYMAP_VERSION;
+    blob->count = sizeof(builtin_profiles) / sizeof(builtin_profiles[0]);
+    memcpy(blob->profiles, builtin_profiles, sizeof(builtin_profiles));
+}
+
+/* @brief Blob from NVS is usable: known version, sane count and bindings */
+static bool keymap_valid(const keymap_blob_t *blob) {
+    if (blob->version != KEYMAP_VERSION || blob->count == 0 || blob->count > KEYMAP_MAX_PROFILES ||
+        blob->active >= blob->count) {
+        return false;
+    }
+    for (int p = 0; p < blob->count; p++) {
+        if (memchr(blob->profiles[p].name, '\0', KEYMAP_NAME_LEN) == NULL) {
+            return false;   // Printed with %s
+        }
+        for (int k = 0; k < KM_KINDS; k++) {
+            for (int key = 0; key < KEYMAP_KEYS; key++) {
+                const keymap_binding_t *b = &blob->profiles[p].bind[k][key];
+                if (b->action >= KM_ACTIONS || (b->action == KM_GAME_KEY && b->arg >= TT_GAME_KEYS)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static esp_err_t keymap_save(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(KEYMAP_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_blob(handle, KEYMAP_NVS_KEY, &keymap, sizeof(keymap));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+/* @brief esp_timer task, KEYMAP_SAVE_DELAY_MS after the last profile switch
+ * @note Cycling through several profiles in a row costs one write
+ */
+static void keymap_save_cb(void *arg) {
+    if (keymap_save() != ESP_OK) {
+        ESP_LOGW(TAG, "Profile %s not saved", active->name);
+    }
+}
+
+/* @brief Runs the action bound to a key
+ * @param kind KM_TAP, KM_HOLD or KM_CHORD
+ * @param key 0 - 10 (K1 - K11)
+ * @return false if nothing is bound
+ */
+bool keymap_dispatch(keymap_kind_t kind, uint8_t key) {
+    if (key >= KEYMAP_KEYS) {
+        return false;
+    }
+    const keymap_binding_t *b = &active->bind[kind][key];
+    handlers[b->action](b->arg);
+    return b->action != KM_NONE;
+}
+
+/* @brief The key has a long-press binding, so its tap waits for the release */
+bool keymap_has_hold(uint8_t key) {
+    return key < KEYMAP_KEYS && active->bind[KM_HOLD][key].action != KM_NONE;
+}
+
+/* @brief Game key code a tap sends (for the latency trace), 0xFF if it is something else */
+uint8_t keymap_game_key(uint8_t key) {
+    if (key >= KEYMAP_KEYS || active->bind[KM_TAP][key].action != KM_GAME_KEY) {
+        return 0xFF;
+    }
+    return active->bind[KM_TAP][key].arg;
+}
+
+/* @brief Makes a profile active, the choice is stored KEYMAP_SAVE_DELAY_MS later by a one-shot timer
+ * @param index 0 - count - 1
+ * @note Called from key_scan_task (K11 + K10), which must not wait on flash
+ */
+bool keymap_select(uint8_t index) {
+    if (index >= keymap.count) {
+        return false;
+    }
+    keymap.active = index;
+    active = &keymap.profiles[index];   // One pointer store, scan_keys() sees either profile whole
+    esp_timer_stop(save_timer);
+    esp_timer_start_once(save_timer, (uint64_t)KEYMAP_SAVE_DELAY_MS * 1000);
+    return true;
+}
+
+const char *keymap_active_name(void) {
+    return active->name;
+}
+
+static int keymap_parse_key(const char *s) {
+    int key = atoi(s + (s[0] == 'K' || s[0] == 'k'));
+    return key >= 1 && key <= KEYMAP_KEYS ? key - 1 : -1;
+}
+
+static void keymap_print(void) {
+    for (int p = 0; p < keymap.count; p++) {
+        printf("%c %d %s\n", p == keymap.active ? '*' : ' ', p, keymap.profiles[p].name);
+    }
+    for (int key = 0; key < KEYMAP_KEYS; key++) {
+        printf("K%-3d", key + 1);
+        for (int k = 0; k < KM_KINDS; k++) {
+            const keymap_binding_t *b = &active->bind[k][key];
+            if (b->action == KM_NONE) {
+                printf(" %-5s -            ", kind_names[k]);
+            } else {
+                printf(" %-5s %-12s %-3u", kind_names[k], action_names[b->action], b->arg);
+            }
+        }
+        printf("\n");
+    }
+}
+
+/* @brief Console: keymap [use <n|name>|set <tap|hold|chord> <K1-K11> <action> [arg]|save|reset]
+ * @note "set" changes the active profile in RAM until "save"
+ */
+static void keymap_command(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "use") == 0) {
+        for (int p = 0; p < keymap.count; p++) {
+            if (strcmp(argv[2], keymap.profiles[p].name) == 0) {
+                keymap_select(p);
+                return;
+            }
+        }
+        if (!keymap_select((uint8_t)atoi(argv[2]))) {
+            printf("no profile %s\n", argv[2]);
+        }
+        return;
+    }
+    if (argc >= 5 && strcmp(argv[1], "set") == 0) {
+        int kind = -1, action = -1, key = keymap_parse_key(argv[3]);
+        for (int k = 0; k < KM_KINDS; k++) {
+            kind = strcmp(argv[2], kind_names[k]) == 0 ? k : kind;
+        }
+        for (int a = 0; a < KM_ACTIONS; a++) {
+            action = strcmp(argv[4], action_names[a]) == 0 ? a : action;
+        }
+        uint8_t arg = argc > 5 ? (uint8_t)atoi(argv[5]) : 0;
+        if (kind < 0 || key < 0 || action < 0 || (action == KM_GAME_KEY && arg >= TT_GAME_KEYS)) {
+            printf("keymap set <tap|hold|chord> <K1-K11> <none|key|next_tab|tab|undo|overlay|next_profile> [arg]\n");
+            return;
+        }
+        // Argument first, the action byte makes the binding live
+        active->bind[kind][key].arg = arg;
+        active->bind[kind][key].action = action;
+        return;
+    }
+    if (argc == 2 && strcmp(argv[1], "save") == 0) {
+        esp_err_t err = keymap_save();
+        printf("%s\n", err == ESP_OK ? "saved" : esp_err_to_name(err));
+        return;
+    }
+    if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+        // Built aside and published like keymap_select(): scan_keys() dispatches through the
+        // complete local copy while the live blob is overwritten, count never reads 0
+        static keymap_blob_t builtin;
+        keymap_load_builtin(&builtin);
+        __atomic_store_n(&active, &builtin.profiles[0], __ATOMIC_RELEASE);
+        memcpy(&keymap, &builtin, sizeof(keymap));
+        __atomic_store_n(&active, &keymap.profiles[0], __ATOMIC_RELEASE);
+        keymap_save();
+    }
+    keymap_print();
+}
+
+/* @brief Loads the profiles with one NVS read, falls back to the built-in ones */
+void keymap_init(void) {
+    nvs_handle_t handle;
+    size_t len = sizeof(keymap);
+    bool loaded = false;
+
+    if (nvs_open(KEYMAP_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        loaded = nvs_get_blob(handle, KEYMAP_NVS_KEY, &keymap, &len) == ESP_OK &&
+                 len == sizeof(keymap) && keymap_valid(&keymap);
+        nvs_close(handle);
+    }
+    if (!loaded) {
+        keymap_load_builtin(&keymap);
+    }
+    active = &keymap.profiles[keymap.active];
+    ESP_LOGI(TAG, "Profile %s (%s)", active->name, loaded ? "NVS" : "built-in");
+
+    const esp_timer_create_args_t save_args = {
+        .callback = keymap_save_cb,
+        .name = "keymap_save",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&save_args, &save_timer));
+    serial_link_register_command("keymap",
+                                 "Key profiles: keymap [use <n>|set <kind> <key> <action> [arg]|save|reset]",
+                                 keymap_command);
+}
@@ -0,0 +1,81 @@
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Keymap profiles and action dispatch
+ *
+ * Every physical key (K1 - K10 by matrix code row * 5 + col, K11 = 10) has
+ * three bindings per profile, each an action and its argument:
+ *
+ *   KM_TAP    pressed (released, if the key also has a hold binding)
+ *   KM_HOLD   held for KEYMAP_LONG_MS
+ *   KM_CHORD  pressed while K11 is held, K11 then does not tap
+ *
+ * scan_keys() looks the binding up by key code and calls the action's
+ * handler, no comparisons against the other keys. Game keys go through
+ * process_key() with their logical code, so journal, history and replays
+ * do not depend on the profile.
+ *
+ * All profiles are one versioned blob in NVS, read once at boot; without a
+ * valid blob the built-in ones are used. Switching profiles does not write
+ * NVS from the key scan, a one-shot esp_timer saves the choice
+ * KEYMAP_SAVE_DELAY_MS after the last switch. Console: keymap, see keymap.c.
+ */
+
+#define KEYMAP_KEYS             11          // K1 - K11
+#define KEYMAP_K11              10
+#define KEYMAP_MAX_PROFILES     4
+#define KEYMAP_NAME_LEN         12
+#define KEYMAP_LONG_MS          600
+#define KEYMAP_SAVE_DELAY_MS    5000        // Settle time after a profile switch before the NVS write
+#define KEYMAP_VERSION          1
+#define KEYMAP_NVS_NAMESPACE    "keymap"
+#define KEYMAP_NVS_KEY          "profiles"
+
+typedef enum {
+    KM_NONE = 0,
+    KM_GAME_KEY,            // arg = key code for process_key(), 0 - 9
+    KM_NEXT_TAB,            // Also logged as K11 (TT_EVT_KEY 10)
+    KM_TAB,                 // arg = tab index
+    KM_UNDO,
+    KM_STATS_OVERLAY,
+    KM_NEXT_PROFILE,
+    KM_ACTIONS
+} keymap_action_t;
+
+typedef enum {
+    KM_TAP = 0,
+    KM_HOLD,
+    KM_CHORD,
+    KM_KINDS
+} keymap_kind_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t action;         // keymap_action_t
+    uint8_t arg;
+} keymap_binding_t;
+
+typedef struct __attribute__((packed)) {
+    char name[KEYMAP_NAME_LEN];
+    keymap_binding_t bind[KM_KINDS][KEYMAP_KEYS];
+} keymap_profile_t;
+
+/* NVS blob, a different version or size falls back to the built-in profiles */
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t count;
+    uint8_t active;
+    uint8_t reserved;
+    keymap_profile_t profiles[KEYMAP_MAX_PROFILES];
+} keymap_blob_t;
+
+void keymap_init(void);
+bool keymap_dispatch(keymap_kind_t kind, uint8_t key);
+bool keymap_has_hold(uint8_t key);
+uint8_t keymap_game_key(uint8_t key);
+bool keymap_select(uint8_t index);
+const char *keymap_active_name(void);
+
+#endif
@@ -0,0 +1,65 @@
+#include <string.h>
+#include "mpsc_ring.h"
+
+/* @brief Empties the ring
+ * @param slots count * slot_size bytes, each slot starts with its sequence number
+ * @param count Power of two
+ */
+void mpsc_ring_init(mpsc_ring_t *ring, void *slots, uint32_t count, uint32_t slot_size) {
+    memset(ring, 0, sizeof(*ring));
+    memset(slots, 0, (size_t)count * slot_size);
+    ring->mask = count - 1;
+    ring->slot_size = slot_size;
+    ring->slots = slots;
+}
+
+static inline volatile uint32_t *slot_seq(const mpsc_ring_t *ring, uint32_t index) {
+    return (volatile uint32_t *)(ring->slots + (index & ring->mask) * ring->slot_size);
+}
+
+/* @brief Claims the next slot for the caller to fill, never blocks
+ * @param ticket Set for mpsc_ring_publish()
+ * @return The slot, NULL if the ring was full and the write was dropped
+ */
+void *mpsc_ring_reserve(mpsc_ring_t *ring, uint32_t *ticket) {
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t used;
+
+    do {
+        used = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (used > ring->mask) {
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&ring->head, &head, head + 1, true,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    if (used + 1 > ring->high_water) {
+        ring->high_water = used + 1;    // Racy, only a statistic
+    }
+    *ticket = head;
+    return (void *)slot_seq(ring, head);
+}
+
+/* @brief Makes a filled slot visible to the reader */
+void mpsc_ring_publish(mpsc_ring_t *ring, void *slot, uint32_t ticket) {
+    __atomic_store_n((volatile uint32_t *)slot, ticket + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&ring->written, 1, __ATOMIC_RELAXED);
+}
+
+/* @brief Oldest published slot, single reader only
+ * @return NULL if the ring is empty or the oldest slot is still being written
+ */
+void *mpsc_ring_peek(mpsc_ring_t *ring) {
+    volatile uint32_t *seq = slot_seq(ring, ring->tail);
+
+    if (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != ring->tail + 1) {
+        return NULL;
+    }
+    return (void *)seq;
+}
+
+/* @brief Hands the slot returned by mpsc_ring_peek() back to the writers */
+void mpsc_ring_release(mpsc_ring_t *ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
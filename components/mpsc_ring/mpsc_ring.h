@@ -0,0 +1,47 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Lock-free ring of fixed-size slots, many writers and one reader
+ *
+ * Any number of writers (tasks on one core preempting each other, ISRs, or
+ * the other core) reserve a slot with a compare-and-swap on head, fill it and
+ * publish it by writing its sequence number. One reader takes slots in order
+ * and stops at a slot that is reserved but not yet published. When the ring
+ * is full the write is dropped and counted, writers never wait.
+ *
+ * The slots belong to the user (dlog records, UI commands); each one must
+ * start with a volatile uint32_t holding the sequence number.
+ *
+ * No ESP-IDF dependencies, builds on a host.
+ */
+
+typedef struct {
+    uint32_t head;              // Next slot to reserve
+    uint32_t tail;              // Next slot to read
+    uint32_t mask;              // Slot count - 1
+    uint32_t slot_size;
+    uint8_t *slots;
+    uint32_t written;
+    uint32_t dropped;
+    uint32_t high_water;        // Most slots waiting at once
+} mpsc_ring_t;
+
+/* Static initialiser, same as mpsc_ring_init() on zeroed slots
+ * @param slot_array Array of a power of two slots
+ */
+#define MPSC_RING_INIT(slot_array) {                                    \
+    .mask = sizeof(slot_array) / sizeof((slot_array)[0]) - 1,           \
+    .slot_size = sizeof((slot_array)[0]),                               \
+    .slots = (uint8_t *)(slot_array),                                   \
+}
+
+void mpsc_ring_init(mpsc_ring_t *ring, void *slots, uint32_t count, uint32_t slot_size);
+void *mpsc_ring_reserve(mpsc_ring_t *ring, uint32_t *ticket);
+void mpsc_ring_publish(mpsc_ring_t *ring, void *slot, uint32_t ticket);
+void *mpsc_ring_peek(mpsc_ring_t *ring);
+void mpsc_ring_release(mpsc_ring_t *ring);
+
+#endif
@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+
+#include "../../main/time_tracker.h"
+#include "../gpio_setup/gpio_setup.h"
+#include "../display/ui_cmd.h"
+#include "../profiler/profiler.h"
+#include "../serial_link/serial_link.h"
+#include "power.h"
+
+#define TAG "POWER"
+
+const char *const power_state_names[POWER_STATES] = { "active", "idle", "sleep" };
+
+static portMUX_TYPE power_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile power_state_t state = POWER_ACTIVE;
+static TaskHandle_t owner = NULL;
+static int64_t last_activity_us = 0;
+static esp_pm_lock_handle_t cpu_lock = NULL;      // Held in ACTIVE, no frequency scaling
+static esp_pm_lock_handle_t awake_lock = NULL;    // Held outside SLEEP, no light sleep
+
+/* Accounting, guarded by power_mux */
+static power_stats_t stats;
+static int64_t state_since_us = 0;
+static uint32_t state_since_switches = 0;
+
+static uint32_t total_switches(void) {
+    return profiler_switches[0] + profiler_switches[1];
+}
+
+static void pm_lock(esp_pm_lock_handle_t lock, bool hold) {
+    if (lock != NULL) {
+        if (hold) {
+            esp_pm_lock_acquire(lock);
+        } else {
+            esp_pm_lock_release(lock);
+        }
+    }
+}
+
+/* @brief Switches state, key_scan_task only
+ * @note ACTIVE -> IDLE -> SLEEP, and back to ACTIVE from either
+ */
+static void power_enter(power_state_t next) {
+    power_state_t prev = state;
+    int64_t now = esp_timer_get_time();
+    uint32_t switches = total_switches();
+
+    portENTER_CRITICAL(&power_mux);
+    stats.time_us[prev] += now - state_since_us;
+    stats.switches[prev] += switches - state_since_switches;
+    stats.entries[next]++;
+    state_since_us = now;
+    state_since_switches = switches;
+    state = next;
+    portEXIT_CRITICAL(&power_mux);
+
+    switch (next) {
+    case POWER_ACTIVE:
+        pm_lock(awake_lock, prev == POWER_SLEEP);
+        pm_lock(cpu_lock, true);
+        set_backlight_brightness(POWER_ACTIVE_BRIGHTNESS / 100.0f);
+        ui_cmd_post(UI_CMD_RESUME, 0);
+        break;
+    case POWER_IDLE:
+        ui_cmd_post(UI_CMD_SUSPEND, 0);
+        set_backlight_brightness(POWER_IDLE_BRIGHTNESS / 100.0f);
+        pm_lock(cpu_lock, false);
+        break;
+    case POWER_SLEEP:
+        set_backlight_brightness(0);    // Duty 0 stays low through light sleep
+        pm_lock(awake_lock, false);
+        break;
+    default:
+        break;
+    }
+    ESP_LOGI(TAG, "%s -> %s", power_state_names[prev], power_state_names[next]);
+}
+
+/* @brief Input or game activity, from any task; wakes key_scan_task if idle */
+void power_activity(void) {
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&power_mux);
+    last_activity_us = now;
+    portEXIT_CRITICAL(&power_mux);
+    if (state != POWER_ACTIVE && owner != NULL && xTaskGetCurrentTaskHandle() != owner) {
+        xTaskNotifyGive(owner);
+    }
+}
+
+/* @brief Game events count as activity (ticks do not, a running game is checked in power_update) */
+void power_listener(uint8_t event, uint8_t arg) {
+    if (event != TT_EVT_TICK) {
+        power_activity();
+    }
+}
+
+/* @brief Sets the task that runs power_update() and is woken by power_activity() */
+void power_set_owner(TaskHandle_t task) {
+    owner = task;
+}
+
+/* @brief Runs the state machine, key_scan_task only
+ * @return 0 in ACTIVE (keep scanning), otherwise how long to wait for a wake interrupt
+ */
+TickType_t power_update(void) {
+    int64_t now = esp_timer_get_time();
+
+    if (all_timers_active && game_timer_active) {
+        power_activity();   // A running game keeps the screen on
+    }
+    portENTER_CRITICAL(&power_mux);
+    int64_t idle_us = now - last_activity_us;
+    portEXIT_CRITICAL(&power_mux);
+
+    if (idle_us < (int64_t)POWER_IDLE_TIMEOUT_S * 1000000) {
+        if (state != POWER_ACTIVE) {
+            power_enter(POWER_ACTIVE);
+        }
+        return 0;
+    }
+    if (state == POWER_ACTIVE) {
+        power_enter(POWER_IDLE);
+    }
+    int64_t to_sleep_us = (int64_t)POWER_SLEEP_TIMEOUT_S * 1000000 - idle_us;
+    if (to_sleep_us > 0) {
+        return pdMS_TO_TICKS(to_sleep_us / 1000) + 1;
+    }
+    if (state == POWER_IDLE) {
+        power_enter(POWER_SLEEP);
+    }
+    return portMAX_DELAY;
+}
+
+power_state_t power_get_state(void) {
+    return state;
+}
+
+/* @brief Totals including the time spent in the current state so far */
+void power_get_stats(power_stats_t *out) {
+    int64_t now = esp_timer_get_time();
+    uint32_t switches = total_switches();
+
+    portENTER_CRITICAL(&power_mux);
+    *out = stats;
+    out->time_us[state] += now - state_since_us;
+    out->switches[state] += switches - state_since_switches;
+    portEXIT_CRITICAL(&power_mux);
+}
+
+/* @brief Estimated current draw of a state (mA), see the POWER_EST_* model */
+static float power_estimate_ma(power_state_t s, float switches_per_s) {
+    float awake = switches_per_s * POWER_EST_WAKE_US / 1e6f;
+    if (awake > 1.0f) {
+        awake = 1.0f;
+    }
+    switch (s) {
+    case POWER_ACTIVE:
+        return POWER_EST_PANEL_MA + POWER_EST_BACKLIGHT_MA * POWER_ACTIVE_BRIGHTNESS / 100.0f + POWER_EST_CPU_MAX_MA;
+    case POWER_IDLE:
+        return POWER_EST_PANEL_MA + POWER_EST_BACKLIGHT_MA * POWER_IDLE_BRIGHTNESS / 100.0f + POWER_EST_CPU_MIN_MA;
+    default:
+        return POWER_EST_PANEL_MA + awake * POWER_EST_CPU_MIN_MA + (1.0f - awake) * POWER_EST_SLEEP_MA;
+    }
+}
+
+/* @brief Console: power */
+static void power_command(int argc, char **argv) {
+    power_stats_t s;
+    uint64_t total_us = 0;
+    float charge = 0;
+
+    power_get_stats(&s);
+    for (int i = 0; i < POWER_STATES; i++) {
+        total_us += s.time_us[i];
+    }
+    printf("state: %s, idle timeout %d s, sleep timeout %d s\n", power_state_names[state],
+           POWER_IDLE_TIMEOUT_S, POWER_SLEEP_TIMEOUT_S);
+    printf("%-7s %10s %6s %8s %12s %8s\n", "state", "time s", "share", "entries", "wakeups/min", "est mA");
+    for (int i = 0; i < POWER_STATES; i++) {
+        float seconds = s.time_us[i] / 1e6f;
+        float per_s = seconds > 0 ? s.switches[i] / seconds : 0;
+        float ma = power_estimate_ma(i, per_s);
+        charge += ma * seconds;
+        printf("%-7s %10.1f %5.1f%% %8lu %12.0f %8.2f\n", power_state_names[i], seconds,
+               total_us ? 100.0f * s.time_us[i] / total_us : 0.0f, (unsigned long)s.entries[i],
+               per_s * 60, ma);
+    }
+    printf("average est %.2f mA\n", total_us ? charge / (total_us / 1e6f) : 0.0f);
+}
+
+/* @brief Configures DFS and automatic light sleep, starts in ACTIVE with both locks held */
+void power_init(void) {
+    last_activity_us = state_since_us = esp_timer_get_time();
+    state_since_switches = total_switches();
+    stats.entries[POWER_ACTIVE] = 1;
+
+    esp_pm_config_t pm = {
+        .max_freq_mhz = POWER_MAX_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "No power management (%s), check CONFIG_PM_ENABLE", esp_err_to_name(err));
+    } else {
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "power_active", &cpu_lock);
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "power_awake", &awake_lock);
+        pm_lock(cpu_lock, true);
+        pm_lock(awake_lock, true);
+    }
+    esp_sleep_enable_gpio_wakeup();
+    serial_link_register_command("power", "Time, wakeups/min and estimated mA per power state", power_command);
+}
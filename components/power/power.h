@@ -0,0 +1,70 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Idle power management
+ *
+ *   ACTIVE  keys scanned every 50 ms, LVGL running, CPU at POWER_MAX_FREQ_MHZ
+ *   IDLE    no input for POWER_IDLE_TIMEOUT_S and no running game: LVGL timers
+ *           suspended (lvgl_task blocks), key scan waits for a key/touch
+ *           interrupt, CPU scaled down to POWER_MIN_FREQ_MHZ, backlight dimmed
+ *   SLEEP   POWER_SLEEP_TIMEOUT_S without input: backlight off and automatic
+ *           light sleep (the LEDC backlight PWM stops in light sleep, so it is
+ *           only allowed once the duty is 0)
+ *
+ * Any key, touch or game event goes back to ACTIVE; the wake interrupt
+ * notifies key_scan_task, which owns the state machine (power_update()), and
+ * the first frame is rendered on the next lvgl_task pass.
+ *
+ * "power" on the console prints time, wakeups per minute (context switches,
+ * profiler_switches) and an estimated current draw per state, from the
+ * POWER_EST_* figures below (ESP32-S3 datasheet typicals, panel guessed).
+ *
+ * UARTs that keep running through IDLE (telemetry, replication) are clocked
+ * from XTAL, not APB, so frequency scaling leaves their baud rate alone.
+ *
+ * Needs CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE (sdkconfig.defaults).
+ */
+
+#define POWER_IDLE_TIMEOUT_S    30
+#define POWER_SLEEP_TIMEOUT_S   300
+#define POWER_ACTIVE_BRIGHTNESS 50      // Backlight %, as gpio_setup() sets it
+#define POWER_IDLE_BRIGHTNESS   10
+#define POWER_MAX_FREQ_MHZ      240
+#define POWER_MIN_FREQ_MHZ      40
+
+/* Current draw model (mA) */
+#define POWER_EST_CPU_MAX_MA    50      // 240 MHz, both cores awake
+#define POWER_EST_CPU_MIN_MA    20      // 40 MHz
+#define POWER_EST_SLEEP_MA      0.25f   // Light sleep
+#define POWER_EST_BACKLIGHT_MA  60      // At 100 %
+#define POWER_EST_PANEL_MA      5       // ST7796 logic, touch controller
+#define POWER_EST_WAKE_US       500     // Awake time per context switch while idle
+
+typedef enum {
+    POWER_ACTIVE = 0,
+    POWER_IDLE,
+    POWER_SLEEP,
+    POWER_STATES
+} power_state_t;
+
+typedef struct {
+    uint64_t time_us[POWER_STATES];
+    uint32_t switches[POWER_STATES];    // Context switches while in the state
+    uint32_t entries[POWER_STATES];
+} power_stats_t;
+
+extern const char *const power_state_names[POWER_STATES];
+
+void power_init(void);
+void power_set_owner(TaskHandle_t task);
+void power_activity(void);
+TickType_t power_update(void);
+power_state_t power_get_state(void);
+void power_listener(uint8_t event, uint8_t arg);
+void power_get_stats(power_stats_t *out);
+
+#endif
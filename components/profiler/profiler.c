@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "../serial_link/serial_link.h"
+#include "profiler.h"
+
+#define TAG "PROFILER"
+
+volatile uint32_t profiler_switches[2] = { 0 };
+
+typedef struct {
+    UBaseType_t number;
+    uint32_t runtime;
+} profiler_prev_t;
+
+/* Previous report, for the deltas */
+static profiler_prev_t prev[PROFILER_MAX_TASKS];
+static int prev_count = 0;
+static int64_t prev_us = 0;
+static uint32_t prev_switches[2] = { 0 };
+
+static TaskStatus_t tasks[PROFILER_MAX_TASKS];
+static profiler_jitter_t jitter;
+static portMUX_TYPE jitter_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t dump_period_s = PROFILER_DUMP_PERIOD_S;
+static volatile bool dump_requested = false;
+static TaskHandle_t profiler_handle = NULL;
+
+/* @brief Records one wakeup of time_tracker_task
+ * @param deadline_us Time it should have run
+ * @param now_us Time it ran
+ */
+void profiler_record_wakeup(int64_t deadline_us, int64_t now_us) {
+    int32_t late = (int32_t)(now_us - deadline_us);
+    uint32_t abs_late = late < 0 ? (uint32_t)-late : (uint32_t)late;
+    uint32_t bucket = abs_late ? 32 - __builtin_clz(abs_late) : 0;
+    if (bucket >= PROFILER_JITTER_BUCKETS) {
+        bucket = PROFILER_JITTER_BUCKETS - 1;
+    }
+
+    portENTER_CRITICAL(&jitter_mux);
+    jitter.count++;
+    jitter.abs_total_us += abs_late;
+    jitter.buckets[bucket]++;
+    if (late > jitter.late_max_us) {
+        jitter.late_max_us = late;
+    }
+    if (-late > jitter.early_max_us) {
+        jitter.early_max_us = -late;
+    }
+    portEXIT_CRITICAL(&jitter_mux);
+}
+
+void profiler_get_jitter(profiler_jitter_t *out) {
+    portENTER_CRITICAL(&jitter_mux);
+    *out = jitter;
+    portEXIT_CRITICAL(&jitter_mux);
+}
+
+static uint32_t profiler_prev_runtime(UBaseType_t number, bool *found) {
+    for (int i = 0; i < prev_count; i++) {
+        if (prev[i].number == number) {
+            *found = true;
+            return prev[i].runtime;
+        }
+    }
+    *found = false;
+    return 0;
+}
+
+static int cmp_task(const void *a, const void *b) {
+    const TaskStatus_t *x = a, *y = b;
+    if (x->xCoreID != y->xCoreID) {
+        return x->xCoreID < y->xCoreID ? -1 : 1;
+    }
+    return x->xTaskNumber < y->xTaskNumber ? -1 : 1;
+}
+
+static void profiler_dump_heap(const char *name, uint32_t caps) {
+    printf("heap %-8s free %7u  min %7u  largest %7u\n", name,
+           (unsigned)heap_caps_get_free_size(caps),
+           (unsigned)heap_caps_get_minimum_free_size(caps),
+           (unsigned)heap_caps_get_largest_free_block(caps));
+}
+
+/* @brief Prints the profile since the previous dump and starts a new interval, profiler_task only */
+void profiler_dump(void) {
+    int64_t now = esp_timer_get_time();
+    uint32_t total;
+    UBaseType_t count = uxTaskGetSystemState(tasks, PROFILER_MAX_TASKS, &total);
+    uint32_t interval_us = (uint32_t)(now - prev_us);
+    uint32_t idle_us[2] = { interval_us, interval_us };
+
+    if (count == 0) {
+        printf("more than %d tasks, raise PROFILER_MAX_TASKS\n", PROFILER_MAX_TASKS);
+        return;
+    }
+    qsort(tasks, count, sizeof(tasks[0]), cmp_task);
+
+    printf("--- %lu ms interval ---\n", (unsigned long)(interval_us / 1000));
+    printf("%-18s core prio   cpu%%  stack_free\n", "task");
+    for (UBaseType_t i = 0; i < count; i++) {
+        TaskStatus_t *t = &tasks[i];
+        bool found;
+        uint32_t before = profiler_prev_runtime(t->xTaskNumber, &found);
+        uint32_t delta = t->ulRunTimeCounter - before;  // Wraps once per ~71 min, unsigned math covers it
+        uint32_t permille = interval_us ? (uint32_t)((uint64_t)delta * 1000 / interval_us) : 0;
+        int core = t->xCoreID;
+
+        if (!found) {
+            permille = 0;   // Created during the interval
+        }
+        if (strncmp(t->pcTaskName, "IDLE", 4) == 0 && core >= 0 && core < 2 && found) {
+            idle_us[core] = delta;
+        }
+        printf("%-18s %4s %4u %4lu.%lu  %10lu\n", t->pcTaskName,
+               core == 0 ? "0" : core == 1 ? "1" : "-", (unsigned)t->uxCurrentPriority,
+               (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+               (unsigned long)t->usStackHighWaterMark);
+    }
+
+    for (int core = 0; core < 2; core++) {
+        uint32_t switches = profiler_switches[core];
+        uint32_t load = interval_us && idle_us[core] < interval_us ?
+            (uint32_t)((uint64_t)(interval_us - idle_us[core]) * 1000 / interval_us) : 0;
+        uint32_t per_s = interval_us ?
+            (uint32_t)((uint64_t)(switches - prev_switches[core]) * 1000000 / interval_us) : 0;
+        printf("core %d load %3lu.%lu%%  %lu switches/s\n", core,
+               (unsigned long)(load / 10), (unsigned long)(load % 10), (unsigned long)per_s);
+        prev_switches[core] = switches;
+    }
+
+    profiler_jitter_t j;
+    profiler_get_jitter(&j);
+    printf("time_tracker wakeups %lu  late max %ld us  early max %ld us  avg |jitter| %lu us\n",
+           (unsigned long)j.count, (long)j.late_max_us, (long)j.early_max_us,
+           (unsigned long)(j.count ? j.abs_total_us / j.count : 0));
+    for (int b = 0; b < PROFILER_JITTER_BUCKETS; b++) {
+        if (j.buckets[b]) {
+            printf("    <%-8lu %lu\n", (unsigned long)(1ul << b), (unsigned long)j.buckets[b]);
+        }
+    }
+
+    profiler_dump_heap("internal", MALLOC_CAP_INTERNAL);
+    profiler_dump_heap("dma", MALLOC_CAP_DMA);
+
+    prev_count = count;
+    for (UBaseType_t i = 0; i < count; i++) {
+        prev[i].number = tasks[i].xTaskNumber;
+        prev[i].runtime = tasks[i].ulRunTimeCounter;
+    }
+    prev_us = now;
+}
+
+/* @brief Console: prof [reset | every <s> | off] */
+static void profiler_command(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        portENTER_CRITICAL(&jitter_mux);
+        memset(&jitter, 0, sizeof(jitter));
+        portEXIT_CRITICAL(&jitter_mux);
+        printf("jitter reset\n");
+        return;
+    }
+    if (argc > 2 && strcmp(argv[1], "every") == 0) {
+        dump_period_s = (uint32_t)atoi(argv[2]);
+    } else if (argc > 1 && strcmp(argv[1], "off") == 0) {
+        dump_period_s = 0;
+    } else {
+        dump_requested = true;
+    }
+    // Reports are only made on profiler_task, it owns the previous snapshot
+    if (profiler_handle != NULL) {
+        xTaskNotifyGive(profiler_handle);
+    }
+}
+
+void profiler_init(void) {
+    prev_us = esp_timer_get_time();
+    serial_link_register_command("prof", "Task CPU/stack/jitter/heap profile, prof every <s> | off | reset",
+                                 profiler_command);
+}
+
+/* @brief Makes the requested and periodic dumps
+ * @param pvParameters N/A
+ */
+void profiler_task(void *pvParameters) {
+    profiler_handle = xTaskGetCurrentTaskHandle();
+    while (1) {
+        uint32_t period = dump_period_s;
+        TickType_t wait = period ? pdMS_TO_TICKS(period * 1000) : portMAX_DELAY;
+        if (ulTaskNotifyTake(pdTRUE, wait) == 0 || dump_requested) {
+            dump_requested = false;
+            profiler_dump();
+        }
+    }
+}
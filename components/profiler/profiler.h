@@ -0,0 +1,43 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+/* Task-level profiling
+ *
+ * "prof" on the console prints, since the previous report:
+ *   - CPU % of every task and the load of each core (100% - its IDLE task)
+ *   - stack high-water mark (fewest free bytes seen) of every task
+ *   - context switches per second per core
+ *   - time_tracker_task wakeup jitter against its deadlines
+ *   - free / minimum free / largest block of internal and DMA-capable heap
+ * "prof every <s>" also dumps it periodically, "prof off" stops that.
+ *
+ * Needs CONFIG_FREERTOS_USE_TRACE_FACILITY, CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+ * and CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID (sdkconfig.defaults). Context
+ * switches are counted by the traceTASK_SWITCHED_IN hook of profiler_trace.h,
+ * which the top-level CMakeLists.txt includes ahead of every source.
+ */
+
+#define PROFILER_MAX_TASKS      24
+#define PROFILER_JITTER_BUCKETS 16      // log2 of |lateness| in us
+#define PROFILER_DUMP_PERIOD_S  0       // Periodic dump at boot, 0 = off
+
+typedef struct {
+    uint32_t count;
+    int32_t late_max_us;        // Woke after the deadline
+    int32_t early_max_us;       // Woke before it (tick rounding)
+    uint64_t abs_total_us;
+    uint32_t buckets[PROFILER_JITTER_BUCKETS];
+} profiler_jitter_t;
+
+/* Written by the traceTASK_SWITCHED_IN hook, see profiler_trace.h */
+extern volatile uint32_t profiler_switches[2];
+
+void profiler_init(void);
+void profiler_record_wakeup(int64_t deadline_us, int64_t now_us);
+void profiler_get_jitter(profiler_jitter_t *out);
+void profiler_dump(void);
+void profiler_task(void *pvParameters);
+
+#endif
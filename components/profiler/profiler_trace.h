@@ -0,0 +1,20 @@
+#ifndef PROFILER_TRACE_H
+#define PROFILER_TRACE_H
+
+/* FreeRTOS trace hook behind the per-core context switch counter
+ *
+ * Included ahead of every source by the top-level CMakeLists.txt (-include),
+ * so FreeRTOS's tasks.c finds traceTASK_SWITCHED_IN() already defined and
+ * skips its empty default. Only macros and a declaration, nothing that
+ * needs FreeRTOS itself: xPortGetCoreID() is resolved where the hook expands.
+ */
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+
+extern volatile uint32_t profiler_switches[2];
+
+#define traceTASK_SWITCHED_IN() do { profiler_switches[xPortGetCoreID()]++; } while (0)
+#endif
+
+#endif
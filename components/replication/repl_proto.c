@@ -0,0 +1,276 @@
+#include <string.h>
+#include "repl_proto.h"
+
+enum {
+    ST_SYNC,
+    ST_TYPE,
+    ST_SEQ,
+    ST_LEN,
+    ST_PAYLOAD,
+    ST_CRC,
+};
+
+static uint8_t crc8_update(uint8_t crc, uint8_t byte) {
+    crc ^= byte;
+    for (int b = 0; b < 8; b++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+void repl_state_from_game(const GameState *in, repl_state_t *out) {
+    out->game_seconds = in->game_minutes * 60 + in->game_seconds;
+    out->flags = (in->all_timers_active ? REPL_FLAG_MATCH : 0) |
+                 (in->game_timer_active ? REPL_FLAG_RUNNING : 0);
+    for (int i = 0; i < HERO_COUNT; i++) {
+        out->heroes[i] = in->heroes[i].active ?
+                         in->heroes[i].minutes * 60 + in->heroes[i].seconds : REPL_HERO_IDLE;
+    }
+}
+
+void repl_state_to_game(const repl_state_t *in, GameState *out) {
+    out->game_minutes = in->game_seconds / 60;
+    out->game_seconds = in->game_seconds % 60;
+    out->all_timers_active = (in->flags & REPL_FLAG_MATCH) ? 1 : 0;
+    out->game_timer_active = (in->flags & REPL_FLAG_RUNNING) ? 1 : 0;
+    for (int i = 0; i < HERO_COUNT; i++) {
+        bool active = in->heroes[i] != REPL_HERO_IDLE;
+        out->heroes[i].minutes = active ? in->heroes[i] / 60 : 0;
+        out->heroes[i].seconds = active ? in->heroes[i] % 60 : 0;
+        out->heroes[i].active = active;
+    }
+}
+
+/* @brief One game second, same rules as advance_hero_timers() in time_tracker.c */
+static void state_tick(repl_state_t *s) {
+    s->game_seconds++;
+    for (int i = 0; i < HERO_COUNT; i++) {
+        if (s->heroes[i] == 0) {
+            s->heroes[i] = REPL_HERO_IDLE;  // Expired
+        } else if (s->heroes[i] != REPL_HERO_IDLE) {
+            s->heroes[i]--;
+        }
+    }
+}
+
+/* @brief Wraps a payload into a frame
+ * @param out At least REPL_FRAME_MAX bytes
+ * @return Frame length
+ */
+size_t repl_encode_control(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t len, uint8_t *out) {
+    uint8_t crc = 0;
+    size_t n = 0;
+
+    out[n++] = REPL_SYNC;
+    out[n++] = type;
+    out[n++] = seq;
+    out[n++] = len;
+    if (len > 0) {
+        memcpy(&out[n], payload, len);
+        n += len;
+    }
+    for (size_t i = 1; i < n; i++) {
+        crc = crc8_update(crc, out[i]);
+    }
+    out[n++] = crc;
+    return n;
+}
+
+void repl_encoder_reset(repl_encoder_t *enc) {
+    memset(enc, 0, sizeof(*enc));
+}
+
+size_t repl_encode_keyframe(repl_encoder_t *enc, const repl_state_t *state, uint8_t *out) {
+    uint8_t payload[4 + 1 + 2 * HERO_COUNT];
+    size_t n = 0;
+
+    payload[n++] = state->game_seconds & 0xFF;
+    payload[n++] = (state->game_seconds >> 8) & 0xFF;
+    payload[n++] = (state->game_seconds >> 16) & 0xFF;
+    payload[n++] = (state->game_seconds >> 24) & 0xFF;
+    payload[n++] = state->flags;
+    for (int i = 0; i < HERO_COUNT; i++) {
+        payload[n++] = state->heroes[i] & 0xFF;
+        payload[n++] = state->heroes[i] >> 8;
+    }
+    enc->sent = *state;
+    return repl_encode_control(REPL_KEYFRAME, enc->seq++, payload, n, out);
+}
+
+/* @brief Encodes what changed since the last frame
+ * @return Frame length, 0 if nothing changed
+ */
+size_t repl_encode_delta(repl_encoder_t *enc, const repl_state_t *state, uint8_t *out) {
+    uint8_t payload[REPL_MAX_PAYLOAD];
+    repl_state_t base = enc->sent;
+    uint8_t mask = 0;
+    size_t n = 1;
+
+    // The common case, a game second elapsed, costs a single bit
+    if (state->game_seconds == base.game_seconds + 1) {
+        state_tick(&base);
+        mask |= REPL_DELTA_TICK;
+    }
+    if (state->game_seconds != base.game_seconds) {
+        int32_t diff = (int32_t)(state->game_seconds - base.game_seconds);
+        uint32_t zz = ((uint32_t)diff << 1) ^ (uint32_t)(diff >> 31);
+        mask |= REPL_DELTA_CLOCK;
+        do {
+            payload[n++] = (zz & 0x7F) | (zz > 0x7F ? 0x80 : 0);
+            zz >>= 7;
+        } while (zz);
+    }
+    if (state->flags != base.flags) {
+        mask |= REPL_DELTA_FLAGS;
+        payload[n++] = state->flags;
+    }
+    for (int i = 0; i < HERO_COUNT; i++) {
+        if (state->heroes[i] != base.heroes[i]) {
+            mask |= REPL_DELTA_HERO0 << i;
+            payload[n++] = state->heroes[i] & 0xFF;
+            payload[n++] = state->heroes[i] >> 8;
+        }
+    }
+    if (mask == 0) {
+        return 0;
+    }
+    payload[0] = mask;
+    enc->sent = *state;
+    return repl_encode_control(REPL_DELTA, enc->seq++, payload, n, out);
+}
+
+void repl_parser_reset(repl_parser_t *p) {
+    memset(p, 0, sizeof(*p));
+}
+
+/* @brief Feeds one received byte
+ * @param out Filled in when a frame with a good CRC is complete
+ * @return true if `out` holds a new frame
+ */
+bool repl_parser_feed(repl_parser_t *p, uint8_t byte, repl_frame_t *out) {
+    switch (p->state) {
+    case ST_SYNC:
+        if (byte == REPL_SYNC) {
+            p->crc = 0;
+            p->state = ST_TYPE;
+        }
+        return false;
+    case ST_TYPE:
+        p->frame.type = byte;
+        p->state = ST_SEQ;
+        break;
+    case ST_SEQ:
+        p->frame.seq = byte;
+        p->state = ST_LEN;
+        break;
+    case ST_LEN:
+        if (byte > REPL_MAX_PAYLOAD) {
+            p->state = ST_SYNC;  // Can't be a frame, hunt for the next sync byte
+            return false;
+        }
+        p->frame.len = byte;
+        p->pos = 0;
+        p->state = byte ? ST_PAYLOAD : ST_CRC;
+        break;
+    case ST_PAYLOAD:
+        p->frame.payload[p->pos++] = byte;
+        if (p->pos == p->frame.len) {
+            p->state = ST_CRC;
+        }
+        break;
+    case ST_CRC:
+        p->state = ST_SYNC;
+        if (byte != p->crc) {
+            p->crc_errors++;
+            return false;
+        }
+        *out = p->frame;
+        return true;
+    }
+    p->crc = crc8_update(p->crc, byte);
+    return false;
+}
+
+void repl_receiver_reset(repl_receiver_t *rx) {
+    memset(rx, 0, sizeof(*rx));
+}
+
+static bool apply_delta(repl_state_t *s, const repl_frame_t *frame) {
+    const uint8_t *p = frame->payload;
+    const uint8_t *end = p + frame->len;
+    repl_state_t next = *s;
+
+    if (p == end) {
+        return false;
+    }
+    uint8_t mask = *p++;
+    if (mask & REPL_DELTA_TICK) {
+        state_tick(&next);
+    }
+    if (mask & REPL_DELTA_CLOCK) {
+        uint32_t zz = 0;
+        int shift = 0;
+        do {
+            if (p == end || shift > 28) {
+                return false;
+            }
+            zz |= (uint32_t)(*p & 0x7F) << shift;
+            shift += 7;
+        } while (*p++ & 0x80);
+        next.game_seconds += (int32_t)((zz >> 1) ^ -(zz & 1));
+    }
+    if (mask & REPL_DELTA_FLAGS) {
+        if (p == end) {
+            return false;
+        }
+        next.flags = *p++;
+    }
+    for (int i = 0; i < HERO_COUNT; i++) {
+        if (mask & (REPL_DELTA_HERO0 << i)) {
+            if (end - p < 2) {
+                return false;
+            }
+            next.heroes[i] = p[0] | (p[1] << 8);
+            p += 2;
+        }
+    }
+    if (p != end) {
+        return false;
+    }
+    *s = next;
+    return true;
+}
+
+/* @brief Applies a state frame (keyframe or delta) on a secondary
+ * @param frame Received frame, other types are ignored
+ */
+repl_result_t repl_receiver_apply(repl_receiver_t *rx, const repl_frame_t *frame) {
+    if (frame->type == REPL_KEYFRAME) {
+        const uint8_t *p = frame->payload;
+        if (frame->len != 4 + 1 + 2 * HERO_COUNT) {
+            return REPL_IGNORED;
+        }
+        rx->state.game_seconds = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        rx->state.flags = p[4];
+        for (int i = 0; i < HERO_COUNT; i++) {
+            rx->state.heroes[i] = p[5 + 2 * i] | (p[6 + 2 * i] << 8);
+        }
+        rx->expected_seq = frame->seq + 1;
+        rx->synced = true;
+        rx->ticked = false;
+        rx->keyframes++;
+        return REPL_APPLIED;
+    }
+    if (frame->type != REPL_DELTA || !rx->synced) {
+        return REPL_IGNORED;
+    }
+    if (frame->seq != rx->expected_seq || !apply_delta(&rx->state, frame)) {
+        rx->synced = false;
+        rx->gaps++;
+        return REPL_GAP;
+    }
+    rx->expected_seq++;
+    rx->ticked = frame->len == 1 && frame->payload[0] == REPL_DELTA_TICK;
+    rx->deltas++;
+    return REPL_APPLIED;
+}
@@ -0,0 +1,112 @@
+#ifndef REPL_PROTO_H
+#define REPL_PROTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../../main/time_tracker.h"
+
+/* Wire protocol for replicating the game state between units
+ *
+ * Frame: [0xA5][type][seq][len][payload 0..REPL_MAX_PAYLOAD][crc8]
+ * The CRC-8 (poly 0x07) covers type, seq, len and the payload.
+ *
+ * Primary -> secondary, seq increments per state frame:
+ *   KEYFRAME  u32 game seconds, u8 flags, 5 x u16 hero seconds (0xFFFF idle)
+ *   DELTA     u8 mask, then the fields whose bit is set, in bit order:
+ *               REPL_DELTA_TICK   no data, one game second elapsed (clock +1,
+ *                                 running heroes -1), applied before the rest
+ *               REPL_DELTA_CLOCK  zigzag varint, change of the game seconds
+ *               REPL_DELTA_FLAGS  u8
+ *               REPL_DELTA_HERO0+ u16 hero seconds, one per set bit
+ *   ACK       no payload, seq = input seq that has been applied
+ * Secondary -> primary:
+ *   INPUT     u8 input (key code 0-9 or TT_INPUT_UNDO), seq = input seq
+ *   RESYNC    no payload, asks for a keyframe after a gap
+ *
+ * A secondary that sees a state seq other than the expected one drops
+ * deltas until the next keyframe.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/replication).
+ */
+
+#define REPL_SYNC           0xA5
+#define REPL_MAX_PAYLOAD    16
+#define REPL_FRAME_MAX      (REPL_MAX_PAYLOAD + 5)
+#define REPL_HERO_IDLE      0xFFFF
+
+#define REPL_FLAG_MATCH     (1 << 0)    // all_timers_active
+#define REPL_FLAG_RUNNING   (1 << 1)    // game_timer_active
+
+#define REPL_DELTA_TICK     (1 << 0)
+#define REPL_DELTA_CLOCK    (1 << 1)
+#define REPL_DELTA_FLAGS    (1 << 2)
+#define REPL_DELTA_HERO0    (1 << 3)    // Heroes 0-4 use bits 3-7
+
+typedef enum {
+    REPL_KEYFRAME = 1,
+    REPL_DELTA,
+    REPL_ACK,
+    REPL_INPUT,
+    REPL_RESYNC,
+} repl_type_t;
+
+/* Compact copy of the replicated state */
+typedef struct {
+    uint32_t game_seconds;
+    uint8_t flags;                  // REPL_FLAG_*
+    uint16_t heroes[HERO_COUNT];    // Seconds left, REPL_HERO_IDLE if not running
+} repl_state_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t len;
+    uint8_t payload[REPL_MAX_PAYLOAD];
+} repl_frame_t;
+
+typedef struct {
+    repl_state_t sent;      // What the secondaries hold after the last frame
+    uint8_t seq;            // Seq of the next state frame
+} repl_encoder_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t crc;
+    uint8_t pos;
+    repl_frame_t frame;
+    uint32_t crc_errors;
+} repl_parser_t;
+
+typedef enum {
+    REPL_APPLIED,           // State changed
+    REPL_IGNORED,           // Waiting for a keyframe
+    REPL_GAP,               // Seq skipped or bad delta, now waiting for a keyframe
+} repl_result_t;
+
+typedef struct {
+    repl_state_t state;
+    uint8_t expected_seq;
+    bool synced;
+    bool ticked;            // Last applied delta was a plain tick
+    uint32_t keyframes;
+    uint32_t deltas;
+    uint32_t gaps;
+} repl_receiver_t;
+
+void repl_state_from_game(const GameState *in, repl_state_t *out);
+void repl_state_to_game(const repl_state_t *in, GameState *out);
+
+void repl_encoder_reset(repl_encoder_t *enc);
+size_t repl_encode_keyframe(repl_encoder_t *enc, const repl_state_t *state, uint8_t *out);
+size_t repl_encode_delta(repl_encoder_t *enc, const repl_state_t *state, uint8_t *out);
+size_t repl_encode_control(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t len, uint8_t *out);
+
+void repl_parser_reset(repl_parser_t *p);
+bool repl_parser_feed(repl_parser_t *p, uint8_t byte, repl_frame_t *out);
+
+void repl_receiver_reset(repl_receiver_t *rx);
+repl_result_t repl_receiver_apply(repl_receiver_t *rx, const repl_frame_t *frame);
+
+#endif
@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/uart.h"
+#include "nvs.h"
+#include "replication.h"
+
+#include "../serial_link/serial_link.h"
+#include "../../main/history.h"
+
+#define TAG "REPLICATION"
+
+#define REPLICATION_UART_BUF    1024
+#define REPLICATION_INPUT_SLOTS 8       // Inputs in flight whose send time is kept for the RTT
+
+static replication_role_t role = REPLICATION_OFF;
+static replication_stats_t stats;
+
+static TaskHandle_t tx_task_handle = NULL;
+static repl_encoder_t encoder;
+static volatile bool resync_requested = false;
+static volatile int pending_ack = -1;    // Primary: input seq to echo after the next delta
+
+static repl_receiver_t receiver;
+static volatile int64_t last_frame_us = 0;
+static uint8_t next_input_seq;
+static int64_t input_sent_us[REPLICATION_INPUT_SLOTS];
+
+static void replication_send(const uint8_t *frame, size_t len) {
+    int written = uart_write_bytes(REPLICATION_UART_NUM, (const char *)frame, len);
+    if (written > 0) {
+        stats.bytes_sent += written;
+    }
+}
+
+/* @brief True on a secondary that currently hears the primary */
+static bool link_up(void) {
+    return role == REPLICATION_SECONDARY && receiver.synced &&
+           esp_timer_get_time() - last_frame_us < REPLICATION_LINK_TIMEOUT_MS * 1000LL;
+}
+
+/* @brief Secondary: sends key presses to the primary instead of applying them
+ * @param input Key code or TT_INPUT_UNDO
+ * @return false while the link is down, so the unit keeps working on its own
+ */
+static bool replication_forward_input(uint8_t input) {
+    if (!link_up()) {
+        return false;
+    }
+    uint8_t frame[REPL_FRAME_MAX];
+    uint8_t seq = next_input_seq++;
+    input_sent_us[seq % REPLICATION_INPUT_SLOTS] = esp_timer_get_time();
+    replication_send(frame, repl_encode_control(REPL_INPUT, seq, &input, 1, frame));
+    stats.inputs++;
+    return true;
+}
+
+static const char *const role_names[] = { "off", "primary", "secondary" };
+
+/* @brief Console: repl [off|primary|secondary] */
+static void replication_command(int argc, char **argv) {
+    if (argc == 2) {
+        for (int r = REPLICATION_OFF; r <= REPLICATION_SECONDARY; r++) {
+            if (strcmp(argv[1], role_names[r]) == 0) {
+                replication_set_role(r);
+                printf("Role %s from the next boot\n", role_names[r]);
+                return;
+            }
+        }
+        printf("usage: repl [off|primary|secondary]\n");
+        return;
+    }
+    replication_stats_t s;
+    replication_get_stats(&s);
+    printf("role %s, link %s\n", role_names[role], link_up() ? "up" : "down");
+    printf("events %lu, keyframes %lu, deltas %lu, sent %lu B, received %lu B\n",
+           (unsigned long)s.events, (unsigned long)s.keyframes, (unsigned long)s.deltas,
+           (unsigned long)s.bytes_sent, (unsigned long)s.bytes_received);
+    printf("crc errors %lu, gaps %lu, resyncs %lu, inputs %lu, rtt %lu us (max %lu us)\n",
+           (unsigned long)s.crc_errors, (unsigned long)s.gaps, (unsigned long)s.resyncs,
+           (unsigned long)s.inputs, (unsigned long)s.rtt_us_last, (unsigned long)s.rtt_us_max);
+}
+
+/* @brief Loads the role from NVS and installs the UART driver, registers "repl"
+ * @param N/A
+ */
+void replication_init(void) {
+    serial_link_register_command("repl", "Replication role and link stats, repl [off|primary|secondary]",
+                                 replication_command);
+    role = REPLICATION_DEFAULT_ROLE;
+    nvs_handle_t handle;
+    if (nvs_open(REPLICATION_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        uint8_t stored;
+        if (nvs_get_u8(handle, REPLICATION_NVS_KEY, &stored) == ESP_OK && stored <= REPLICATION_SECONDARY) {
+            role = stored;
+        }
+        nvs_close(handle);
+    }
+    if (role == REPLICATION_OFF) {
+        ESP_LOGI(TAG, "Replication off");
+        return;
+    }
+
+    uart_config_t uart_config = {
+        .baud_rate = REPLICATION_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_XTAL,     // APB follows the CPU down in power IDLE, the baud rate would too
+    };
+    ESP_ERROR_CHECK(uart_driver_install(REPLICATION_UART_NUM, REPLICATION_UART_BUF, REPLICATION_UART_BUF, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(REPLICATION_UART_NUM, &uart_config));
+    ESP_ERROR_CHECK(uart_set_pin(REPLICATION_UART_NUM, REPLICATION_TX_PIN, REPLICATION_RX_PIN,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+
+    repl_encoder_reset(&encoder);
+    repl_receiver_reset(&receiver);
+    if (role == REPLICATION_SECONDARY) {
+        time_tracker_set_input_hook(replication_forward_input);
+    }
+    ESP_LOGI(TAG, "%s on UART%d TX GPIO%d RX GPIO%d @ %d baud",
+             role == REPLICATION_PRIMARY ? "Primary" : "Secondary",
+             REPLICATION_UART_NUM, REPLICATION_TX_PIN, REPLICATION_RX_PIN, REPLICATION_BAUD);
+}
+
+replication_role_t replication_get_role(void) {
+    return role;
+}
+
+/* @brief Stores the role in NVS, used from the next boot
+ * @param role REPLICATION_OFF / PRIMARY / SECONDARY
+ */
+void replication_set_role(replication_role_t new_role) {
+    nvs_handle_t handle;
+    if (nvs_open(REPLICATION_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_u8(handle, REPLICATION_NVS_KEY, new_role) == ESP_OK) {
+        nvs_commit(handle);
+    }
+    nvs_close(handle);
+}
+
+/* @brief True if the game clock is driven by the primary, the local tick must not run */
+bool replication_clock_is_remote(void) {
+    return link_up();
+}
+
+/* @brief Primary: wakes the TX task on every state change
+ * @param event tt_event_t
+ * @param arg N/A
+ */
+void replication_listener(uint8_t event, uint8_t arg) {
+    if (role != REPLICATION_PRIMARY || tx_task_handle == NULL) {
+        return;
+    }
+    stats.events++;
+    xTaskNotifyGive(tx_task_handle);
+}
+
+void replication_get_stats(replication_stats_t *out) {
+    memcpy(out, &stats, sizeof(stats));
+}
+
+/* @brief Primary: sends deltas as the state changes and a keyframe every REPLICATION_KEYFRAME_MS
+ * @param pvParameters N/A
+ */
+void replication_tx_task(void *pvParameters) {
+    uint8_t frame[REPL_FRAME_MAX];
+    int64_t last_keyframe_us = 0;
+
+    tx_task_handle = xTaskGetCurrentTaskHandle();
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(REPLICATION_KEYFRAME_MS));
+        if (role != REPLICATION_PRIMARY) {
+            continue;
+        }
+
+        GameState game;
+        repl_state_t state;
+        time_tracker_get_state(&game);
+        repl_state_from_game(&game, &state);
+
+        int64_t now = esp_timer_get_time();
+        size_t len;
+        if (resync_requested || now - last_keyframe_us >= REPLICATION_KEYFRAME_MS * 1000LL) {
+            resync_requested = false;
+            last_keyframe_us = now;
+            len = repl_encode_keyframe(&encoder, &state, frame);
+            stats.keyframes++;
+        } else {
+            len = repl_encode_delta(&encoder, &state, frame);
+            if (len > 0) {
+                stats.deltas++;
+            }
+        }
+        if (len > 0) {
+            replication_send(frame, len);
+        }
+
+        // The echo goes after the state it caused, so the secondary's RTT covers the whole loop
+        int ack = pending_ack;
+        if (ack >= 0) {
+            pending_ack = -1;
+            replication_send(frame, repl_encode_control(REPL_ACK, (uint8_t)ack, NULL, 0, frame));
+        }
+    }
+}
+
+/* @brief Primary: applies an input forwarded by a secondary */
+static void replication_apply_input(const repl_frame_t *frame) {
+    if (frame->len != 1) {
+        return;
+    }
+    uint8_t input = frame->payload[0];
+    if (input == TT_INPUT_UNDO) {
+        history_undo_last_key();
+    } else if (input < 10) {
+        process_key(input / 5, input % 5);
+    }
+    stats.inputs++;
+    pending_ack = frame->seq;
+    if (tx_task_handle != NULL) {
+        xTaskNotifyGive(tx_task_handle);
+    }
+}
+
+/* @brief Secondary: makes a received state the local one */
+static void replication_apply_state(void) {
+    GameState game;
+    repl_state_to_game(&receiver.state, &game);
+    time_tracker_lock();    // Listeners see the state together with its event
+    time_tracker_set_state(&game);
+    time_tracker_emit(receiver.ticked ? TT_EVT_TICK : TT_EVT_SYNC, 0);
+    time_tracker_unlock();
+}
+
+static void replication_handle_frame(const repl_frame_t *frame) {
+    uint8_t out[REPL_FRAME_MAX];
+
+    if (role == REPLICATION_PRIMARY) {
+        if (frame->type == REPL_INPUT) {
+            replication_apply_input(frame);
+        } else if (frame->type == REPL_RESYNC) {
+            stats.resyncs++;
+            resync_requested = true;
+            if (tx_task_handle != NULL) {
+                xTaskNotifyGive(tx_task_handle);
+            }
+        }
+        return;
+    }
+
+    if (frame->type == REPL_ACK) {
+        uint32_t rtt = esp_timer_get_time() - input_sent_us[frame->seq % REPLICATION_INPUT_SLOTS];
+        stats.rtt_us_last = rtt;
+        if (rtt > stats.rtt_us_max) {
+            stats.rtt_us_max = rtt;
+        }
+        return;
+    }
+    last_frame_us = esp_timer_get_time();
+    switch (repl_receiver_apply(&receiver, frame)) {
+    case REPL_APPLIED:
+        replication_apply_state();
+        break;
+    case REPL_GAP:
+        stats.gaps++;
+        replication_send(out, repl_encode_control(REPL_RESYNC, 0, NULL, 0, out));
+        break;
+    case REPL_IGNORED:
+        break;
+    }
+}
+
+/* @brief Reads the link and handles frames on both roles
+ * @param pvParameters N/A
+ */
+void replication_rx_task(void *pvParameters) {
+    static uint8_t rx[128];
+    repl_parser_t parser;
+    repl_frame_t frame;
+
+    repl_parser_reset(&parser);
+    while (1) {
+        int len = uart_read_bytes(REPLICATION_UART_NUM, rx, sizeof(rx), pdMS_TO_TICKS(100));
+        if (len <= 0) {
+            continue;
+        }
+        stats.bytes_received += len;
+        for (int i = 0; i < len; i++) {
+            if (repl_parser_feed(&parser, rx[i], &frame)) {
+                replication_handle_frame(&frame);
+            }
+        }
+        stats.crc_errors = parser.crc_errors;
+    }
+}
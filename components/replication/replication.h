@@ -0,0 +1,64 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "repl_proto.h"
+
+/* Game state replication between units over UART (protocol: repl_proto.h)
+ *
+ * The primary runs the game logic and sends a delta after every change and
+ * a keyframe every REPLICATION_KEYFRAME_MS. Secondaries apply them instead
+ * of ticking their own clock, and forward their key presses to the primary,
+ * which echoes an ACK once the input is applied (round-trip time).
+ * A secondary that hears nothing for REPLICATION_LINK_TIMEOUT_MS runs on
+ * its own again until the primary is back.
+ *
+ * Wiring: TX of each unit to RX of the other, common GND.
+ *
+ * Off by default. "repl primary" / "repl secondary" / "repl off" on the
+ * console stores the role in NVS for the next boot; "repl" shows the role
+ * and the link statistics.
+ */
+
+#define REPLICATION_UART_NUM        UART_NUM_2
+#define REPLICATION_TX_PIN          21      // D10 on the Nano header
+#define REPLICATION_RX_PIN          44      // D0 on the Nano header
+#define REPLICATION_BAUD            460800
+#define REPLICATION_KEYFRAME_MS     2000
+#define REPLICATION_LINK_TIMEOUT_MS 3000
+#define REPLICATION_NVS_NAMESPACE   "replication"
+#define REPLICATION_NVS_KEY         "role"
+#define REPLICATION_DEFAULT_ROLE    REPLICATION_OFF     // No UART or tasks until "repl" sets a role
+
+typedef enum {
+    REPLICATION_OFF = 0,
+    REPLICATION_PRIMARY,
+    REPLICATION_SECONDARY,
+} replication_role_t;
+
+typedef struct {
+    uint32_t events;            // State changes seen by the primary
+    uint32_t keyframes;
+    uint32_t deltas;
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+    uint32_t crc_errors;
+    uint32_t gaps;              // Secondary: seq gaps, each one answered with RESYNC
+    uint32_t resyncs;           // Primary: RESYNC requests served
+    uint32_t inputs;            // Inputs forwarded (secondary) or applied (primary)
+    uint32_t rtt_us_last;       // Secondary: input sent -> ACK received
+    uint32_t rtt_us_max;
+} replication_stats_t;
+
+void replication_init(void);
+replication_role_t replication_get_role(void);
+void replication_set_role(replication_role_t role);
+bool replication_clock_is_remote(void);
+void replication_listener(uint8_t event, uint8_t arg);
+void replication_get_stats(replication_stats_t *out);
+void replication_tx_task(void *pvParameters);
+void replication_rx_task(void *pvParameters);
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "driver/usb_serial_jtag.h"
+#include "esp_vfs_usb_serial_jtag.h"
+#include "serial_link.h"
+
+#define TAG "SERIAL_LINK"
+
+static const serial_link_frame_handler_t *frame_handler = NULL;
+static bool in_frame = false;
+
+typedef struct {
+    const char *name;
+    const char *help;
+    serial_link_command_fn_t fn;
+} serial_link_command_t;
+
+static serial_link_command_t commands[SERIAL_LINK_MAX_COMMANDS];
+static int command_count = 0;
+static char line[SERIAL_LINK_LINE_MAX];
+static size_t line_len = 0;
+static bool line_overflow = false;
+
+static void serial_link_help(int argc, char **argv);
+
+/* @brief Installs the USB Serial/JTAG driver, stdout keeps working through it
+ * @param N/A
+ */
+void serial_link_init(void) {
+    usb_serial_jtag_driver_config_t config = USB_SERIAL_JTAG_DRIVER_CONFIG_DEFAULT();
+    config.rx_buffer_size = 1024;
+    ESP_ERROR_CHECK(usb_serial_jtag_driver_install(&config));
+    esp_vfs_usb_serial_jtag_use_driver();
+    serial_link_register_command("help", "List console commands", serial_link_help);
+    ESP_LOGI(TAG, "serial_link_init completed");
+}
+
+void serial_link_set_frame_handler(const serial_link_frame_handler_t *handler) {
+    frame_handler = handler;
+}
+
+/* @brief Adds a console command, call before serial_link_task starts
+ * @param name First word of the command line
+ * @param help One line description for "help"
+ * @param fn Handler
+ * @return false if the table is full
+ */
+bool serial_link_register_command(const char *name, const char *help, serial_link_command_fn_t fn) {
+    if (command_count >= SERIAL_LINK_MAX_COMMANDS) {
+        ESP_LOGW(TAG, "No room for command %s", name);
+        return false;
+    }
+    commands[command_count++] = (serial_link_command_t){ name, help, fn };
+    return true;
+}
+
+static void serial_link_help(int argc, char **argv) {
+    for (int i = 0; i < command_count; i++) {
+        printf("%-10s %s\n", commands[i].name, commands[i].help);
+    }
+}
+
+/* @brief Splits a console line into words and runs its command */
+static void serial_link_dispatch(char *text) {
+    char *argv[SERIAL_LINK_MAX_ARGS];
+    int argc = 0;
+    char *save = NULL;
+
+    for (char *word = strtok_r(text, " \t", &save); word != NULL && argc < SERIAL_LINK_MAX_ARGS;
+         word = strtok_r(NULL, " \t", &save)) {
+        argv[argc++] = word;
+    }
+    if (argc == 0) {
+        return;
+    }
+    for (int i = 0; i < command_count; i++) {
+        if (strcmp(argv[0], commands[i].name) == 0) {
+            commands[i].fn(argc, argv);
+            return;
+        }
+    }
+    printf("Unknown command '%s', try help\n", argv[0]);
+}
+
+/* @brief Collects console bytes into lines */
+static void serial_link_console_byte(uint8_t c) {
+    if (c == '\r' || c == '\n') {
+        if (!line_overflow && line_len > 0) {
+            line[line_len] = '\0';
+            serial_link_dispatch(line);
+        }
+        line_len = 0;
+        line_overflow = false;
+    } else if (line_len < sizeof(line) - 1) {
+        line[line_len++] = (char)c;
+    } else {
+        line_overflow = true;
+    }
+}
+
+/* @brief Splits one received chunk into frame data and console bytes
+ * @param buf Received bytes
+ * @param len Number of bytes
+ */
+static void serial_link_route(const uint8_t *buf, size_t len) {
+    size_t start = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] == SERIAL_LINK_STX) {
+            in_frame = true;
+            start = i + 1;
+            if (frame_handler != NULL) {
+                frame_handler->begin();
+            }
+        } else if (buf[i] == SERIAL_LINK_ETX && in_frame) {
+            if (frame_handler != NULL) {
+                if (i > start) {
+                    frame_handler->data(&buf[start], i - start);
+                }
+                frame_handler->end();
+            }
+            in_frame = false;
+        } else if (!in_frame) {
+            serial_link_console_byte(buf[i]);
+        }
+    }
+    // Pass the tail of an unfinished frame on without copying it
+    if (in_frame && frame_handler != NULL && len > start) {
+        frame_handler->data(&buf[start], len - start);
+    }
+}
+
+/* @brief Reads the USB serial port and routes frames as bytes arrive
+ * @param pvParameters N/A
+ */
+void serial_link_task(void *pvParameters) {
+    static uint8_t rx[SERIAL_LINK_RX_CHUNK];
+
+    while (1) {
+        int len = usb_serial_jtag_read_bytes(rx, sizeof(rx), portMAX_DELAY);
+        if (len > 0) {
+            serial_link_route(rx, len);
+        }
+    }
+}
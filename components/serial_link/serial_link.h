@@ -0,0 +1,37 @@
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Receive side of the native USB serial port
+ *
+ * Bytes between STX (0x02) and ETX (0x03) are handed to the frame handler
+ * as they arrive, without buffering the whole frame. Everything else is
+ * console input: lines are split into words and dispatched to the command
+ * registered under the first word ("help" lists them).
+ */
+
+#define SERIAL_LINK_STX         0x02
+#define SERIAL_LINK_ETX         0x03
+#define SERIAL_LINK_RX_CHUNK    256
+#define SERIAL_LINK_LINE_MAX    96      // Longer console lines are dropped
+#define SERIAL_LINK_MAX_ARGS    8
+#define SERIAL_LINK_MAX_COMMANDS 16
+
+typedef struct {
+    void (*begin)(void);                            // STX received
+    void (*data)(const uint8_t *data, size_t len);  // Frame bytes, any chunking
+    void (*end)(void);                              // ETX received
+} serial_link_frame_handler_t;
+
+/* Console command, argv[0] is the command name. Runs on serial_link_task */
+typedef void (*serial_link_command_fn_t)(int argc, char **argv);
+
+void serial_link_init(void);
+void serial_link_set_frame_handler(const serial_link_frame_handler_t *handler);
+bool serial_link_register_command(const char *name, const char *help, serial_link_command_fn_t fn);
+void serial_link_task(void *pvParameters);
+
+#endif
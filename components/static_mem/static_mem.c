@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "../serial_link/serial_link.h"
+#include "static_mem.h"
+
+#define TAG "STATIC_MEM"
+
+/* Linker symbols (sections.ld) */
+extern int _data_start, _data_end, _bss_start, _bss_end;
+
+typedef struct {
+    TaskHandle_t handle;
+    const char *name;
+    uint32_t stack_bytes;
+} static_mem_task_t;
+
+typedef struct {
+    uint32_t size;
+    uint32_t caps;
+    TaskHandle_t task;          // Running when it was allocated
+} static_mem_late_t;
+
+#if STATIC_ALLOC
+static StackType_t stack_pool[STATIC_STACK_POOL_BYTES] __attribute__((aligned(16)));
+static StaticTask_t tcbs[STATIC_MAX_TASKS];
+#endif
+static uint32_t pool_used = 0;
+static static_mem_task_t tasks[STATIC_MAX_TASKS];
+static int task_count = 0;
+
+static static_mem_stats_t stats;
+static static_mem_late_t late[STATIC_LATE_ALLOCS];
+static volatile bool booted = false;
+
+static struct {
+    uint32_t total, used, max_used;
+    uint8_t frag_pct;
+} lvgl_pool;
+
+static esp_timer_handle_t soak_timer = NULL;
+static int64_t soak_start_us = 0;
+static uint32_t soak_seconds = 0;
+
+/* @brief CONFIG_HEAP_USE_HOOKS, called by heap_caps after every allocation
+ * @note Any task, either core or an ISR, possibly with the cache disabled
+ */
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (!booted) {
+        __atomic_fetch_add(&stats.boot_count, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stats.boot_bytes, size, __ATOMIC_RELAXED);
+        return;
+    }
+    uint32_t index = __atomic_fetch_add(&stats.late_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.late_bytes, size, __ATOMIC_RELAXED);
+    if (index < STATIC_LATE_ALLOCS) {
+        late[index].size = size;
+        late[index].caps = caps;
+        late[index].task = xTaskGetCurrentTaskHandle();
+    }
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr) {
+    if (ptr != NULL) {
+        __atomic_fetch_add(&stats.frees, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/* @brief Creates one of app_main's tasks, from the static pool with STATIC_ALLOC
+ * @param stack_bytes One of the STACK_* defines
+ * @return NULL if the pool or the task table is exhausted
+ */
+TaskHandle_t static_mem_task_create(TaskFunction_t fn, const char *name, uint32_t stack_bytes,
+                                    UBaseType_t priority, BaseType_t core) {
+    TaskHandle_t handle = NULL;
+
+    if (task_count == STATIC_MAX_TASKS) {
+        ESP_LOGE(TAG, "No task slot left for %s, raise STATIC_MAX_TASKS", name);
+        return NULL;
+    }
+#if STATIC_ALLOC
+    if (pool_used + stack_bytes > STATIC_STACK_POOL_BYTES) {
+        ESP_LOGE(TAG, "Stack pool exhausted by %s (%lu of %u bytes used)", name,
+                 (unsigned long)pool_used, STATIC_STACK_POOL_BYTES);
+        return NULL;
+    }
+    handle = xTaskCreateStaticPinnedToCore(fn, name, stack_bytes, NULL, priority,
+                                           &stack_pool[pool_used], &tcbs[task_count], core);
+#else
+    xTaskCreatePinnedToCore(fn, name, stack_bytes, NULL, priority, &handle, core);
+#endif
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "Failed to create %s", name);
+        return NULL;
+    }
+    pool_used += stack_bytes;
+    tasks[task_count++] = (static_mem_task_t){ handle, name, stack_bytes };
+    return handle;
+}
+
+/* @brief Ends the boot phase, every allocation from here on is a late one */
+void static_mem_boot_done(void) {
+    booted = true;
+    ESP_LOGI(TAG, "Boot done, %lu heap allocations (%lu bytes)", (unsigned long)stats.boot_count,
+             (unsigned long)stats.boot_bytes);
+}
+
+/* @brief LVGL pool usage, sampled on lvgl_task (lv_mem_monitor is not thread-safe) */
+void static_mem_note_lvgl(uint32_t total, uint32_t used, uint32_t max_used, uint8_t frag_pct) {
+    lvgl_pool.total = total;
+    lvgl_pool.used = used;
+    lvgl_pool.max_used = max_used;
+    lvgl_pool.frag_pct = frag_pct;
+}
+
+void static_mem_get_stats(static_mem_stats_t *out) {
+    memcpy(out, &stats, sizeof(*out));
+}
+
+static void print_late_allocs(void) {
+    uint32_t count = stats.late_count < STATIC_LATE_ALLOCS ? stats.late_count : STATIC_LATE_ALLOCS;
+    for (uint32_t i = 0; i < count; i++) {
+        printf("  late #%lu: %lu B caps 0x%lx in %s\n", (unsigned long)i + 1, (unsigned long)late[i].size,
+               (unsigned long)late[i].caps, late[i].task ? pcTaskGetName(late[i].task) : "?");
+    }
+}
+
+void static_mem_report(void) {
+    printf("RAM at link time: .data %u B, .bss %u B\n",
+           (unsigned)((char *)&_data_end - (char *)&_data_start),
+           (unsigned)((char *)&_bss_end - (char *)&_bss_start));
+#if STATIC_ALLOC
+    printf("Static pool: stacks %lu of %u B for %d tasks, TCBs %d x %u B\n", (unsigned long)pool_used,
+           STATIC_STACK_POOL_BYTES, task_count, STATIC_MAX_TASKS, (unsigned)sizeof(StaticTask_t));
+#else
+    printf("Static pool: off (STATIC_ALLOC 0), %lu B of task stacks on the heap\n", (unsigned long)pool_used);
+#endif
+    printf("Heap: free %u B, min free %u B, largest block %u B (internal)\n",
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    printf("LVGL pool: %lu of %lu B used, max %lu B, frag %u%%\n", (unsigned long)lvgl_pool.used,
+           (unsigned long)lvgl_pool.total, (unsigned long)lvgl_pool.max_used, lvgl_pool.frag_pct);
+    printf("Allocations: boot %lu (%lu B), after boot %lu (%lu B), frees %lu\n",
+           (unsigned long)stats.boot_count, (unsigned long)stats.boot_bytes, (unsigned long)stats.late_count,
+           (unsigned long)stats.late_bytes, (unsigned long)stats.frees);
+    print_late_allocs();
+
+    printf("%-18s %6s %6s %8s\n", "task", "stack", "used", "suggest");
+    for (int i = 0; i < task_count; i++) {
+        uint32_t used = tasks[i].stack_bytes - uxTaskGetStackHighWaterMark(tasks[i].handle) * sizeof(StackType_t);
+        uint32_t suggest = (used * (100 + STATIC_STACK_MARGIN_PCT) / 100 + 255) & ~255u;
+        printf("%-18s %6lu %6lu %8lu\n", tasks[i].name, (unsigned long)tasks[i].stack_bytes,
+               (unsigned long)used, (unsigned long)suggest);
+    }
+    if (soak_seconds != 0) {
+        printf("Soak: %lld of %lu s\n", (esp_timer_get_time() - soak_start_us) / 1000000,
+               (unsigned long)soak_seconds);
+    }
+}
+
+/* @brief End of "mem soak", runs on the esp_timer task */
+static void soak_done_cb(void *arg) {
+    uint32_t count = stats.late_count;
+    printf("Soak %s: %lu heap allocations (%lu B) in %lu s\n", count == 0 ? "PASS" : "FAIL",
+           (unsigned long)count, (unsigned long)stats.late_bytes, (unsigned long)soak_seconds);
+    print_late_allocs();
+    soak_seconds = 0;
+}
+
+/* @brief Console: mem [soak <s>] */
+static void static_mem_command(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "soak") == 0) {
+        uint32_t seconds = strtoul(argv[2], NULL, 10);
+        if (seconds == 0) {
+            printf("usage: mem soak <seconds>\n");
+            return;
+        }
+        esp_timer_stop(soak_timer);
+        stats.late_count = 0;
+        stats.late_bytes = 0;
+        soak_start_us = esp_timer_get_time();
+        soak_seconds = seconds;
+        esp_timer_start_once(soak_timer, (uint64_t)seconds * 1000000);
+        printf("Soak started, %lu s\n", (unsigned long)seconds);
+        return;
+    }
+    static_mem_report();
+}
+
+/* @brief Registers "mem", call early in app_main so its own allocations count as boot */
+void static_mem_init(void) {
+    const esp_timer_create_args_t soak_args = {
+        .callback = soak_done_cb,
+        .name = "mem_soak",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&soak_args, &soak_timer));
+    serial_link_register_command("mem", "RAM report, task stack sizing, mem soak <s>", static_mem_command);
+}
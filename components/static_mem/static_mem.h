@@ -0,0 +1,80 @@
+#ifndef STATIC_MEM_H
+#define STATIC_MEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+/* Static memory build mode and allocation accounting
+ *
+ * With STATIC_ALLOC set, app_main's tasks get their stacks and TCBs from one
+ * pool in .bss (carved in creation order) and queues/mutexes use the
+ * xQueueCreateStatic family, so RAM for them is committed at link time and
+ * shows up in `idf.py size`. LVGL already draws from its own static pool
+ * (CONFIG_LV_USE_BUILTIN_MALLOC, CONFIG_LV_MEM_SIZE_KILOBYTES).
+ *
+ * Every heap allocation is counted by the CONFIG_HEAP_USE_HOOKS hooks.
+ * static_mem_boot_done() closes the boot phase; later allocations are counted
+ * separately and the first few are kept with their task for the report.
+ *
+ * "mem" on the console prints .data/.bss, the pools, heap and LVGL pool usage,
+ * allocations at and after boot, and per task the stack size, the most used
+ * and a suggested size (high-water mark + STATIC_STACK_MARGIN_PCT, rounded up
+ * to 256 bytes) to carry back into the STACK_* defines below.
+ * "mem soak <s>" restarts the after-boot count and reports PASS (no
+ * allocation) or FAIL after s seconds.
+ */
+
+#define STATIC_ALLOC            1       // 1 = static pools, 0 = heap (xTaskCreatePinnedToCore)
+
+/* Stack bytes per task. Estimates, not yet measured on the device: replace
+ * each with the size "mem" suggests after a long match */
+#define STACK_KEY_SCAN          2048
+#define STACK_LVGL              8192
+#define STACK_TIME_TRACKER      2048
+#define STACK_JOURNAL           3072
+#define STACK_CHECKPOINT        3072
+#define STACK_TELEMETRY         2048
+#define STACK_SERIAL_LINK       4096
+#define STACK_REPL_TX           2560
+#define STACK_REPL_RX           3072
+#define STACK_DLOG              3072
+#define STACK_PROFILER          3072
+#define STACK_TOUCH             2560
+
+/* CONFIG_APP_EVENT_LOOP (main/event_loop.h): one stack for what the three
+ * tasks ran, its callbacks never nest so LVGL's is enough */
+#ifdef CONFIG_APP_EVENT_LOOP
+#define STACK_APP_LOOP          STACK_LVGL
+#define STACK_APP_TASKS         STACK_APP_LOOP
+#else
+#define STACK_APP_TASKS         (STACK_KEY_SCAN + STACK_LVGL + STACK_TIME_TRACKER)
+#endif
+
+#define STATIC_STACK_POOL_BYTES (STACK_APP_TASKS + STACK_JOURNAL + \
+                                 STACK_CHECKPOINT + STACK_TELEMETRY + STACK_SERIAL_LINK + \
+                                 STACK_REPL_TX + STACK_REPL_RX + STACK_DLOG + STACK_PROFILER + \
+                                 STACK_TOUCH)
+#define STATIC_MAX_TASKS        16      // app_main creates up to 12, the rest is headroom
+#define STATIC_STACK_MARGIN_PCT 25
+#define STATIC_LATE_ALLOCS      8       // After-boot allocations kept for the report
+
+typedef struct {
+    uint32_t boot_count;        // Allocations before static_mem_boot_done()
+    uint32_t boot_bytes;
+    uint32_t late_count;        // After it (or since "mem soak")
+    uint32_t late_bytes;
+    uint32_t frees;
+} static_mem_stats_t;
+
+void static_mem_init(void);
+TaskHandle_t static_mem_task_create(TaskFunction_t fn, const char *name, uint32_t stack_bytes,
+                                    UBaseType_t priority, BaseType_t core);
+void static_mem_boot_done(void);
+void static_mem_note_lvgl(uint32_t total, uint32_t used, uint32_t max_used, uint8_t frag_pct);
+void static_mem_get_stats(static_mem_stats_t *out);
+void static_mem_report(void);
+
+#endif
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/uart.h"
+#include "telemetry.h"
+
+#define TAG "TELEMETRY"
+
+#define TELEMETRY_SYNC0         0xD2
+#define TELEMETRY_SYNC1         0x7A
+#define TELEMETRY_UART_TX_BUF   2048
+
+_Static_assert(sizeof(telemetry_record_t) == 32, "telemetry record must stay 32 bytes");
+
+static telemetry_record_t ring[TELEMETRY_RING_RECORDS];
+static uint32_t ring_head;      // Next slot to fill
+static uint32_t ring_tail;      // Next slot to send
+static uint16_t next_seq;
+static portMUX_TYPE ring_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t telemetry_task_handle = NULL;
+static volatile uint32_t period_ms = TELEMETRY_PERIOD_MS;
+static bool initialized = false;
+static telemetry_stats_t stats;
+
+/* @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ */
+static uint16_t telemetry_crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* @brief Serializes the current state directly into the next ring slot
+ * @param cause tt_event_t, 0 for periodic snapshots
+ */
+static void telemetry_snapshot(uint8_t cause) {
+    bool queued = false;
+
+    portENTER_CRITICAL(&ring_lock);
+    if (ring_head - ring_tail >= TELEMETRY_RING_RECORDS) {
+        stats.records_dropped++;
+    } else {
+        telemetry_record_t *rec = &ring[ring_head % TELEMETRY_RING_RECORDS];
+        rec->sync[0] = TELEMETRY_SYNC0;
+        rec->sync[1] = TELEMETRY_SYNC1;
+        rec->version = TELEMETRY_VERSION;
+        rec->type = TELEMETRY_REC_SNAPSHOT;
+        rec->seq = next_seq++;
+        rec->len = offsetof(telemetry_record_t, crc) - offsetof(telemetry_record_t, time_ms);
+        rec->cause = cause;
+        rec->time_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        rec->game_seconds = game_timer_minutes * 60 + game_timer_seconds;
+        rec->flags = (all_timers_active ? TELEMETRY_FLAG_MATCH : 0) |
+                     (game_timer_active ? TELEMETRY_FLAG_RUNNING : 0);
+        memset(rec->reserved, 0, sizeof(rec->reserved));
+        for (int i = 0; i < HERO_COUNT; i++) {
+            rec->heroes[i] = hero_timers[i].active ?
+                             hero_timers[i].minutes * 60 + hero_timers[i].seconds : TELEMETRY_HERO_IDLE;
+        }
+        rec->crc = telemetry_crc16(&rec->version,
+                                   offsetof(telemetry_record_t, crc) - offsetof(telemetry_record_t, version));
+        ring_head++;
+        queued = true;
+    }
+    portEXIT_CRITICAL(&ring_lock);
+
+    if (queued && telemetry_task_handle != NULL) {
+        xTaskNotifyGive(telemetry_task_handle);
+    }
+}
+
+/* @brief Hands every queued record to the UART driver, one write per contiguous run
+ * @note Slots are only released after the driver has taken them, so producers never touch them mid-send
+ */
+static void telemetry_drain(void) {
+    while (1) {
+        portENTER_CRITICAL(&ring_lock);
+        uint32_t head = ring_head;
+        uint32_t tail = ring_tail;
+        portEXIT_CRITICAL(&ring_lock);
+        if (head == tail) {
+            return;
+        }
+
+        uint32_t start = tail % TELEMETRY_RING_RECORDS;
+        uint32_t count = head - tail;
+        if (start + count > TELEMETRY_RING_RECORDS) {
+            count = TELEMETRY_RING_RECORDS - start;  // Stop at the wrap, the rest goes next loop
+        }
+
+        int written = uart_write_bytes(TELEMETRY_UART_NUM, (const char *)&ring[start],
+                                       count * sizeof(telemetry_record_t));
+        if (written < 0) {
+            return;
+        }
+
+        portENTER_CRITICAL(&ring_lock);
+        ring_tail += count;
+        stats.records_sent += count;
+        stats.bytes_sent += written;
+        stats.writes++;
+        portEXIT_CRITICAL(&ring_lock);
+    }
+}
+
+/* @brief Installs the UART driver (TX only) for the telemetry stream
+ * @param N/A
+ */
+void telemetry_init(void) {
+    uart_config_t uart_config = {
+        .baud_rate = TELEMETRY_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_XTAL,     // APB follows the CPU down in power IDLE, the baud rate would too
+    };
+    ESP_ERROR_CHECK(uart_driver_install(TELEMETRY_UART_NUM, 256, TELEMETRY_UART_TX_BUF, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(TELEMETRY_UART_NUM, &uart_config));
+    ESP_ERROR_CHECK(uart_set_pin(TELEMETRY_UART_NUM, TELEMETRY_TX_PIN, UART_PIN_NO_CHANGE,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+    initialized = true;
+    ESP_LOGI(TAG, "Telemetry on UART%d TX GPIO%d @ %d baud", TELEMETRY_UART_NUM, TELEMETRY_TX_PIN, TELEMETRY_BAUD);
+}
+
+/* @brief Sends a snapshot on every state change
+ * @param event tt_event_t
+ * @param arg N/A
+ */
+void telemetry_listener(uint8_t event, uint8_t arg) {
+    if (initialized) {
+        telemetry_snapshot(event);
+    }
+}
+
+/* @brief Sets the rate of snapshots sent while nothing changes
+ * @param ms Period in milliseconds, 0 = only on change
+ */
+void telemetry_set_period(uint32_t ms) {
+    period_ms = ms;
+    if (telemetry_task_handle != NULL) {
+        xTaskNotifyGive(telemetry_task_handle);
+    }
+}
+
+/* @brief Sends other self-framed packets on the telemetry UART (frame capture)
+ * @param data Complete packet, written in one driver call so it never splits a record
+ * @param len Bytes
+ * @note Blocks while the driver's TX buffer is full
+ */
+void telemetry_write_raw(const void *data, size_t len) {
+    if (!initialized) {
+        return;
+    }
+    int written = uart_write_bytes(TELEMETRY_UART_NUM, (const char *)data, len);
+    if (written > 0) {
+        portENTER_CRITICAL(&ring_lock);
+        stats.raw_bytes += written;
+        portEXIT_CRITICAL(&ring_lock);
+    }
+}
+
+void telemetry_get_stats(telemetry_stats_t *out) {
+    portENTER_CRITICAL(&ring_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&ring_lock);
+}
+
+/* @brief Sends queued records, and a periodic snapshot every period_ms
+ * @param pvParameters N/A
+ */
+void telemetry_task(void *pvParameters) {
+    telemetry_task_handle = xTaskGetCurrentTaskHandle();
+    int64_t last_periodic = esp_timer_get_time();
+
+    while (1) {
+        uint32_t period = period_ms;
+        ulTaskNotifyTake(pdTRUE, period ? pdMS_TO_TICKS(period) : portMAX_DELAY);
+        if (!initialized) {
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        if (period && now - last_periodic >= (int64_t)period * 1000) {
+            last_periodic = now;
+            telemetry_snapshot(0);
+        }
+        telemetry_drain();
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../../main/time_tracker.h"
+
+/* Binary telemetry of game state snapshots
+ *
+ * Snapshots are serialized once, straight into a ring of fixed 32 byte
+ * records, and telemetry_task hands contiguous runs of the ring to the UART
+ * driver. Decoder: tools/telemetry/telemetry_decode.py
+ *
+ * Record (little endian):
+ *   0  sync       0xD2 0x7A
+ *   2  version    TELEMETRY_VERSION
+ *   3  type       TELEMETRY_REC_*
+ *   4  seq        u16, increments per record
+ *   6  len        bytes from offset 8 up to the CRC (22)
+ *   7  cause      tt_event_t that triggered it, 0 = periodic
+ *   8  time_ms    u32, ms since boot
+ *   12 game_secs  u32, in-game timer
+ *   16 flags      bit 0 match created, bit 1 timer running
+ *   17 reserved   3 bytes
+ *   20 heroes     5 x u16 seconds left, 0xFFFF = not running
+ *   30 crc        u16 CRC-16/CCITT-FALSE over bytes 2..29
+ */
+
+#define TELEMETRY_VERSION       1
+#define TELEMETRY_REC_SNAPSHOT  1
+
+#define TELEMETRY_UART_NUM      UART_NUM_1
+#define TELEMETRY_TX_PIN        43          // D1 on the Nano header
+#define TELEMETRY_BAUD          921600
+#define TELEMETRY_RING_RECORDS  64
+#define TELEMETRY_PERIOD_MS     1000        // Default rate when nothing changes
+
+#define TELEMETRY_FLAG_MATCH    (1 << 0)
+#define TELEMETRY_FLAG_RUNNING  (1 << 1)
+#define TELEMETRY_HERO_IDLE     0xFFFF
+
+typedef struct __attribute__((packed)) {
+    uint8_t sync[2];
+    uint8_t version;
+    uint8_t type;
+    uint16_t seq;
+    uint8_t len;
+    uint8_t cause;
+    uint32_t time_ms;
+    uint32_t game_seconds;
+    uint8_t flags;
+    uint8_t reserved[3];
+    uint16_t heroes[HERO_COUNT];
+    uint16_t crc;
+} telemetry_record_t;
+
+typedef struct {
+    uint32_t records_sent;
+    uint32_t records_dropped;   // Ring was full
+    uint32_t bytes_sent;
+    uint32_t writes;            // Driver calls, one per contiguous run
+    uint32_t raw_bytes;         // telemetry_write_raw(), e.g. frame capture packets
+} telemetry_stats_t;
+
+void telemetry_init(void);
+void telemetry_listener(uint8_t event, uint8_t arg);
+void telemetry_set_period(uint32_t period_ms);
+void telemetry_write_raw(const void *data, size_t len);
+void telemetry_get_stats(telemetry_stats_t *out);
+void telemetry_task(void *pvParameters);
+
+#endif
@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "lvgl.h"
+
+#include "../gpio_setup/gpio_setup.h"
+#include "../display/display.h"
+#include "../power/power.h"
+#include "touch_coalesce.h"
+#include "touch_trace.h"
+#include "touch.h"
+
+#define TAG "TOUCH"
+
+/* FT6336 registers */
+#define FT_REG_TD_STATUS    0x02    // TD_STATUS, P1_XH, P1_XL, P1_YH, P1_YL
+#define FT_REG_G_MODE       0xA4
+#define FT_G_MODE_TRIGGER   0x01    // INT pulses once per new report
+#define FT_READ_LEN         5
+#define FT_EVENT_LIFT_UP    0x01
+
+/* Demo trace for TOUCH_USE_TRACE: visit each tab, then tap the hero rows */
+static const char touch_demo_trace[] =
+    "0 down 80 20\n"
+    "60 up\n"
+    "1000 down 240 20\n"
+    "1050 up\n"
+    "2000 down 400 20\n"
+    "2040 up\n"
+    "3000 down 120 70\n"
+    "3030 up\n"
+    "4000 down 120 100\n"
+    "4010 down 124 102\n"
+    "4025 up\n"
+    "6000 down 200 160\n"
+    "6100 down 240 160\n"
+    "6200 down 280 160\n"
+    "6300 up\n";
+
+static touch_sample_t trace_samples[32];
+static touch_trace_t trace;
+
+static touch_source_t source;
+static touch_coalescer_t coalescer;
+static touch_stats_t stats;
+static portMUX_TYPE touch_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* @brief Maps controller coordinates to the landscape display */
+static void touch_transform(uint16_t raw_x, uint16_t raw_y, touch_sample_t *out) {
+    uint16_t x = raw_x;
+    uint16_t y = raw_y;
+#if TOUCH_SWAP_XY
+    x = raw_y;
+    y = raw_x;
+#endif
+#if TOUCH_INVERT_X
+    x = (MY_DISP_HOR_RES - 1) - x;
+#endif
+#if TOUCH_INVERT_Y
+    y = (MY_DISP_VER_RES - 1) - y;
+#endif
+    out->x = x < MY_DISP_HOR_RES ? x : MY_DISP_HOR_RES - 1;
+    out->y = y < MY_DISP_VER_RES ? y : MY_DISP_VER_RES - 1;
+}
+
+static bool ft6336_init(void *ctx) {
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = I2C_SDA,
+        .scl_io_num = I2C_SCL,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = TOUCH_I2C_FREQ_HZ,
+    };
+    if (i2c_param_config(TOUCH_I2C_PORT, &conf) != ESP_OK ||
+        i2c_driver_install(TOUCH_I2C_PORT, conf.mode, 0, 0, 0) != ESP_OK) {
+        return false;
+    }
+
+    // Reset pulse, controller needs ~300 ms before it answers
+    gpio_set_level(TP_RESET, 0);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    gpio_set_level(TP_RESET, 1);
+    vTaskDelay(pdMS_TO_TICKS(300));
+
+    uint8_t mode[2] = { FT_REG_G_MODE, FT_G_MODE_TRIGGER };
+    return i2c_master_write_to_device(TOUCH_I2C_PORT, TOUCH_I2C_ADDR, mode, sizeof(mode),
+                                      pdMS_TO_TICKS(TOUCH_I2C_TIMEOUT_MS)) == ESP_OK;
+}
+
+/* @brief One burst read of the first touch point */
+static bool ft6336_read(void *ctx, int64_t now_us, touch_sample_t *out) {
+    uint8_t reg = FT_REG_TD_STATUS;
+    uint8_t buf[FT_READ_LEN];
+
+    if (i2c_master_write_read_device(TOUCH_I2C_PORT, TOUCH_I2C_ADDR, &reg, 1, buf, sizeof(buf),
+                                     pdMS_TO_TICKS(TOUCH_I2C_TIMEOUT_MS)) != ESP_OK) {
+        return false;
+    }
+    uint8_t points = buf[0] & 0x0F;
+    uint8_t event = buf[1] >> 6;
+    uint16_t raw_x = ((buf[1] & 0x0F) << 8) | buf[2];
+    uint16_t raw_y = ((buf[3] & 0x0F) << 8) | buf[4];
+
+    out->time_us = now_us;
+    out->pressed = points > 0 && points <= 2 && event != FT_EVENT_LIFT_UP;
+    touch_transform(raw_x, raw_y, out);
+    return true;
+}
+
+static const touch_source_t ft6336_source = {
+    .name = "ft6336",
+    .init = ft6336_init,
+    .read = ft6336_read,
+    .bytes_per_read = 2 + 1 + FT_READ_LEN,  // addr+reg, addr, data
+    .uses_irq = true,
+    .ctx = NULL,
+};
+
+/* @brief LVGL pointer read callback, one coalesced state per read */
+static void touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+    touch_sample_t sample;
+    int64_t oldest_us = 0;
+
+    taskENTER_CRITICAL(&touch_mux);
+    bool fresh = touch_coalesce_take(&coalescer, &sample, &oldest_us);
+    taskEXIT_CRITICAL(&touch_mux);
+
+    data->point.x = sample.x;
+    data->point.y = sample.y;
+    data->state = sample.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    if (fresh) {
+        uint32_t latency = (uint32_t)(esp_timer_get_time() - oldest_us);
+        taskENTER_CRITICAL(&touch_mux);
+        stats.events++;
+        stats.irq_to_event_us_last = latency;
+        stats.irq_to_event_us_total += latency;
+        if (latency > stats.irq_to_event_us_max) {
+            stats.irq_to_event_us_max = latency;
+        }
+        taskEXIT_CRITICAL(&touch_mux);
+    }
+}
+
+/* @brief Picks the touch source and registers the LVGL input device, after lvgl_setup()
+ * @param src Touch source, NULL for the controller (or the demo trace if TOUCH_USE_TRACE)
+ * @note Does no bus I/O: the controller's reset and its 300 ms start-up wait run
+ *       in touch_task, so app_main (and a resumed match's first frame) never waits
+ *       for them. Until then the input device reads as released.
+ */
+void touch_init(const touch_source_t *src) {
+    if (src != NULL) {
+        source = *src;
+    } else if (TOUCH_USE_TRACE) {
+        size_t count = touch_trace_parse(touch_demo_trace, trace_samples,
+                                         sizeof(trace_samples) / sizeof(trace_samples[0]));
+        touch_trace_init(&trace, trace_samples, count, true);
+        touch_trace_source(&trace, &source);
+    } else {
+        source = ft6336_source;
+    }
+
+    touch_coalesce_reset(&coalescer);
+    memset(&stats, 0, sizeof(stats));
+    stats.since_us = esp_timer_get_time();
+
+    lv_indev_t *indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, touch_read_cb);
+}
+
+/* @brief Reads the source once and feeds the coalescer
+ * @param irq_us Time of the oldest interrupt served by this read
+ */
+static void touch_sample(int64_t irq_us) {
+    touch_sample_t sample;
+    int64_t start = esp_timer_get_time();
+    bool ok = source.read(source.ctx, start, &sample);
+    int64_t end = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&touch_mux);
+    stats.reads++;
+    stats.bus_bytes += source.bytes_per_read;
+    if (source.bytes_per_read) {
+        stats.bus_busy_us += end - start;
+    }
+    if (start - irq_us > stats.irq_to_read_us_max) {
+        stats.irq_to_read_us_max = (uint32_t)(start - irq_us);
+    }
+    if (ok) {
+        sample.time_us = irq_us;    // Latency is measured from the interrupt
+        touch_coalesce_push(&coalescer, &sample);
+        stats.samples = coalescer.samples;
+        stats.coalesced = coalescer.coalesced;
+    } else {
+        stats.read_errors++;
+    }
+    taskEXIT_CRITICAL(&touch_mux);
+}
+
+/* @brief Brings the source up, then waits for TP_INT, drains queued interrupts and
+ *        reads the controller once per wakeup
+ * @param pvParameters N/A
+ */
+void touch_task(void *pvParameters) {
+    gpio_evt_t evt;
+
+    if (!source.init(source.ctx)) {
+        ESP_LOGW(TAG, "%s did not answer, touch disabled", source.name);
+        vTaskDelete(NULL);
+    }
+    ESP_LOGI(TAG, "Touch input from %s", source.name);
+    // Interrupts queued during the reset are not touches
+    xQueueReset(gpio_evt_queue);
+    while (1) {
+        // Poll while a finger is down in case the lift-up report is missed
+        TickType_t wait = (!source.uses_irq || coalescer.latest.pressed) ?
+            pdMS_TO_TICKS(TOUCH_POLL_MS) : portMAX_DELAY;
+
+        if (source.uses_irq && xQueueReceive(gpio_evt_queue, &evt, wait) == pdTRUE) {
+            uint32_t irqs = 1;
+            int64_t oldest = evt.time_us;
+            while (xQueueReceive(gpio_evt_queue, &evt, 0) == pdTRUE) {
+                irqs++;     // Reports queued while busy are covered by this read
+            }
+            taskENTER_CRITICAL(&touch_mux);
+            stats.irqs += irqs;
+            taskEXIT_CRITICAL(&touch_mux);
+            touch_sample(oldest);
+        } else {
+            if (!source.uses_irq) {
+                vTaskDelay(wait);
+            }
+            touch_sample(esp_timer_get_time());
+        }
+        if (coalescer.latest.pressed) {
+            power_activity();
+        }
+    }
+}
+
+void touch_get_stats(touch_stats_t *out) {
+    taskENTER_CRITICAL(&touch_mux);
+    *out = stats;
+    taskEXIT_CRITICAL(&touch_mux);
+}
+
+/* @brief I2C bus occupancy since touch_init, in 1/1000 */
+uint32_t touch_bus_occupancy_permille(const touch_stats_t *s, int64_t now_us) {
+    int64_t elapsed = now_us - s->since_us;
+    return elapsed > 0 ? (uint32_t)(s->bus_busy_us * 1000 / elapsed) : 0;
+}
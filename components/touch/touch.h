@@ -0,0 +1,50 @@
+#ifndef TOUCH_H
+#define TOUCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "touch_source.h"
+
+/* Touch input (FT6336 capacitive controller)
+ *
+ * TP_INT -> gpio_isr_handler -> gpio_evt_queue -> touch_task
+ * touch_task drains the queue, burst-reads the controller once over I2C and
+ * pushes the sample into the coalescer. The LVGL pointer device takes one
+ * coalesced state per read, so a burst of moves is a single event per frame.
+ */
+
+#define TOUCH_I2C_PORT      0
+#define TOUCH_I2C_FREQ_HZ   400000
+#define TOUCH_I2C_ADDR      0x38
+#define TOUCH_I2C_TIMEOUT_MS 10
+#define TOUCH_POLL_MS       10      // Sources without an interrupt (trace), and release detection
+#define TOUCH_USE_TRACE     0       // 1: replay touch_demo_trace instead of reading the controller
+
+/* Panel is mounted landscape, controller reports portrait */
+#define TOUCH_SWAP_XY       1
+#define TOUCH_INVERT_X      0
+#define TOUCH_INVERT_Y      1
+
+typedef struct {
+    uint32_t irqs;
+    uint32_t reads;             // Bus transactions
+    uint32_t read_errors;
+    uint32_t bus_bytes;
+    uint64_t bus_busy_us;       // Time spent inside reads
+    uint32_t irq_to_read_us_max;
+    uint32_t irq_to_event_us_last;  // Interrupt to LVGL read delivering it
+    uint32_t irq_to_event_us_max;
+    uint64_t irq_to_event_us_total;
+    uint32_t events;
+    uint32_t samples;
+    uint32_t coalesced;
+    int64_t since_us;           // Start of the occupancy window
+} touch_stats_t;
+
+void touch_init(const touch_source_t *source);
+void touch_get_stats(touch_stats_t *out);
+uint32_t touch_bus_occupancy_permille(const touch_stats_t *stats, int64_t now_us);
+void touch_task(void *pvParameters);
+
+#endif
@@ -0,0 +1,53 @@
+#include <string.h>
+#include "touch_coalesce.h"
+
+void touch_coalesce_reset(touch_coalescer_t *c) {
+    memset(c, 0, sizeof(*c));
+}
+
+/* @brief Adds a sample read from the controller
+ * @param sample Newest position / state
+ */
+void touch_coalesce_push(touch_coalescer_t *c, const touch_sample_t *sample) {
+    if (c->fresh) {
+        c->coalesced++;
+    } else {
+        c->oldest_us = sample->time_us;
+    }
+    // A press not seen by a read yet must survive a release arriving before it
+    if (sample->pressed && !c->latest.pressed) {
+        c->press = *sample;
+        c->press_latched = true;
+    } else if (sample->pressed && c->press_latched) {
+        c->press = *sample;
+    }
+    c->latest = *sample;
+    c->fresh = true;
+    c->samples++;
+}
+
+/* @brief Takes the state to report for this read, once per frame
+ * @param out State to report
+ * @param oldest_us Time of the oldest sample merged into it
+ * @return false if nothing arrived since the last take (out still holds the current state)
+ */
+bool touch_coalesce_take(touch_coalescer_t *c, touch_sample_t *out, int64_t *oldest_us) {
+    if (c->press_latched && !c->latest.pressed) {
+        // Tap shorter than a frame: report the press now, the release on the next take
+        *out = c->press;
+        *oldest_us = c->oldest_us;
+        c->press_latched = false;
+        c->oldest_us = c->latest.time_us;
+        c->events++;
+        return true;
+    }
+    c->press_latched = false;
+    *out = c->latest;
+    if (!c->fresh) {
+        return false;
+    }
+    *oldest_us = c->oldest_us;
+    c->fresh = false;
+    c->events++;
+    return true;
+}
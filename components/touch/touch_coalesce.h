@@ -0,0 +1,39 @@
+#ifndef TOUCH_COALESCE_H
+#define TOUCH_COALESCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Coalesces touch samples into one input event per LVGL read
+ *
+ * The controller reports far more often than LVGL reads the input device,
+ * so only the newest position is kept. A press that is released again
+ * before the next read is latched, so a quick tap is still reported as
+ * pressed for one read and then released.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/touch).
+ */
+
+typedef struct {
+    int64_t time_us;        // Interrupt (or trace) time of the sample
+    uint16_t x;
+    uint16_t y;
+    bool pressed;
+} touch_sample_t;
+
+typedef struct {
+    touch_sample_t latest;
+    touch_sample_t press;       // Latched press, valid if press_latched
+    bool press_latched;
+    bool fresh;                 // Samples arrived since the last take
+    int64_t oldest_us;          // Time of the oldest sample not yet taken
+    uint32_t samples;
+    uint32_t events;            // Takes that delivered new data
+    uint32_t coalesced;         // Samples merged into a later one
+} touch_coalescer_t;
+
+void touch_coalesce_reset(touch_coalescer_t *c);
+void touch_coalesce_push(touch_coalescer_t *c, const touch_sample_t *sample);
+bool touch_coalesce_take(touch_coalescer_t *c, touch_sample_t *out, int64_t *oldest_us);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef TOUCH_SOURCE_H
+#define TOUCH_SOURCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "touch_coalesce.h"
+
+/* Where touch samples come from: the FT6336 controller or a recorded trace */
+typedef struct {
+    const char *name;
+    bool (*init)(void *ctx);
+    bool (*read)(void *ctx, int64_t now_us, touch_sample_t *out);  // Current state, false on a bus error
+    uint32_t bytes_per_read;    // Bus bytes of one read, for the occupancy estimate
+    bool uses_irq;              // false: polled every TOUCH_POLL_MS
+    void *ctx;
+} touch_source_t;
+
+#endif
@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include <string.h>
+#include "touch_trace.h"
+
+/* @brief Parses a text trace
+ * @param text Trace, NUL terminated
+ * @param out Parsed samples
+ * @param max Capacity of out
+ * @return Number of samples parsed
+ */
+size_t touch_trace_parse(const char *text, touch_sample_t *out, size_t max) {
+    size_t count = 0;
+    const char *line = text;
+
+    while (*line != '\0' && count < max) {
+        const char *next = strchr(line, '\n');
+        size_t len = next ? (size_t)(next - line) : strlen(line);
+        char buf[64];
+        if (len >= sizeof(buf)) {
+            len = sizeof(buf) - 1;
+        }
+        memcpy(buf, line, len);
+        buf[len] = '\0';
+        char *hash = strchr(buf, '#');
+        if (hash != NULL) {
+            *hash = '\0';
+        }
+
+        char *end;
+        long ms = strtol(buf, &end, 10);
+        if (end != buf) {
+            while (*end == ' ' || *end == '\t') {
+                end++;
+            }
+            touch_sample_t *s = &out[count];
+            s->time_us = (int64_t)ms * 1000;
+            if (strncmp(end, "down", 4) == 0) {
+                char *ystr;
+                s->x = (uint16_t)strtol(end + 4, &ystr, 10);
+                s->y = (uint16_t)strtol(ystr, NULL, 10);
+                s->pressed = true;
+                count++;
+            } else if (strncmp(end, "up", 2) == 0) {
+                s->x = count ? out[count - 1].x : 0;
+                s->y = count ? out[count - 1].y : 0;
+                s->pressed = false;
+                count++;
+            }
+        }
+        line = next ? next + 1 : line + len;
+    }
+    return count;
+}
+
+void touch_trace_init(touch_trace_t *trace, const touch_sample_t *samples, size_t count, bool loop) {
+    memset(trace, 0, sizeof(*trace));
+    trace->samples = samples;
+    trace->count = count;
+    trace->loop = loop;
+}
+
+/* @brief Reads the trace like the controller's registers: the newest sample due by now_us */
+bool touch_trace_read(void *ctx, int64_t now_us, touch_sample_t *out) {
+    touch_trace_t *t = ctx;
+
+    if (!t->started) {
+        t->start_us = now_us;
+        t->started = true;
+    }
+    while (t->count > 0) {
+        if (t->pos == t->count) {
+            if (!t->loop) {
+                break;
+            }
+            t->start_us += t->samples[t->count - 1].time_us + 1000;
+            t->pos = 0;
+        }
+        if (t->start_us + t->samples[t->pos].time_us > now_us) {
+            break;
+        }
+        t->current = t->samples[t->pos++];
+    }
+    *out = t->current;
+    out->time_us = now_us;
+    return true;
+}
+
+static bool touch_trace_init_cb(void *ctx) {
+    touch_trace_t *t = ctx;
+    t->pos = 0;
+    t->started = false;
+    return true;
+}
+
+/* @brief Wraps a trace as a touch source, polled (no interrupt) */
+void touch_trace_source(touch_trace_t *trace, touch_source_t *out) {
+    out->name = "trace";
+    out->init = touch_trace_init_cb;
+    out->read = touch_trace_read;
+    out->bytes_per_read = 0;
+    out->uses_irq = false;
+    out->ctx = trace;
+}
@@ -0,0 +1,33 @@
+#ifndef TOUCH_TRACE_H
+#define TOUCH_TRACE_H
+
+#include <stddef.h>
+
+#include "touch_source.h"
+
+/* Replayable touch trace, stands in for the controller
+ *
+ * Text format, one sample per line ('#' starts a comment):
+ *   <time_ms> down <x> <y>     finger down or moved
+ *   <time_ms> up               finger lifted
+ * Times are relative to the start of the replay, in display coordinates.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/touch).
+ */
+
+typedef struct {
+    const touch_sample_t *samples;
+    size_t count;
+    size_t pos;             // Next sample not yet due
+    int64_t start_us;
+    bool started;
+    bool loop;              // Start over after the last sample
+    touch_sample_t current;
+} touch_trace_t;
+
+size_t touch_trace_parse(const char *text, touch_sample_t *out, size_t max);
+void touch_trace_init(touch_trace_t *trace, const touch_sample_t *samples, size_t count, bool loop);
+bool touch_trace_read(void *ctx, int64_t now_us, touch_sample_t *out);
+void touch_trace_source(touch_trace_t *trace, touch_source_t *out);
+
+#endif
@@ -0,0 +1,157 @@
+#include <string.h>
+#include "clock_discipline.h"
+
+clock_discipline_t game_clock = { .period_us = CD_NOMINAL_PERIOD_US, .interval_us = CD_NOMINAL_PERIOD_US };
+
+static int32_t clamp(int64_t value, int32_t limit) {
+    if (value > limit) {
+        return limit;
+    }
+    if (value < -limit) {
+        return -limit;
+    }
+    return (int32_t)value;
+}
+
+/* @brief Offset estimate from the window
+ * A delivery delay only ever makes a sample look late (offset too low), so the
+ * least delayed samples are the most accurate: the second largest offset is
+ * used, which still ignores a single fluke on the high side.
+ */
+static int32_t window_estimate(const clock_discipline_t *cd) {
+    int32_t sorted[CD_FILTER_SAMPLES];
+    int n = cd->window_count;
+
+    memcpy(sorted, cd->window, n * sizeof(sorted[0]));
+    for (int i = 1; i < n; i++) {
+        int32_t v = sorted[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[n >= 3 ? n - 2 : n - 1];
+}
+
+/* @brief Forgets all samples and the rate estimate, back to a nominal 1 s tick
+ * @param cd Clock to reset
+ */
+void clock_discipline_reset(clock_discipline_t *cd) {
+    memset(cd, 0, sizeof(*cd));
+    cd->period_us = CD_NOMINAL_PERIOD_US;
+    cd->interval_us = CD_NOMINAL_PERIOD_US;
+}
+
+/* @brief Records when the game clock ticked, called by the tick task
+ * @param cd Clock
+ * @param now_us Local time of the tick
+ */
+void clock_discipline_tick(clock_discipline_t *cd, int64_t now_us) {
+    cd->last_tick_us = now_us;
+}
+
+/* @brief Game time with sub-second resolution
+ * @param game_seconds Whole seconds on the game timer
+ * @param running false while paused (the fraction is frozen at the last tick)
+ * @param now_us Local time
+ * @return Game time in microseconds
+ */
+int64_t clock_discipline_local_us(const clock_discipline_t *cd, uint32_t game_seconds, bool running, int64_t now_us) {
+    int64_t fraction = 0;
+    if (running && cd->last_tick_us != 0) {
+        int64_t since_tick = now_us - cd->last_tick_us;
+        if (since_tick > cd->period_us) {
+            since_tick = cd->period_us;  // Tick is late, don't count past the next second
+        }
+        if (since_tick > 0) {
+            fraction = since_tick * CD_NOMINAL_PERIOD_US / cd->period_us;
+        }
+    }
+    return (int64_t)game_seconds * CD_NOMINAL_PERIOD_US + fraction;
+}
+
+/* @brief Feeds one reference sample and updates the tick period
+ * @param ref_us Reference game time
+ * @param local_us Game time of the device when the sample arrived (clock_discipline_local_us)
+ * @param now_us Local time the sample arrived
+ * @return What was done with the sample
+ */
+cd_result_t clock_discipline_sample(clock_discipline_t *cd, int64_t ref_us, int64_t local_us, int64_t now_us) {
+    int64_t offset = ref_us - local_us;
+
+    // Far off: step, but only once a few samples agree (or there is nothing to slew from yet)
+    if (offset > CD_STEP_US || offset < -CD_STEP_US) {
+        cd->step_count++;
+        if (cd->window_count == 0 || cd->step_count >= CD_STEP_CONFIRM) {
+            return CD_STEP;
+        }
+        cd->rejected++;
+        return CD_REJECTED;
+    }
+    cd->step_count = 0;
+
+    int64_t dt = 0;
+    if (cd->window_count > 0) {
+        dt = now_us - cd->last_sample_us;
+        if (dt < 0 || dt > CD_MAX_SAMPLE_GAP_US) {
+            dt = 0;
+        }
+        // Older offsets were measured before the slew since then, move them by what it corrected
+        int32_t slewed = (int32_t)((int64_t)cd->phase_ppm * dt / 1000000);
+        for (int i = 0; i < cd->window_count; i++) {
+            cd->window[i] -= slewed;
+        }
+        if (dt > 0) {
+            cd->interval_us += (int32_t)((dt - cd->interval_us) / 4);
+        }
+    }
+    cd->last_sample_us = now_us;
+
+    // The sample always enters the window, so a lasting shift moves the estimate and is accepted
+    cd->window[cd->window_pos] = (int32_t)offset;
+    cd->window_pos = (cd->window_pos + 1) % CD_FILTER_SAMPLES;
+    if (cd->window_count < CD_FILTER_SAMPLES) {
+        cd->window_count++;
+    }
+    int32_t estimate = window_estimate(cd);
+    if (cd->window_count >= 3 && (offset - estimate > CD_OUTLIER_US || estimate - offset > CD_OUTLIER_US)) {
+        cd->rejected++;
+        return CD_REJECTED;
+    }
+    cd->offset_us = estimate;
+    cd->samples++;
+
+    // Sparse samples get a longer time constant, so one correction never overshoots the next sample
+    int64_t tau = CD_TIME_CONSTANT_US;
+    if (tau < 4LL * cd->interval_us) {
+        tau = 4LL * cd->interval_us;
+    }
+
+    // Rate: integral of the offset, held while the slew is saturated so it doesn't wind up
+    if (cd->freq_ppm + cd->phase_ppm < CD_MAX_SLEW_PPM && cd->freq_ppm + cd->phase_ppm > -CD_MAX_SLEW_PPM) {
+        int64_t integral = (int64_t)estimate * dt / tau;
+        cd->freq_ppm = clamp(cd->freq_ppm + integral * 1000000 / (4 * tau), CD_MAX_FREQ_PPM);
+    }
+
+    // Offset: corrected over roughly one time constant, on top of the rate
+    cd->phase_ppm = clamp((int64_t)estimate * 1000000 / tau, CD_MAX_SLEW_PPM);
+    int32_t rate_ppm = clamp((int64_t)cd->freq_ppm + cd->phase_ppm, CD_MAX_SLEW_PPM);
+    cd->phase_ppm = rate_ppm - cd->freq_ppm;
+    cd->period_us = (int32_t)(1000000LL * CD_NOMINAL_PERIOD_US / (1000000 + rate_ppm));
+    return CD_ACCEPTED;
+}
+
+/* @brief Clears the offset history after the caller stepped the clock
+ * @param cd Clock, the rate estimate is kept
+ */
+void clock_discipline_stepped(clock_discipline_t *cd) {
+    cd->window_count = 0;
+    cd->window_pos = 0;
+    cd->step_count = 0;
+    cd->offset_us = 0;
+    cd->phase_ppm = 0;
+    cd->steps++;
+    cd->period_us = (int32_t)(1000000LL * CD_NOMINAL_PERIOD_US / (1000000 + cd->freq_ppm));
+}
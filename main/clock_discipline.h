@@ -0,0 +1,62 @@
+#ifndef CLOCK_DISCIPLINE_H
+#define CLOCK_DISCIPLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Discipline of the game clock against an external reference (GSI, serial sync)
+ *
+ * Reference samples give the offset between the reference and the device's
+ * game time. Instead of stepping game_timer_seconds, the length of the game
+ * tick (time_tracker_task) is stretched or shortened by at most
+ * CD_MAX_SLEW_PPM, so the clock and hero timers slew smoothly. A PI loop
+ * tracks both the offset and the rate error of the local clock. The offset is
+ * estimated from the least delayed of the last CD_FILTER_SAMPLES samples,
+ * samples far from that estimate are rejected as outliers, and only an
+ * offset beyond CD_STEP_US, seen CD_STEP_CONFIRM times in a row, is stepped.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/clock_sim).
+ */
+
+#define CD_NOMINAL_PERIOD_US    1000000
+#define CD_MAX_SLEW_PPM         50000       // Clock runs at most 5% fast/slow while slewing
+#define CD_MAX_FREQ_PPM         20000       // Largest rate error that is tracked
+#define CD_TIME_CONSTANT_US     8000000     // Offset correction time constant
+#define CD_STEP_US              2500000     // Larger offsets are stepped instead of slewed
+#define CD_STEP_CONFIRM         3           // Samples in a row beyond CD_STEP_US before stepping
+#define CD_FILTER_SAMPLES       7           // Samples kept for the offset estimate
+#define CD_OUTLIER_US           300000      // Distance from the estimate to reject a sample
+#define CD_MAX_SAMPLE_GAP_US    30000000    // Longer gaps don't count towards the rate estimate
+
+typedef enum {
+    CD_ACCEPTED,    // Used to slew the clock
+    CD_REJECTED,    // Outlier, ignored
+    CD_STEP,        // Caller must set the clock to the reference, then clock_discipline_stepped()
+} cd_result_t;
+
+typedef struct {
+    int32_t period_us;          // Current length of one game second
+    int32_t freq_ppm;           // Estimated rate error of the local clock, positive = slow
+    int32_t phase_ppm;          // Part of the rate correcting the offset
+    int32_t offset_us;          // Estimated offset (reference - local) at the last accepted sample
+    int32_t interval_us;        // Average time between samples
+    int64_t last_tick_us;
+    int64_t last_sample_us;
+    int32_t window[CD_FILTER_SAMPLES];
+    uint8_t window_count;
+    uint8_t window_pos;
+    uint8_t step_count;
+    uint32_t samples;
+    uint32_t rejected;
+    uint32_t steps;
+} clock_discipline_t;
+
+extern clock_discipline_t game_clock;  // Disciplines time_tracker_task
+
+void clock_discipline_reset(clock_discipline_t *cd);
+void clock_discipline_tick(clock_discipline_t *cd, int64_t now_us);
+int64_t clock_discipline_local_us(const clock_discipline_t *cd, uint32_t game_seconds, bool running, int64_t now_us);
+cd_result_t clock_discipline_sample(clock_discipline_t *cd, int64_t ref_us, int64_t local_us, int64_t now_us);
+void clock_discipline_stepped(clock_discipline_t *cd);
+
+#endif
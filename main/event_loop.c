@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <string.h>
+#include "event_loop.h"
+
+void event_loop_init(event_loop_t *el, int64_t (*now_us)(void)) {
+    memset(el, 0, sizeof(*el));
+    el->now_us = now_us;
+}
+
+/* @brief Moves a timer to its place in order[] after its deadline changed
+ * @param pos Its current position
+ */
+static void event_loop_sort(event_loop_t *el, int pos) {
+    uint8_t id = el->order[pos];
+    int64_t deadline = el->timers[id].deadline_us;
+
+    // Earlier: towards the front
+    while (pos > 0) {
+        const event_loop_timer_t *prev = &el->timers[el->order[pos - 1]];
+        if (prev->deadline_us < deadline || (prev->deadline_us == deadline && el->order[pos - 1] < id)) {
+            break;
+        }
+        el->order[pos] = el->order[pos - 1];
+        pos--;
+    }
+    // Later: towards the back
+    while (pos < el->count - 1) {
+        const event_loop_timer_t *next = &el->timers[el->order[pos + 1]];
+        if (next->deadline_us > deadline || (next->deadline_us == deadline && el->order[pos + 1] > id)) {
+            break;
+        }
+        el->order[pos] = el->order[pos + 1];
+        pos++;
+    }
+    el->order[pos] = id;
+}
+
+static int event_loop_position(const event_loop_t *el, int id) {
+    for (int pos = 0; pos < el->count; pos++) {
+        if (el->order[pos] == id) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+/* @brief Adds a timer, ids are given in order and also break deadline ties
+ * @param deadline_us First run, EVENT_LOOP_PARK to wait for a kick
+ * @return Timer id, -1 if EVENT_LOOP_MAX_TIMERS are in use
+ */
+int event_loop_add(event_loop_t *el, const char *name, event_loop_fn_t fn, int64_t deadline_us) {
+    if (el->count == EVENT_LOOP_MAX_TIMERS) {
+        return -1;
+    }
+    int id = el->count++;
+    el->timers[id].name = name;
+    el->timers[id].fn = fn;
+    el->timers[id].deadline_us = deadline_us;
+    el->order[id] = id;
+    event_loop_sort(el, id);
+    return id;
+}
+
+/* @param slack_us How long the timer may wait past its deadline for another timer's wakeup */
+void event_loop_set_slack(event_loop_t *el, int id, int64_t slack_us) {
+    el->timers[id].slack_us = slack_us;
+}
+
+/* @brief Makes a timer due now, unless its deadline is earlier already; loop task only */
+void event_loop_kick(event_loop_t *el, int id) {
+    int64_t now = el->now_us();
+    event_loop_timer_t *t = &el->timers[id];
+
+    if (t->deadline_us > now) {
+        t->deadline_us = now;
+        t->kicks++;
+        event_loop_sort(el, event_loop_position(el, id));
+    }
+}
+
+/* @brief When the loop has to wake up: the earliest deadline plus its slack
+ * @return Time (us), EVENT_LOOP_PARK if every timer is parked
+ */
+int64_t event_loop_wake_at(event_loop_t *el) {
+    int64_t wake = EVENT_LOOP_PARK;
+
+    for (int id = 0; id < el->count; id++) {
+        const event_loop_timer_t *t = &el->timers[id];
+        if (t->deadline_us != EVENT_LOOP_PARK && t->deadline_us + t->slack_us < wake) {
+            wake = t->deadline_us + t->slack_us;
+        }
+    }
+    if (wake != EVENT_LOOP_PARK && wake > el->now_us()) {
+        el->wakeups++;
+    }
+    return wake;
+}
+
+/* @brief Runs the due timers in deadline order, each at most once
+ * @return Timers run
+ */
+int event_loop_run_due(event_loop_t *el) {
+    bool ran[EVENT_LOOP_MAX_TIMERS] = { false };
+    int runs = 0;
+
+    el->passes++;
+    for (;;) {
+        // Clock read again after every callback, a render takes a while
+        int64_t now = el->now_us();
+        int pos = 0;
+        while (pos < el->count && ran[el->order[pos]]) {
+            pos++;
+        }
+        if (pos == el->count || el->timers[el->order[pos]].deadline_us > now) {
+            break;
+        }
+
+        int id = el->order[pos];
+        event_loop_timer_t *t = &el->timers[id];
+        int64_t late = now - t->deadline_us;
+        t->runs++;
+        t->late_total_us += late;
+        if (late > t->late_max_us) {
+            t->late_max_us = late > INT32_MAX ? INT32_MAX : (int32_t)late;
+        }
+        t->deadline_us = t->fn(t->deadline_us, now);
+        ran[id] = true;
+        runs++;
+        event_loop_sort(el, pos);
+    }
+    if (runs == 0) {
+        el->idle_passes++;
+    }
+    return runs;
+}
+
+void event_loop_reset_stats(event_loop_t *el) {
+    for (int id = 0; id < el->count; id++) {
+        el->timers[id].runs = 0;
+        el->timers[id].kicks = 0;
+        el->timers[id].late_total_us = 0;
+        el->timers[id].late_max_us = 0;
+    }
+    el->passes = 0;
+    el->idle_passes = 0;
+    el->wakeups = 0;
+}
+
+void event_loop_print(const event_loop_t *el) {
+    printf("%lu passes, %lu with nothing due, %lu wakeups\n", (unsigned long)el->passes,
+           (unsigned long)el->idle_passes, (unsigned long)el->wakeups);
+    printf("%-8s %8s %8s %10s %10s %s\n", "timer", "runs", "kicks", "late avg", "late max", "next");
+    for (int id = 0; id < el->count; id++) {
+        const event_loop_timer_t *t = &el->timers[id];
+        printf("%-8s %8lu %8lu %7lu us %7ld us %s\n", t->name, (unsigned long)t->runs, (unsigned long)t->kicks,
+               (unsigned long)(t->runs ? t->late_total_us / t->runs : 0), (long)t->late_max_us,
+               t->deadline_us == EVENT_LOOP_PARK ? "parked" : "scheduled");
+    }
+}
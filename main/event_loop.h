@@ -0,0 +1,88 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+/* Deadline-ordered timer queue for the single-task execution model
+ *
+ * With CONFIG_APP_EVENT_LOOP (menuconfig, main/Kconfig.projbuild), app_main
+ * starts one app_loop_task instead of key_scan_task, lvgl_task and
+ * time_tracker_task. Key scan, game clock tick and LVGL are timers in one
+ * queue, kept sorted by deadline. The task blocks
+ * until the earliest deadline or a task notification (ui_cmd_post, the key
+ * wake interrupt, power_activity), runs every timer that is due in deadline
+ * order, and each callback returns its next deadline:
+ *
+ *   tick   previous deadline + game_clock.period_us (no drift, as before)
+ *   keys   now + 50 ms, or EVENT_LOOP_PARK while power idle (wake interrupt)
+ *   lvgl   now + lv_timer_handler() ms, or EVENT_LOOP_PARK while suspended
+ *
+ * A timer with slack may run up to slack_us after its deadline, so it rides
+ * along with the next wakeup of another timer instead of waking the core on
+ * its own: the key scan (EVENT_LOOP_KEY_SLACK_MS) mostly runs in an lvgl
+ * pass. event_loop_kick() makes a timer due right away; the loop kicks lvgl
+ * on every notification, so UI commands are applied as soon as with lvgl_task.
+ * Every timer runs at most once per event_loop_run_due(), a callback that
+ * keeps returning "now" cannot starve the others.
+ *
+ * Key scan, tick and LVGL no longer run on different cores and two stacks
+ * and TCBs are saved; in exchange a tick or key scan waits for a render in
+ * progress. The game state still has writers on core 0 (serial_link_task
+ * with GSI and the console, the replication tasks), they take the
+ * time_tracker lock as before. "loop" on the console shows runs and
+ * lateness per timer, "prof", "mem" and "latency" compare the two models.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/event_loop).
+ */
+
+#ifdef CONFIG_APP_EVENT_LOOP
+#define EVENT_LOOP              1               // One task and a timer queue
+#else
+#define EVENT_LOOP              0               // Three polling tasks
+#endif
+#define EVENT_LOOP_MAX_TIMERS   4
+#define EVENT_LOOP_PARK         INT64_MAX       // Deadline of a timer that waits for event_loop_kick()
+#define EVENT_LOOP_KEY_SLACK_MS 20              // Key scan may wait this long for another wakeup
+
+/* @return Next deadline (us), EVENT_LOOP_PARK to wait for a kick */
+typedef int64_t (*event_loop_fn_t)(int64_t deadline_us, int64_t now_us);
+
+typedef struct {
+    const char *name;
+    event_loop_fn_t fn;
+    int64_t deadline_us;
+    int64_t slack_us;               // May run this much later, with another timer
+
+    /* Statistics */
+    uint32_t runs;
+    uint32_t kicks;
+    int64_t late_total_us;          // Run time minus deadline
+    int32_t late_max_us;
+} event_loop_timer_t;
+
+typedef struct {
+    event_loop_timer_t timers[EVENT_LOOP_MAX_TIMERS];
+    uint8_t order[EVENT_LOOP_MAX_TIMERS];      // Timer ids by deadline, ties by id
+    uint8_t count;
+    int64_t (*now_us)(void);
+
+    /* Statistics */
+    uint32_t passes;                // event_loop_run_due() calls
+    uint32_t idle_passes;           // Nothing was due (woken early)
+    uint32_t wakeups;               // event_loop_wake_at() later than now, the task blocks
+} event_loop_t;
+
+void event_loop_init(event_loop_t *el, int64_t (*now_us)(void));
+int event_loop_add(event_loop_t *el, const char *name, event_loop_fn_t fn, int64_t deadline_us);
+void event_loop_set_slack(event_loop_t *el, int id, int64_t slack_us);
+void event_loop_kick(event_loop_t *el, int id);
+int64_t event_loop_wake_at(event_loop_t *el);
+int event_loop_run_due(event_loop_t *el);
+void event_loop_reset_stats(event_loop_t *el);
+void event_loop_print(const event_loop_t *el);
+
+#endif
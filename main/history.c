@@ -0,0 +1,173 @@
+#include <string.h>
+#include "history.h"
+
+typedef struct {
+    uint32_t seq;       // Number of events applied when the state was taken
+    GameState state;
+} history_checkpoint_t;
+
+static uint8_t events[HISTORY_MAX_EVENTS];
+static history_checkpoint_t checkpoints[HISTORY_CHECKPOINTS];
+static uint32_t head;   // Sequence number of the next event
+static uint32_t written;    // Highest head reached, events before written - MAX are overwritten
+static bool replaying;
+
+static void take_checkpoint(void) {
+    history_checkpoint_t *cp = &checkpoints[(head / HISTORY_CHECKPOINT_INTERVAL) % HISTORY_CHECKPOINTS];
+    cp->seq = head;
+    time_tracker_get_state(&cp->state);
+}
+
+static void record(uint8_t event) {
+    events[head % HISTORY_MAX_EVENTS] = event;
+    head++;
+    if (head > written) {
+        written = head;
+    }
+    if (head % HISTORY_CHECKPOINT_INTERVAL == 0) {
+        take_checkpoint();
+    }
+}
+
+static void apply(uint8_t event) {
+    if (event == HISTORY_EVT_TICK) {
+        time_tracker_tick();
+    } else {
+        process_key(event / 5, event % 5);
+    }
+}
+
+/* @brief Oldest sequence number that can still be restored
+ * @note Always a checkpoint boundary, so its events are all still in the ring.
+ *       Events recorded before a rewind also count, they overwrote older slots.
+ */
+static uint32_t oldest_seq(void) {
+    if (written <= HISTORY_MAX_EVENTS) {
+        return 0;
+    }
+    uint32_t oldest = written - HISTORY_MAX_EVENTS;
+    return (oldest + HISTORY_CHECKPOINT_INTERVAL - 1) / HISTORY_CHECKPOINT_INTERVAL * HISTORY_CHECKPOINT_INTERVAL;
+}
+
+/* @brief Restores the state after `target` events
+ * @note Listeners are muted, the caller reports the result
+ */
+static void restore(uint32_t target) {
+    uint32_t cp_seq = target / HISTORY_CHECKPOINT_INTERVAL * HISTORY_CHECKPOINT_INTERVAL;
+    history_checkpoint_t *cp = &checkpoints[(cp_seq / HISTORY_CHECKPOINT_INTERVAL) % HISTORY_CHECKPOINTS];
+
+    time_tracker_set_state(&cp->state);
+    for (uint32_t seq = cp_seq; seq < target; seq++) {
+        apply(events[seq % HISTORY_MAX_EVENTS]);
+    }
+    head = target;
+}
+
+/* @brief Starts a new history from the current state
+ * @param N/A
+ */
+void history_reset(void) {
+    time_tracker_lock();
+    head = 0;
+    written = 0;
+    take_checkpoint();
+    time_tracker_unlock();
+}
+
+/* @brief Records key presses and ticks, registered with time_tracker_add_listener()
+ * @param event tt_event_t
+ * @param arg Key code for TT_EVT_KEY
+ * @note Called with the time_tracker lock held, like every listener
+ */
+void history_listener(uint8_t event, uint8_t arg) {
+    if (replaying) {
+        return;
+    }
+    if (event == TT_EVT_SYNC) {
+        history_reset();  // Set from outside, earlier events no longer replay to this state
+    } else if (event == TT_EVT_TICK) {
+        record(HISTORY_EVT_TICK);
+    } else if (event == TT_EVT_KEY && arg < 10) {
+        record(arg);
+    }
+}
+
+/* @brief Number of events that can be rewound */
+uint32_t history_available(void) {
+    time_tracker_lock();
+    uint32_t available = head - oldest_seq();
+    time_tracker_unlock();
+    return available;
+}
+
+/* @brief Rewinds the last `steps` key presses and ticks
+ * @param steps Number of events to undo
+ * @return false if the history does not reach back that far
+ */
+bool history_rewind(uint32_t steps) {
+    time_tracker_lock();
+    if (steps == 0 || steps > history_available()) {
+        time_tracker_unlock();
+        return false;
+    }
+
+    replaying = true;
+    time_tracker_mute(true);
+    restore(head - steps);
+    time_tracker_mute(false);
+    replaying = false;
+
+    time_tracker_emit(TT_EVT_REWIND, steps > 255 ? 255 : steps);
+    time_tracker_unlock();
+    return true;
+}
+
+/* @brief Removes the most recent key press as if it never happened
+ * @param N/A
+ * @return false if no key press is among the last HISTORY_UNDO_WINDOW events
+ * @note Ticks after the key press are replayed, so running timers keep their progress
+ */
+bool history_undo_last_key(void) {
+    static uint8_t tail[HISTORY_UNDO_WINDOW];
+    if (time_tracker_redirect_input(TT_INPUT_UNDO)) {
+        return true;
+    }
+    time_tracker_lock();
+    uint32_t oldest = oldest_seq();
+    if (head - oldest > HISTORY_UNDO_WINDOW) {
+        oldest = head - HISTORY_UNDO_WINDOW;
+    }
+    uint32_t key_seq = head;
+
+    while (key_seq > oldest) {
+        if (events[(key_seq - 1) % HISTORY_MAX_EVENTS] != HISTORY_EVT_TICK) {
+            break;
+        }
+        key_seq--;
+    }
+    if (key_seq == oldest) {
+        time_tracker_unlock();
+        return false;
+    }
+    key_seq--;  // Index of the key event
+
+    uint8_t key = events[key_seq % HISTORY_MAX_EVENTS];
+    uint32_t tail_len = head - key_seq - 1;
+    for (uint32_t i = 0; i < tail_len; i++) {
+        tail[i] = events[(key_seq + 1 + i) % HISTORY_MAX_EVENTS];
+    }
+
+    replaying = true;
+    time_tracker_mute(true);
+    restore(key_seq);
+    for (uint32_t i = 0; i < tail_len; i++) {
+        apply(tail[i]);
+        record(tail[i]);
+    }
+    time_tracker_mute(false);
+    replaying = false;
+
+    time_tracker_emit(TT_EVT_UNDO, key);
+    time_tracker_unlock();
+    return true;
+}
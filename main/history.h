@@ -0,0 +1,36 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "time_tracker.h"
+
+/* Undo / rewind of game state changes
+ *
+ * Every key press and tick is recorded as a one byte event. A full GameState
+ * checkpoint is kept every HISTORY_CHECKPOINT_INTERVAL events, so rewinding
+ * restores the nearest checkpoint and replays at most that many events.
+ * Undo replays the ticks after the removed key press as well, so only a key
+ * press among the last HISTORY_UNDO_WINDOW events can be undone: at most
+ * twice the checkpoint interval is replayed.
+ *
+ * No ESP-IDF dependencies, builds on a host together with time_tracker.c.
+ * Runs under the time_tracker lock, so a restore is never interleaved with a
+ * tick, key press or sync from another task; those wait and apply after it.
+ */
+
+#define HISTORY_MAX_EVENTS          512
+#define HISTORY_CHECKPOINT_INTERVAL 32
+#define HISTORY_CHECKPOINTS         (HISTORY_MAX_EVENTS / HISTORY_CHECKPOINT_INTERVAL + 1)
+#define HISTORY_UNDO_WINDOW         HISTORY_CHECKPOINT_INTERVAL     // About 30 s of ticks
+
+#define HISTORY_EVT_TICK            0xFF    // Any other value is a key code (row * 5 + col)
+
+void history_reset(void);
+void history_listener(uint8_t event, uint8_t arg);
+uint32_t history_available(void);
+bool history_rewind(uint32_t steps);
+bool history_undo_last_key(void);
+
+#endif
@@ -0,0 +1,211 @@
+#include <stdlib.h>
+#include <string.h>
+#include "latency_trace.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+static portMUX_TYPE lt_mux = portMUX_INITIALIZER_UNLOCKED;
+#define LT_LOCK()   portENTER_CRITICAL(&lt_mux)
+#define LT_UNLOCK() portEXIT_CRITICAL(&lt_mux)
+#else
+#define LT_LOCK()
+#define LT_UNLOCK()
+#endif
+
+typedef struct {
+    bool used;
+    uint16_t id;
+    uint8_t key;
+    uint8_t stage;              // Last stage stamped
+    int64_t t[LT_STAGES];
+    int32_t x1, y1, x2, y2;     // Label area, from INVALIDATE
+} lt_trace_t;
+
+const char *const lt_stage_names[LT_STAGES] = {
+    "gpio", "debounce", "process", "state", "invalidate", "render", "flush"
+};
+
+static int64_t (*clock_us)(void) = NULL;
+static lt_trace_t inflight[LT_INFLIGHT];
+static uint32_t history[LT_HISTORY][LT_STAGES];    // Stage times relative to GPIO
+static uint32_t history_count = 0;
+static uint32_t completed = 0;
+static uint32_t abandoned = 0;
+static uint16_t next_id = 0;
+static uint16_t last_id = 0;
+
+void latency_trace_init(int64_t (*now_us)(void)) {
+    clock_us = now_us;
+    memset(inflight, 0, sizeof(inflight));
+    history_count = 0;
+    completed = 0;
+    abandoned = 0;
+}
+
+static void lt_expire(int64_t now) {
+    for (int i = 0; i < LT_INFLIGHT; i++) {
+        if (inflight[i].used && now - inflight[i].t[LT_GPIO] > LT_TIMEOUT_US) {
+            inflight[i].used = false;
+            abandoned++;
+        }
+    }
+}
+
+/* @brief Starts a trace, the scan just saw the key down
+ * @param key Key code (row * 5 + col), only K1 - K5 are traced
+ */
+void latency_trace_begin(uint8_t key) {
+    if (clock_us == NULL || key >= LT_KEYS) {
+        return;
+    }
+    int64_t now = clock_us();
+    LT_LOCK();
+    lt_expire(now);
+    lt_trace_t *slot = NULL;
+    for (int i = 0; i < LT_INFLIGHT && slot == NULL; i++) {
+        if (!inflight[i].used) {
+            slot = &inflight[i];
+        }
+    }
+    if (slot == NULL) {
+        // Oldest one gives way
+        slot = &inflight[0];
+        for (int i = 1; i < LT_INFLIGHT; i++) {
+            if (inflight[i].t[LT_GPIO] < slot->t[LT_GPIO]) {
+                slot = &inflight[i];
+            }
+        }
+        abandoned++;
+    }
+    memset(slot, 0, sizeof(*slot));
+    slot->used = true;
+    slot->id = next_id++;
+    slot->key = key;
+    slot->stage = LT_GPIO;
+    slot->t[LT_GPIO] = now;
+    LT_UNLOCK();
+}
+
+/* @brief Stamps a per-key stage (DEBOUNCE, PROCESS, STATE) on the oldest trace of that key waiting for it */
+void latency_trace_stamp(uint8_t key, lt_stage_t stage) {
+    if (clock_us == NULL || key >= LT_KEYS || stage == LT_GPIO) {
+        return;
+    }
+    int64_t now = clock_us();
+    LT_LOCK();
+    lt_trace_t *best = NULL;
+    for (int i = 0; i < LT_INFLIGHT; i++) {
+        lt_trace_t *t = &inflight[i];
+        if (t->used && t->key == key && t->stage == stage - 1 &&
+            (best == NULL || t->t[LT_GPIO] < best->t[LT_GPIO])) {
+            best = t;
+        }
+    }
+    if (best != NULL) {
+        best->t[stage] = now;
+        best->stage = stage;
+    }
+    LT_UNLOCK();
+}
+
+/* @brief The hero label of a key got new text, covering the given area */
+void latency_trace_invalidate(uint8_t key, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    if (clock_us == NULL || key >= LT_KEYS) {
+        return;
+    }
+    int64_t now = clock_us();
+    LT_LOCK();
+    for (int i = 0; i < LT_INFLIGHT; i++) {
+        lt_trace_t *t = &inflight[i];
+        if (t->used && t->key == key && t->stage == LT_STATE) {
+            t->t[LT_INVALIDATE] = now;
+            t->stage = LT_INVALIDATE;
+            t->x1 = x1;
+            t->y1 = y1;
+            t->x2 = x2;
+            t->y2 = y2;
+        }
+    }
+    LT_UNLOCK();
+}
+
+/* @brief An LVGL refresh started, it renders everything invalidated so far */
+void latency_trace_render_start(void) {
+    if (clock_us == NULL) {
+        return;
+    }
+    int64_t now = clock_us();
+    LT_LOCK();
+    for (int i = 0; i < LT_INFLIGHT; i++) {
+        if (inflight[i].used && inflight[i].stage == LT_INVALIDATE) {
+            inflight[i].t[LT_RENDER] = now;
+            inflight[i].stage = LT_RENDER;
+        }
+    }
+    LT_UNLOCK();
+}
+
+/* @brief A flush of the given area finished; completes traces whose label it finishes */
+void latency_trace_flush_done(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    if (clock_us == NULL) {
+        return;
+    }
+    int64_t now = clock_us();
+    LT_LOCK();
+    for (int i = 0; i < LT_INFLIGHT; i++) {
+        lt_trace_t *t = &inflight[i];
+        // Partial buffers are flushed top to bottom, the label is done with the flush holding its last row
+        if (!t->used || t->stage != LT_RENDER || x2 < t->x1 || x1 > t->x2 || y1 > t->y2 || y2 < t->y2) {
+            continue;
+        }
+        t->t[LT_FLUSH] = now;
+        uint32_t *h = history[history_count % LT_HISTORY];
+        for (int s = 0; s < LT_STAGES; s++) {
+            h[s] = (uint32_t)(t->t[s] - t->t[LT_GPIO]);
+        }
+        history_count++;
+        completed++;
+        last_id = t->id;
+        t->used = false;
+    }
+    LT_UNLOCK();
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void lt_stat(uint32_t *values, uint32_t n, lt_stat_t *out) {
+    qsort(values, n, sizeof(values[0]), cmp_u32);
+    out->count = n;
+    out->p50_us = n ? values[n / 2] : 0;
+    out->p99_us = n ? values[(n * 99) / 100] : 0;
+    out->max_us = n ? values[n - 1] : 0;
+}
+
+/* @brief Percentiles of the last LT_HISTORY completed traces */
+void latency_trace_report(lt_report_t *out) {
+    static uint32_t rows[LT_HISTORY][LT_STAGES];
+    uint32_t values[LT_HISTORY];
+
+    LT_LOCK();
+    uint32_t n = history_count < LT_HISTORY ? history_count : LT_HISTORY;
+    memcpy(rows, history, sizeof(rows));
+    out->completed = completed;
+    out->abandoned = abandoned;
+    out->last_id = last_id;
+    LT_UNLOCK();
+
+    memset(&out->stage[LT_GPIO], 0, sizeof(out->stage[LT_GPIO]));
+    for (int s = 1; s < LT_STAGES; s++) {
+        for (uint32_t i = 0; i < n; i++) {
+            values[i] = rows[i][s] - rows[i][s - 1];
+        }
+        lt_stat(values, n, &out->stage[s]);
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        values[i] = rows[i][LT_FLUSH];
+    }
+    lt_stat(values, n, &out->total);
+}
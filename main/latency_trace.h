@@ -0,0 +1,70 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Key-to-photon latency tracer for K1 - K5
+ *
+ * Each press gets an ID and is timestamped at every stage on its way to the
+ * panel. A stage is only stamped if the previous one was, so presses from
+ * other sources (touch, replication, history) are not traced.
+ *
+ *   GPIO       first scan that saw the key down      (keyboard.c)
+ *   DEBOUNCE   press accepted after the lockout      (keyboard.c)
+ *   PROCESS    process_key() called                  (keyboard.c)
+ *   STATE      hero timer started / ended            (time tracker listener)
+ *   INVALIDATE hero label text set by hero_timer     (display.c)
+ *   RENDER     next LVGL refresh started             (display.c)
+ *   FLUSH      flush reaching the label's bottom row (display.c, my_flush_cb)
+ *
+ * Presses that do not reach FLUSH within LT_TIMEOUT_US are abandoned.
+ * The clock is injected, so tools/latency simulates the stages on a host.
+ *
+ * No ESP-IDF dependencies, builds on a host (tools/latency).
+ */
+
+#define LT_INFLIGHT     8       // Presses traced at the same time
+#ifndef LT_HISTORY
+#define LT_HISTORY      64      // Completed traces kept for the percentiles
+#endif
+#define LT_TIMEOUT_US   3000000
+#define LT_KEYS         5       // K1 - K5
+
+typedef enum {
+    LT_GPIO,
+    LT_DEBOUNCE,
+    LT_PROCESS,
+    LT_STATE,
+    LT_INVALIDATE,
+    LT_RENDER,
+    LT_FLUSH,
+    LT_STAGES
+} lt_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} lt_stat_t;
+
+typedef struct {
+    lt_stat_t stage[LT_STAGES];     // Time from the previous stage, [LT_GPIO] is unused
+    lt_stat_t total;                // GPIO to FLUSH
+    uint32_t completed;
+    uint32_t abandoned;
+    uint16_t last_id;
+} lt_report_t;
+
+extern const char *const lt_stage_names[LT_STAGES];
+
+void latency_trace_init(int64_t (*now_us)(void));
+void latency_trace_begin(uint8_t key);
+void latency_trace_stamp(uint8_t key, lt_stage_t stage);
+void latency_trace_invalidate(uint8_t key, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+void latency_trace_render_start(void);
+void latency_trace_flush_done(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+void latency_trace_report(lt_report_t *out);
+
+#endif
@@ -3,69 +3,361 @@
 #include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "keyboard.h"
 #include "display.h"
+#include "ui_cmd.h"
+#include "frame_capture.h"
 #include "gpio_setup.h"
 #include "lvgl.h"
 #include "esp_heap_caps.h"
+#include "journal.h"
+#include "checkpoint.h"
+#include "telemetry.h"
+#include "serial_link.h"
+#include "gsi.h"
+#include "replication.h"
+#include "touch.h"
+#include "profiler.h"
+#include "dlog.h"
+#include "static_mem.h"
+#include "power.h"
+#include "nvs_flash.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_private/esp_clk.h"
 
 #include "time_tracker.h"
+#include "history.h"
+#include "clock_discipline.h"
+#include "latency_trace.h"
+#include "event_loop.h"
 #include "display.h"
 
+#define KEY_SCAN_PERIOD_MS 50
+
+static SemaphoreHandle_t game_lock;
+
+static void game_lock_take(void) {
+    xSemaphoreTakeRecursive(game_lock, portMAX_DELAY);
+}
+
+static void game_lock_give(void) {
+    xSemaphoreGiveRecursive(game_lock);
+}
+
 void key_scan_task(void *pvParameters) {
+    power_set_owner(xTaskGetCurrentTaskHandle());
     while (1) {
         scan_keys();
-        vTaskDelay(pdMS_TO_TICKS(50));  // Adjust scan rate as needed
+        TickType_t idle_wait = power_update();
+        // Idle: no polling, a key or touch interrupt (or power_activity) wakes us,
+        // once nothing is held any more
+        if (idle_wait == 0 || !keys_arm_wakeup()) {
+            vTaskDelay(pdMS_TO_TICKS(KEY_SCAN_PERIOD_MS));  // Adjust scan rate as needed
+            continue;
+        }
+        bool woken = ulTaskNotifyTake(pdTRUE, idle_wait) > 0;
+        keys_disarm_wakeup();
+        if (woken) {
+            power_activity();   // Back to ACTIVE on the power_update() after this scan
+        }
     }
 }
 
+#define LVGL_TASK_MAX_IDLE_MS 100
+
 void lvgl_task(void *pvParameters) {
+    ui_cmd_set_owner(xTaskGetCurrentTaskHandle());
     while (1) {
-        lv_task_handler();              // Handle LVGL events
-        vTaskDelay(pdMS_TO_TICKS(10));   // ~200 Hz refresh
+        display_apply_ui_commands();    // Everything posted since the last pass, one batch
+        if (display_ui_suspended()) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);    // Power idle until UI_CMD_RESUME is posted
+            continue;
+        }
+        uint32_t idle_ms = lv_timer_handler();  // Handle LVGL events, returns ms until the next timer
+        if (idle_ms > LVGL_TASK_MAX_IDLE_MS) {
+            idle_ms = LVGL_TASK_MAX_IDLE_MS;
+        }
+        TickType_t ticks = pdMS_TO_TICKS(idle_ms);
+        ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);  // ui_cmd_post wakes us early
     }
 }
 
 void time_tracker_task(void *pvParameters) {
+    int64_t next_tick_us = esp_timer_get_time();
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(1000));  // Delay *after* ticking
-        if(all_timers_active && game_timer_active) {
-            game_timer_seconds++;
-            if (game_timer_seconds >= 60) {
-                game_timer_seconds = 0;
-                game_timer_minutes++;
-            }
-            // Update all active hero timers
-            for (int i = 0; i < HERO_COUNT; i++) {
-                if (hero_timers[i].active) {
-                    if (hero_timers[i].seconds == 0) {
-                        if (hero_timers[i].minutes == 0) {
-                            hero_timers[i].active = false; // Timer done
-                        } else {
-                            hero_timers[i].minutes--;
-                            hero_timers[i].seconds = 59;
-                        }
-                    } else {
-                        hero_timers[i].seconds--;
-                    }
-                }
+        // Deadline based, the period is stretched or shortened while the clock is slewed
+        next_tick_us += game_clock.period_us;
+        int64_t wait_us = next_tick_us - esp_timer_get_time();
+        if (wait_us > 0) {
+            vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+        }
+        profiler_record_wakeup(next_tick_us, esp_timer_get_time());
+        clock_discipline_tick(&game_clock, esp_timer_get_time());
+        if (!replication_clock_is_remote()) {
+            time_tracker_tick();  // A secondary gets its ticks from the primary
+        }
+    }
+}
+
+#if EVENT_LOOP
+static event_loop_t app_loop;
+static int loop_keys = -1;
+static int loop_lvgl = -1;
+static bool keys_armed = false;     // Key wake interrupt armed, power idle
+
+/* @brief Game clock tick, deadline based like time_tracker_task */
+static int64_t loop_tick(int64_t deadline_us, int64_t now_us) {
+    profiler_record_wakeup(deadline_us, now_us);
+    clock_discipline_tick(&game_clock, now_us);
+    if (!replication_clock_is_remote()) {
+        time_tracker_tick();  // A secondary gets its ticks from the primary
+    }
+    return deadline_us + game_clock.period_us;
+}
+
+/* @brief Key scan every KEY_SCAN_PERIOD_MS, parked on the wake interrupt while power idle */
+static int64_t loop_key_scan(int64_t deadline_us, int64_t now_us) {
+    if (keys_armed) {
+        keys_armed = false;
+        if (keys_disarm_wakeup()) {
+            power_activity();   // Back to ACTIVE on the power_update() after this scan
+        }
+    }
+    scan_keys();
+    TickType_t idle_wait = power_update();
+    if (idle_wait == 0 || !keys_arm_wakeup()) {
+        return now_us + KEY_SCAN_PERIOD_MS * 1000;  // Active, or idle with a key still held
+    }
+    keys_armed = true;
+    return idle_wait == portMAX_DELAY ? EVENT_LOOP_PARK : now_us + (int64_t)pdTICKS_TO_MS(idle_wait) * 1000;
+}
+
+/* @brief UI commands and LVGL timers, parked while the UI is suspended */
+static int64_t loop_lvgl_pass(int64_t deadline_us, int64_t now_us) {
+    display_apply_ui_commands();    // Everything posted since the last pass, one batch
+    if (display_ui_suspended()) {
+        return EVENT_LOOP_PARK;     // Power idle until UI_CMD_RESUME is posted
+    }
+    uint32_t idle_ms = lv_timer_handler();
+    if (idle_ms > LVGL_TASK_MAX_IDLE_MS) {
+        idle_ms = LVGL_TASK_MAX_IDLE_MS;
+    }
+    return esp_timer_get_time() + (idle_ms > 0 ? idle_ms : 1) * 1000;
+}
+
+/* @brief Key scan, game clock and LVGL in one task, instead of the three above */
+void app_loop_task(void *pvParameters) {
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+
+    power_set_owner(xTaskGetCurrentTaskHandle());
+    ui_cmd_set_owner(xTaskGetCurrentTaskHandle());
+    while (1) {
+        event_loop_run_due(&app_loop);
+        int64_t next = event_loop_wake_at(&app_loop);
+        int64_t wait_us = next - esp_timer_get_time();
+        // Rounded up, waking before the deadline would only make an empty pass
+        TickType_t ticks = next == EVENT_LOOP_PARK ? portMAX_DELAY :
+                           wait_us <= 0 ? 0 : (TickType_t)((wait_us + tick_us - 1) / tick_us);
+        if (ulTaskNotifyTake(pdTRUE, ticks) > 0) {
+            // ui_cmd_post, power_activity or the key wake interrupt
+            event_loop_kick(&app_loop, loop_lvgl);
+            if (keys_armed) {
+                event_loop_kick(&app_loop, loop_keys);
             }
         }
     }
 }
 
+/* @brief Console: loop [reset], runs and lateness of the app_loop_task timers */
+static void loop_command(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+        event_loop_reset_stats(&app_loop);  // Racy against app_loop_task, counters only
+        return;
+    }
+    event_loop_print(&app_loop);
+}
+#endif
+
+/* @brief Forwards game events to the flash journal (ticks are implied by game time) */
+static void journal_listener(uint8_t event, uint8_t arg) {
+    if (event != TT_EVT_TICK) {
+        journal_log(event, arg);
+    }
+}
+
+/* @brief Frame capture packets go out on the telemetry UART, between snapshot records */
+static void capture_uart_sink(const void *data, size_t len, void *ctx) {
+    telemetry_write_raw(data, len);
+}
+
+/* @brief Visual feedback for hero keys and undo, posted to lvgl_task */
+static void ui_listener(uint8_t event, uint8_t arg) {
+    if (event == TT_EVT_HERO_START || event == TT_EVT_HERO_END) {
+        ui_cmd_post(UI_CMD_FLASH_ROW, arg);
+    } else if (event == TT_EVT_HERO_EXPIRED) {
+        ui_cmd_post(UI_CMD_EXPIRED_ROW, arg);
+    } else if (event == TT_EVT_UNDO) {
+        ui_cmd_post_text(UI_CMD_TOAST, "Undo");
+    } else if (event == TT_EVT_REWIND) {
+        ui_cmd_post_text(UI_CMD_TOAST, "Rewind");
+    }
+}
+
+/* @brief Hero state changes end the STATE stage of a traced key press */
+static void latency_listener(uint8_t event, uint8_t arg) {
+    if (event == TT_EVT_HERO_START || event == TT_EVT_HERO_END) {
+        latency_trace_stamp(arg, LT_STATE);
+    }
+}
+
+/* @brief Console: key-to-photon latency per stage */
+static void latency_command(int argc, char **argv) {
+    static lt_report_t report;
+
+    latency_trace_report(&report);
+    printf("%lu completed, %lu abandoned, last id %u\n", (unsigned long)report.completed,
+           (unsigned long)report.abandoned, report.last_id);
+    for (int s = LT_DEBOUNCE; s < LT_STAGES; s++) {
+        printf("%-10s p50 %7lu  p99 %7lu  max %7lu us\n", lt_stage_names[s],
+               (unsigned long)report.stage[s].p50_us, (unsigned long)report.stage[s].p99_us,
+               (unsigned long)report.stage[s].max_us);
+    }
+    printf("%-10s p50 %7lu  p99 %7lu  max %7lu us\n", "total", (unsigned long)report.total.p50_us,
+           (unsigned long)report.total.p99_us, (unsigned long)report.total.max_us);
+}
+
+/* @brief Console: history [rewind <events> | undo] */
+static void history_command(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "rewind") == 0) {
+        if (replication_clock_is_remote()) {
+            printf("Secondary: rewind on the primary\n");
+            return;
+        }
+        uint32_t steps = (uint32_t)atoi(argv[2]);
+        if (!history_rewind(steps)) {
+            printf("Can rewind 1 - %lu events\n", (unsigned long)history_available());
+            return;
+        }
+    } else if (argc >= 2 && strcmp(argv[1], "undo") == 0) {
+        if (!history_undo_last_key()) {
+            printf("No key press in the last %d events\n", HISTORY_UNDO_WINDOW);
+            return;
+        }
+    }
+    printf("%lu events available to rewind\n", (unsigned long)history_available());
+}
 
 void app_main(void) {
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+
+    // One writer of the game state at a time: key scan, tick, touch, GSI, replication, undo
+#if STATIC_ALLOC
+    static StaticSemaphore_t game_lock_buf;
+    game_lock = xSemaphoreCreateRecursiveMutexStatic(&game_lock_buf);
+#else
+    game_lock = xSemaphoreCreateRecursiveMutex();
+#endif
+    time_tracker_set_lock(game_lock_take, game_lock_give);
+
+    // Restore before anything listens or draws, so the first frame is already correct
+    checkpoint_source_t resumed = checkpoint_restore();
+
+    journal_init();
+    time_tracker_add_listener(journal_listener);
+    time_tracker_add_listener(checkpoint_listener);
+    history_reset();
+    time_tracker_add_listener(history_listener);
+    telemetry_init();
+    time_tracker_add_listener(telemetry_listener);
+    frame_capture_init(capture_uart_sink, NULL, esp_timer_get_time);
+    serial_link_init();
+    static_mem_init();
+    dlog_init();
+    profiler_init();
+    latency_trace_init(esp_timer_get_time);
+    time_tracker_add_listener(latency_listener);
+    time_tracker_add_listener(ui_listener);
+    power_init();
+    time_tracker_add_listener(power_listener);
+    serial_link_register_command("latency", "Key-to-photon latency per stage (K1 - K5)", latency_command);
+    serial_link_register_command("history", "history [rewind <events> | undo]", history_command);
+    gsi_init();
+    replication_init();
+    time_tracker_add_listener(replication_listener);
     init_keys();
-    gpio_setup();  // Your own custom GPIO init, presumably for display
+    gpio_setup(resumed != CHECKPOINT_NONE);  // Your own custom GPIO init, presumably for display
+    touch_init(NULL);  // Needs LVGL up (input device), the controller is reset in touch_task
 
+    if (resumed != CHECKPOINT_NONE) {
+        lv_refr_now(NULL);  // Render and flush the restored timers right away
+        // esp_timer starts with the app, the RTC timer at power-on and runs through ROM and bootloader
+        int64_t app_ms = esp_timer_get_time() / 1000;
+        if (esp_reset_reason() == ESP_RST_POWERON) {
+            int64_t reset_ms = (int64_t)(esp_clk_rtc_time() / 1000);
+            ESP_LOGI("MAIN", "Match restored, first frame %lld ms after reset (ROM and bootloader %lld ms)",
+                     reset_ms, reset_ms - app_ms);
+        } else {
+            // Other resets keep the RTC timer running, there is no clock that starts at the reset
+            ESP_LOGI("MAIN", "Match restored, first frame %lld ms after app start (ROM and bootloader not measured)",
+                     app_ms);
+        }
+    }
+
+#if EVENT_LOOP
+    // Create the app loop task on core 1 (key scan, game clock tick and LVGL, tick first on a tie)
+    event_loop_init(&app_loop, esp_timer_get_time);
+    event_loop_add(&app_loop, "tick", loop_tick, esp_timer_get_time() + game_clock.period_us);
+    loop_keys = event_loop_add(&app_loop, "keys", loop_key_scan, esp_timer_get_time());
+    event_loop_set_slack(&app_loop, loop_keys, EVENT_LOOP_KEY_SLACK_MS * 1000);   // Rides along with lvgl passes
+    loop_lvgl = event_loop_add(&app_loop, "lvgl", loop_lvgl_pass, esp_timer_get_time());
+    serial_link_register_command("loop", "App loop timers, runs and lateness, loop [reset]", loop_command);
+    static_mem_task_create(app_loop_task, "app_loop_task", STACK_APP_LOOP, 6, 1);
+#else
     // Create key scan task on core 0
-    xTaskCreatePinnedToCore(key_scan_task, "key_scan_task", 2048, NULL, 5, NULL, 0);
+    static_mem_task_create(key_scan_task, "key_scan_task", STACK_KEY_SCAN, 5, 0);
 
     // Create LVGL task on core 1
-    xTaskCreatePinnedToCore(lvgl_task, "lvgl_task", 8192, NULL, 6, NULL, 1);
+    static_mem_task_create(lvgl_task, "lvgl_task", STACK_LVGL, 6, 1);
 
     // Create time tracker task (on core 1, or change as needed)
-    xTaskCreatePinnedToCore(time_tracker_task, "time_tracker_task", 2048, NULL, 4, NULL, 1);
+    static_mem_task_create(time_tracker_task, "time_tracker_task", STACK_TIME_TRACKER, 4, 1);
+#endif
+
+    // Create journal task (low priority, commits RAM pages to flash)
+    static_mem_task_create(journal_task, "journal_task", STACK_JOURNAL, 2, 0);
+
+    // Create checkpoint task (low priority, rate-limited NVS snapshots)
+    static_mem_task_create(checkpoint_task, "checkpoint_task", STACK_CHECKPOINT, 2, 0);
+
+    // Create telemetry task (streams state snapshots over UART)
+    static_mem_task_create(telemetry_task, "telemetry_task", STACK_TELEMETRY, 3, 0);
+
+    // Create serial link task (GSI payloads and console commands from the PC over native USB)
+    static_mem_task_create(serial_link_task, "serial_link_task", STACK_SERIAL_LINK, 3, 0);
+
+    // Create replication tasks (state to secondaries, inputs back to the primary)
+    if (replication_get_role() != REPLICATION_OFF) {
+        static_mem_task_create(replication_tx_task, "repl_tx_task", STACK_REPL_TX, 4, 0);
+        static_mem_task_create(replication_rx_task, "repl_rx_task", STACK_REPL_RX, 4, 0);
+    }
+
+    // Create deferred log task (formats DLOG records off the hot paths)
+    static_mem_task_create(dlog_task, "dlog_task", STACK_DLOG, 1, 0);
+
+    // Create profiler task (console "prof" reports and periodic dumps)
+    static_mem_task_create(profiler_task, "profiler_task", STACK_PROFILER, 1, 0);
+
+    // Create touch task (woken by TP_INT, reads the controller over I2C)
+    static_mem_task_create(touch_task, "touch_task", STACK_TOUCH, 5, 0);
+
+    // Everything allocated from here on is unexpected, see "mem" / "mem soak"
+    static_mem_boot_done();
 }
\ No newline at end of file
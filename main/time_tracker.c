@@ -1,5 +1,9 @@
+#include <string.h>
 #include "time_tracker.h"
 
+// Longer jumps leave hero timers no further to move
+#define SYNC_MAX_HERO_STEPS (HERO_START_MIN * 60 + HERO_START_SEC)
+
 volatile uint32_t game_timer_minutes;
 volatile uint8_t game_timer_seconds;
 volatile uint8_t game_timer_active;
@@ -12,4 +16,376 @@ volatile uint8_t start_up_buybacks;
 volatile int user_data;
 uint8_t something_happened;
 
-uint8_t indexing;
\ No newline at end of file
+uint8_t indexing;
+
+static time_tracker_listener_t listeners[TIME_TRACKER_MAX_LISTENERS];
+static int listener_count;
+static bool listeners_muted;
+static time_tracker_input_hook_t input_hook;
+static time_tracker_lock_fn_t lock_fn;
+static time_tracker_lock_fn_t unlock_fn;
+
+/* @brief Installs the lock taken by every function that changes the game state
+ * @param lock Recursive, NULL on single-threaded hosts
+ * @param unlock Releases it
+ * @note Key scan, tick, touch, GSI, replication and history restores run on
+ *       different tasks; listeners are called with the lock held, so none of
+ *       them sees another writer's change halfway
+ */
+void time_tracker_set_lock(time_tracker_lock_fn_t lock, time_tracker_lock_fn_t unlock) {
+    lock_fn = lock;
+    unlock_fn = unlock;
+}
+
+/* @brief Holds off every other writer, for read-modify-write sequences outside this file */
+void time_tracker_lock(void) {
+    if (lock_fn != NULL) {
+        lock_fn();
+    }
+}
+
+void time_tracker_unlock(void) {
+    if (unlock_fn != NULL) {
+        unlock_fn();
+    }
+}
+
+/* @brief Registers a callback for state change events
+ * @param listener Called from whichever task changed the state
+ * @return false if the listener table is full
+ */
+bool time_tracker_add_listener(time_tracker_listener_t listener) {
+    if (listener_count == TIME_TRACKER_MAX_LISTENERS) {
+        return false;
+    }
+    listeners[listener_count++] = listener;
+    return true;
+}
+
+void time_tracker_emit(uint8_t event, uint8_t arg) {
+    time_tracker_lock();
+    if (!listeners_muted) {
+        for (int i = 0; i < listener_count; i++) {
+            listeners[i](event, arg);
+        }
+    }
+    time_tracker_unlock();
+}
+
+/* @brief Suppresses events while a state is rebuilt (undo / rewind replay)
+ * @param muted true to stop notifying listeners
+ */
+void time_tracker_mute(bool muted) {
+    listeners_muted = muted;
+}
+
+/* @brief Lets another module take key presses instead of applying them here
+ * @param hook NULL to apply inputs locally again
+ */
+void time_tracker_set_input_hook(time_tracker_input_hook_t hook) {
+    input_hook = hook;
+}
+
+/* @brief Offers an input to the hook
+ * @param input Key code (row * 5 + col) or TT_INPUT_UNDO
+ * @return true if the hook took it and it must not be applied locally
+ */
+bool time_tracker_redirect_input(uint8_t input) {
+    return input_hook != NULL && input_hook(input);
+}
+
+void time_tracker_get_state(GameState *out) {
+    time_tracker_lock();
+    out->game_minutes = game_timer_minutes;
+    out->game_seconds = game_timer_seconds;
+    out->game_timer_active = game_timer_active;
+    out->all_timers_active = all_timers_active;
+    memcpy(out->heroes, hero_timers, sizeof(hero_timers));
+    time_tracker_unlock();
+}
+
+void time_tracker_set_state(const GameState *in) {
+    time_tracker_lock();
+    game_timer_minutes = in->game_minutes;
+    game_timer_seconds = in->game_seconds;
+    game_timer_active = in->game_timer_active;
+    all_timers_active = in->all_timers_active;
+    memcpy(hero_timers, in->heroes, sizeof(hero_timers));
+    time_tracker_unlock();
+}
+
+/* @brief Counts every active hero timer down by one second
+ * @return Bit mask of the heroes whose timer expired
+ */
+static uint8_t advance_hero_timers(void) {
+    uint8_t expired = 0;
+    for (int i = 0; i < HERO_COUNT; i++) {
+        if (hero_timers[i].active) {
+            if (hero_timers[i].seconds == 0) {
+                if (hero_timers[i].minutes == 0) {
+                    hero_timers[i].active = false; // Timer done
+                    expired |= 1 << i;
+                } else {
+                    hero_timers[i].minutes--;
+                    hero_timers[i].seconds = 59;
+                }
+            } else {
+                hero_timers[i].seconds--;
+            }
+        }
+    }
+    return expired;
+}
+
+/* @brief Counts every active hero timer up by one second, capped at 8:00
+ * @param N/A
+ */
+static void rewind_hero_timers(void) {
+    for (int i = 0; i < HERO_COUNT; i++) {
+        if (hero_timers[i].active) {
+            uint16_t total_secs = hero_timers[i].minutes * 60 + hero_timers[i].seconds;
+            if (total_secs < HERO_START_MIN * 60 + HERO_START_SEC) {
+                hero_timers[i].seconds++;
+                if (hero_timers[i].seconds >= 60) {
+                    hero_timers[i].seconds = 0;
+                    hero_timers[i].minutes++;
+                }
+            }
+        }
+    }
+}
+
+static void emit_expired(uint8_t expired) {
+    for (int i = 0; i < HERO_COUNT; i++) {
+        if (expired & (1 << i)) {
+            time_tracker_emit(TT_EVT_HERO_EXPIRED, i);
+        }
+    }
+}
+
+void start_hero_timer(int index) {
+    time_tracker_lock();
+    hero_timers[index].minutes = HERO_START_MIN;
+    hero_timers[index].seconds = HERO_START_SEC;
+    hero_timers[index].active = true;
+    time_tracker_emit(TT_EVT_HERO_START, index);
+    time_tracker_unlock();
+}
+
+void end_hero_timer(int index) {
+    time_tracker_lock();
+    bool was_active = hero_timers[index].active;
+    hero_timers[index].minutes = 0;
+    hero_timers[index].seconds = 0;
+    hero_timers[index].active = false;
+    if (was_active) {
+        time_tracker_emit(TT_EVT_HERO_END, index);
+    }
+    time_tracker_unlock();
+}
+
+/* Key actions of the 2x5 matrix, one handler per key code (row * 5 + col)
+ *
+ *  {"K1", "K2", "K3", "K4", "K5"},     Hero #1 - #5 timer
+ *  {"K6", "K7", "K8", "K9", "K10"}     End match, clock -1 s, pause, clock +1 s, start match
+ *
+ * K11 and key remapping live in components/keyboard/keymap.c, which turns
+ * physical keys into these codes, so the journal and replays stay the same.
+ */
+
+// K1 - K5 - Hero #1 - #5 timer
+static void key_hero(uint8_t code) {
+    if (!hero_timers[code].active && all_timers_active) {
+        start_hero_timer(code);
+    } else {
+        end_hero_timer(code);
+    }
+}
+
+// K6 - Remove/Close in-game timer
+static void key_match_end(uint8_t code) {
+    bool was_active = all_timers_active;
+    all_timers_active = 0;
+    game_timer_active = 0;
+    game_timer_minutes = 0;
+    game_timer_seconds = 0;
+    if (was_active) {
+        time_tracker_emit(TT_EVT_MATCH_END, 0);
+    }
+}
+
+// K7 - Decrease in-game timer (if active)
+static void key_clock_back(uint8_t code) {
+    if (all_timers_active && !game_timer_active) {
+        if (game_timer_minutes > 0 || game_timer_seconds > 0) {
+            if (game_timer_seconds == 0) {
+                game_timer_minutes--;
+                game_timer_seconds = 59;
+            } else {
+                game_timer_seconds--;
+            }
+        }
+        // Increase all active hero timers (but cap at 8:00)
+        rewind_hero_timers();
+        time_tracker_emit(TT_EVT_CLOCK_ADJUST, 0);
+    }
+}
+
+// K8 - Pause/Resume in-game timer (if active)
+static void key_pause(uint8_t code) {
+    if (all_timers_active) {
+        game_timer_active = !game_timer_active;
+        time_tracker_emit(game_timer_active ? TT_EVT_RESUME : TT_EVT_PAUSE, 0);
+    }
+}
+
+// K9 - Increase in-game timer (if active)
+static void key_clock_forward(uint8_t code) {
+    if (all_timers_active && !game_timer_active) {
+        game_timer_seconds++;
+        if (game_timer_seconds >= 60) {
+            game_timer_seconds = 0;
+            game_timer_minutes++;
+        }
+        // Decrease all active hero timers
+        uint8_t expired = advance_hero_timers();
+        time_tracker_emit(TT_EVT_CLOCK_ADJUST, 1);
+        emit_expired(expired);
+    }
+}
+
+// K10 - Starts in-game timer (if in-active)
+static void key_match_start(uint8_t code) {
+    if (!all_timers_active) {
+        all_timers_active = 1;
+        game_timer_minutes = 0;
+        game_timer_seconds = 0;
+        game_timer_active = 1;
+        time_tracker_emit(TT_EVT_MATCH_START, 0);
+    }
+}
+
+static void (*const key_actions[TT_GAME_KEYS])(uint8_t code) = {
+    key_hero, key_hero, key_hero, key_hero, key_hero,
+    key_match_end, key_clock_back, key_pause, key_clock_forward, key_match_start,
+};
+
+/* @brief Applies one key press of the 2x5 matrix to the game state
+ * @param row 0-1
+ * @param col 0-4
+ */
+void process_key(uint8_t row, uint8_t col) {
+    uint8_t code = row * 5 + col;
+
+    if (code >= TT_GAME_KEYS) {
+        return;
+    }
+    if (time_tracker_redirect_input(code)) {
+        return;
+    }
+    time_tracker_lock();
+    key_actions[code](code);
+    time_tracker_emit(TT_EVT_KEY, code);
+    time_tracker_unlock();
+}
+
+/* @brief Advances the in-game timer by one second, called once per second
+ * @param N/A
+ */
+void time_tracker_tick(void) {
+    time_tracker_lock();
+    if (all_timers_active && game_timer_active) {
+        game_timer_seconds++;
+        if (game_timer_seconds >= 60) {
+            game_timer_seconds = 0;
+            game_timer_minutes++;
+        }
+        // Update all active hero timers
+        uint8_t expired = advance_hero_timers();
+        time_tracker_emit(TT_EVT_TICK, 0);
+        emit_expired(expired);
+    }
+    time_tracker_unlock();
+}
+
+/* @brief Moves the in-game timer to a clock reported by the game (GSI)
+ * @param clock_time In-game seconds, negative before the horn (ignored)
+ * @param paused true if the game is paused
+ * Starts a match if none is running. Hero timers move by the same amount as
+ * the clock, so a sync never changes how long is left on a buyback.
+ */
+static void sync_locked(int32_t clock_time, bool paused) {
+    if (clock_time < 0) {
+        return;
+    }
+    if (!all_timers_active) {
+        all_timers_active = 1;
+        game_timer_minutes = 0;
+        game_timer_seconds = 0;
+        game_timer_active = 1;
+        time_tracker_emit(TT_EVT_MATCH_START, 0);
+    }
+
+    int32_t current = game_timer_minutes * 60 + game_timer_seconds;
+    int32_t delta = clock_time - current;
+    uint8_t expired = 0;
+    for (int32_t i = 0; i < delta && i < SYNC_MAX_HERO_STEPS; i++) {
+        expired |= advance_hero_timers();
+    }
+    for (int32_t i = 0; i > delta && i > -SYNC_MAX_HERO_STEPS; i--) {
+        rewind_hero_timers();
+    }
+    game_timer_minutes = clock_time / 60;
+    game_timer_seconds = clock_time % 60;
+
+    uint8_t running = paused ? 0 : 1;
+    bool pause_changed = game_timer_active != running;
+    game_timer_active = running;
+
+    if (delta == 0 && !pause_changed) {
+        return;  // Already in step, nothing to report
+    }
+    time_tracker_emit(TT_EVT_SYNC, delta < -128 ? 0x80 : (delta > 127 ? 0x7F : (uint8_t)(int8_t)delta));
+    if (pause_changed) {
+        time_tracker_emit(running ? TT_EVT_RESUME : TT_EVT_PAUSE, 0);
+    }
+    emit_expired(expired);
+}
+
+void time_tracker_sync(int32_t clock_time, bool paused) {
+    time_tracker_lock();
+    sync_locked(clock_time, paused);
+    time_tracker_unlock();
+}
+
+static void set_hero_locked(int index, uint16_t seconds) {
+    if (index < 0 || index >= HERO_COUNT || !all_timers_active) {
+        return;
+    }
+    if (seconds == 0) {
+        end_hero_timer(index);
+        return;
+    }
+    if (seconds > HERO_START_MIN * 60 + HERO_START_SEC) {
+        seconds = HERO_START_MIN * 60 + HERO_START_SEC;
+    }
+    uint16_t current = hero_timers[index].minutes * 60 + hero_timers[index].seconds;
+    if (hero_timers[index].active && current == seconds) {
+        return;
+    }
+    hero_timers[index].minutes = seconds / 60;
+    hero_timers[index].seconds = seconds % 60;
+    hero_timers[index].active = true;
+    time_tracker_emit(TT_EVT_HERO_START, index);
+    time_tracker_emit(TT_EVT_SYNC, 0);
+}
+
+/* @brief Sets a hero timer to a remaining time reported by the game
+ * @param index Hero 0-4
+ * @param seconds Remaining seconds, 0 ends the timer
+ */
+void time_tracker_set_hero(int index, uint16_t seconds) {
+    time_tracker_lock();
+    set_hero_locked(index, seconds);
+    time_tracker_unlock();
+}
@@ -8,12 +8,51 @@
 #define HERO_START_MIN 8
 #define HERO_START_SEC 0
 
+#define TIME_TRACKER_MAX_LISTENERS 12
+#define TT_GAME_KEYS 10  // Key codes process_key() acts on, K1 - K10
+
 typedef struct {
     uint8_t minutes;
     uint8_t seconds;
     bool active;
 } HeroTimer;
 
+/* Copy of everything the game logic owns */
+typedef struct {
+    uint32_t game_minutes;
+    uint8_t game_seconds;
+    uint8_t game_timer_active;
+    uint8_t all_timers_active;
+    HeroTimer heroes[HERO_COUNT];
+} GameState;
+
+/* Events reported to listeners after the state has changed */
+typedef enum {
+    TT_EVT_KEY = 1,         // arg: key code (row * 5 + col, 10 = K11)
+    TT_EVT_MATCH_START,
+    TT_EVT_MATCH_END,
+    TT_EVT_PAUSE,
+    TT_EVT_RESUME,
+    TT_EVT_CLOCK_ADJUST,    // arg: 0 = decrement, 1 = increment
+    TT_EVT_HERO_START,      // arg: hero index
+    TT_EVT_HERO_END,        // arg: hero index
+    TT_EVT_HERO_EXPIRED,    // arg: hero index
+    TT_EVT_TICK,            // one in-game second elapsed
+    TT_EVT_UNDO,            // arg: key code of the removed key press
+    TT_EVT_REWIND,          // arg: number of events rewound (capped at 255)
+    TT_EVT_SYNC,            // state set from the game, arg: int8 seconds the clock moved (clamped)
+} tt_event_t;
+
+typedef void (*time_tracker_listener_t)(uint8_t event, uint8_t arg);
+
+#define TT_INPUT_UNDO 0x40  // Input code of K11 + K7, key presses use their key code
+
+/* Returns true if the input was taken elsewhere (e.g. forwarded to a primary unit) */
+typedef bool (*time_tracker_input_hook_t)(uint8_t input);
+
+/* Lock around every change of the game state, must be recursive */
+typedef void (*time_tracker_lock_fn_t)(void);
+
 extern HeroTimer hero_timers[HERO_COUNT];
 
 extern volatile uint32_t game_timer_minutes;
@@ -28,4 +67,23 @@ extern uint8_t something_happened;
 
 extern uint8_t indexing;
 
+/* Game logic, no ESP-IDF dependencies so it also builds on a host */
+void start_hero_timer(int index);
+void end_hero_timer(int index);
+void process_key(uint8_t row, uint8_t col);
+void time_tracker_tick(void);
+
+void time_tracker_get_state(GameState *out);
+void time_tracker_set_state(const GameState *in);
+bool time_tracker_add_listener(time_tracker_listener_t listener);
+void time_tracker_emit(uint8_t event, uint8_t arg);
+void time_tracker_mute(bool muted);
+void time_tracker_sync(int32_t clock_time, bool paused);
+void time_tracker_set_hero(int index, uint16_t seconds);
+void time_tracker_set_input_hook(time_tracker_input_hook_t hook);
+bool time_tracker_redirect_input(uint8_t input);
+void time_tracker_set_lock(time_tracker_lock_fn_t lock, time_tracker_lock_fn_t unlock);
+void time_tracker_lock(void);
+void time_tracker_unlock(void);
+
 #endif // TIME_TRACKER_H
\ No newline at end of file
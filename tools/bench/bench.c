@@ -0,0 +1,800 @@
+/* Host benchmark suite
+ *
+ * Builds the game logic, the label formatting, the flush chunk/byte-swap
+ * loop (lcd_stream) and the key scan/debounce code (keyboard.c) against the
+ * stubs in tools/bench/stubs, and with LVGL available also the UI of
+ * display.c rendered into a memory framebuffer. Every metric is the median
+ * of several runs.
+ *
+ * The flush diff (lcd_diff) runs on synthetic match screens: a clock, and
+ * five buyback rows plus the clock counting, each label flushed whole once
+ * per game second as LVGL does. It reports bytes flushed, sent and saved per
+ * second, and fails if the simulated panel ends up different from the
+ * framebuffer.
+ *
+ * The virtualized list (vlist) scrolls a roster of 1000 timers pixel by
+ * pixel, checking after every step that exactly the rows in view plus the
+ * overscan are bound, and reports the rebinds per scrolled row for 10 to
+ * 10000 items; with LVGL the timer_list widget is scrolled and rendered too.
+ *
+ * --capture writes a frame capture stream (frame_capture.c) of a synthetic
+ * screen, and with LVGL of the lv_example_tabview_1 states, to dir/capture.bin
+ * with the framebuffer of every frame as dir/<name>.ppm, so
+ * tools/capture/capture_decode.py can check the round trip pixel for pixel.
+ *
+ * Build and run (see CMakeLists.txt):
+ *   cmake -S tools/bench -B build-bench && cmake --build build-bench
+ *   ./build-bench/bench --json results.json
+ *   python3 tools/bench/bench_compare.py baseline.json results.json
+ *
+ * Usage:
+ *   bench [--json file] [--quick] [--runs n] [--capture dir]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "../../main/time_tracker.h"
+#include "../../main/history.h"
+#include "../../components/keyboard/keyboard.h"
+#include "../../components/display/lcd_stream.h"
+#include "../../components/display/lcd_diff.h"
+#include "../../components/display/vlist.h"
+#include "../../components/display/frame_capture.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+
+#ifdef BENCH_WITH_LVGL
+#include "lvgl.h"
+#include "../../components/display/display.h"
+#include "../../components/display/timer_list.h"
+#include "../../components/display/ui_theme.h"
+#endif
+
+#define MAX_METRICS 16
+#define MAX_RUNS    15
+
+#define FB_HOR 480
+#define FB_VER 320
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    const char *better;     // "lower" or "higher"
+    double value;
+} metric_t;
+
+static metric_t metrics[MAX_METRICS];
+static int metric_count = 0;
+static int runs = 5;
+static long scale = 1;      // Iteration divisor for --quick
+static volatile uint32_t sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* @brief Runs fn `runs` times and records the median of what it returns */
+static void measure(const char *name, const char *unit, const char *better, double (*fn)(void)) {
+    double values[MAX_RUNS];
+    for (int r = 0; r < runs; r++) {
+        values[r] = fn();
+    }
+    qsort(values, runs, sizeof(values[0]), cmp_double);
+    metrics[metric_count++] = (metric_t){ name, unit, better, values[runs / 2] };
+    printf("%-22s %12.2f %s\n", name, values[runs / 2], unit);
+}
+
+static void start_match(void) {
+    GameState empty;
+    memset(&empty, 0, sizeof(empty));
+    time_tracker_set_state(&empty);
+    process_key(1, 4);      // K10 - start
+    for (int i = 0; i < HERO_COUNT; i++) {
+        process_key(0, i);  // K1 - K5 - every hero on cooldown
+    }
+}
+
+/* time_tracker_tick() with all five hero timers running */
+static double bench_tick(void) {
+    const long batches = 4000 / scale;
+    double total = 0;
+    start_match();
+    for (long b = 0; b < batches; b++) {
+        for (int i = 0; i < HERO_COUNT; i++) {
+            if (!hero_timers[i].active) {
+                start_hero_timer(i);
+            }
+        }
+        double start = now_ns();
+        for (int t = 0; t < 64; t++) {
+            time_tracker_tick();
+        }
+        total += now_ns() - start;
+    }
+    return total / (batches * 64);
+}
+
+/* process_key() on K1 - K5, alternately starting and ending hero timers */
+static double bench_process_key(void) {
+    const long keys = 200000 / scale;
+    start_match();
+    double start = now_ns();
+    for (long k = 0; k < keys; k++) {
+        process_key(0, (uint8_t)(k % HERO_COUNT));
+    }
+    return (now_ns() - start) / keys;
+}
+
+/* The text hero_timer and my_timer set, one pass over all labels */
+static double bench_format(void) {
+    const long passes = 200000 / scale;
+    char buf[48];
+    start_match();
+    double start = now_ns();
+    for (long p = 0; p < passes; p++) {
+        for (int i = 0; i < HERO_COUNT; i++) {
+            sink += snprintf(buf, sizeof(buf), "Hero #%d: %02d:%02d", i + 1,
+                             hero_timers[i].minutes, (int)((p + i) % 60));
+        }
+        sink += snprintf(buf, sizeof(buf), "In-game Timer: %02ld:%02d\nTimer is paused.",
+                         (long)game_timer_minutes, (int)(p % 60));
+    }
+    return (now_ns() - start) / passes;
+}
+
+static void null_send(const uint16_t *chunk, int pixels, void *ctx) {
+    sink += chunk[0] + chunk[pixels - 1];
+}
+
+/* my_flush_cb chunking and byte swap of one partial buffer into a null sink */
+static double bench_flush(void) {
+    enum { STRIP = 480 * 32 };
+    static uint16_t strip[STRIP];
+    const long flushes = 20000 / scale;
+    for (int i = 0; i < STRIP; i++) {
+        strip[i] = (uint16_t)(i * 2654435761u >> 16);
+    }
+    double start = now_ns();
+    for (long f = 0; f < flushes; f++) {
+        lcd_stream_pixels(strip, STRIP, null_send, NULL);
+    }
+    double seconds = (now_ns() - start) / 1e9;
+    return (double)flushes * STRIP * 2 / seconds / 1e6;
+}
+
+static uint16_t framebuffer[FB_HOR * FB_VER];
+
+/* @brief Flat background, a title bar and rows of text-like detail, as the UI looks to the RLE */
+static void synth_frame(uint16_t *fb) {
+    for (int y = 0; y < FB_VER; y++) {
+        for (int x = 0; x < FB_HOR; x++) {
+            uint16_t c = y < 40 ? 0x2104 : 0xFFFF;
+            // 24 px glyph rows with 12 px glyphs, ~30% ink
+            int row = (y - 60) / 40, gy = (y - 60) % 40, gx = x % 14;
+            if (y >= 60 && row < 6 && gy < 24 && x >= 16 && x < 16 + 14 * 24 && gx < 12 &&
+                ((x / 14 * 7 + row * 13 + gy * 3 + gx * 5) * 2654435761u >> 29) < 3) {
+                c = 0x0000;
+            }
+            fb[y * FB_HOR + x] = c;
+        }
+    }
+}
+
+/* @brief One frame into the capture stream, flushed in 32-line strips like LVGL's partial buffer */
+static void capture_strips(const uint16_t *fb, int y1, int y2) {
+    frame_capture_frame_begin(FB_HOR, FB_VER);
+    for (int y = y1; y <= y2; y += 32) {
+        int last = y + 31 > y2 ? y2 : y + 31;
+        frame_capture_area(0, y, FB_HOR - 1, last, &fb[y * FB_HOR]);
+    }
+    frame_capture_frame_end(0);
+}
+
+static uint64_t capture_bytes = 0;
+
+static void capture_count(const void *data, size_t len, void *ctx) {
+    capture_bytes += len;
+}
+
+/* RLE capture of the synthetic screen into a null sink */
+static double bench_capture(void) {
+    const long frames = 400 / scale;
+    synth_frame(framebuffer);
+    frame_capture_init(capture_count, NULL, NULL);
+    frame_capture_start(NULL, CAPTURE_CONTINUOUS);
+    double start = now_ns();
+    for (long f = 0; f < frames; f++) {
+        capture_strips(framebuffer, 0, FB_VER - 1);
+    }
+    double seconds = (now_ns() - start) / 1e9;
+    frame_capture_stop();
+    return (double)frames * FB_HOR * FB_VER * 2 / seconds / 1e6;
+}
+
+/* Raw bytes per captured byte of the synthetic screen */
+static double bench_capture_ratio(void) {
+    synth_frame(framebuffer);
+    frame_capture_init(capture_count, NULL, NULL);
+    frame_capture_start(NULL, 1);
+    capture_bytes = 0;
+    capture_strips(framebuffer, 0, FB_VER - 1);
+    return (double)FB_HOR * FB_VER * 2 / capture_bytes;
+}
+
+/* @brief Label box with text in a 12 x 24 synthetic font, each character its own fixed ~30% ink */
+static void synth_label(uint16_t *fb, int x0, int y0, int w, int h, const char *text) {
+    for (int y = y0; y < y0 + h; y++) {
+        for (int x = x0; x < x0 + w; x++) {
+            int cell = (x - x0 - 2) / 14, gx = (x - x0 - 2) % 14, gy = y - y0 - 3;
+            uint16_t c = 0xFFFF;
+            if (x - x0 >= 2 && cell < (int)strlen(text) && gx < 12 && gy >= 0 && gy < 24 && text[cell] != ' ' &&
+                (((unsigned)text[cell] * 131 + gy * 12 + gx) * 2654435761u >> 29) < 3) {
+                c = 0x0000;
+            }
+            fb[y * FB_HOR + x] = c;
+        }
+    }
+}
+
+typedef struct {
+    const char *name;
+    int rows;                       // Buyback rows counting down, besides the clock
+} diff_screen_t;
+
+static const diff_screen_t diff_screens[] = {
+    { "clock", 0 },
+    { "buybacks", HERO_COUNT },
+};
+
+static uint16_t panel[FB_HOR * FB_VER];
+static uint16_t diff_shadow[FB_HOR * FB_VER];
+static uint64_t diff_sent_px = 0;
+static int diff_mismatch = 0;
+
+/* lcd_diff_send_t into the simulated panel */
+static void diff_panel(const lcd_diff_rect_t *r, const uint16_t *px, int stride, void *ctx) {
+    for (int y = r->y1; y <= r->y2; y++) {
+        memcpy(&panel[y * FB_HOR + r->x1], px + (y - r->y1) * stride, (r->x2 - r->x1 + 1) * 2);
+    }
+    diff_sent_px += (uint64_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+/* @brief Flushes a label area of the framebuffer through the diff, as LVGL's partial buffer would */
+static void diff_flush(lcd_diff_t *d, int x0, int y0, int w, int h) {
+    static uint16_t area[FB_HOR * 40];
+    for (int y = 0; y < h; y++) {
+        memcpy(&area[y * w], &framebuffer[(y0 + y) * FB_HOR + x0], w * 2);
+    }
+    lcd_diff_area(d, x0, y0, x0 + w - 1, y0 + h - 1, area, diff_panel, NULL);
+}
+
+/* @brief seconds game seconds of one screen: full first frame, then every label that changed
+ * @return Seconds of CPU spent in lcd_diff_area and the copies around it
+ */
+static double diff_run(const diff_screen_t *screen, long seconds, lcd_diff_t *d) {
+    char text[48];
+    double total = 0;
+
+    lcd_diff_init(d, diff_shadow, FB_HOR, FB_VER);
+    synth_frame(framebuffer);
+    lcd_diff_frame_begin(d);
+    for (int y = 0; y < FB_VER; y += 32) {
+        diff_flush(d, 0, y, FB_HOR, 32);
+    }
+    lcd_diff_frame_end(d);
+    lcd_diff_reset_stats(d);
+    diff_sent_px = 0;
+
+    for (long t = 0; t < seconds; t++) {
+        long game = 754 + t;
+        double start;
+        lcd_diff_frame_begin(d);
+        for (int i = 0; i < screen->rows; i++) {
+            long left = 480 - (t + i * 37) % 480;   // Cooldowns started at different times
+            snprintf(text, sizeof(text), "Hero #%d: %02ld:%02ld", i + 1, left / 60, left % 60);
+            synth_label(framebuffer, 16, 60 + i * 40, 448, 30, text);
+            start = now_ns();
+            diff_flush(d, 16, 60 + i * 40, 448, 30);
+            total += now_ns() - start;
+        }
+        snprintf(text, sizeof(text), "In-game Timer: %02ld:%02ld", game / 60, game % 60);
+        synth_label(framebuffer, 0, 290, FB_HOR, 30, text);
+        start = now_ns();
+        diff_flush(d, 0, 290, FB_HOR, 30);
+        total += now_ns() - start;
+        lcd_diff_frame_end(d);
+    }
+    if (memcmp(panel, framebuffer, sizeof(panel)) != 0) {
+        diff_mismatch = 1;
+    }
+    return total / 1e9;
+}
+
+/* Flushed label pixels the diff gets through per second of CPU, five rows and the clock */
+static double bench_diff(void) {
+    lcd_diff_t d;
+    double cpu = diff_run(&diff_screens[1], 600 / scale, &d);
+    return d.bytes_in / 2 / cpu / 1e6;
+}
+
+/* Share of the flushed bytes the diff keeps off the bus, five rows and the clock */
+static double bench_diff_saved(void) {
+    lcd_diff_t d;
+    diff_run(&diff_screens[1], 600, &d);
+    return 100.0 * (d.bytes_in - d.bytes_out) / d.bytes_in;
+}
+
+/* @brief Bytes per second with one label update per game second, for every screen */
+static void report_diff(void) {
+    for (size_t i = 0; i < sizeof(diff_screens) / sizeof(diff_screens[0]); i++) {
+        lcd_diff_t d;
+        const long seconds = 600;
+        diff_run(&diff_screens[i], seconds, &d);
+        printf("diff %-17s %8.0f B/s flushed %7.0f sent %8.0f saved, %.1f windows/s\n", diff_screens[i].name,
+               (double)d.bytes_in / seconds, (double)d.bytes_out / seconds,
+               (double)(d.bytes_in - d.bytes_out) / seconds, (double)d.windows / seconds);
+    }
+}
+
+#define VLIST_ITEMS     1000
+#define VLIST_ROW_H     30
+#define VLIST_VIEW_H    220     // Tab content under the tab bar
+
+static int32_t vlist_bound[VLIST_MAX_SLOTS];
+static int vlist_broken = 0;
+
+/* vlist_bind_t, remembers what each slot shows */
+static void vlist_bench_bind(int slot, int32_t index, void *ctx) {
+    vlist_bound[slot] = index;
+}
+
+/* @brief Every row in the viewport and the overscan is bound, in its slot */
+static bool vlist_check(const vlist_t *vl) {
+    int32_t first = vl->scroll_y / vl->row_h - VLIST_OVERSCAN;
+    int32_t last = (vl->scroll_y + vl->view_h - 1) / vl->row_h + VLIST_OVERSCAN;
+
+    for (int32_t i = first < 0 ? 0 : first; i <= last && i < vl->count; i++) {
+        if (vlist_slot_of(vl, i) < 0 || vlist_bound[vlist_slot_of(vl, i)] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* @brief Scrolls to the end and back one pixel at a time
+ * @param check Verify the bound rows after every step
+ * @return Scroll steps
+ */
+static long vlist_sweep(vlist_t *vl, bool check) {
+    int32_t max_y = vlist_content_h(vl) - vl->view_h;
+    long steps = 0;
+
+    for (int32_t y = 0; y <= max_y; y++, steps++) {
+        vlist_scroll_to(vl, y);
+        vlist_broken |= check && !vlist_check(vl);
+    }
+    for (int32_t y = max_y; y >= 0; y--, steps++) {
+        vlist_scroll_to(vl, y);
+        vlist_broken |= check && !vlist_check(vl);
+    }
+    return steps;
+}
+
+/* Time per scroll step through 1000 timers, rebinding included */
+static double bench_vlist(void) {
+    vlist_t vl;
+    long steps = 0;
+    double start = now_ns();
+
+    vlist_init(&vl, VLIST_ROW_H, VLIST_VIEW_H, vlist_bench_bind, NULL);
+    vlist_set_count(&vl, VLIST_ITEMS);
+    for (int r = 0; r < 20 / scale; r++) {
+        steps += vlist_sweep(&vl, false);
+    }
+    return (now_ns() - start) / steps;
+}
+
+/* @brief Rebinds per row scrolled past, the same whatever the list length */
+static void report_vlist(void) {
+    static const int32_t counts[] = { 10, 100, 1000, 10000 };
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        vlist_t vl;
+        vlist_init(&vl, VLIST_ROW_H, VLIST_VIEW_H, vlist_bench_bind, NULL);
+        vlist_set_count(&vl, counts[i]);
+        uint32_t binds = vl.binds;
+        vlist_sweep(&vl, true);
+        int32_t rows = 2 * (vlist_content_h(&vl) - vl.view_h) / VLIST_ROW_H;
+        printf("vlist %5ld items  %2d slots  %7lu binds over %6ld rows scrolled  %.2f per row\n",
+               (long)counts[i], vl.slots, (unsigned long)(vl.binds - binds), (long)rows,
+               rows ? (double)(vl.binds - binds) / rows : 0.0);
+    }
+}
+
+static uint32_t keys_seen = 0;
+
+static void count_keys(uint8_t event, uint8_t arg) {
+    if (event == TT_EVT_KEY) {
+        keys_seen++;
+    }
+}
+
+/* scan_keys() with keys pressed and released against the simulated matrix */
+static double bench_scan(void) {
+    const long scans = 100000 / scale;
+    double total = 0;
+    init_keys();
+    start_match();
+    for (long s = 0; s < scans; s++) {
+        int key = (int)((s / 4) % 10);
+        bench_set_key(key / 5, key % 5, s % 4 < 2);     // Held for two scans
+        double start = now_ns();
+        scan_keys();
+        total += now_ns() - start;
+        bench_advance_us(50000);    // key_scan_task period
+    }
+    for (int key = 0; key < 10; key++) {
+        bench_set_key(key / 5, key % 5, false);
+    }
+    return total / scans;
+}
+
+#ifdef BENCH_WITH_LVGL
+void lv_example_tabview_1(void);
+void hero_timer(lv_timer_t * timer);
+void my_timer(lv_timer_t * timer);
+
+static uint64_t fb_pixels = 0;
+
+static void fb_flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map) {
+    int32_t w = area->x2 - area->x1 + 1;
+    const uint16_t *src = (const uint16_t *)px_map;
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&framebuffer[y * FB_HOR + area->x1], src, w * 2);
+        src += w;
+    }
+    fb_pixels += (uint64_t)w * (area->y2 - area->y1 + 1);
+    frame_capture_area(area->x1, area->y1, area->x2, area->y2, (const uint16_t *)px_map);
+    lv_display_flush_ready(display);
+}
+
+static uint32_t bench_tick_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static lv_display_t *ui_display = NULL;
+
+static void ui_setup(void) {
+    static uint16_t draw_buf[FB_HOR * FB_VER / 10];
+    lv_init();
+    lv_tick_set_cb(bench_tick_ms);
+    ui_display = lv_display_create(FB_HOR, FB_VER);
+    lv_display_set_buffers(ui_display, draw_buf, NULL, sizeof(draw_buf), LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(ui_display, fb_flush);
+    ui_theme_init(ui_display);
+    lv_example_tabview_1();
+    lv_tabview_set_act(tabview, 2, LV_ANIM_OFF);   // Buybacks tab, the hero labels
+    lv_refr_now(ui_display);
+}
+
+static void roster_bench_text(int32_t index, char *buf, size_t len) {
+    snprintf(buf, len, "Timer #%ld: %02ld:%02ld", (long)index + 1, (long)(index * 7 % 480) / 60,
+             (long)(index * 7 % 60));
+}
+
+/* @brief Scrolls a timer_list of count items in 7 px steps, rendering every step
+ * @return Microseconds per step
+ */
+static double ui_scroll_list(int32_t count) {
+    static timer_list_t list;
+    lv_obj_t *home = lv_screen_active();
+    lv_obj_t *screen = lv_obj_create(NULL);
+    long steps = 0;
+
+    lv_screen_load(screen);
+    timer_list_create(&list, screen, VLIST_ROW_H, roster_bench_text);
+    timer_list_set_count(&list, count);
+    lv_refr_now(ui_display);
+
+    double start = now_ns();
+    int32_t max_y = vlist_content_h(&list.vl) - list.vl.view_h;
+    for (int32_t y = 0; y <= max_y && steps < 2000 / scale; y += 7, steps++) {
+        lv_obj_scroll_to_y(list.obj, y, LV_ANIM_OFF);
+        lv_refr_now(ui_display);
+    }
+    double us = steps ? (now_ns() - start) / steps / 1000 : 0;
+
+    lv_screen_load(home);
+    lv_obj_delete(screen);
+    return us;
+}
+
+/* Scroll step of the 1000 timer roster: rebind, layout, render and flush */
+static double bench_ui_scroll(void) {
+    return ui_scroll_list(VLIST_ITEMS);
+}
+
+/* One game second on screen: tick, hero_timer and my_timer text, render and flush to memory */
+static double bench_ui(void) {
+    const long updates = 2000 / scale;
+    double total = 0;
+    start_match();
+    for (long u = 0; u < updates; u++) {
+        for (int i = 0; i < HERO_COUNT; i++) {
+            if (!hero_timers[i].active) {
+                start_hero_timer(i);
+            }
+        }
+        time_tracker_tick();
+        bench_advance_us(1000000);
+        double start = now_ns();
+        hero_timer(NULL);
+        my_timer(NULL);
+        lv_refr_now(ui_display);
+        total += now_ns() - start;
+    }
+    return total / updates / 1000;
+}
+
+#define STYLE_ROWS      200
+
+static double style_bytes[2];           // LVGL pool per row, [0] local styles, [1] shared
+static double style_ns[2];
+
+/* @brief STYLE_ROWS hero rows styled as before themes (local) or with the shared styles,
+ *        then the properties a redraw of a row reads
+ * @return Nanoseconds per style property lookup
+ */
+static double ui_style_rows(bool shared) {
+    static lv_obj_t *rows[STYLE_ROWS];
+    const long passes = 500 / scale;
+    volatile uint32_t sink = 0;
+    lv_obj_t *screen = lv_obj_create(NULL);     // Not loaded, nothing is rendered
+    lv_mem_monitor_t before, after;
+
+    lv_mem_monitor(&before);
+    for (int i = 0; i < STYLE_ROWS; i++) {
+        rows[i] = lv_label_create(screen);
+        lv_label_set_text_static(rows[i], "Hero #1: 01:30");
+        if (shared) {
+            ui_theme_apply(rows[i], UI_CLASS_ROW);
+            ui_theme_set_status(rows[i], UI_STATUS_COOLDOWN);
+            ui_theme_set_highlight(rows[i], UI_HIGHLIGHT_WARN);
+        } else {
+            lv_obj_set_style_text_font(rows[i], &lv_font_montserrat_24, 0);
+            lv_obj_set_style_text_color(rows[i], lv_color_hex(0x212121), 0);
+            lv_obj_set_style_bg_color(rows[i], lv_palette_main(LV_PALETTE_ORANGE), 0);
+        }
+        lv_obj_set_style_bg_opa(rows[i], LV_OPA_50, 0);    // Local either way, animated
+    }
+    lv_mem_monitor(&after);
+    style_bytes[shared] = (double)(before.free_size - after.free_size) / STYLE_ROWS;
+
+    double start = now_ns();
+    for (long p = 0; p < passes; p++) {
+        for (int i = 0; i < STYLE_ROWS; i++) {
+            sink += (uintptr_t)lv_obj_get_style_text_font(rows[i], 0);
+            sink += lv_obj_get_style_text_color(rows[i], 0).red;
+            sink += lv_obj_get_style_bg_color(rows[i], 0).red;
+            sink += lv_obj_get_style_bg_opa(rows[i], 0);
+            sink += lv_obj_get_style_pad_top(rows[i], 0);   // Default theme
+        }
+    }
+    style_ns[shared] = (now_ns() - start) / ((double)passes * STYLE_ROWS * 5);
+
+    lv_obj_delete(screen);
+    return style_ns[shared];
+}
+
+/* Style property lookup on a themed row */
+static double bench_style_lookup(void) {
+    return ui_style_rows(true);
+}
+
+/* @brief Local against shared styles, and a theme switch with the full redraw it causes */
+static void report_styles(void) {
+    ui_style_rows(false);
+    ui_style_rows(true);
+    printf("%-22s local %.0f B/row %.1f ns/lookup, shared %.0f B/row %.1f ns/lookup\n", "ui_styles",
+           style_bytes[0], style_ns[0], style_bytes[1], style_ns[1]);
+
+    double start = now_ns();
+    ui_theme_set(UI_THEME_DARK);
+    lv_refr_now(ui_display);
+    ui_theme_set(UI_THEME_LIGHT);
+    lv_refr_now(ui_display);
+    printf("%-22s %9.1f us per switch, restyle and redraw\n", "ui_theme", (now_ns() - start) / 2 / 1000);
+}
+#endif
+
+/* @brief The framebuffer as dir/name.ppm, RGB565 widened like capture_decode.py does */
+static int write_ppm(const char *dir, const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.ppm", dir, name);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", FB_HOR, FB_VER);
+    for (int i = 0; i < FB_HOR * FB_VER; i++) {
+        uint16_t c = framebuffer[i];
+        uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        uint8_t rgb[3] = { (uint8_t)(r << 3 | r >> 2), (uint8_t)(g << 2 | g >> 4), (uint8_t)(b << 3 | b >> 2) };
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+    return 0;
+}
+
+static void capture_file(const void *data, size_t len, void *ctx) {
+    fwrite(data, 1, len, (FILE *)ctx);
+}
+
+#ifdef BENCH_WITH_LVGL
+/* @brief Renders one state of lv_example_tabview_1 as a keyframe */
+static int capture_ui_state(const char *dir, const char *name, int tab) {
+    lv_tabview_set_act(tabview, tab, LV_ANIM_OFF);
+    hero_timer(NULL);
+    my_timer(NULL);
+    lv_obj_invalidate(lv_screen_active());
+    frame_capture_start(name, 1);
+    frame_capture_frame_begin(FB_HOR, FB_VER);
+    lv_refr_now(ui_display);
+    frame_capture_frame_end(0);
+    return write_ppm(dir, name);
+}
+#endif
+
+/* @brief Capture stream plus reference images in dir, for tools/capture/capture_decode.py */
+static int write_capture(const char *dir) {
+    char path[512];
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        perror(dir);
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/capture.bin", dir);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    int err = 0;
+    capture_stats_t before, s;
+    frame_capture_get_stats(&before);
+    frame_capture_init(capture_file, f, esp_timer_get_time);
+
+    // Keyframe, then a delta that only carries a highlighted row
+    synth_frame(framebuffer);
+    frame_capture_start("synthetic", 2);
+    capture_strips(framebuffer, 0, FB_VER - 1);
+    err |= write_ppm(dir, "synthetic");
+    for (int y = 100; y < 132; y++) {
+        for (int x = 0; x < FB_HOR; x++) {
+            if (framebuffer[y * FB_HOR + x] == 0xFFFF) {
+                framebuffer[y * FB_HOR + x] = 0xFE00;   // Amber behind the text
+            }
+        }
+    }
+    frame_capture_start("synthetic_row", 1);            // Still running, stays a delta
+    capture_strips(framebuffer, 100, 131);
+    err |= write_ppm(dir, "synthetic_row");
+
+#ifdef BENCH_WITH_LVGL
+    GameState empty;
+    memset(&empty, 0, sizeof(empty));
+    time_tracker_set_state(&empty);
+    err |= capture_ui_state(dir, "ult_idle", 0);
+    err |= capture_ui_state(dir, "tormentor_idle", 1);
+    err |= capture_ui_state(dir, "buybacks_idle", 2);
+    start_match();
+    for (int t = 0; t < 75; t++) {
+        time_tracker_tick();
+    }
+    err |= capture_ui_state(dir, "buybacks_match", 2);
+#endif
+    fclose(f);
+
+    frame_capture_get_stats(&s);
+    s.frames -= before.frames;
+    s.pixels -= before.pixels;
+    s.bytes -= before.bytes;
+    printf("capture %lu frames, %llu px -> %llu bytes (%.1f:1) in %s\n", (unsigned long)s.frames,
+           (unsigned long long)s.pixels, (unsigned long long)s.bytes,
+           s.bytes ? (double)s.pixels * 2 / s.bytes : 0.0, path);
+    return err;
+}
+
+static int write_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    fprintf(f, "{\n  \"bench\": \"dota-timer-host\",\n  \"quick\": %s,\n  \"runs\": %d,\n  \"metrics\": {\n",
+            scale > 1 ? "true" : "false", runs);
+    for (int i = 0; i < metric_count; i++) {
+        fprintf(f, "    \"%s\": {\"value\": %.3f, \"unit\": \"%s\", \"better\": \"%s\"}%s\n",
+                metrics[i].name, metrics[i].value, metrics[i].unit, metrics[i].better,
+                i + 1 < metric_count ? "," : "");
+    }
+    fprintf(f, "  }\n}\n");
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *json = NULL;
+    const char *capture = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json = argv[++i];
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            scale = 20;
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            runs = runs < 1 ? 1 : runs > MAX_RUNS ? MAX_RUNS : runs;
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capture = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--json file] [--quick] [--runs n] [--capture dir]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    time_tracker_add_listener(history_listener);    // As on the device
+    time_tracker_add_listener(count_keys);
+
+    measure("tick_ns", "ns", "lower", bench_tick);
+    measure("process_key_ns", "ns", "lower", bench_process_key);
+    measure("format_labels_ns", "ns", "lower", bench_format);
+    measure("flush_mbytes_s", "MB/s", "higher", bench_flush);
+    measure("scan_keys_ns", "ns", "lower", bench_scan);
+    measure("capture_mbytes_s", "MB/s", "higher", bench_capture);
+    measure("capture_ratio", "x", "higher", bench_capture_ratio);
+    measure("diff_mpx_s", "Mpx/s", "higher", bench_diff);
+    measure("diff_saved_pct", "%", "higher", bench_diff_saved);
+    report_diff();
+    measure("vlist_scroll_ns", "ns", "lower", bench_vlist);
+    report_vlist();
+#ifdef BENCH_WITH_LVGL
+    ui_setup();
+    measure("ui_update_us", "us", "lower", bench_ui);
+    printf("%-22s %12.0f px flushed\n", "ui", (double)fb_pixels);
+    measure("ui_scroll_us", "us", "lower", bench_ui_scroll);
+    printf("%-22s %9.1f / %.1f us for 100 / 10000 items\n", "ui_scroll", ui_scroll_list(100), ui_scroll_list(10000));
+    measure("style_lookup_ns", "ns", "lower", bench_style_lookup);
+    report_styles();
+#else
+    printf("ui_update_us           skipped, built without LVGL (set LVGL_DIR)\n");
+#endif
+
+    if (vlist_broken) {
+        fprintf(stderr, "vlist left a row in view unbound\n");
+        return 1;
+    }
+    if (diff_mismatch) {
+        fprintf(stderr, "the flush diff left the panel different from the framebuffer\n");
+        return 1;
+    }
+    if (keys_seen == 0) {
+        fprintf(stderr, "scan_keys never accepted a key, the matrix stub is broken\n");
+        return 1;
+    }
+    if (capture != NULL && write_capture(capture) != 0) {
+        return 1;
+    }
+    return json != NULL ? write_json(json) : 0;
+}
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Compare two bench --json results and gate on regressions.
+
+Usage:
+  bench_compare.py baseline.json current.json [--threshold 10] [--metric name=pct ...]
+
+Every metric present in both files is compared in the direction its
+"better" field gives. A metric that got worse by more than the threshold
+(percent, per-metric overrides with --metric) is a regression and the exit
+status is 1. Metrics missing on either side are listed but do not fail.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    if "metrics" not in data:
+        sys.exit(f"{path}: no metrics")
+    return data["metrics"]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10)")
+    parser.add_argument("--metric", action="append", default=[], metavar="NAME=PCT",
+                        help="per-metric threshold override")
+    args = parser.parse_args()
+
+    overrides = {}
+    for item in args.metric:
+        name, _, pct = item.partition("=")
+        overrides[name] = float(pct)
+
+    base = load(args.baseline)
+    cur = load(args.current)
+    regressions = 0
+
+    print(f"{'metric':<22} {'baseline':>12} {'current':>12} {'change':>9}  verdict")
+    for name in sorted(set(base) | set(cur)):
+        if name not in base or name not in cur:
+            side = "baseline" if name not in base else "current"
+            print(f"{name:<22} {'':>12} {'':>12} {'':>9}  missing in {side}")
+            continue
+        b, c = base[name]["value"], cur[name]["value"]
+        higher = cur[name].get("better", "lower") == "higher"
+        change = (c - b) / b * 100 if b else 0.0
+        worse = -change if higher else change
+        limit = overrides.get(name, args.threshold)
+        if worse > limit:
+            verdict = f"REGRESSION (> {limit:g}%)"
+            regressions += 1
+        elif worse < -limit:
+            verdict = "improved"
+        else:
+            verdict = "ok"
+        unit = cur[name].get("unit", "")
+        print(f"{name:<22} {b:>12.2f} {c:>12.2f} {change:>+8.1f}%  {verdict} [{unit}]")
+
+    if regressions:
+        print(f"{regressions} metric(s) regressed")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,21 @@
+/* LVGL configuration for the host benchmark, close to the device sdkconfig */
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+#define LV_USE_OS LV_OS_NONE
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_BUILTIN
+#define LV_MEM_SIZE (128 * 1024U)
+#define LV_DEF_REFR_PERIOD 33
+#define LV_USE_LOG 0
+#define LV_USE_ASSERT_NULL 0
+#define LV_USE_ASSERT_MALLOC 0
+
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_24 1
+#define LV_FONT_MONTSERRAT_38 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_14
+
+#define LV_BUILD_EXAMPLES 0
+
+#endif
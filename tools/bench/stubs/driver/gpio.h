@@ -0,0 +1,42 @@
+#ifndef BENCH_GPIO_H
+#define BENCH_GPIO_H
+
+#include "esp_err.h"
+
+/* Simulated key matrix: a row reads high while a pressed key sits in the driven column */
+typedef int gpio_num_t;
+typedef enum { GPIO_MODE_INPUT, GPIO_MODE_OUTPUT } gpio_mode_t;
+typedef enum { GPIO_INTR_DISABLE, GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE, GPIO_INTR_ANYEDGE,
+               GPIO_INTR_LOW_LEVEL, GPIO_INTR_HIGH_LEVEL } gpio_int_type_t;
+typedef void (*gpio_isr_t)(void *arg);
+
+#define GPIO_NUM_5  5
+#define GPIO_NUM_6  6
+#define GPIO_NUM_7  7
+#define GPIO_NUM_8  8
+#define GPIO_NUM_9  9
+#define GPIO_NUM_10 10
+#define GPIO_NUM_17 17
+#define GPIO_NUM_18 18
+
+esp_err_t gpio_reset_pin(gpio_num_t pin);
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level);
+int gpio_get_level(gpio_num_t pin);
+esp_err_t gpio_pullup_en(gpio_num_t pin);
+esp_err_t gpio_pullup_dis(gpio_num_t pin);
+esp_err_t gpio_pulldown_en(gpio_num_t pin);
+esp_err_t gpio_pulldown_dis(gpio_num_t pin);
+
+/* Power idle wake path, no-ops */
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t isr, void *arg);
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin);
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type);
+esp_err_t gpio_intr_enable(gpio_num_t pin);
+esp_err_t gpio_intr_disable(gpio_num_t pin);
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type);
+esp_err_t gpio_wakeup_disable(gpio_num_t pin);
+
+void bench_set_key(int row, int col, bool pressed);    // row 2 = K11
+
+#endif
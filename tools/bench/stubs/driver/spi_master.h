@@ -0,0 +1,40 @@
+#ifndef BENCH_SPI_MASTER_H
+#define BENCH_SPI_MASTER_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/* Null sink: transactions complete at once and only count bytes */
+typedef struct spi_device_t *spi_device_handle_t;
+
+#define SPI_TRANS_USE_TXDATA        (1 << 3)
+#define SPI_TRANS_VARIABLE_CMD      (1 << 4)
+#define SPI_TRANS_VARIABLE_DUMMY    (1 << 6)
+
+typedef struct {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;          // Bits
+    size_t rxlength;
+    void *user;
+    const void *tx_buffer;
+    void *rx_buffer;
+    uint8_t tx_data[4];
+    uint8_t rx_data[4];
+} spi_transaction_t;
+
+typedef struct {
+    spi_transaction_t base;
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+} spi_transaction_ext_t;
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, TickType_t wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, TickType_t wait);
+
+extern uint64_t bench_spi_bytes;
+
+#endif
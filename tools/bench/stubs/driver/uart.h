@@ -0,0 +1,33 @@
+#ifndef BENCH_UART_H
+#define BENCH_UART_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/* Configuration calls are accepted, the host program decides where the bytes go */
+typedef int uart_port_t;
+typedef enum { UART_DATA_8_BITS = 3 } uart_word_length_t;
+typedef enum { UART_PARITY_DISABLE = 0 } uart_parity_t;
+typedef enum { UART_STOP_BITS_1 = 1 } uart_stop_bits_t;
+typedef enum { UART_HW_FLOWCTRL_DISABLE = 0 } uart_hw_flowcontrol_t;
+typedef enum { UART_SCLK_DEFAULT, UART_SCLK_APB, UART_SCLK_XTAL, UART_SCLK_RTC } uart_sclk_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uart_sclk_t source_clk;
+} uart_config_t;
+
+#define UART_NUM_1          1
+#define UART_NUM_2          2
+#define UART_PIN_NO_CHANGE  (-1)
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_buf, int tx_buf, int queue_size, QueueHandle_t *queue, int flags);
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t *config);
+esp_err_t uart_set_pin(uart_port_t port, int tx, int rx, int rts, int cts);
+int uart_write_bytes(uart_port_t port, const void *src, size_t size);
+
+#endif
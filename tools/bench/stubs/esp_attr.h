@@ -0,0 +1,10 @@
+#ifndef BENCH_ESP_ATTR_H
+#define BENCH_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define DMA_ATTR
+#define EXT_RAM_BSS_ATTR
+#define WORD_ALIGNED_ATTR   __attribute__((aligned(4)))
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef BENCH_ESP_HEAP_CAPS_H
+#define BENCH_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define heap_caps_malloc(size, caps) malloc(size)
+
+#endif
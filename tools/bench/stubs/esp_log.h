@@ -0,0 +1,14 @@
+#ifndef BENCH_ESP_LOG_H
+#define BENCH_ESP_LOG_H
+
+#include <stdio.h>
+#include "esp_err.h"
+
+/* Logging is compiled out; sizeof keeps the arguments type-checked and used */
+#define BENCH_LOG_NOP(tag, ...)  ((void)(tag), (void)sizeof(printf(__VA_ARGS__)))
+#define ESP_LOGE(tag, ...)  BENCH_LOG_NOP(tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...)  BENCH_LOG_NOP(tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...)  BENCH_LOG_NOP(tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...)  BENCH_LOG_NOP(tag, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef BENCH_ESP_PARTITION_H
+#define BENCH_ESP_PARTITION_H
+
+#include "esp_err.h"
+
+/* No partitions on the host: lookups fail, callers mount a stand-in instead */
+typedef enum { ESP_PARTITION_TYPE_DATA = 1 } esp_partition_type_t;
+typedef enum { ESP_PARTITION_SUBTYPE_ANY = 0xff } esp_partition_subtype_t;
+
+typedef struct {
+    size_t size;
+} esp_partition_t;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t len);
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t len);
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t len);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef BENCH_ESP_TIMER_H
+#define BENCH_ESP_TIMER_H
+
+#include "esp_err.h"
+
+/* Virtual clock, advanced by vTaskDelay() and bench_advance_us() */
+int64_t esp_timer_get_time(void);
+void bench_advance_us(int64_t us);
+
+/* One-shot timers never fire on the host */
+typedef struct esp_timer *esp_timer_handle_t;
+typedef struct {
+    void (*callback)(void *arg);
+    void *arg;
+    const char *name;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+#endif
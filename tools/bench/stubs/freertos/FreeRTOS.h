@@ -0,0 +1,24 @@
+#ifndef BENCH_FREERTOS_H
+#define BENCH_FREERTOS_H
+
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void *QueueHandle_t;
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef struct { int unused; } portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portENTER_CRITICAL(mux)         (void)(mux)
+#define portEXIT_CRITICAL(mux)          (void)(mux)
+#define portTICK_PERIOD_MS              1
+#define portMAX_DELAY                   0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)               (ms)
+#define pdTRUE                          1
+#define pdFALSE                         0
+#define portYIELD_FROM_ISR()
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef BENCH_SEMPHR_H
+#define BENCH_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+/* Host programs are single-threaded where these are used, a mutex is a no-op */
+typedef void *SemaphoreHandle_t;
+typedef struct { int unused; } StaticSemaphore_t;
+
+#define xSemaphoreCreateMutex()             ((SemaphoreHandle_t)1)
+#define xSemaphoreCreateMutexStatic(buf)    ((SemaphoreHandle_t)(buf))
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    return pdTRUE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return pdTRUE;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef BENCH_TASK_H
+#define BENCH_TASK_H
+
+#include "FreeRTOS.h"
+
+void vTaskDelay(TickType_t ticks);     // Advances the virtual clock, does not sleep
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+#endif
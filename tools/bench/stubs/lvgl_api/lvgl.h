@@ -0,0 +1,357 @@
+#ifndef BENCH_LVGL_API_H
+#define BENCH_LVGL_API_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Declarations of the LVGL 9.2 API used by components/display
+ *
+ * For the lvgl_syntax test only: display.c, display_stats.c, timer_list.c,
+ * ui_theme.c and vlist.c are compiled with -fsyntax-only against these
+ * prototypes when no LVGL checkout is at hand (no LVGL_DIR). Signatures are
+ * copied from the LVGL 9.2 headers; struct layouts and enum values are
+ * placeholders, nothing here is ever linked or run. Add a declaration when
+ * the UI starts using a new LVGL function, from the same release.
+ */
+
+/* misc/lv_types.h, lv_area.h, lv_color.h */
+typedef struct _lv_obj_t lv_obj_t;
+typedef struct _lv_display_t lv_display_t;
+typedef struct _lv_timer_t lv_timer_t;
+typedef struct _lv_event_t lv_event_t;
+typedef struct _lv_event_dsc_t lv_event_dsc_t;
+typedef struct _lv_theme_t lv_theme_t;
+typedef struct _lv_font_t lv_font_t;
+
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} lv_area_t;
+
+typedef struct {
+    uint8_t blue;
+    uint8_t green;
+    uint8_t red;
+} lv_color_t;
+
+typedef uint8_t lv_opa_t;
+typedef uint32_t lv_part_t;
+typedef uint32_t lv_style_selector_t;
+
+#define LV_OPA_TRANSP   0
+#define LV_OPA_50       127
+#define LV_OPA_60       153
+#define LV_OPA_70       178
+#define LV_OPA_80       204
+#define LV_OPA_COVER    255
+
+#define LV_PART_MAIN    0x000000
+#define LV_COORD_MAX    ((1 << 29) - 1)
+#define LV_SIZE_CONTENT (LV_COORD_MAX | (1 << 29))
+#define LV_PCT(x)       ((x) < 0 ? (1000 - (x)) | (1 << 29) : (x) | (1 << 29))
+
+typedef enum {
+    LV_PALETTE_RED,
+    LV_PALETTE_PINK,
+    LV_PALETTE_PURPLE,
+    LV_PALETTE_DEEP_PURPLE,
+    LV_PALETTE_INDIGO,
+    LV_PALETTE_BLUE,
+    LV_PALETTE_LIGHT_BLUE,
+    LV_PALETTE_CYAN,
+    LV_PALETTE_TEAL,
+    LV_PALETTE_GREEN,
+    LV_PALETTE_LIGHT_GREEN,
+    LV_PALETTE_LIME,
+    LV_PALETTE_YELLOW,
+    LV_PALETTE_AMBER,
+    LV_PALETTE_ORANGE,
+    LV_PALETTE_DEEP_ORANGE,
+    LV_PALETTE_BROWN,
+    LV_PALETTE_BLUE_GREY,
+    LV_PALETTE_GREY,
+} lv_palette_t;
+
+typedef enum {
+    LV_COLOR_FORMAT_UNKNOWN = 0,
+    LV_COLOR_FORMAT_RGB565 = 0x12,
+    LV_COLOR_FORMAT_RGB888 = 0x0F,
+    LV_COLOR_FORMAT_XRGB8888 = 0x11,
+} lv_color_format_t;
+
+/* Constant expressions, like LVGL's, static buffers are sized with them */
+#define LV_COLOR_FORMAT_GET_BPP(cf) ((cf) == LV_COLOR_FORMAT_RGB565 ? 16 : \
+                                     (cf) == LV_COLOR_FORMAT_RGB888 ? 24 : \
+                                     (cf) == LV_COLOR_FORMAT_XRGB8888 ? 32 : 0)
+#define LV_COLOR_FORMAT_GET_SIZE(cf) ((LV_COLOR_FORMAT_GET_BPP(cf) + 7) >> 3)
+
+lv_color_t lv_color_hex(uint32_t c);
+lv_color_t lv_palette_main(lv_palette_t p);
+
+uint32_t lv_area_get_size(const lv_area_t *area_p);
+int32_t lv_area_get_width(const lv_area_t *area_p);
+int32_t lv_area_get_height(const lv_area_t *area_p);
+
+/* lv_init.h, tick/lv_tick.h, misc/lv_timer.h */
+typedef uint32_t (*lv_tick_get_cb_t)(void);
+typedef void (*lv_timer_cb_t)(lv_timer_t *timer);
+
+void lv_init(void);
+void lv_tick_set_cb(lv_tick_get_cb_t cb);
+uint32_t lv_tick_get(void);
+uint32_t lv_tick_elaps(uint32_t prev_tick);
+
+uint32_t lv_timer_handler(void);
+lv_timer_t *lv_timer_create(lv_timer_cb_t timer_xcb, uint32_t period, void *user_data);
+void lv_timer_delete(lv_timer_t *timer);
+void lv_timer_pause(lv_timer_t *timer);
+void lv_timer_resume(lv_timer_t *timer);
+void lv_timer_set_period(lv_timer_t *timer, uint32_t period);
+void lv_timer_set_repeat_count(lv_timer_t *timer, int32_t repeat_count);
+void lv_timer_ready(lv_timer_t *timer);
+void lv_timer_reset(lv_timer_t *timer);
+void lv_timer_enable(bool en);
+void *lv_timer_get_user_data(lv_timer_t *timer);
+
+/* misc/lv_event.h */
+typedef enum {
+    LV_EVENT_ALL = 0,
+    LV_EVENT_PRESSED,
+    LV_EVENT_CLICKED,
+    LV_EVENT_RELEASED,
+    LV_EVENT_SCROLL,
+    LV_EVENT_VALUE_CHANGED,
+    LV_EVENT_REFR_START,
+    LV_EVENT_REFR_READY,
+    LV_EVENT_RENDER_START,
+    LV_EVENT_RENDER_READY,
+    LV_EVENT_FLUSH_START,
+    LV_EVENT_FLUSH_FINISH,
+} lv_event_code_t;
+
+typedef void (*lv_event_cb_t)(lv_event_t *e);
+
+lv_event_code_t lv_event_get_code(lv_event_t *e);
+void *lv_event_get_target(lv_event_t *e);
+void *lv_event_get_current_target(lv_event_t *e);
+void *lv_event_get_user_data(lv_event_t *e);
+
+/* display/lv_display.h */
+typedef enum {
+    LV_DISPLAY_RENDER_MODE_PARTIAL,
+    LV_DISPLAY_RENDER_MODE_DIRECT,
+    LV_DISPLAY_RENDER_MODE_FULL,
+} lv_display_render_mode_t;
+
+typedef void (*lv_display_flush_cb_t)(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+
+lv_display_t *lv_display_create(int32_t hor_res, int32_t ver_res);
+lv_display_t *lv_display_get_default(void);
+void lv_display_set_buffers(lv_display_t *disp, void *buf1, void *buf2, uint32_t buf_size,
+                            lv_display_render_mode_t render_mode);
+void lv_display_set_flush_cb(lv_display_t *disp, lv_display_flush_cb_t flush_cb);
+void lv_display_flush_ready(lv_display_t *disp);
+int32_t lv_display_get_horizontal_resolution(const lv_display_t *disp);
+int32_t lv_display_get_vertical_resolution(const lv_display_t *disp);
+void lv_display_add_event_cb(lv_display_t *disp, lv_event_cb_t event_cb, lv_event_code_t filter, void *user_data);
+lv_timer_t *lv_display_get_refr_timer(lv_display_t *disp);
+void lv_display_set_theme(lv_display_t *disp, lv_theme_t *th);
+lv_obj_t *lv_screen_active(void);
+lv_obj_t *lv_layer_top(void);
+
+/* misc/lv_anim.h */
+typedef void (*lv_anim_exec_xcb_t)(void *var, int32_t value);
+
+typedef struct _lv_anim_t {
+    void *var;
+    lv_anim_exec_xcb_t exec_cb;
+    int32_t start_value;
+    int32_t end_value;
+    uint32_t duration;
+    uint32_t playback_duration;
+    uint32_t repeat_cnt;
+} lv_anim_t;
+
+#define LV_ANIM_REPEAT_INFINITE 0xFFFFFFFF
+
+typedef enum {
+    LV_ANIM_OFF,
+    LV_ANIM_ON,
+} lv_anim_enable_t;
+
+void lv_anim_init(lv_anim_t *a);
+void lv_anim_set_var(lv_anim_t *a, void *var);
+void lv_anim_set_exec_cb(lv_anim_t *a, lv_anim_exec_xcb_t exec_cb);
+void lv_anim_set_values(lv_anim_t *a, int32_t start, int32_t end);
+void lv_anim_set_duration(lv_anim_t *a, uint32_t duration);
+void lv_anim_set_playback_duration(lv_anim_t *a, uint32_t duration);
+void lv_anim_set_repeat_count(lv_anim_t *a, uint32_t cnt);
+lv_anim_t *lv_anim_start(const lv_anim_t *a);
+bool lv_anim_delete(void *var, lv_anim_exec_xcb_t exec_cb);
+
+/* misc/lv_style.h, misc/lv_text.h, font/lv_font.h */
+typedef struct {
+    void *values_and_props;
+    uint32_t has_group;
+    uint8_t prop_cnt;
+} lv_style_t;
+
+typedef enum {
+    LV_TEXT_ALIGN_AUTO,
+    LV_TEXT_ALIGN_LEFT,
+    LV_TEXT_ALIGN_CENTER,
+    LV_TEXT_ALIGN_RIGHT,
+} lv_text_align_t;
+
+extern const lv_font_t lv_font_montserrat_14;
+extern const lv_font_t lv_font_montserrat_24;
+extern const lv_font_t lv_font_montserrat_38;
+#define LV_FONT_DEFAULT (&lv_font_montserrat_14)
+
+void lv_style_init(lv_style_t *style);
+void lv_style_reset(lv_style_t *style);
+void lv_style_set_pad_all(lv_style_t *style, int32_t value);
+void lv_style_set_pad_column(lv_style_t *style, int32_t value);
+void lv_style_set_border_width(lv_style_t *style, int32_t value);
+void lv_style_set_radius(lv_style_t *style, int32_t value);
+void lv_style_set_bg_color(lv_style_t *style, lv_color_t value);
+void lv_style_set_bg_opa(lv_style_t *style, lv_opa_t value);
+void lv_style_set_text_color(lv_style_t *style, lv_color_t value);
+void lv_style_set_text_font(lv_style_t *style, const lv_font_t *value);
+void lv_style_set_text_align(lv_style_t *style, lv_text_align_t value);
+
+/* themes/default/lv_theme_default.h */
+lv_theme_t *lv_theme_default_init(lv_display_t *disp, lv_color_t color_primary, lv_color_t color_secondary,
+                                  bool dark, const lv_font_t *font);
+
+/* core/lv_obj*.h */
+typedef enum {
+    LV_OBJ_FLAG_HIDDEN = (1L << 0),
+    LV_OBJ_FLAG_CLICKABLE = (1L << 1),
+    LV_OBJ_FLAG_SCROLLABLE = (1L << 4),
+} lv_obj_flag_t;
+
+typedef enum {
+    LV_ALIGN_DEFAULT = 0,
+    LV_ALIGN_TOP_LEFT,
+    LV_ALIGN_TOP_MID,
+    LV_ALIGN_TOP_RIGHT,
+    LV_ALIGN_BOTTOM_LEFT,
+    LV_ALIGN_BOTTOM_MID,
+    LV_ALIGN_BOTTOM_RIGHT,
+    LV_ALIGN_LEFT_MID,
+    LV_ALIGN_RIGHT_MID,
+    LV_ALIGN_CENTER,
+} lv_align_t;
+
+typedef enum {
+    LV_DIR_NONE = 0x00,
+    LV_DIR_LEFT = (1 << 0),
+    LV_DIR_RIGHT = (1 << 1),
+    LV_DIR_TOP = (1 << 2),
+    LV_DIR_BOTTOM = (1 << 3),
+    LV_DIR_HOR = LV_DIR_LEFT | LV_DIR_RIGHT,
+    LV_DIR_VER = LV_DIR_TOP | LV_DIR_BOTTOM,
+    LV_DIR_ALL = LV_DIR_HOR | LV_DIR_VER,
+} lv_dir_t;
+
+typedef enum {
+    LV_SCROLLBAR_MODE_OFF,
+    LV_SCROLLBAR_MODE_ON,
+    LV_SCROLLBAR_MODE_ACTIVE,
+    LV_SCROLLBAR_MODE_AUTO,
+} lv_scrollbar_mode_t;
+
+lv_obj_t *lv_obj_create(lv_obj_t *parent);
+void lv_obj_delete(lv_obj_t *obj);
+void lv_obj_add_flag(lv_obj_t *obj, lv_obj_flag_t f);
+void lv_obj_remove_flag(lv_obj_t *obj, lv_obj_flag_t f);
+void lv_obj_set_y(lv_obj_t *obj, int32_t y);
+void lv_obj_set_size(lv_obj_t *obj, int32_t w, int32_t h);
+void lv_obj_set_width(lv_obj_t *obj, int32_t w);
+void lv_obj_set_height(lv_obj_t *obj, int32_t h);
+void lv_obj_align(lv_obj_t *obj, lv_align_t align, int32_t x_ofs, int32_t y_ofs);
+void lv_obj_update_layout(const lv_obj_t *obj);
+void lv_obj_get_coords(const lv_obj_t *obj, lv_area_t *coords);
+int32_t lv_obj_get_content_height(const lv_obj_t *obj);
+void lv_obj_invalidate(const lv_obj_t *obj);
+void lv_obj_set_scrollbar_mode(lv_obj_t *obj, lv_scrollbar_mode_t mode);
+void lv_obj_set_scroll_dir(lv_obj_t *obj, lv_dir_t dir);
+int32_t lv_obj_get_scroll_y(const lv_obj_t *obj);
+void lv_obj_scroll_to_y(lv_obj_t *obj, int32_t y, lv_anim_enable_t anim_en);
+lv_event_dsc_t *lv_obj_add_event_cb(lv_obj_t *obj, lv_event_cb_t event_cb, lv_event_code_t filter, void *user_data);
+
+void lv_obj_add_style(lv_obj_t *obj, const lv_style_t *style, lv_style_selector_t selector);
+void lv_obj_remove_style(lv_obj_t *obj, const lv_style_t *style, lv_style_selector_t selector);
+void lv_obj_remove_style_all(lv_obj_t *obj);
+void lv_obj_report_style_change(lv_style_t *style);
+void lv_obj_set_style_pad_all(lv_obj_t *obj, int32_t value, lv_style_selector_t selector);
+void lv_obj_set_style_border_width(lv_obj_t *obj, int32_t value, lv_style_selector_t selector);
+void lv_obj_set_style_bg_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector);
+void lv_obj_set_style_text_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_text_font(lv_obj_t *obj, const lv_font_t *value, lv_style_selector_t selector);
+const lv_font_t *lv_obj_get_style_text_font(const lv_obj_t *obj, lv_part_t part);
+lv_color_t lv_obj_get_style_text_color(const lv_obj_t *obj, lv_part_t part);
+lv_color_t lv_obj_get_style_bg_color(const lv_obj_t *obj, lv_part_t part);
+lv_opa_t lv_obj_get_style_bg_opa(const lv_obj_t *obj, lv_part_t part);
+int32_t lv_obj_get_style_pad_top(const lv_obj_t *obj, lv_part_t part);
+
+/* layouts/flex/lv_flex.h */
+typedef enum {
+    LV_LAYOUT_NONE = 0,
+    LV_LAYOUT_FLEX,
+    LV_LAYOUT_GRID,
+} lv_layout_t;
+
+typedef enum {
+    LV_FLEX_FLOW_ROW = 0x00,
+    LV_FLEX_FLOW_COLUMN = (1 << 0),
+} lv_flex_flow_t;
+
+void lv_obj_set_layout(lv_obj_t *obj, uint32_t layout);
+void lv_obj_set_flex_flow(lv_obj_t *obj, lv_flex_flow_t flow);
+void lv_obj_set_flex_grow(lv_obj_t *obj, uint8_t grow);
+
+/* widgets/label/lv_label.h, widgets/tabview/lv_tabview.h */
+typedef enum {
+    LV_LABEL_LONG_WRAP,
+    LV_LABEL_LONG_DOT,
+    LV_LABEL_LONG_SCROLL,
+    LV_LABEL_LONG_SCROLL_CIRCULAR,
+    LV_LABEL_LONG_CLIP,
+} lv_label_long_mode_t;
+
+lv_obj_t *lv_label_create(lv_obj_t *parent);
+void lv_label_set_text(lv_obj_t *obj, const char *text);
+void lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void lv_label_set_text_static(lv_obj_t *obj, const char *text);
+void lv_label_set_long_mode(lv_obj_t *obj, lv_label_long_mode_t long_mode);
+
+lv_obj_t *lv_tabview_create(lv_obj_t *parent);
+lv_obj_t *lv_tabview_add_tab(lv_obj_t *obj, const char *name);
+void lv_tabview_set_active(lv_obj_t *obj, uint32_t idx, lv_anim_enable_t anim_en);
+uint32_t lv_tabview_get_tab_active(lv_obj_t *obj);
+uint32_t lv_tabview_get_tab_count(lv_obj_t *obj);
+
+/* stdlib/lv_mem.h */
+typedef struct {
+    size_t total_size;
+    size_t free_cnt;
+    size_t free_size;
+    size_t free_biggest_size;
+    size_t used_cnt;
+    size_t max_used;
+    uint8_t used_pct;
+    uint8_t frag_pct;
+} lv_mem_monitor_t;
+
+void lv_mem_monitor(lv_mem_monitor_t *mon_p);
+
+/* lv_api_map_v9_0.h */
+#define lv_tabview_set_act lv_tabview_set_active
+
+#endif
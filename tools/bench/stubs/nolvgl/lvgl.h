@@ -0,0 +1,12 @@
+#ifndef BENCH_NOLVGL_H
+#define BENCH_NOLVGL_H
+
+#include <stdint.h>
+
+/* Just enough of LVGL for keyboard.c when the bench is built without LVGL */
+typedef struct _lv_obj_t lv_obj_t;
+typedef struct _lv_timer_t lv_timer_t;
+typedef struct _lv_display_t lv_display_t;
+typedef enum { LV_ANIM_OFF, LV_ANIM_ON } lv_anim_enable_t;
+
+#endif
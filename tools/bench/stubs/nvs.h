@@ -0,0 +1,20 @@
+/* Host stand-ins for the ESP-IDF APIs used by the benchmarked sources */
+#ifndef BENCH_NVS_H
+#define BENCH_NVS_H
+
+#include "esp_err.h"
+
+/* No NVS on the host: every open fails, so callers use their defaults */
+typedef uint32_t nvs_handle_t;
+typedef enum { NVS_READONLY, NVS_READWRITE } nvs_open_mode_t;
+#define ESP_ERR_NVS_NOT_FOUND   0x1102
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *len);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t len);
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out);
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value);
+esp_err_t nvs_commit(nvs_handle_t handle);
+void nvs_close(nvs_handle_t handle);
+
+#endif
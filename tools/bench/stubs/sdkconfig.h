@@ -0,0 +1,6 @@
+#ifndef BENCH_SDKCONFIG_H
+#define BENCH_SDKCONFIG_H
+
+/* Host builds: no menuconfig options set, the defaults of every Kconfig bool (n) */
+
+#endif
@@ -0,0 +1,215 @@
+/* Host stand-ins for ESP-IDF, FreeRTOS and the components not under test */
+#include <string.h>
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "nvs.h"
+#include "esp_partition.h"
+
+static int64_t virtual_us = 0;
+
+int64_t esp_timer_get_time(void) {
+    return virtual_us;
+}
+
+void bench_advance_us(int64_t us) {
+    virtual_us += us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+    *out = NULL;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    return ESP_OK;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    virtual_us += (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    virtual_us += us;
+}
+
+/* Key matrix as wired in keyboard.c */
+static const gpio_num_t row_pins[2] = { GPIO_NUM_10, GPIO_NUM_17 };
+static const gpio_num_t col_pins[5] = { GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7, GPIO_NUM_8, GPIO_NUM_9 };
+static bool keys[2][5];
+static bool standalone_key;
+static int driven_col = -1;
+
+void bench_set_key(int row, int col, bool pressed) {
+    if (row == 2) {
+        standalone_key = pressed;
+    } else {
+        keys[row][col] = pressed;
+    }
+}
+
+static int col_index(gpio_num_t pin) {
+    for (int c = 0; c < 5; c++) {
+        if (col_pins[c] == pin) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode) {
+    int c = col_index(pin);
+    if (c >= 0 && mode == GPIO_MODE_INPUT && driven_col == c) {
+        driven_col = -1;
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+    int c = col_index(pin);
+    if (c >= 0 && level) {
+        driven_col = c;
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin) {
+    if (pin == GPIO_NUM_18) {
+        return standalone_key ? 0 : 1;  // Pull-up, pressed reads low
+    }
+    for (int r = 0; r < 2; r++) {
+        if (row_pins[r] == pin) {
+            return driven_col >= 0 && keys[r][driven_col];
+        }
+    }
+    return 0;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_pullup_en(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_pullup_dis(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_pulldown_en(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_pulldown_dis(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t isr, void *arg) { return ESP_OK; }
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) { return ESP_OK; }
+esp_err_t gpio_intr_enable(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_intr_disable(gpio_num_t pin) { return ESP_OK; }
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) { return ESP_OK; }
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) { return ESP_OK; }
+void gpio_isr_handler(void *arg) { }
+
+/* SPI null sink */
+uint64_t bench_spi_bytes = 0;
+spi_device_handle_t spi = NULL;
+static spi_transaction_t *last_trans;
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans) {
+    bench_spi_bytes += trans->length / 8;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, TickType_t wait) {
+    bench_spi_bytes += trans->length / 8;
+    last_trans = trans;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, TickType_t wait) {
+    *trans = last_trans;
+    return ESP_OK;
+}
+
+/* Components that are not benchmarked */
+void dlog_write(uint8_t level, const char *tag, const char *fmt, const uint32_t *args, uint32_t nargs) {
+}
+
+typedef void (*serial_link_command_fn_t)(int argc, char **argv);
+bool serial_link_register_command(const char *name, const char *help, serial_link_command_fn_t fn) {
+    return true;
+}
+
+void set_backlight_brightness(float brightness) {
+}
+
+bool spi_set_clock(uint32_t hz) {
+    return true;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle) {
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *len) {
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t len) {
+    return ESP_FAIL;
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out) {
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value) {
+    return ESP_FAIL;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return ESP_FAIL;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return pdTRUE;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return NULL;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    return 0;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t len) {
+    return ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t len) {
+    return ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t len) {
+    return ESP_FAIL;
+}
+
+#ifdef BENCH_WITH_LVGL
+void static_mem_note_lvgl(uint32_t total, uint32_t used, uint32_t max_used, uint8_t frag_pct) {
+}
+#else
+void display_stats_toggle_overlay(void) {
+}
+#endif
@@ -0,0 +1,342 @@
+#!/usr/bin/env python3
+"""Decoder and golden-image check for the frame capture stream (components/display/frame_capture.c).
+
+Reads the telemetry UART (needs pyserial), a pseudo-terminal or a capture
+file, skips telemetry records, checks every packet's CRC and rebuilds full
+frames from the keyframe and the flushed areas after it. Prints the size,
+compression ratio and capture overhead of every frame.
+
+    capture_decode.py /dev/ttyUSB0 --save out/           # frames as out/<name>.png
+    capture_decode.py capture.bin --golden golden/       # compare with golden/<name>.png or .ppm
+    capture_decode.py /dev/ttyUSB0 --console /dev/ttyACM0 --steps tabview_states.txt --golden golden/
+
+With --console every line of the steps file ("name: command; command") is
+sent to the device console, followed by "cap name", and the tool waits for
+that frame. Frames without a name are called frame_<number>. Exits with 1 if
+a frame differs from its golden image or a packet was lost.
+"""
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+SYNC = b"\xD2\x7B"
+HEADER = struct.Struct("<2sBBHH")
+VERSION = 1
+PAYLOAD_MAX = 1024
+PKT_FRAME, PKT_AREA, PKT_END = 1, 2, 3
+FLAG_KEY = 1
+FRAME = struct.Struct("<IIHHB16s")
+AREA = struct.Struct("<HHHHIH")
+END = struct.Struct("<IHIIII")
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def rle_decode(data, count):
+    """RGB565 pixels of one area packet, see frame_capture.h."""
+    px = []
+    i = 0
+    while i < len(data) and len(px) < count:
+        token = data[i]
+        n = (token & 0x7F) + 1
+        if token & 0x80:
+            px.extend(struct.unpack_from("<H", data, i + 1) * n)
+            i += 3
+        else:
+            px.extend(struct.unpack_from("<%dH" % n, data, i + 1))
+            i += 1 + 2 * n
+    if len(px) != count or i != len(data):
+        raise ValueError("area packet decodes to %d of %d pixels" % (len(px), count))
+    return px
+
+
+class Decoder:
+    """Incremental decoder, feed() any chunking of the byte stream, returns completed frames."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.fb = None
+        self.width = self.height = 0
+        self.frame = None
+        self.packets = 0
+        self.crc_errors = 0
+        self.seq_gaps = 0
+        self.skipped = 0          # Frames before the first keyframe or with lost packets
+        self.bytes_in = 0
+        self.last_seq = None
+
+    def feed(self, data):
+        self.bytes_in += len(data)
+        self.buf += data
+        out = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                del self.buf[:-1]
+                return out
+            if start:
+                del self.buf[:start]
+            if len(self.buf) < HEADER.size:
+                return out
+            _, version, ptype, seq, length = HEADER.unpack_from(self.buf)
+            if version != VERSION or length > PAYLOAD_MAX:
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            total = HEADER.size + length + 2
+            if len(self.buf) < total:
+                return out
+            raw = bytes(self.buf[:total])
+            if crc16_ccitt(raw[2:-2]) != struct.unpack_from("<H", raw, total - 2)[0]:
+                self.crc_errors += 1
+                del self.buf[:1]  # False sync (pixel data, telemetry), search again one byte later
+                continue
+            del self.buf[:total]
+            self.packets += 1
+            if self.last_seq is not None and seq != (self.last_seq + 1) & 0xFFFF:
+                self.seq_gaps += 1
+                self._lost()
+            self.last_seq = seq
+            frame = self._packet(ptype, raw[HEADER.size:-2])
+            if frame is not None:
+                out.append(frame)
+
+    def _lost(self):
+        if self.frame is not None:
+            self.frame["lost"] = True
+        self.fb = None            # Deltas are useless until the next keyframe
+
+    def _packet(self, ptype, payload):
+        if ptype == PKT_FRAME:
+            number, time_ms, width, height, flags, name = FRAME.unpack(payload)
+            if flags & FLAG_KEY:
+                self.fb = [0] * (width * height)
+                self.width, self.height = width, height
+            name = name.rstrip(b"\0").decode("ascii", "replace") or "frame_%05d" % number
+            self.frame = {"number": number, "name": name, "time_ms": time_ms, "key": bool(flags & FLAG_KEY),
+                          "lost": self.fb is None, "next": {}}
+        elif ptype == PKT_AREA and self.frame is not None:
+            x1, y1, x2, y2, offset, count = AREA.unpack_from(payload)
+            w = x2 - x1 + 1
+            key = (x1, y1, x2, y2)
+            if self.frame["next"].get(key, 0) != offset:
+                self.frame["lost"] = True
+            self.frame["next"][key] = offset + count
+            if self.frame["lost"]:
+                return None
+            for i, c in enumerate(rle_decode(payload[AREA.size:], count), offset):
+                self.fb[(y1 + i // w) * self.width + x1 + i % w] = c
+        elif ptype == PKT_END and self.frame is not None:
+            frame, self.frame = self.frame, None
+            number, frame["areas"], frame["pixels"], frame["bytes"], frame["capture_us"], frame["frame_us"] = \
+                END.unpack(payload)
+            if frame["lost"] or self.fb is None:
+                self.skipped += 1
+                return None
+            frame["fb"] = list(self.fb)
+            return frame
+        return None
+
+
+def rgb888(fb):
+    out = bytearray()
+    for c in fb:
+        r, g, b = c >> 11, (c >> 5) & 0x3F, c & 0x1F
+        out += bytes(((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)))
+    return out
+
+
+def write_png(path, width, height, rgb):
+    def chunk(tag, data):
+        return struct.pack(">I", len(data)) + tag + data + struct.pack(">I", zlib.crc32(tag + data))
+    rows = b"".join(b"\0" + bytes(rgb[y * width * 3:(y + 1) * width * 3]) for y in range(height))
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(rows, 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def read_png(path):
+    """PNGs written by write_png (8 bit RGB, filter 0), returns (width, height, rgb)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    pos, idat, width = 8, b"", None
+    while pos < len(data):
+        length, tag = struct.unpack_from(">I4s", data, pos)
+        body = data[pos + 8:pos + 8 + length]
+        if tag == b"IHDR":
+            width, height, depth, ctype = struct.unpack_from(">IIBB", body)
+            if depth != 8 or ctype != 2:
+                raise ValueError("%s: only 8 bit RGB (as written by --save)" % path)
+        elif tag == b"IDAT":
+            idat += body
+        pos += 12 + length
+    raw = zlib.decompress(idat)
+    stride = width * 3 + 1
+    if any(raw[y * stride] != 0 for y in range(height)):
+        raise ValueError("%s: filtered rows, save golden images with --save" % path)
+    return width, height, b"".join(raw[y * stride + 1:(y + 1) * stride] for y in range(height))
+
+
+def read_ppm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = data.split(maxsplit=4)
+    if fields[0] != b"P6" or fields[3] != b"255":
+        raise ValueError("%s: only binary 8 bit PPM" % path)
+    return int(fields[1]), int(fields[2]), fields[4][:int(fields[1]) * int(fields[2]) * 3]
+
+
+def compare(frame, width, height, golden_dir):
+    """Returns None if no golden image exists, else (differing pixels, bounding box)."""
+    for ext, reader in ((".png", read_png), (".ppm", read_ppm)):
+        path = os.path.join(golden_dir, frame["name"] + ext)
+        if os.path.isfile(path):
+            break
+    else:
+        return None
+    gw, gh, golden = reader(path)
+    if (gw, gh) != (width, height):
+        return width * height, (0, 0, width - 1, height - 1)
+    rgb = rgb888(frame["fb"])
+    diff, box = 0, [width, height, -1, -1]
+    for i in range(width * height):
+        if rgb[i * 3:i * 3 + 3] != golden[i * 3:i * 3 + 3]:
+            diff += 1
+            x, y = i % width, i // width
+            box = [min(box[0], x), min(box[1], y), max(box[2], x), max(box[3], y)]
+    return diff, tuple(box)
+
+
+def open_source(path, baud):
+    if os.path.isfile(path):
+        f = open(path, "rb")
+        return lambda: f.read(65536)
+    try:
+        import serial
+        port = serial.Serial(path, baud, timeout=0.2)
+        return lambda: port.read(65536)
+    except ImportError:
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)  # Raw pty / device without pyserial
+        return lambda: os.read(fd, 65536)
+
+
+def open_console(path):
+    try:
+        import serial
+        port = serial.Serial(path, 115200, timeout=0.2)
+        return lambda line: port.write(line.encode() + b"\n")
+    except ImportError:
+        fd = os.open(path, os.O_WRONLY | os.O_NOCTTY)
+        return lambda line: os.write(fd, line.encode() + b"\n")
+
+
+def read_steps(path):
+    steps = []
+    with open(path) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if line:
+                name, _, commands = line.partition(":")
+                steps.append((name.strip(), [c.strip() for c in commands.split(";") if c.strip()]))
+    return steps
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="telemetry serial port, pty or capture file")
+    ap.add_argument("--baud", type=int, default=921600)
+    ap.add_argument("--save", metavar="DIR", help="write every frame as DIR/<name>.png")
+    ap.add_argument("--golden", metavar="DIR", help="compare frames with DIR/<name>.png or .ppm")
+    ap.add_argument("--console", metavar="PORT", help="device console (native USB) to drive --steps")
+    ap.add_argument("--steps", metavar="FILE", help="states to capture, 'name: command; command' per line")
+    ap.add_argument("--settle", type=float, default=0.5, help="seconds between a step's commands and cap")
+    ap.add_argument("--timeout", type=float, default=10.0, help="seconds to wait for a frame (serial)")
+    args = ap.parse_args()
+
+    if args.save:
+        os.makedirs(args.save, exist_ok=True)
+    read = open_source(args.source, args.baud)
+    is_file = os.path.isfile(args.source)
+    steps = read_steps(args.steps) if args.steps else []
+    send = open_console(args.console) if args.console else None
+    if steps and send is None:
+        ap.error("--steps needs --console")
+
+    dec = Decoder()
+    frames = mismatches = missing = 0
+    total_bytes = total_pixels = 0
+    pending = list(steps)
+    waiting = None
+    deadline = None
+    print("%-20s %5s %6s %8s %8s %7s %9s %9s %s" % (
+        "frame", "key", "areas", "pixels", "bytes", "ratio", "capture", "frame", "golden"))
+    try:
+        while True:
+            if send is not None and waiting is None:
+                if not pending:
+                    break
+                waiting, commands = pending.pop(0)
+                for command in commands:
+                    send(command)
+                time.sleep(args.settle)
+                send("cap " + waiting)
+                deadline = time.monotonic() + args.timeout
+            data = read()
+            if not data and is_file:
+                break
+            if deadline is not None and time.monotonic() > deadline:
+                print("%s: no frame within %.0f s" % (waiting, args.timeout), file=sys.stderr)
+                missing += 1
+                waiting = None
+                continue
+            for frame in dec.feed(data):
+                frames += 1
+                total_bytes += frame["bytes"]
+                total_pixels += frame["pixels"]
+                ratio = frame["pixels"] * 2 / frame["bytes"] if frame["bytes"] else 0
+                result = "-"
+                if args.golden:
+                    cmp = compare(frame, dec.width, dec.height, args.golden)
+                    if cmp is None:
+                        result = "no golden image"
+                        missing += 1
+                    elif cmp[0] == 0:
+                        result = "ok"
+                    else:
+                        result = "DIFF %d px in %d,%d - %d,%d" % ((cmp[0],) + cmp[1])
+                        mismatches += 1
+                print("%-20s %5s %6d %8d %8d %6.1f:1 %6d us %6d us %s" % (
+                    frame["name"], "key" if frame["key"] else "", frame["areas"], frame["pixels"],
+                    frame["bytes"], ratio, frame["capture_us"], frame["frame_us"], result))
+                if args.save:
+                    write_png(os.path.join(args.save, frame["name"] + ".png"),
+                              dec.width, dec.height, rgb888(frame["fb"]))
+                if frame["name"] == waiting:
+                    waiting = None
+    except KeyboardInterrupt:
+        pass
+
+    print("total: %d frames, %d packets, %d bytes in, %.1f:1, %d crc errors, %d seq gaps, %d skipped" % (
+        frames, dec.packets, dec.bytes_in, total_pixels * 2 / total_bytes if total_bytes else 0,
+        dec.crc_errors, dec.seq_gaps, dec.skipped), file=sys.stderr)
+    if args.golden:
+        print("golden: %d differ, %d without image or frame" % (mismatches, missing), file=sys.stderr)
+    failed = mismatches or dec.seq_gaps or (args.golden and (missing or frames == 0))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+/* Host simulation of the game clock discipline (main/clock_discipline.c)
+ *
+ * Runs the tick task and a stream of reference samples against a virtual
+ * clock, 1 ms per step, for a set of noisy reference scenarios. For each one
+ * reports how long the clock takes to converge, the worst error once
+ * converged and the largest slew rate used, and checks them against limits.
+ *
+ * Build:
+ *   cc -O2 -o clock_sim tools/clock_sim/clock_sim.c main/clock_discipline.c
+ *
+ * Usage:
+ *   clock_sim [-s seed] [-t scenario] [-v]
+ *
+ * -v prints a CSV trace (t_ms, error_us, period_us) of the selected scenario.
+ * Exits with 1 if any scenario misses its limits.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../main/clock_discipline.h"
+
+#define CONVERGED_US    100000  // Error below this counts as converged
+#define BOOT_US         3000000 // Local time when the match starts
+
+typedef struct {
+    const char *name;
+    int32_t drift_ppm;          // Local oscillator fast (+) or slow (-)
+    int32_t initial_us;         // Reference minus device game time at start
+    int32_t latency_us;         // Fixed delivery delay of a sample
+    int32_t jitter_us;          // Extra delay, uniform 0..jitter
+    int32_t outlier_pct;        // Samples delivered late by up to outlier_us
+    int32_t outlier_us;
+    int32_t sample_every_s;     // Reference second edges that produce a sample
+    int32_t duration_s;
+    int32_t converge_limit_s;   // Limits checked at the end
+    int32_t error_limit_us;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    // name         drift   initial   lat    jitter  out%  out_us   every dur  conv  err
+    {"clean",          0,   800000, 30000,      0,   0,       0,   1, 300,  30, 20000},
+    {"jitter",        40, -1500000, 30000, 100000,   0,       0,   1, 300,  90, 80000},
+    {"drift",      15000,   400000, 30000, 100000,   0,       0,   1, 600,  60, 80000},
+    {"outliers",     -60,  1000000, 30000, 100000,  10, 2000000,   1, 600,  60, 95000},
+    {"sparse",       200,  -900000, 30000,  50000,   0,       0,  10, 900, 120, 80000},
+    {"step",          10, 12000000, 30000, 100000,   0,       0,   1, 300,  45, 80000},
+};
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static uint64_t rng_state;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+static int32_t rng_range(int32_t max) {
+    return max > 0 ? (int32_t)(rng() % (uint32_t)max) : 0;
+}
+
+static int run(const scenario_t *sc, bool trace) {
+    clock_discipline_t cd;
+    clock_discipline_reset(&cd);
+
+    // Device game timer starts at 0, the reference is initial_us ahead of it
+    uint32_t game_seconds = 0;
+    int64_t next_tick_local = BOOT_US + CD_NOMINAL_PERIOD_US;
+    int64_t next_edge = 1;                      // Next reference second
+    int64_t arrival = -1;
+    int64_t last_arrival = 0;
+    int64_t converged_at = 0;
+    int64_t max_error = 0, max_error_late = 0;
+    int32_t max_slew_ppm = 0;
+    uint32_t accepted = 0;
+    int64_t duration = (int64_t)sc->duration_s * 1000000;
+
+    clock_discipline_tick(&cd, BOOT_US);  // Timer started at the boot of the simulation
+    while (next_edge * 1000000 - sc->initial_us <= 0) {
+        next_edge++;
+    }
+    for (int64_t t = 0; t <= duration; t += 1000) {
+        int64_t local = BOOT_US + t + t * sc->drift_ppm / 1000000;
+        int64_t reference = t + sc->initial_us;
+
+        // Tick task: one game second per (disciplined) period of the local clock
+        if (local >= next_tick_local) {
+            game_seconds++;
+            clock_discipline_tick(&cd, local);
+            next_tick_local += cd.period_us;
+        }
+
+        // Reference: each second edge is seen after a delay, in order
+        while (arrival < 0) {
+            int64_t edge_t = next_edge * 1000000 - sc->initial_us;
+            int64_t delay = sc->latency_us + rng_range(sc->jitter_us);
+            if (rng_range(100) < sc->outlier_pct) {
+                delay += rng_range(sc->outlier_us);
+            }
+            arrival = edge_t + delay;
+            if (arrival <= last_arrival) {
+                next_edge += sc->sample_every_s;  // Sent while a late one was stalled, superseded
+                arrival = -1;
+            }
+        }
+        if (t >= arrival) {
+            int64_t ref_us = next_edge * 1000000 + sc->latency_us;
+            int64_t local_us = clock_discipline_local_us(&cd, game_seconds, true, local);
+            cd_result_t result = clock_discipline_sample(&cd, ref_us, local_us, local);
+            if (result == CD_STEP) {
+                game_seconds = (uint32_t)next_edge;
+                clock_discipline_stepped(&cd);
+            } else if (result == CD_ACCEPTED) {
+                accepted++;
+            }
+            last_arrival = arrival;
+            arrival = -1;
+            next_edge += sc->sample_every_s;
+        }
+
+        int64_t error = clock_discipline_local_us(&cd, game_seconds, true, local) - reference;
+        if (error < 0) {
+            error = -error;
+        }
+        if (error > CONVERGED_US) {
+            converged_at = t;
+        }
+        if (error > max_error) {
+            max_error = error;
+        }
+        if (t > duration / 2 && error > max_error_late) {
+            max_error_late = error;
+        }
+        int32_t slew = (int32_t)(1000000LL * CD_NOMINAL_PERIOD_US / cd.period_us) - 1000000;
+        slew = slew < 0 ? -slew : slew;
+        if (slew > max_slew_ppm) {
+            max_slew_ppm = slew;
+        }
+        if (trace && t % 100000 == 0) {
+            printf("%lld,%lld,%d\n", (long long)(t / 1000), (long long)error, cd.period_us);
+        }
+    }
+
+    // The tick period is computed in whole microseconds, allow for the rounding
+    bool ok = converged_at <= (int64_t)sc->converge_limit_s * 1000000 &&
+              max_error_late <= sc->error_limit_us && max_slew_ppm <= CD_MAX_SLEW_PPM + 2;
+    if (!trace) {
+        printf("%-9s converged %6.1f s  max error %5lld ms  late max %4lld ms  slew %5d ppm  "
+               "samples %4u rejected %3u steps %u  freq %6d ppm  %s\n",
+               sc->name, converged_at / 1e6, (long long)(max_error / 1000), (long long)(max_error_late / 1000),
+               max_slew_ppm, accepted, cd.rejected, cd.steps, cd.freq_ppm, ok ? "ok" : "FAIL");
+    }
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    uint64_t seed = 1;
+    const char *only = NULL;
+    bool trace = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "-v") == 0) {
+            trace = true;
+        } else {
+            fprintf(stderr, "usage: clock_sim [-s seed] [-t scenario] [-v]\n");
+            return 2;
+        }
+    }
+
+    int failures = 0;
+    for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+        if (only != NULL && strcmp(only, scenarios[i].name) != 0) {
+            continue;
+        }
+        rng_state = seed;
+        failures += run(&scenarios[i], trace && only != NULL);
+    }
+    return failures ? 1 : 0;
+}
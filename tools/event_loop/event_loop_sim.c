@@ -0,0 +1,330 @@
+/* Host simulation of the two execution models (EVENT_LOOP in main/event_loop.h)
+ *
+ * The same work runs on a virtual clock, once scheduled like the three tasks
+ * and once through main/event_loop.c like app_loop_task:
+ *   keys   a scan every 50 ms (SCAN_US); a press is seen by the first scan
+ *          after it and posts a UI command (FLASH_ROW), which notifies LVGL
+ *   tick   every second (TICK_US); the labels change, LVGL has to redraw them
+ *   lvgl   applies the UI commands, and when its refresh timer is due (every
+ *          refr_ms after the last refresh) renders and flushes what changed
+ * Three tasks: keys alone on core 0, lvgl (prio 6) and tick (prio 4) share
+ * core 1, a running pass is never preempted (the tick is short). The event
+ * loop runs everything on core 1, the key scan with EVENT_LOOP_KEY_SLACK_MS.
+ *
+ * Reports per model the stack RAM of the three jobs, context switches per
+ * second (one into the task and one back to IDLE per wakeup, as the
+ * traceTASK_SWITCHED_IN counter of "prof" sees them), tick lateness, and
+ * key-to-display latency (press to the end of the flush that shows it).
+ *
+ * Build:
+ *   cc -O2 -o event_loop_sim tools/event_loop/event_loop_sim.c main/event_loop.c
+ *
+ * Usage:
+ *   event_loop_sim [-t seconds] [-s seed] [-R refr_ms] [-r render_us] [-v]
+ *
+ * -v prints the timer statistics (as the "loop" console command) of the event loop.
+ * Exits with 1 if a press never reaches the panel, a tick is lost or the
+ * event loop is late by more than a render.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../main/event_loop.h"
+
+#define SCAN_PERIOD_US      50000
+#define SCAN_US             400     // 5 columns
+#define TICK_PERIOD_US      1000000
+#define TICK_US             60      // time_tracker_tick() and its listeners
+#define HANDLER_US          150     // lv_timer_handler() without a refresh
+#define APPLY_US            20      // One UI command
+#define MAX_IDLE_US         100000  // LVGL_TASK_MAX_IDLE_MS
+#define MAX_PRESSES         4096
+
+/* Stacks from components/static_mem/static_mem.h, TCB as StaticTask_t on the ESP32-S3 */
+#define STACK_THREE_TASKS   (2048 + 8192 + 2048)
+#define STACK_ONE_LOOP      8192
+#define TCB_BYTES           352
+
+typedef struct {
+    const char *name;
+    int64_t press_us[MAX_PRESSES];
+    int64_t shown_us[MAX_PRESSES];  // End of the flush that shows the press, 0 = not yet
+    int presses;
+    uint32_t switches;
+    uint32_t ticks;
+    int64_t tick_late_total_us;
+    int64_t tick_late_max_us;
+} model_t;
+
+/* Shared LVGL model */
+typedef struct {
+    int64_t refr_due_us;
+    bool dirty;
+    int pending_first;              // Oldest press posted but not yet shown
+    int posted;                     // Presses whose UI command is queued
+} lvgl_t;
+
+static int64_t press_at[MAX_PRESSES];
+static int press_total = 0;
+static int64_t refr_us = 33000;
+static int64_t render_us = 6000;   // Hero row or timer labels, rendered and flushed
+
+static uint64_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+/* Presses 0.3 - 3 s apart */
+static void generate(int64_t end_us) {
+    int64_t t = 200000 + rng() % 100000;
+    while (t < end_us && press_total < MAX_PRESSES) {
+        press_at[press_total++] = t;
+        t += 300000 + rng() % 2700000;
+    }
+}
+
+/* @brief One scan at now: the presses since the previous scan are seen
+ * @return Presses seen, their UI commands are posted at now + SCAN_US
+ */
+static int keys_scan(int *next_press, int64_t now) {
+    int seen = 0;
+    while (*next_press < press_total && press_at[*next_press] <= now) {
+        (*next_press)++;
+        seen++;
+    }
+    return seen;
+}
+
+/* @brief One lvgl pass starting at now
+ * @return Its end, *idle_us is what lv_timer_handler() returns
+ */
+static int64_t lvgl_pass(lvgl_t *lv, model_t *m, int64_t now, int64_t *idle_us) {
+    now += APPLY_US * (lv->posted - lv->pending_first) + HANDLER_US;
+    if (lv->posted > lv->pending_first) {
+        lv->dirty = true;
+    }
+    int shown = lv->posted;
+    if (now >= lv->refr_due_us) {
+        if (lv->dirty) {
+            now += render_us;
+            lv->dirty = false;
+            for (int i = lv->pending_first; i < shown; i++) {
+                m->shown_us[i] = now;
+            }
+            lv->pending_first = shown;
+        }
+        lv->refr_due_us = now + refr_us;
+    }
+    *idle_us = lv->refr_due_us - now;
+    if (*idle_us > MAX_IDLE_US) {
+        *idle_us = MAX_IDLE_US;
+    }
+    if (*idle_us < 1000) {
+        *idle_us = 1000;            // One tick at least, as lvgl_task
+    }
+    return now;
+}
+
+static void tick_done(model_t *m, int64_t deadline, int64_t start) {
+    int64_t late = start - deadline;
+    m->ticks++;
+    m->tick_late_total_us += late;
+    if (late > m->tick_late_max_us) {
+        m->tick_late_max_us = late;
+    }
+}
+
+/* @brief Three tasks, keys on core 0, lvgl and tick on core 1 */
+static void run_tasks(model_t *m, int64_t end_us) {
+    lvgl_t lv = { 0 };
+    int64_t post_us[MAX_PRESSES];
+    int next_press = 0, posts = 0;
+
+    // Core 0: scans never wait for anything, every one is a wakeup
+    for (int64_t t = SCAN_PERIOD_US; t < end_us; t += SCAN_PERIOD_US) {
+        int seen = keys_scan(&next_press, t);
+        for (int i = 0; i < seen; i++) {
+            post_us[posts++] = t + SCAN_US;
+        }
+        m->switches += 2;
+    }
+    m->presses = posts;
+    memcpy(m->press_us, press_at, sizeof(press_at[0]) * posts);
+
+    // Core 1: lvgl wakes on its timeout or a post, tick on its deadline
+    int64_t core = 0, lvgl_wake = 0, tick_due = TICK_PERIOD_US;
+    int next_post = 0;
+    bool idle = true;
+    while (core < end_us) {
+        int64_t lvgl_ready = lvgl_wake;
+        if (next_post < posts && post_us[next_post] < lvgl_ready) {
+            lvgl_ready = post_us[next_post];
+        }
+        int64_t start = lvgl_ready <= tick_due ? lvgl_ready : tick_due;
+        if (start > core) {
+            core = start;
+            idle = true;
+        }
+        if (idle) {
+            m->switches += 2;       // Into the task, later back to IDLE
+            idle = false;
+        } else {
+            m->switches++;          // From the other task
+        }
+        if (lvgl_ready <= core) {   // Higher priority
+            int64_t idle_us;
+            while (next_post < posts && post_us[next_post] <= core) {
+                next_post++;
+            }
+            lv.posted = next_post;
+            core = lvgl_pass(&lv, m, core, &idle_us);
+            lvgl_wake = core + idle_us;
+        } else {
+            tick_done(m, tick_due, core);
+            core += TICK_US;
+            lv.dirty = true;
+            lvgl_wake = core;       // Label text set, next pass renders it
+            tick_due += TICK_PERIOD_US;
+        }
+    }
+}
+
+/* Event loop model, on the real timer queue */
+static event_loop_t loop;
+static model_t *loop_model;
+static lvgl_t loop_lv;
+static int64_t sim_now;
+static int loop_next_press;
+static int loop_posts;
+static bool loop_notified;
+
+static int64_t sim_clock(void) {
+    return sim_now;
+}
+
+static int64_t sim_tick(int64_t deadline_us, int64_t now_us) {
+    tick_done(loop_model, deadline_us, now_us);
+    sim_now += TICK_US;
+    loop_lv.dirty = true;
+    loop_notified = true;           // Label text set, kick the lvgl timer
+    return deadline_us + TICK_PERIOD_US;
+}
+
+static int64_t sim_keys(int64_t deadline_us, int64_t now_us) {
+    int seen = keys_scan(&loop_next_press, now_us);
+    sim_now += SCAN_US;
+    if (seen > 0) {
+        loop_posts += seen;
+        loop_notified = true;       // ui_cmd_post to itself
+    }
+    return now_us + SCAN_PERIOD_US;
+}
+
+static int64_t sim_lvgl(int64_t deadline_us, int64_t now_us) {
+    int64_t idle_us;
+    loop_lv.posted = loop_posts;
+    sim_now = lvgl_pass(&loop_lv, loop_model, now_us, &idle_us);
+    return sim_now + idle_us;
+}
+
+static void run_loop(model_t *m, int64_t end_us, int verbose) {
+    int lvgl;
+
+    memset(&loop_lv, 0, sizeof(loop_lv));
+    loop_model = m;
+    loop_next_press = loop_posts = 0;
+    sim_now = 0;
+    event_loop_init(&loop, sim_clock);
+    event_loop_add(&loop, "tick", sim_tick, TICK_PERIOD_US);
+    int keys = event_loop_add(&loop, "keys", sim_keys, SCAN_PERIOD_US);
+    event_loop_set_slack(&loop, keys, EVENT_LOOP_KEY_SLACK_MS * 1000);
+    lvgl = event_loop_add(&loop, "lvgl", sim_lvgl, 0);
+
+    while (sim_now < end_us) {
+        loop_notified = false;
+        event_loop_run_due(&loop);
+        if (loop_notified) {
+            event_loop_kick(&loop, lvgl);   // ulTaskNotifyTake returns right away
+            continue;
+        }
+        int64_t next = event_loop_wake_at(&loop);
+        if (next > sim_now) {
+            sim_now = next;
+            m->switches += 2;
+        }
+    }
+    m->presses = loop_posts;
+    memcpy(m->press_us, press_at, sizeof(press_at[0]) * loop_posts);
+    if (verbose) {
+        event_loop_print(&loop);
+    }
+}
+
+static int cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* @return Presses not shown */
+static int report(const model_t *m, double seconds, uint32_t ram) {
+    static int64_t lat[MAX_PRESSES];
+    int n = 0, lost = 0;
+
+    for (int i = 0; i < m->presses; i++) {
+        if (m->shown_us[i] == 0) {
+            lost++;
+        } else {
+            lat[n++] = m->shown_us[i] - m->press_us[i];
+        }
+    }
+    qsort(lat, n, sizeof(lat[0]), cmp_i64);
+    printf("%-12s %6lu %9.1f %8.0f %8.0f %8.1f %8.1f %8.1f %5d\n", m->name, (unsigned long)ram,
+           m->switches / seconds, m->ticks ? (double)m->tick_late_total_us / m->ticks : 0.0,
+           (double)m->tick_late_max_us, n ? lat[n / 2] / 1000.0 : 0.0, n ? lat[n * 99 / 100] / 1000.0 : 0.0,
+           n ? lat[n - 1] / 1000.0 : 0.0, lost);
+    return lost;
+}
+
+int main(int argc, char **argv) {
+    static model_t tasks = { .name = "three tasks" }, looped = { .name = "event loop" };
+    int seconds = 600, verbose = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) {
+            refr_us = atoi(argv[++i]) * 1000LL;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            render_us = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else {
+            fprintf(stderr, "usage: event_loop_sim [-t seconds] [-s seed] [-R refr_ms] [-r render_us] [-v]\n");
+            return 2;
+        }
+    }
+
+    int64_t end_us = (int64_t)seconds * 1000000;
+    generate(end_us - 1000000);     // The last presses still get to the panel
+    run_tasks(&tasks, end_us);
+    run_loop(&looped, end_us, verbose);
+
+    printf("%d s, %d presses, refresh %lld ms, render %lld us\n", seconds, press_total,
+           (long long)(refr_us / 1000), (long long)render_us);
+    printf("%-12s %6s %9s %8s %8s %8s %8s %8s %5s\n", "model", "ram", "switch/s", "tick avg", "tick max",
+           "key p50", "key p99", "key max", "lost");
+    int lost = report(&tasks, seconds, STACK_THREE_TASKS + 3 * TCB_BYTES);
+    lost += report(&looped, seconds, STACK_ONE_LOOP + TCB_BYTES);
+
+    bool ok = lost == 0 && looped.ticks >= (uint32_t)(seconds - 1) &&
+              looped.tick_late_max_us <= render_us + HANDLER_US + SCAN_US + 2 * APPLY_US;
+    if (!ok) {
+        printf("FAIL\n");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/* Host simulation of the frame-budget governor (components/display/frame_budget.c)
+ *
+ * Drives the governor with the refresh pattern of the Buybacks tab: every
+ * hero row and the footer redraw once per second, 0 - 5 rows are highlighted
+ * (fade, blink or steady colour as picked by frame_budget_pick_fx(), updated
+ * every 250 ms like hero_timer), and some scenarios add a touch scroll that
+ * redraws the whole screen every frame for a while. Frame cost is a fixed
+ * render overhead plus a per-pixel cost with jitter.
+ *
+ * For each scenario reports the level the governor settles on, the load
+ * (render + flush per 33 ms frame) and the share of windows over budget after
+ * the first two seconds, and fails if the load is over budget for more than
+ * the scroll itself accounts for.
+ *
+ * Build:
+ *   cc -O2 -o fb_sim tools/frame_budget/fb_sim.c components/display/frame_budget.c
+ *
+ * Usage:
+ *   fb_sim [-s seed] [-v]
+ *
+ * -v prints the governor statistics (as the "fb" console command) per scenario.
+ * Exits with 1 if any scenario misses the budget.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../components/display/frame_budget.h"
+
+#define HERO_COUNT      5
+#define ROW_PX          (448 * 30)  // Hero label, 24 pt font
+#define FOOTER_PX       (480 * 30)
+#define SCREEN_PX       (480 * 320)
+#define RENDER_FIXED_US 600         // Per refresh, before any pixel
+#define SIM_MS          30000
+#define SETTLE_MS       2000
+
+typedef struct {
+    const char *name;
+    uint32_t ns_per_px;             // Render + SPI per pixel
+    int rows;                       // Highlighted rows
+    int scroll_from_ms;             // Full-screen redraw every frame, 0 = none
+    int scroll_to_ms;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "idle 80 MHz",            250, 0, 0, 0 },
+    { "1 row 80 MHz",           250, 1, 0, 0 },
+    { "5 rows 80 MHz",          250, 5, 0, 0 },
+    { "5 rows 40 MHz",          500, 5, 0, 0 },
+    { "5 rows slow SPI",       1000, 5, 0, 0 },
+    { "5 rows + scroll",        250, 5, 10000, 13000 },
+    { "3 rows 40 MHz + scroll", 500, 3, 5000, 8000 },
+};
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static int run(const scenario_t *sc, int verbose) {
+    frame_budget_t fb;
+    fb_fx_t fx[HERO_COUNT] = { 0 };
+    int blink_on[HERO_COUNT];
+    bool dirty[HERO_COUNT + 1];
+    uint32_t windows = 0, windows_over = 0, windows_scroll = 0;
+    uint64_t load_sum = 0;
+    uint32_t last_windows = 0;
+
+    frame_budget_init(&fb, FB_BUDGET_US);
+    memset(blink_on, -1, sizeof(blink_on));
+    memset(dirty, 0, sizeof(dirty));
+
+    int next_frame = 0, next_hero_timer = 0, next_second = 0;
+    for (int t = 0; t < SIM_MS; t++) {
+        if (t == next_second) {             // Text of every row and the footer
+            for (int i = 0; i <= HERO_COUNT; i++) {
+                dirty[i] = true;
+            }
+            next_second += 1000;
+        }
+        if (t == next_hero_timer) {         // row_highlight_update()
+            uint32_t anim_px = frame_budget_anim_px(&fb);
+            int phase = (t / FB_BLINK_MS) & 1;
+            for (int i = 0; i < HERO_COUNT; i++) {
+                fb_fx_t want = i < sc->rows ? frame_budget_pick_fx(&fb, ROW_PX, &anim_px) : FB_FX_NONE;
+                if (want != fx[i]) {
+                    fx[i] = want;
+                    blink_on[i] = -1;
+                    dirty[i] = true;
+                }
+                if (fx[i] == FB_FX_BLINK && blink_on[i] != phase) {
+                    blink_on[i] = phase;
+                    dirty[i] = true;
+                }
+            }
+            next_hero_timer += 250;
+        }
+        if (t < next_frame) {
+            continue;
+        }
+
+        // Refresh timer
+        bool scroll = t >= sc->scroll_from_ms && t < sc->scroll_to_ms;
+        uint32_t px = 0;
+        if (scroll) {
+            px = SCREEN_PX;
+        } else {
+            for (int i = 0; i <= HERO_COUNT; i++) {
+                if (dirty[i] || (i < HERO_COUNT && fx[i] == FB_FX_FADE)) {
+                    px += i < HERO_COUNT ? ROW_PX : FOOTER_PX;
+                }
+            }
+        }
+        memset(dirty, 0, sizeof(dirty));
+        int period = fb.level == FB_FULL ? FB_REFR_PERIOD_FULL_MS : FB_REFR_PERIOD_SLOW_MS;
+        next_frame = t + period;
+        if (px == 0) {
+            continue;
+        }
+        uint64_t cost = (uint64_t)px * sc->ns_per_px / 1000;
+        uint32_t frame_us = RENDER_FIXED_US + (uint32_t)(cost * (90 + rng() % 21) / 100);
+        frame_budget_frame(&fb, (int64_t)t * 1000 + frame_us, frame_us, px);
+
+        if (fb.windows != last_windows) {
+            last_windows = fb.windows;
+            if (t >= SETTLE_MS) {
+                windows++;
+                load_sum += fb.load_us;
+                if (fb.load_us > fb.budget_us) {
+                    windows_over++;
+                    // Windows touching the scroll are over budget whatever the highlights do
+                    if (t >= sc->scroll_from_ms && t < sc->scroll_to_ms + FB_WINDOW_MS) {
+                        windows_scroll++;
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t over_pct = windows ? windows_over * 100 / windows : 0;
+    int ok = windows_over == windows_scroll;
+    printf("%-24s %-8s %6lu %8lu %6lu%% %7lu %s\n", sc->name, fb_level_names[fb.level],
+           (unsigned long)(windows ? load_sum / windows : 0), (unsigned long)fb.max_load_us,
+           (unsigned long)over_pct, (unsigned long)fb.level_changes, ok ? "ok" : "OVER");
+    if (verbose) {
+        frame_budget_print(&fb);
+        printf("\n");
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int verbose = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else {
+            fprintf(stderr, "usage: fb_sim [-s seed] [-v]\n");
+            return 2;
+        }
+    }
+
+    printf("budget %d us per %d ms frame\n", FB_BUDGET_US, FB_REFR_PERIOD_FULL_MS);
+    printf("%-24s %-8s %6s %8s %7s %7s\n", "scenario", "level", "load", "max load", "over", "changes");
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        failed += !run(&scenarios[i], verbose);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+/* Host benchmark for the streaming GSI parser (components/gsi/gsi_parser.c)
+ *
+ * Build:
+ *   cc -O2 -o gsi_bench tools/gsi/gsi_bench.c components/gsi/gsi_parser.c
+ *
+ * Usage:
+ *   gsi_bench [-n iterations] [-c chunk_bytes] payload.json...
+ *
+ * Every payload is fed in chunks of -c bytes (default 64, roughly one USB
+ * packet) to mimic bytes arriving over the serial link. Reports throughput
+ * and the worst-case time spent in a single feed call and a whole payload.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../components/gsi/gsi_parser.h"
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint8_t *load(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc(size > 0 ? size : 1);
+    *len = fread(buf, 1, size, f);
+    fclose(f);
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    unsigned long iterations = 10000;
+    size_t chunk = 64;
+    int first = 1;
+
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-n") == 0 && first + 1 < argc) {
+            iterations = strtoul(argv[first + 1], NULL, 0);
+        } else if (strcmp(argv[first], "-c") == 0 && first + 1 < argc) {
+            chunk = strtoul(argv[first + 1], NULL, 0);
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    if (first >= argc || chunk == 0) {
+        fprintf(stderr, "usage: gsi_bench [-n iterations] [-c chunk_bytes] payload.json...\n");
+        return 2;
+    }
+
+    printf("parser state: %zu bytes, chunk %zu bytes\n", sizeof(gsi_parser_t), chunk);
+    for (int f = first; f < argc; f++) {
+        size_t len;
+        uint8_t *payload = load(argv[f], &len);
+        if (payload == NULL) {
+            return 2;
+        }
+
+        gsi_parser_t parser;
+        double worst_feed = 0, worst_payload = 0;
+        double start = now_ns();
+        unsigned long failures = 0;
+
+        for (unsigned long it = 0; it < iterations; it++) {
+            double t0 = now_ns();
+            gsi_parser_reset(&parser);
+            for (size_t off = 0; off < len; off += chunk) {
+                size_t n = (len - off < chunk) ? len - off : chunk;
+                double c0 = now_ns();
+                gsi_parser_feed(&parser, payload + off, n);
+                double c1 = now_ns() - c0;
+                if (c1 > worst_feed) {
+                    worst_feed = c1;
+                }
+            }
+            if (!gsi_parser_finish(&parser)) {
+                failures++;
+            }
+            double t1 = now_ns() - t0;
+            if (t1 > worst_payload) {
+                worst_payload = t1;
+            }
+        }
+
+        double secs = (now_ns() - start) / 1e9;
+        const gsi_values_t *v = &parser.values;
+        printf("%s: %zu bytes, %s, clock_time=%ld paused=%d in_progress=%d team=%d buybacks=0x%03x\n",
+               argv[f], len, failures ? "PARSE FAILED" : "ok", (long)v->clock_time, v->paused,
+               v->in_progress, v->team, v->buyback_present);
+        printf("  %.1f MB/s, %.0f payloads/s, avg %.2f us/payload, worst payload %.2f us, worst feed %.2f us\n",
+               len * (double)iterations / secs / 1e6, iterations / secs,
+               secs * 1e6 / iterations, worst_payload / 1e3, worst_feed / 1e3);
+        free(payload);
+        if (failures) {
+            return 1;
+        }
+    }
+    return 0;
+}
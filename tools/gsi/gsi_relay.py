@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Relay Dota 2 Game State Integration payloads to the device (components/gsi).
+
+Dota 2 POSTs JSON game state to a local HTTP endpoint. This script accepts
+those POSTs and writes each body to the device's native USB port framed as
+STX (0x02) + body + ETX (0x03), which the device parses as it arrives.
+
+Put a file named gamestate_integration_buyback.cfg in
+<Steam>/steamapps/common/dota 2 beta/game/dota/cfg/gamestate_integration/:
+
+    "buyback-timer"
+    {
+        "uri"       "http://127.0.0.1:3000/"
+        "timeout"   "5.0"
+        "buffer"    "0.1"
+        "throttle"  "0.1"
+        "heartbeat" "10.0"
+        "data"
+        {
+            "provider"  "1"
+            "map"       "1"
+            "player"    "1"
+            "hero"      "1"
+        }
+        "auth"
+        {
+            "token"     "buyback-timer"
+        }
+    }
+
+then run (needs pyserial for a serial port):
+
+    gsi_relay.py /dev/ttyACM0
+    gsi_relay.py /dev/ttyACM0 --port 3000 --token buyback-timer
+    gsi_relay.py capture.bin --record payloads/    # also save each payload
+"""
+import argparse
+import http.server
+import json
+import os
+import sys
+import time
+
+STX = b"\x02"
+ETX = b"\x03"
+
+
+def open_output(path):
+    if os.path.exists(path) and not os.path.isfile(path):
+        import serial
+        return serial.Serial(path, 115200, timeout=0)
+    return open(path, "ab", buffering=0)
+
+
+def make_handler(out, token, record_dir, counters):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        def do_POST(self):
+            body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+            self.send_response(200)
+            self.end_headers()
+
+            if token is not None:
+                try:
+                    auth = json.loads(body).get("auth", {}).get("token")
+                except ValueError:
+                    auth = None
+                if auth != token:
+                    counters["rejected"] += 1
+                    return
+            if STX in body or ETX in body:
+                counters["rejected"] += 1  # Would break the framing
+                return
+
+            out.write(STX + body + ETX)
+            counters["payloads"] += 1
+            counters["bytes"] += len(body)
+            if record_dir is not None:
+                name = "%06d.json" % counters["payloads"]
+                with open(os.path.join(record_dir, name), "wb") as f:
+                    f.write(body)
+
+        def log_message(self, fmt, *args):
+            pass
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("output", help="serial port or file to write frames to")
+    parser.add_argument("--port", type=int, default=3000, help="HTTP port (default 3000)")
+    parser.add_argument("--token", default="buyback-timer", help="expected auth token, '' to accept any")
+    parser.add_argument("--record", metavar="DIR", help="save every payload for tools/gsi/gsi_bench")
+    parser.add_argument("--stats", type=float, metavar="SECONDS", default=10.0)
+    args = parser.parse_args()
+
+    if args.record:
+        os.makedirs(args.record, exist_ok=True)
+    counters = {"payloads": 0, "bytes": 0, "rejected": 0}
+    out = open_output(args.output)
+    handler = make_handler(out, args.token or None, args.record, counters)
+    server = http.server.HTTPServer(("127.0.0.1", args.port), handler)
+    server.timeout = 0.5
+
+    print("listening on http://127.0.0.1:%d/, writing to %s" % (args.port, args.output), file=sys.stderr)
+    last = time.monotonic()
+    try:
+        while True:
+            server.handle_request()
+            now = time.monotonic()
+            if args.stats and now - last >= args.stats:
+                print("%d payloads, %d bytes, %d rejected" % (
+                    counters["payloads"], counters["bytes"], counters["rejected"]), file=sys.stderr)
+                last = now
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
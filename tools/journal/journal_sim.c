@@ -0,0 +1,259 @@
+/* Host harness for the match journal (components/journal/journal.c)
+ *
+ * Mounts the journal on a file-backed journal_flash_t that behaves like NOR
+ * flash (erase sets a sector to 0xFF, a write can only clear bits) and plays
+ * random matches through the real game logic (main/time_tracker.c), logging
+ * every non-tick event like main.c's journal_listener. A page is committed
+ * when it fills and every JOURNAL_COMMIT_PERIOD_MS of virtual time, as
+ * journal_task does.
+ *
+ * Reports the cost of journal_log() and of a commit, bytes written to flash
+ * per event (records plus sector headers, against the 16 byte payload) and
+ * sector erases. Then mounts the file again, as after a reset, and reads the
+ * last matches back.
+ *
+ * Build:
+ *   cc -O2 -Itools/bench/stubs -o journal_sim tools/journal/journal_sim.c components/journal/journal.c \
+ *      main/time_tracker.c tools/bench/stubs/stubs.c
+ *
+ * Usage:
+ *   journal_sim [-m matches] [-S sectors] [-s seed]
+ *
+ * Exits with 1 if a write tried to set a bit the flash had not erased, a
+ * record was dropped, or the remount reads back a different number of valid
+ * records for the last matches than were logged.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "../../components/journal/journal.h"
+#include "../../main/time_tracker.h"
+
+#define MATCH_SECONDS_MIN   (25 * 60)
+#define MATCH_SECONDS_MAX   (55 * 60)
+#define MATCHES_READ_BACK   4
+
+typedef struct {
+    FILE *file;
+    uint32_t writes;
+    uint32_t erases;
+    uint32_t bad_writes;            // Bits set that were not erased
+} file_flash_t;
+
+static file_flash_t backing;
+static uint32_t events;
+static uint32_t events_by_match[JOURNAL_MAX_MATCHES * 4];
+static int match_no = -1;
+static double log_ns;
+static double commit_ns;
+static double commit_ns_max;
+static uint32_t commits;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static esp_err_t file_read(void *ctx, size_t offset, void *dst, size_t len) {
+    file_flash_t *f = ctx;
+    if (fseek(f->file, (long)offset, SEEK_SET) != 0 || fread(dst, 1, len, f->file) != len) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t file_write(void *ctx, size_t offset, const void *src, size_t len) {
+    file_flash_t *f = ctx;
+    uint8_t old[JOURNAL_SECTOR_SIZE];
+    const uint8_t *in = src;
+
+    if (len > sizeof(old) || file_read(ctx, offset, old, len) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] & ~old[i]) {
+            f->bad_writes++;
+        }
+        old[i] &= in[i];            // NOR programming only clears bits
+    }
+    fseek(f->file, (long)offset, SEEK_SET);
+    fwrite(old, 1, len, f->file);
+    f->writes++;
+    return ESP_OK;
+}
+
+static esp_err_t file_erase(void *ctx, size_t offset, size_t len) {
+    file_flash_t *f = ctx;
+    uint8_t ones[JOURNAL_SECTOR_SIZE];
+
+    memset(ones, 0xFF, sizeof(ones));
+    fseek(f->file, (long)offset, SEEK_SET);
+    for (size_t done = 0; done < len; done += sizeof(ones)) {
+        fwrite(ones, 1, sizeof(ones), f->file);
+    }
+    f->erases += len / JOURNAL_SECTOR_SIZE;
+    return ESP_OK;
+}
+
+static void commit(void) {
+    double start = now_ns();
+    journal_flush();
+    double ns = now_ns() - start;
+    commit_ns += ns;
+    commit_ns_max = ns > commit_ns_max ? ns : commit_ns_max;
+    commits++;
+}
+
+/* @brief journal_listener of main.c, plus journal_task's wakeup on a full page */
+static void listener(uint8_t event, uint8_t arg) {
+    if (event == TT_EVT_TICK) {
+        return;
+    }
+    if (event == TT_EVT_MATCH_START) {
+        match_no++;
+    }
+    double start = now_ns();
+    journal_log(event, arg);
+    log_ns += now_ns() - start;
+    events++;
+    if (match_no >= 0 && match_no < (int)(sizeof(events_by_match) / sizeof(events_by_match[0]))) {
+        events_by_match[match_no]++;
+    }
+
+    journal_stats_t s;
+    journal_get_stats(&s);
+    if (s.records_logged % JOURNAL_PAGE_RECORDS == 0) {
+        commit();
+    }
+}
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void press(uint8_t code) {
+    process_key(code / 5, code % 5);
+}
+
+/* @brief One match: start, hero timers every few minutes, a pause or a clock fix now and then, end */
+static void play_match(int64_t *next_commit_us) {
+    uint32_t seconds = MATCH_SECONDS_MIN + rng() % (MATCH_SECONDS_MAX - MATCH_SECONDS_MIN);
+
+    press(9);                                   // K10
+    for (uint32_t s = 0; s < seconds; s++) {
+        if (rng() % 40 == 0) {
+            press(rng() % HERO_COUNT);          // K1 - K5
+        }
+        if (rng() % 600 == 0) {
+            press(7);                           // K8 pause, a clock fix, K8 resume
+            press(rng() % 2 ? 6 : 8);
+            press(7);
+        }
+        time_tracker_tick();
+        bench_advance_us(1000000);
+        if (esp_timer_get_time() >= *next_commit_us) {
+            commit();
+            *next_commit_us += JOURNAL_COMMIT_PERIOD_MS * 1000LL;
+        }
+    }
+    press(5);                                   // K6
+    bench_advance_us((60 + rng() % 600) * 1000000LL);   // Between matches
+}
+
+static void count_record(const journal_record_t *record, void *ctx) {
+    (*(uint32_t *)ctx)++;
+}
+
+int main(int argc, char **argv) {
+    int matches = 20;
+    uint32_t sectors = 16;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            matches = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+            sectors = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0) | 1;
+        } else {
+            fprintf(stderr, "usage: journal_sim [-m matches] [-S sectors] [-s seed]\n");
+            return 2;
+        }
+    }
+    if (matches < 1 || matches > (int)(sizeof(events_by_match) / sizeof(events_by_match[0]))) {
+        fprintf(stderr, "journal_sim: 1 - %d matches\n", (int)(sizeof(events_by_match) / sizeof(events_by_match[0])));
+        return 2;
+    }
+
+    backing.file = tmpfile();
+    if (backing.file == NULL) {
+        perror("tmpfile");
+        return 1;
+    }
+    journal_flash_t flash = {
+        .read = file_read, .write = file_write, .erase = file_erase,
+        .size = sectors * JOURNAL_SECTOR_SIZE, .ctx = &backing,
+    };
+    file_erase(&backing, 0, flash.size);        // A blank partition
+    backing.erases = 0;
+    if (journal_mount(&flash) != ESP_OK) {
+        fprintf(stderr, "journal_sim: mount failed\n");
+        return 1;
+    }
+    time_tracker_add_listener(listener);
+
+    int64_t next_commit_us = JOURNAL_COMMIT_PERIOD_MS * 1000LL;
+    for (int m = 0; m < matches; m++) {
+        play_match(&next_commit_us);
+    }
+    commit();
+
+    journal_stats_t s;
+    journal_get_stats(&s);
+    printf("%d matches, %lu events (%.0f per match), %lu sectors of %d records\n", matches,
+           (unsigned long)events, (double)events / matches, (unsigned long)sectors, JOURNAL_RECORDS_PER_SECTOR);
+    printf("journal_log         %8.1f ns per event\n", log_ns / events);
+    printf("journal_flush       %8.1f us avg, %.1f us max, %lu calls, %lu wrote (%.1f events each)\n",
+           commit_ns / commits / 1000, commit_ns_max / 1000, (unsigned long)commits, (unsigned long)s.commits,
+           s.commits ? (double)events / s.commits : 0.0);
+    printf("flash written       %8.2f bytes per event, %.3fx the %d byte records, %lu writes\n",
+           (double)s.bytes_written / events, (double)s.bytes_written / s.bytes_logged, JOURNAL_RECORD_SIZE,
+           (unsigned long)backing.writes);
+    printf("sector erases       %8lu, %.2f per 1000 events, %.2f per match\n", (unsigned long)backing.erases,
+           1000.0 * backing.erases / events, (double)backing.erases / matches);
+
+    int failed = 0;
+    if (backing.bad_writes != 0 || s.records_dropped != 0) {
+        fprintf(stderr, "%lu writes over unerased bits, %lu records dropped\n",
+                (unsigned long)backing.bad_writes, (unsigned long)s.records_dropped);
+        failed = 1;
+    }
+
+    // As after a reset: the last matches must come back whole
+    uint32_t expected = 0, read = 0;
+    int back = matches < MATCHES_READ_BACK ? matches : MATCHES_READ_BACK;
+    for (int m = matches - back; m < matches; m++) {
+        expected += events_by_match[m];
+    }
+    if (journal_mount(&flash) != ESP_OK) {
+        fprintf(stderr, "journal_sim: remount failed\n");
+        return 1;
+    }
+    journal_read_matches(back, count_record, &read);
+    printf("remount             %8lu of %lu records of the last %d matches read back\n",
+           (unsigned long)read, (unsigned long)expected, back);
+    if (read != expected) {
+        failed = 1;
+    }
+    fclose(backing.file);
+    return failed;
+}
@@ -0,0 +1,250 @@
+/* Host simulation of the key-to-photon path, traced by main/latency_trace.c
+ *
+ * Models the stages between a K1 - K5 press and the hero label on the panel
+ * as a discrete-event simulation and feeds them through the same tracer the
+ * device uses, with a virtual clock:
+ *   key_scan_task   one column per col_ms, a pass every scan_ms, 100 ms lockout
+ *   lvgl_task       lv_task_handler every lvgl_ms; hero_timer every hero_ms
+ *                   (runs before the display refresh, LVGL 9 runs the newest
+ *                   timer first), refresh every refr_ms
+ *   render/flush    partial buffer of BUF_LINES lines, rendered then sent in
+ *                   512 pixel SPI chunks
+ * Prints p50/p99 per stage so the effect of each period can be tried out.
+ *
+ * Build:
+ *   cc -O2 -DLT_HISTORY=8192 -o latency_sim tools/latency/latency_sim.c main/latency_trace.c
+ *
+ * Usage:
+ *   latency_sim [-n presses] [-s seed] [-S scan_ms] [-H hero_ms] [-R refr_ms] [-L lvgl_ms] [-M spi_mhz]
+ *
+ * Exits with 1 if an accepted press never reaches the flush stage.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../main/latency_trace.h"
+
+#define DEBOUNCE_TIME_MS    100
+#define MAX_PRESSES         8192
+#define BUF_LINES           32      // MY_DISP_HOR_RES * MY_DISP_VER_RES / 10 pixels
+#define HOR_RES             480
+#define CHUNK_PX            512
+#define CHUNK_OVERHEAD_US   25      // Queue + wait for one SPI transaction
+#define RENDER_NS_PER_PX    40
+#define SWAP_NS_PER_PX      10
+#define LABEL_Y0            50      // First hero label on the Buybacks tab
+#define LABEL_PITCH         30
+#define LABEL_HEIGHT        29
+#define PROCESS_US          5       // process_key() to the state update
+#define HANDLER_US          150     // lv_task_handler() without a refresh
+
+typedef struct {
+    int64_t down_us;
+    int64_t up_us;
+    uint8_t key;
+} press_t;
+
+static press_t presses[MAX_PRESSES];
+static int press_count;
+static int64_t sim_now;
+
+static int64_t sim_clock(void) {
+    return sim_now;
+}
+
+static uint64_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+static int32_t rng_range(int32_t min, int32_t max) {
+    return min + (int32_t)(rng() % (uint32_t)(max - min + 1));
+}
+
+static bool key_down(uint8_t key, int64_t t) {
+    for (int i = 0; i < press_count; i++) {
+        if (presses[i].key == key && presses[i].down_us <= t && t < presses[i].up_us) {
+            return true;
+        }
+        if (presses[i].down_us > t) {
+            break;
+        }
+    }
+    return false;
+}
+
+/* Presses 0.6 - 2 s apart, sometimes a quick second press that hits the lockout */
+static void generate(int count) {
+    int64_t t = 500000;
+    for (int i = 0; i < count && press_count < MAX_PRESSES - 1; i++) {
+        uint8_t key = (uint8_t)rng_range(0, LT_KEYS - 1);
+        int32_t hold = rng_range(60000, 200000);
+        presses[press_count++] = (press_t){ t, t + hold, key };
+        if (rng() % 10 == 0) {
+            int64_t again = t + hold + rng_range(30000, 90000);
+            presses[press_count++] = (press_t){ again, again + rng_range(60000, 200000), key };
+            t = again;
+        }
+        t += rng_range(600000, 2000000);
+    }
+}
+
+typedef struct {
+    int32_t y1, y2;
+} strip_t;
+
+int main(int argc, char **argv) {
+    int count = 2000;
+    int scan_ms = 50, col_ms = 1, hero_ms = 250, refr_ms = 33, lvgl_ms = 10, spi_mhz = 80;
+
+    for (int i = 1; i < argc; i++) {
+        int *target = NULL;
+        if (i + 1 >= argc) {
+            target = NULL;
+        } else if (strcmp(argv[i], "-n") == 0) {
+            target = &count;
+        } else if (strcmp(argv[i], "-S") == 0) {
+            target = &scan_ms;
+        } else if (strcmp(argv[i], "-H") == 0) {
+            target = &hero_ms;
+        } else if (strcmp(argv[i], "-R") == 0) {
+            target = &refr_ms;
+        } else if (strcmp(argv[i], "-L") == 0) {
+            target = &lvgl_ms;
+        } else if (strcmp(argv[i], "-M") == 0) {
+            target = &spi_mhz;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            rng_state = strtoull(argv[++i], NULL, 10);
+            continue;
+        }
+        if (target == NULL) {
+            fprintf(stderr, "usage: %s [-n presses] [-s seed] [-S scan_ms] [-H hero_ms] [-R refr_ms] [-L lvgl_ms] [-M spi_mhz]\n", argv[0]);
+            return 2;
+        }
+        *target = atoi(argv[++i]);
+    }
+
+    generate(count);
+    latency_trace_init(sim_clock);
+
+    // key_scan_task
+    int64_t next_sample = 0;
+    int col = 0;
+    bool key_states[LT_KEYS] = { false };
+    bool seen_down[LT_KEYS] = { false };
+    int64_t last_accept_ms[LT_KEYS] = { 0 };
+    uint32_t accepted = 0;
+
+    // lvgl_task
+    int64_t next_lvgl = 0;
+    int64_t hero_due = hero_ms * 1000;
+    int64_t refr_due = refr_ms * 1000;
+    bool dirty = false;
+    strip_t strips[16];
+    int strip_count = 0, strip = 0;
+    int64_t strip_render_end = -1, strip_flush_end = -1;
+
+    const int64_t end_us = presses[press_count - 1].up_us + 3000000;
+    while (1) {
+        int64_t t_lvgl = strip_render_end >= 0 ? strip_render_end : strip_flush_end >= 0 ? strip_flush_end : next_lvgl;
+        sim_now = next_sample < t_lvgl ? next_sample : t_lvgl;
+        if (sim_now > end_us) {
+            break;
+        }
+
+        if (sim_now == next_sample) {
+            // One column: drive it, wait a tick, read the row (only K1 - K5 are modelled)
+            uint8_t key = (uint8_t)col;
+            bool pressed = key_down(key, sim_now);
+            int64_t now_ms = sim_now / 1000;
+            if (pressed && !key_states[key]) {
+                if (!seen_down[key]) {
+                    latency_trace_begin(key);
+                }
+                seen_down[key] = true;
+                if (now_ms - last_accept_ms[key] > DEBOUNCE_TIME_MS) {
+                    last_accept_ms[key] = now_ms;
+                    key_states[key] = true;
+                    accepted++;
+                    latency_trace_stamp(key, LT_DEBOUNCE);
+                    latency_trace_stamp(key, LT_PROCESS);
+                    sim_now += PROCESS_US;
+                    latency_trace_stamp(key, LT_STATE);     // TT_EVT_HERO_START/END listener
+                    sim_now -= PROCESS_US;
+                }
+            } else if (!pressed && key_states[key]) {
+                key_states[key] = false;
+            }
+            if (!pressed) {
+                seen_down[key] = false;
+            }
+            col = (col + 1) % 5;
+            next_sample += col_ms * 1000 + (col == 0 ? scan_ms * 1000 : 0);
+            continue;
+        }
+
+        if (sim_now == strip_render_end) {
+            // Rendered into the buffer, now my_flush_cb: byte swap + SPI chunks
+            int64_t px = (int64_t)HOR_RES * (strips[strip].y2 - strips[strip].y1 + 1);
+            int64_t chunks = (px + CHUNK_PX - 1) / CHUNK_PX;
+            strip_render_end = -1;
+            strip_flush_end = sim_now + px * 16 / spi_mhz + px * SWAP_NS_PER_PX / 1000 + chunks * CHUNK_OVERHEAD_US;
+            continue;
+        }
+        if (sim_now == strip_flush_end) {
+            latency_trace_flush_done(0, strips[strip].y1, HOR_RES - 1, strips[strip].y2);
+            strip_flush_end = -1;
+            if (++strip < strip_count) {
+                int64_t px = (int64_t)HOR_RES * (strips[strip].y2 - strips[strip].y1 + 1);
+                strip_render_end = sim_now + px * RENDER_NS_PER_PX / 1000;
+            } else {
+                next_lvgl = sim_now + HANDLER_US + lvgl_ms * 1000;
+            }
+            continue;
+        }
+
+        // lv_task_handler(): hero_timer, then the display refresh
+        if (sim_now >= hero_due) {
+            for (int i = 0; i < LT_KEYS; i++) {
+                int32_t y1 = LABEL_Y0 + i * LABEL_PITCH;
+                latency_trace_invalidate((uint8_t)i, 0, y1, HOR_RES - 1, y1 + LABEL_HEIGHT - 1);
+            }
+            hero_due = sim_now + hero_ms * 1000;
+            dirty = true;
+        }
+        if (sim_now >= refr_due) {
+            refr_due = sim_now + refr_ms * 1000;
+            if (dirty) {
+                latency_trace_render_start();
+                int32_t y_end = LABEL_Y0 + LT_KEYS * LABEL_PITCH - 1;   // Adjacent labels are joined
+                strip_count = 0;
+                for (int32_t y = LABEL_Y0; y <= y_end; y += BUF_LINES) {
+                    strips[strip_count++] = (strip_t){ y, y + BUF_LINES - 1 < y_end ? y + BUF_LINES - 1 : y_end };
+                }
+                strip = 0;
+                int64_t px = (int64_t)HOR_RES * (strips[0].y2 - strips[0].y1 + 1);
+                strip_render_end = sim_now + px * RENDER_NS_PER_PX / 1000;
+                dirty = false;
+                continue;
+            }
+        }
+        next_lvgl = sim_now + HANDLER_US + lvgl_ms * 1000;
+    }
+
+    lt_report_t report;
+    latency_trace_report(&report);
+    printf("scan %d ms, hero_timer %d ms, refresh %d ms, handler %d ms, SPI %d MHz\n",
+           scan_ms, hero_ms, refr_ms, lvgl_ms, spi_mhz);
+    printf("%u presses, %u accepted, %u completed, %u abandoned\n",
+           press_count, accepted, report.completed, report.abandoned);
+    for (int s = LT_DEBOUNCE; s < LT_STAGES; s++) {
+        printf("%-10s p50 %7u  p99 %7u  max %7u us\n", lt_stage_names[s],
+               report.stage[s].p50_us, report.stage[s].p99_us, report.stage[s].max_us);
+    }
+    printf("%-10s p50 %7u  p99 %7u  max %7u us\n", "total",
+           report.total.p50_us, report.total.p99_us, report.total.max_us);
+    return report.completed == accepted ? 0 : 1;
+}
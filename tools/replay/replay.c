@@ -0,0 +1,538 @@
+/* Headless replay of the game logic against a virtual clock
+ *
+ * Runs main/time_tracker.c (process_key / time_tracker_tick / hero timers)
+ * and main/history.c on a Linux host, driven by a key-event script, as fast
+ * as the CPU allows. Keys go through the device's key path: the script sets
+ * the simulated matrix of tools/bench/stubs and scan_keys() debounces them
+ * and resolves taps, holds and chords with the active keymap profile.
+ *
+ * Build (or with tools/bench/CMakeLists.txt):
+ *   cc -O2 -Itools/bench/stubs -Itools/bench/stubs/nolvgl -o replay tools/replay/replay.c \
+ *      tools/bench/stubs/stubs.c main/time_tracker.c main/history.c main/latency_trace.c \
+ *      components/keyboard/keyboard.c components/keyboard/keymap.c components/display/ui_cmd.c \
+ *      components/mpsc_ring/mpsc_ring.c
+ *
+ * Script format, one event per line ('#' starts a comment):
+ *   <time_ms> K1..K11     key tap at a virtual time since boot
+ *   <time_ms> K1..K11 hold  key held for KEYMAP_LONG_MS
+ *   <time_ms> undo        K11 + K7 chord, removes the last key press
+ *   <time_ms> end         keep ticking until this time
+ *
+ * The virtual clock ticks the game every 1000 ms like time_tracker_task.
+ * A tick that falls on the same millisecond as a key press runs first. A
+ * key pressed again within DEBOUNCE_TIME_MS is dropped, as on the device.
+ *
+ * Usage:
+ *   replay [-o trace] [-g golden] [-q] [-n repeat] [-R seed] [-p profile] script
+ *   replay --generate <matches> <seed> > script
+ *
+ * -R rewinds the history by a random number of steps at random points and
+ * checks every rewound state against the state recorded at that point.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "../../main/time_tracker.h"
+#include "../../main/history.h"
+#include "../../components/keyboard/keyboard.h"
+#include "../../components/keyboard/keymap.h"
+#include "../../components/display/ui_cmd.h"
+
+#define TICK_PERIOD_MS   1000
+#define MAX_LINE         256
+#define TABS             3
+#define SCAN_PERIOD_MS   50
+
+typedef struct {
+    uint32_t time_ms;
+    uint8_t key;        // 0-10 (K1-K11), KEY_UNDO, KEY_END
+    bool hold;
+} script_event_t;
+
+void bench_set_key(int row, int col, bool pressed);
+
+#define KEY_UNDO    0xFE
+#define KEY_END     0xFF
+
+static const char *event_names[] = {
+    [TT_EVT_KEY] = "KEY",
+    [TT_EVT_MATCH_START] = "MATCH_START",
+    [TT_EVT_MATCH_END] = "MATCH_END",
+    [TT_EVT_PAUSE] = "PAUSE",
+    [TT_EVT_RESUME] = "RESUME",
+    [TT_EVT_CLOCK_ADJUST] = "CLOCK_ADJUST",
+    [TT_EVT_HERO_START] = "HERO_START",
+    [TT_EVT_HERO_END] = "HERO_END",
+    [TT_EVT_HERO_EXPIRED] = "HERO_EXPIRED",
+    [TT_EVT_TICK] = "TICK",
+    [TT_EVT_UNDO] = "UNDO",
+    [TT_EVT_REWIND] = "REWIND",
+    [TT_EVT_SYNC] = "SYNC",
+};
+
+/* Replay context shared with the listener */
+static uint32_t now_ms;
+static FILE *trace_out;
+static FILE *golden_in;
+static unsigned long trace_line;
+static int golden_failed;
+static unsigned long events_seen;
+static unsigned long matches_ended;
+static int64_t run_base_ms;  // Virtual clock at a run's time 0, keeps it going forward over -n repeats
+
+/* Ground truth for -R: the state after every recorded history event */
+static int rewind_check;
+static GameState *truth;
+static size_t truth_cap;
+static uint32_t truth_seq;
+static uint32_t truth_floor;  // An undo rewrote the history after some unknown earlier point, no rewinds past it
+static unsigned long rewinds_checked;
+static unsigned long rewinds_failed;
+
+static bool states_equal(const GameState *a, const GameState *b) {
+    if (a->game_minutes != b->game_minutes || a->game_seconds != b->game_seconds ||
+        a->game_timer_active != b->game_timer_active || a->all_timers_active != b->all_timers_active) {
+        return false;
+    }
+    for (int i = 0; i < HERO_COUNT; i++) {
+        if (a->heroes[i].active != b->heroes[i].active ||
+            a->heroes[i].minutes != b->heroes[i].minutes ||
+            a->heroes[i].seconds != b->heroes[i].seconds) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void record_truth(void) {
+    truth_seq++;
+    if (truth_seq >= truth_cap) {
+        truth_cap = truth_cap ? truth_cap * 2 : 4096;
+        truth = realloc(truth, truth_cap * sizeof(*truth));
+    }
+    time_tracker_get_state(&truth[truth_seq]);
+}
+
+static void format_state(char *buf, size_t len, uint8_t event, uint8_t arg) {
+    int n = snprintf(buf, len, "%lu %s %u game=%02lu:%02u match=%u run=%u heroes=",
+                     (unsigned long)now_ms, event_names[event], arg,
+                     (unsigned long)game_timer_minutes, game_timer_seconds,
+                     all_timers_active, game_timer_active);
+    for (int i = 0; i < HERO_COUNT && n > 0 && (size_t)n < len; i++) {
+        if (hero_timers[i].active) {
+            n += snprintf(buf + n, len - n, "%s%02u:%02u", i ? "," : "",
+                          hero_timers[i].minutes, hero_timers[i].seconds);
+        } else {
+            n += snprintf(buf + n, len - n, "%s--", i ? "," : "");
+        }
+    }
+}
+
+static void trace_listener(uint8_t event, uint8_t arg) {
+    events_seen++;
+    if (event == TT_EVT_MATCH_END) {
+        matches_ended++;
+    }
+    if (rewind_check && (event == TT_EVT_TICK || (event == TT_EVT_KEY && arg < 10))) {
+        record_truth();  // Mirrors what history_listener records
+    } else if (rewind_check && event == TT_EVT_UNDO) {
+        truth_seq--;     // The key is gone and the ticks after it are recorded again
+        time_tracker_get_state(&truth[truth_seq]);
+        truth_floor = truth_seq;
+    }
+    if (trace_out == NULL && golden_in == NULL) {
+        return;
+    }
+
+    char line[MAX_LINE];
+    format_state(line, sizeof(line), event, arg);
+    trace_line++;
+
+    if (trace_out != NULL) {
+        fprintf(trace_out, "%s\n", line);
+    }
+    if (golden_in != NULL && !golden_failed) {
+        char expected[MAX_LINE];
+        if (fgets(expected, sizeof(expected), golden_in) == NULL) {
+            fprintf(stderr, "golden: trace longer than golden file at line %lu\n", trace_line);
+            golden_failed = 1;
+            return;
+        }
+        expected[strcspn(expected, "\r\n")] = '\0';
+        if (strcmp(expected, line) != 0) {
+            fprintf(stderr, "golden: mismatch at line %lu\n  expected: %s\n  actual:   %s\n",
+                    trace_line, expected, line);
+            golden_failed = 1;
+        }
+    }
+}
+
+static int parse_key(const char *token) {
+    if (strcmp(token, "end") == 0) {
+        return KEY_END;
+    }
+    if (strcmp(token, "undo") == 0) {
+        return KEY_UNDO;
+    }
+    if (token[0] != 'K' && token[0] != 'k') {
+        return -1;
+    }
+    int key = atoi(token + 1);
+    return (key >= 1 && key <= 11) ? key - 1 : -1;
+}
+
+static script_event_t *load_script(const char *path, size_t *count) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    size_t cap = 1024, n = 0;
+    script_event_t *events = malloc(cap * sizeof(*events));
+    char line[MAX_LINE];
+    unsigned long lineno = 0;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash != NULL) {
+            *hash = '\0';
+        }
+        unsigned long time_ms;
+        char token[16], modifier[16];
+        int fields = sscanf(line, "%lu %15s %15s", &time_ms, token, modifier);
+        if (fields <= 0) {
+            continue;
+        }
+        int key = (fields >= 2) ? parse_key(token) : -1;
+        bool hold = fields == 3 && strcmp(modifier, "hold") == 0;
+        if (key < 0 || (fields == 3 && (!hold || key > 10))) {
+            fprintf(stderr, "%s:%lu: bad event\n", path, lineno);
+            free(events);
+            fclose(f);
+            return NULL;
+        }
+        if (n > 0 && time_ms < events[n - 1].time_ms) {
+            fprintf(stderr, "%s:%lu: time goes backwards\n", path, lineno);
+            free(events);
+            fclose(f);
+            return NULL;
+        }
+        if (n == cap) {
+            cap *= 2;
+            events = realloc(events, cap * sizeof(*events));
+        }
+        events[n].time_ms = (uint32_t)time_ms;
+        events[n].key = (uint8_t)key;
+        events[n].hold = hold;
+        n++;
+    }
+    fclose(f);
+    *count = n;
+    return events;
+}
+
+/* @brief What lvgl_task does with the tab commands of the keymap */
+static void drain_ui_commands(void) {
+    ui_cmd_t cmd;
+    while (ui_cmd_take(&cmd)) {
+        if (cmd.type == UI_CMD_NEXT_TAB) {
+            indexing = (indexing + 1) % TABS;
+        } else if (cmd.type == UI_CMD_SWITCH_TAB && cmd.arg < TABS) {
+            indexing = cmd.arg;
+        }
+    }
+}
+
+/* @brief One key_scan_task pass at script time time_ms */
+static void scan_at(uint32_t time_ms) {
+    int64_t target_us = (run_base_ms + time_ms) * 1000;
+    int64_t now_us = esp_timer_get_time();
+    if (target_us > now_us) {
+        bench_advance_us(target_us - now_us);
+    }
+    scan_keys();
+    drain_ui_commands();
+}
+
+static void set_key(uint8_t key, bool pressed) {
+    bench_set_key(key == KEYMAP_K11 ? 2 : key / 5, key % 5, pressed);
+}
+
+static void advance_to(uint32_t time_ms, uint32_t *next_tick) {
+    while (*next_tick <= time_ms) {
+        now_ms = *next_tick;
+        time_tracker_tick();
+        *next_tick += TICK_PERIOD_MS;
+    }
+    now_ms = time_ms;
+}
+
+/* @brief Presses a key on the simulated matrix and lets scan_keys() resolve it
+ * @param key 0-10 (K1-K11)
+ * @param hold Kept down for KEYMAP_LONG_MS, the game ticks meanwhile
+ */
+static void press_key(uint8_t key, bool hold, uint32_t *next_tick) {
+    uint32_t t = now_ms;
+    set_key(key, true);
+    scan_at(t);
+    if (hold) {
+        for (uint32_t held = SCAN_PERIOD_MS; held <= KEYMAP_LONG_MS; held += SCAN_PERIOD_MS) {
+            advance_to(t + held, next_tick);
+            scan_at(t + held);
+        }
+        t += KEYMAP_LONG_MS;
+    }
+    set_key(key, false);
+    scan_at(t);
+}
+
+/* @brief K11 + K7, the chord every built-in profile binds to undo */
+static void press_undo(void) {
+    set_key(KEYMAP_K11, true);
+    scan_at(now_ms);
+    set_key(6, true);
+    scan_at(now_ms);
+    set_key(6, false);
+    set_key(KEYMAP_K11, false);
+    scan_at(now_ms);
+}
+
+/* Small deterministic PRNG so generated scripts match across hosts */
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi) {
+    return lo + rng_next() % (hi - lo + 1);
+}
+
+static void random_rewind(void) {
+    uint32_t available = history_available();
+    if (available > truth_seq - truth_floor) {
+        available = truth_seq - truth_floor;
+    }
+    if (available == 0 || rng_range(0, 7) != 0) {
+        return;
+    }
+    uint32_t steps = rng_range(1, available);
+    rewinds_checked++;
+    if (!history_rewind(steps)) {
+        fprintf(stderr, "rewind: %lu of %lu steps refused\n", (unsigned long)steps, (unsigned long)available);
+        rewinds_failed++;
+        return;
+    }
+    truth_seq -= steps;
+    GameState now;
+    time_tracker_get_state(&now);
+    if (!states_equal(&now, &truth[truth_seq])) {
+        fprintf(stderr, "rewind: state mismatch at t=%lu after %lu steps\n",
+                (unsigned long)now_ms, (unsigned long)steps);
+        rewinds_failed++;
+    }
+}
+
+static void run_script(const script_event_t *events, size_t count) {
+    GameState reset;
+    memset(&reset, 0, sizeof(reset));
+    time_tracker_set_state(&reset);
+    indexing = 0;
+    history_reset();
+    run_base_ms = esp_timer_get_time() / 1000 + 1000;   // Past the debounce of the last run's keys
+    if (rewind_check) {
+        truth_seq = 0;
+        record_truth();
+        truth_seq = 0;
+        truth_floor = 0;
+    }
+
+    uint32_t next_tick = TICK_PERIOD_MS;
+    for (size_t i = 0; i < count; i++) {
+        if (events[i].time_ms >= now_ms) {  // Not while a hold was still down
+            advance_to(events[i].time_ms, &next_tick);
+        }
+        if (events[i].key == KEY_UNDO) {
+            press_undo();
+        } else if (events[i].key != KEY_END) {
+            press_key(events[i].key, events[i].hold, &next_tick);
+        }
+        if (rewind_check) {
+            random_rewind();
+        }
+    }
+    if (all_timers_active) {
+        matches_ended++;  // Script ended mid-match, still count it
+    }
+}
+
+static void generate(unsigned long matches, uint32_t seed) {
+    rng_state = seed ? seed : 1;
+    uint32_t t = rng_range(500, 5000);
+
+    printf("# generated: %lu matches, seed %lu\n", matches, (unsigned long)seed);
+    for (unsigned long m = 0; m < matches; m++) {
+        uint32_t match_end = t + rng_range(25 * 60, 60 * 60) * 1000;
+        printf("%lu K10\n", (unsigned long)t);
+
+        while (1) {
+            t += rng_range(5, 90) * 1000 + rng_range(0, 999);
+            if (t >= match_end) {
+                break;
+            }
+            uint32_t roll = rng_range(0, 99);
+            if (roll < 75) {
+                printf("%lu K%lu\n", (unsigned long)t, (unsigned long)rng_range(1, 5));
+            } else if (roll < 85) {
+                // Pause, nudge the clock, resume
+                printf("%lu K8\n", (unsigned long)t);
+                uint32_t nudges = rng_range(0, 4);
+                for (uint32_t i = 0; i < nudges; i++) {
+                    t += rng_range(150, 600);
+                    printf("%lu K%s\n", (unsigned long)t, (rng_next() & 1) ? "9" : "7");
+                }
+                t += rng_range(2, 60) * 1000;
+                printf("%lu K8\n", (unsigned long)t);
+            } else if (roll < 90) {
+                printf("%lu K11\n", (unsigned long)t);
+            }
+        }
+        if (t < match_end) {
+            t = match_end;
+        }
+        printf("%lu K6\n", (unsigned long)t);
+        t += rng_range(10, 120) * 1000;
+    }
+    printf("%lu end\n", (unsigned long)t);
+}
+
+static double elapsed_s(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) + (b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: replay [-o trace] [-g golden] [-q] [-n repeat] [-R seed] [-p profile] script\n"
+            "       replay --generate <matches> <seed>\n");
+}
+
+int main(int argc, char **argv) {
+    const char *trace_path = NULL;
+    const char *golden_path = NULL;
+    const char *script_path = NULL;
+    const char *profile = NULL;
+    int quiet = 0;
+    unsigned long repeat = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--generate") == 0 && i + 2 < argc) {
+            generate(strtoul(argv[i + 1], NULL, 0), (uint32_t)strtoul(argv[i + 2], NULL, 0));
+            return 0;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            golden_path = argv[++i];
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            repeat = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) {
+            rewind_check = 1;
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0) | 1;
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            profile = argv[++i];
+        } else if (argv[i][0] != '-' && script_path == NULL) {
+            script_path = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (script_path == NULL || repeat == 0) {
+        usage();
+        return 2;
+    }
+
+    init_keys();
+    keymap_init();
+    if (profile != NULL) {
+        uint8_t p = 0;
+        while (keymap_select(p) && strcmp(keymap_active_name(), profile) != 0) {
+            p++;
+        }
+        if (strcmp(keymap_active_name(), profile) != 0) {
+            fprintf(stderr, "replay: no keymap profile %s\n", profile);
+            return 2;
+        }
+    }
+
+    size_t count;
+    script_event_t *events = load_script(script_path, &count);
+    if (events == NULL) {
+        return 2;
+    }
+
+    if (trace_path != NULL) {
+        trace_out = fopen(trace_path, "w");
+    } else if (!quiet) {
+        trace_out = stdout;
+    }
+    if (golden_path != NULL) {
+        golden_in = fopen(golden_path, "r");
+        if (golden_in == NULL) {
+            perror(golden_path);
+            return 2;
+        }
+    }
+    time_tracker_add_listener(trace_listener);
+    time_tracker_add_listener(history_listener);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // First pass produces the trace / golden comparison, the rest are timing only
+    run_script(events, count);
+    if (trace_out != NULL && trace_out != stdout) {
+        fclose(trace_out);
+    }
+    trace_out = NULL;
+    if (golden_in != NULL) {
+        char extra[MAX_LINE];
+        if (!golden_failed && fgets(extra, sizeof(extra), golden_in) != NULL) {
+            fprintf(stderr, "golden: golden file longer than trace (%lu lines)\n", trace_line);
+            golden_failed = 1;
+        }
+        fclose(golden_in);
+        golden_in = NULL;
+    }
+    for (unsigned long r = 1; r < repeat; r++) {
+        run_script(events, count);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double secs = elapsed_s(&start, &end);
+    double simulated = count ? (double)events[count - 1].time_ms * repeat / 1000.0 : 0;
+
+    fprintf(stderr, "replay: %lu matches, %lu events, %.0f s simulated in %.3f s "
+                    "(%.0f matches/s, %.0fx real time)\n",
+            matches_ended, events_seen, simulated, secs,
+            secs > 0 ? matches_ended / secs : 0, secs > 0 ? simulated / secs : 0);
+    if (golden_path != NULL) {
+        fprintf(stderr, "golden: %s\n", golden_failed ? "FAIL" : "ok");
+    }
+    if (rewind_check) {
+        fprintf(stderr, "rewind: %lu checked, %lu failed\n", rewinds_checked, rewinds_failed);
+    }
+
+    free(events);
+    free(truth);
+    return (golden_failed || rewinds_failed) ? 1 : 0;
+}
@@ -0,0 +1,444 @@
+/* Host end of the replication protocol (components/replication/repl_proto.c)
+ *
+ * Runs a primary (the real game logic from main/time_tracker.c, driven by
+ * random key presses and accelerated ticks) and/or a secondary over serial
+ * ports or pseudo-terminals, and measures bytes per event, one-way
+ * propagation latency, input round-trip time and gap recovery.
+ *
+ * Build:
+ *   cc -O2 -o repl_link tools/replication/repl_link.c components/replication/repl_proto.c \
+ *      main/time_tracker.c main/history.c
+ *
+ * Both ends in one process over a pty pair (latency is measured one-way):
+ *   socat -d -d pty,raw,echo=0 pty,raw,echo=0     # prints the two /dev/pts/N
+ *   repl_link -p /dev/pts/3 -s /dev/pts/4 -n 20000 -r 200 -d 1 -i 10
+ *
+ * or with -l on a pty pair of its own, as the ctest does:
+ *   repl_link -l -n 2000 -r 2000 -d 1 -i 10 -q
+ *
+ * Against a device, e.g. a unit set as secondary on a USB-UART adapter:
+ *   repl_link -p /dev/ttyUSB0 -b 460800 -r 1
+ *
+ * Options:
+ *   -p tty    act as primary on tty          -s tty    act as secondary on tty
+ *   -n N      events to generate (10000)      -r N      key presses / ticks per second (100)
+ *   -d pct    drop pct% of state frames      -i pct    pct% of key presses entered on the secondary
+ *   -b baud   set the tty speed              -S seed   random seed
+ *   -l        both ends on a new pty pair     -q        no per-frame output
+ */
+#define _GNU_SOURCE     // posix_openpt() and cfmakeraw() with glibc
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../components/replication/repl_proto.h"
+#include "../../main/history.h"
+
+#define KEYFRAME_MS     2000
+#define LATENCY_SLOTS   256     // One per state seq
+
+typedef struct {
+    int fd;
+    repl_parser_t parser;
+    unsigned long bytes_out;
+    unsigned long bytes_in;
+} port_t;
+
+/* Primary */
+static port_t primary = {.fd = -1};
+static repl_encoder_t encoder;
+static bool resync_requested;
+static int pending_ack = -1;
+static unsigned long changes, keyframes, deltas, delta_bytes, dropped, resyncs, inputs_applied;
+static int64_t last_keyframe_ns;
+static int64_t sent_ns[LATENCY_SLOTS];
+static repl_state_t sent_state[LATENCY_SLOTS];
+
+/* Secondary */
+static port_t secondary = {.fd = -1};
+static repl_receiver_t receiver;
+static uint8_t next_input_seq;
+static int64_t input_sent_ns[LATENCY_SLOTS];
+static unsigned long applied, mismatches, gaps, inputs_sent, acks;
+static int64_t gap_ns, recovery_max_ns;
+static uint32_t *latency_us, *rtt_us;
+static size_t latency_count, rtt_count, latency_cap, rtt_cap;
+
+static int drop_pct, input_pct;
+static uint64_t rng_state = 1;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+static void push(uint32_t **buf, size_t *count, size_t *cap, uint32_t value) {
+    if (*count == *cap) {
+        *cap = *cap ? *cap * 2 : 4096;
+        *buf = realloc(*buf, *cap * sizeof(**buf));
+    }
+    (*buf)[(*count)++] = value;
+}
+
+static int open_port(const char *path, int baud) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        perror(path);
+        exit(2);
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        if (baud > 0) {
+            speed_t speed = baud == 115200 ? B115200 : baud == 230400 ? B230400 :
+                            baud == 460800 ? B460800 : B921600;
+            cfsetispeed(&tio, speed);
+            cfsetospeed(&tio, speed);
+        }
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/* @brief Opens a pty pair, the master side for the primary
+ * @return Path of the slave side, for the secondary
+ */
+static const char *open_loopback(int *master_fd) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        perror("posix_openpt");
+        exit(2);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    *master_fd = fd;
+    return ptsname(fd);
+}
+
+static void port_write(port_t *port, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(port->fd, data, len);
+        if (n < 0) {
+            if (errno == EAGAIN) {
+                struct pollfd pfd = {.fd = port->fd, .events = POLLOUT};
+                poll(&pfd, 1, 100);
+                continue;
+            }
+            perror("write");
+            exit(2);
+        }
+        port->bytes_out += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/* ---- Primary ---- */
+
+/* @brief Sends what changed, like replication_tx_task on the device */
+static void primary_send(void) {
+    uint8_t frame[REPL_FRAME_MAX];
+    GameState game;
+    repl_state_t state;
+    size_t len;
+
+    time_tracker_get_state(&game);
+    repl_state_from_game(&game, &state);
+    int64_t now = now_ns();
+    uint8_t seq = encoder.seq;
+    bool keyframe = resync_requested || now - last_keyframe_ns >= KEYFRAME_MS * 1000000LL;
+
+    if (keyframe) {
+        resync_requested = false;
+        last_keyframe_ns = now;
+        len = repl_encode_keyframe(&encoder, &state, frame);
+        keyframes++;
+    } else {
+        len = repl_encode_delta(&encoder, &state, frame);
+        if (len > 0) {
+            deltas++;
+            delta_bytes += len;
+        }
+    }
+    if (len > 0) {
+        sent_ns[seq] = now;
+        sent_state[seq] = state;
+        if (!keyframe && (int)(rng() % 100) < drop_pct) {
+            dropped++;  // Lost on the wire, the secondary has to notice the gap
+        } else {
+            port_write(&primary, frame, len);
+        }
+    }
+    if (pending_ack >= 0) {
+        port_write(&primary, frame, repl_encode_control(REPL_ACK, (uint8_t)pending_ack, NULL, 0, frame));
+        pending_ack = -1;
+    }
+}
+
+static void change_listener(uint8_t event, uint8_t arg) {
+    (void)event;
+    (void)arg;
+    changes++;
+}
+
+/* @brief Picks a plausible key press for the current state
+ * @return Key code 0-9, or -1 for a plain tick
+ */
+static int random_action(void) {
+    if (!all_timers_active) {
+        return 9;                               // K10, start a match
+    }
+    uint32_t r = rng() % 100;
+    if (!game_timer_active) {
+        return r < 40 ? 7 : r < 60 ? 6 : 8;     // K8 resume, K7 / K9 adjust
+    }
+    if (r < 70) {
+        return -1;
+    }
+    if (r < 97) {
+        return rng() % HERO_COUNT;              // K1-K5
+    }
+    return r < 99 ? 7 : 5;                      // K8 pause, rarely K6 end
+}
+
+static void primary_frame(const repl_frame_t *frame) {
+    if (frame->type == REPL_INPUT && frame->len == 1) {
+        uint8_t input = frame->payload[0];
+        if (input == TT_INPUT_UNDO) {
+            history_undo_last_key();
+        } else if (input < 10) {
+            process_key(input / 5, input % 5);
+        }
+        inputs_applied++;
+        pending_ack = frame->seq;
+        primary_send();
+    } else if (frame->type == REPL_RESYNC) {
+        resyncs++;
+        resync_requested = true;
+        primary_send();
+    }
+}
+
+/* ---- Secondary ---- */
+
+static bool secondary_forward(uint8_t input) {
+    uint8_t frame[REPL_FRAME_MAX];
+    uint8_t seq = next_input_seq++;
+    input_sent_ns[seq] = now_ns();
+    port_write(&secondary, frame, repl_encode_control(REPL_INPUT, seq, &input, 1, frame));
+    inputs_sent++;
+    return true;
+}
+
+static void secondary_frame(const repl_frame_t *frame, bool quiet) {
+    int64_t now = now_ns();
+    uint8_t out[REPL_FRAME_MAX];
+
+    if (frame->type == REPL_ACK) {
+        acks++;
+        push(&rtt_us, &rtt_count, &rtt_cap, (uint32_t)((now - input_sent_ns[frame->seq]) / 1000));
+        return;
+    }
+    bool was_synced = receiver.synced;
+    switch (repl_receiver_apply(&receiver, frame)) {
+    case REPL_APPLIED:
+        applied++;
+        if (primary.fd >= 0) {
+            push(&latency_us, &latency_count, &latency_cap, (uint32_t)((now - sent_ns[frame->seq]) / 1000));
+            if (memcmp(&receiver.state, &sent_state[frame->seq], sizeof(repl_state_t)) != 0) {
+                mismatches++;
+            }
+        }
+        if (!was_synced && gap_ns != 0) {
+            if (now - gap_ns > recovery_max_ns) {
+                recovery_max_ns = now - gap_ns;
+            }
+            gap_ns = 0;
+        }
+        if (!quiet && primary.fd < 0) {
+            const repl_state_t *s = &receiver.state;
+            printf("seq %3u game %02u:%02u %s%s heroes", frame->seq, s->game_seconds / 60, s->game_seconds % 60,
+                   (s->flags & REPL_FLAG_MATCH) ? "match" : "-", (s->flags & REPL_FLAG_RUNNING) ? " running" : "");
+            for (int i = 0; i < HERO_COUNT; i++) {
+                if (s->heroes[i] == REPL_HERO_IDLE) {
+                    printf(" --");
+                } else {
+                    printf(" %02u:%02u", s->heroes[i] / 60, s->heroes[i] % 60);
+                }
+            }
+            printf("\n");
+        }
+        break;
+    case REPL_GAP:
+        gaps++;
+        gap_ns = now;
+        port_write(&secondary, out, repl_encode_control(REPL_RESYNC, 0, NULL, 0, out));
+        break;
+    case REPL_IGNORED:
+        break;
+    }
+}
+
+/* ---- Main loop ---- */
+
+static void pump(port_t *port, bool is_primary, bool quiet) {
+    uint8_t buf[512];
+    repl_frame_t frame;
+    ssize_t n;
+
+    while ((n = read(port->fd, buf, sizeof(buf))) > 0) {
+        port->bytes_in += n;
+        for (ssize_t i = 0; i < n; i++) {
+            if (repl_parser_feed(&port->parser, buf[i], &frame)) {
+                if (is_primary) {
+                    primary_frame(&frame);
+                } else {
+                    secondary_frame(&frame, quiet);
+                }
+            }
+        }
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report_percentiles(const char *name, uint32_t *v, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    qsort(v, n, sizeof(*v), cmp_u32);
+    printf("%s: n=%zu p50 %u us  p99 %u us  max %u us\n", name, n, v[n / 2], v[n * 99 / 100], v[n - 1]);
+}
+
+int main(int argc, char **argv) {
+    const char *primary_path = NULL, *secondary_path = NULL;
+    unsigned long target = 10000;
+    double rate = 100;
+    int baud = 0;
+    bool quiet = false;
+    bool loopback = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "-l") == 0) {
+            loopback = true;
+        } else if (i + 1 < argc && argv[i][0] == '-') {
+            const char *v = argv[++i];
+            switch (argv[i - 1][1]) {
+            case 'p': primary_path = v; break;
+            case 's': secondary_path = v; break;
+            case 'n': target = strtoul(v, NULL, 0); break;
+            case 'r': rate = atof(v); break;
+            case 'd': drop_pct = atoi(v); break;
+            case 'i': input_pct = atoi(v); break;
+            case 'b': baud = atoi(v); break;
+            case 'S': rng_state = strtoull(v, NULL, 0); break;
+            default: primary_path = secondary_path = NULL; i = argc; break;
+            }
+        } else {
+            primary_path = secondary_path = NULL;
+            loopback = false;
+            break;
+        }
+    }
+    if (primary_path == NULL && secondary_path == NULL && !loopback) {
+        fprintf(stderr, "usage: repl_link [-p tty] [-s tty] [-l] [-n events] [-r per_s] [-d drop%%] [-i input%%] [-b baud] [-S seed] [-q]\n");
+        return 2;
+    }
+
+    repl_encoder_reset(&encoder);
+    repl_receiver_reset(&receiver);
+    if (loopback) {
+        secondary_path = open_loopback(&primary.fd);
+    } else if (primary_path != NULL) {
+        primary.fd = open_port(primary_path, baud);
+    }
+    if (primary.fd >= 0) {
+        time_tracker_add_listener(change_listener);
+        time_tracker_add_listener(history_listener);
+        history_reset();
+    }
+    if (secondary_path != NULL) {
+        secondary.fd = open_port(secondary_path, baud);
+    }
+
+    int64_t start = now_ns();
+    int64_t next_event = start;
+    int64_t period = (int64_t)(1e9 / rate);
+    unsigned long sent_changes = 0;
+    int64_t drain_until = 0;
+
+    while (1) {
+        int64_t now = now_ns();
+        if (primary.fd >= 0 && drain_until == 0 && now >= next_event) {
+            next_event += period;
+            unsigned long before = changes;
+            int key = random_action();
+            if (key < 0) {
+                time_tracker_tick();
+            } else if (secondary.fd >= 0 && (int)(rng() % 100) < input_pct) {
+                secondary_forward((uint8_t)key);  // Entered on the secondary, applied when the primary reads it
+            } else {
+                process_key(key / 5, key % 5);
+            }
+            if (changes != before || now - last_keyframe_ns >= KEYFRAME_MS * 1000000LL) {
+                primary_send();
+            }
+            sent_changes = changes;
+            if (sent_changes >= target) {
+                drain_until = now + 500000000;  // Let the last frames and acks arrive
+            }
+        }
+        if (drain_until != 0 && now >= drain_until) {
+            break;
+        }
+
+        struct pollfd pfd[2];
+        int nfds = 0;
+        if (primary.fd >= 0) {
+            pfd[nfds++] = (struct pollfd){.fd = primary.fd, .events = POLLIN};
+        }
+        if (secondary.fd >= 0) {
+            pfd[nfds++] = (struct pollfd){.fd = secondary.fd, .events = POLLIN};
+        }
+        int64_t wait = primary.fd >= 0 ? (drain_until ? drain_until : next_event) - now : 1000000000;
+        poll(pfd, nfds, wait > 0 ? (int)(wait / 1000000) : 0);
+        if (primary.fd >= 0) {
+            pump(&primary, true, quiet);
+        }
+        if (secondary.fd >= 0) {
+            pump(&secondary, false, quiet);
+        }
+    }
+
+    double secs = (now_ns() - start) / 1e9;
+    printf("%.1f s, %lu events: %lu deltas (%.2f bytes avg), %lu keyframes, %lu dropped\n",
+           secs, changes, deltas, deltas ? (double)delta_bytes / deltas : 0.0, keyframes, dropped);
+    printf("primary -> secondary %lu bytes, %.2f bytes per event (%.1f us per event at %d baud)\n",
+           primary.bytes_out, changes ? (double)primary.bytes_out / changes : 0.0,
+           changes ? primary.bytes_out * 10.0e6 / (baud ? baud : 460800) / changes : 0.0, baud ? baud : 460800);
+    if (secondary.fd >= 0) {
+        printf("secondary: %lu applied, %lu gaps (worst recovery %.1f ms), %lu resyncs served, %lu mismatches\n",
+               applied, gaps, recovery_max_ns / 1e6, resyncs, mismatches);
+        printf("inputs: %lu forwarded, %lu applied, %lu acked, secondary -> primary %lu bytes\n",
+               inputs_sent, inputs_applied, acks, secondary.bytes_out);
+        report_percentiles("propagation", latency_us, latency_count);
+        report_percentiles("input rtt", rtt_us, rtt_count);
+    }
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+/* Host simulation of the SPI clock calibration (components/display/spi_clock.c)
+ *
+ * The simulated panel stores what is written into a GRAM test window and
+ * flips each written bit with a probability that depends on the write clock:
+ * none up to the board's limit, then rising steeply (1e-4 just past it,
+ * times e for every 2 % faster). Reads at SPI_CLOCK_READ_HZ are clean unless
+ * the scenario has no MISO. Transfer time is counted from the clocks.
+ *
+ * Every scenario runs many trials with different seeds and checks that the
+ * calibration ends on the fastest candidate at or under the limit, that a
+ * long run at that clock is error-free, and for the drift scenario that spot
+ * checks ask for a new calibration once the limit drops.
+ *
+ * Build:
+ *   cc -O2 -o spi_clock_sim tools/spi_clock/spi_clock_sim.c components/display/spi_clock.c -lm
+ *
+ * Usage:
+ *   spi_clock_sim [-s seed] [-n trials] [-v]
+ *
+ * -v prints the calibration statistics (as the "spi" console command) of the first trial.
+ * Exits with 1 if any trial picks a clock that is too fast or needlessly slow.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../../components/display/spi_clock.h"
+
+#define EDGE_BER            1e-4    // Bit error rate just past the limit
+#define EDGE_STEEPNESS      0.02    // BER times e per 2 % over the limit
+#define SET_CLOCK_US        40      // Removing and adding the SPI device
+#define VERIFY_ROUNDS       2000    // Long run on the chosen clock
+#define DRIFT_CHECKS        20      // Spot checks after the limit drops
+
+typedef struct {
+    const char *name;
+    uint32_t limit_hz;              // Fastest error-free write clock of the board
+    uint32_t cached_hz;             // In NVS from an earlier boot, 0 = none
+    uint32_t drift_hz;              // Limit after warming up, 0 = no drift
+    int no_miso;                    // Readback returns nothing
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "short cable",        100000000, 0,        0,        0 },
+    { "long cable",          45000000, 0,        0,        0 },
+    { "old board",           22000000, 0,        0,        0 },
+    { "marginal 40 MHz",     39900000, 0,        0,        0 },
+    { "cached, still good",  45000000, 40000000, 0,        0 },
+    { "cached, board swap",  30000000, 80000000, 0,        0 },
+    { "drift when warm",     60000000, 0,        30000000, 0 },
+    { "no MISO",            100000000, 0,        0,        1 },
+};
+
+typedef struct {
+    const scenario_t *sc;
+    uint32_t limit_hz;
+    uint32_t hz;
+    uint16_t gram[SPI_CLOCK_TEST_PIXELS];
+    double time_us;
+    uint64_t bits_flipped;
+} panel_t;
+
+static uint64_t rng_state = 1;
+
+static double rng_unit(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (rng_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double bit_error_rate(const panel_t *p) {
+    if (p->hz <= p->limit_hz) {
+        return 0.0;
+    }
+    double over = (double)(p->hz - p->limit_hz) / p->limit_hz;
+    double ber = EDGE_BER * exp(over / EDGE_STEEPNESS);
+    return ber > 0.5 ? 0.5 : ber;
+}
+
+static bool sim_set_clock(void *ctx, uint32_t hz) {
+    panel_t *p = ctx;
+    p->hz = hz;
+    p->time_us += SET_CLOCK_US;
+    return true;
+}
+
+static bool sim_write(void *ctx, const uint16_t *px, int count) {
+    panel_t *p = ctx;
+    double ber = bit_error_rate(p);
+
+    for (int i = 0; i < count; i++) {
+        uint16_t v = px[i];
+        if (ber > 0.0) {
+            for (int b = 0; b < 16; b++) {
+                if (rng_unit() < ber) {
+                    v ^= 1u << b;
+                    p->bits_flipped++;
+                }
+            }
+        }
+        p->gram[i] = v;
+    }
+    p->time_us += (double)count * 16 * 1e6 / p->hz + 5 * 8 * 1e6 / p->hz * 3;  // Pixels, CASET/RASET/RAMWR
+    return true;
+}
+
+static bool sim_read(void *ctx, uint16_t *px, int count) {
+    panel_t *p = ctx;
+
+    for (int i = 0; i < count; i++) {
+        // Through the RGB666 readback format, as on the panel
+        uint16_t v = p->gram[i];
+        uint8_t rgb[3] = { (uint8_t)((v >> 11) << 3), (uint8_t)(((v >> 5) & 0x3F) << 2), (uint8_t)((v & 0x1F) << 3) };
+        px[i] = p->sc->no_miso ? 0xFFFF : spi_clock_rgb666_to_565(rgb);
+    }
+    p->time_us += (double)(count * 24 + 16) * 1e6 / SPI_CLOCK_READ_HZ + 2 * SET_CLOCK_US;
+    return true;
+}
+
+/* @brief Fastest candidate the board handles, 0 if none */
+static uint32_t expected_hz(const scenario_t *sc, uint32_t limit_hz) {
+    if (sc->no_miso) {
+        return 0;
+    }
+    for (int div = 1; div <= SPI_CLOCK_MAX_DIV; div++) {
+        if (spi_clock_candidate_hz(div) <= limit_hz) {
+            return spi_clock_candidate_hz(div);
+        }
+    }
+    return 0;
+}
+
+/* @brief Long run at the chosen clock, what the flushes would see */
+static bool verify(panel_t *p) {
+    uint16_t out[SPI_CLOCK_TEST_PIXELS], in[SPI_CLOCK_TEST_PIXELS];
+
+    for (int r = 0; r < VERIFY_ROUNDS; r++) {
+        spi_clock_pattern(r, out, SPI_CLOCK_TEST_PIXELS);
+        sim_write(p, out, SPI_CLOCK_TEST_PIXELS);
+        sim_read(p, in, SPI_CLOCK_TEST_PIXELS);
+        if (memcmp(in, out, sizeof(out)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* @brief Drift: the limit drops, spot checks of 64 px must trigger a new calibration */
+static bool drift(spi_clock_t *sc, panel_t *p, const spi_clock_bus_t *bus) {
+    uint16_t out[SPI_CLOCK_CHECK_PIXELS], in[SPI_CLOCK_CHECK_PIXELS];
+
+    p->limit_hz = p->sc->drift_hz;
+    for (int i = 0; i < DRIFT_CHECKS; i++) {
+        spi_clock_pattern(3 + i, out, SPI_CLOCK_CHECK_PIXELS);
+        sim_write(p, out, SPI_CLOCK_CHECK_PIXELS);
+        sim_read(p, in, SPI_CLOCK_CHECK_PIXELS);
+        if (spi_clock_check(sc, memcmp(in, out, sizeof(out)) == 0)) {
+            return spi_clock_calibrate(sc, bus) == expected_hz(p->sc, p->limit_hz);
+        }
+    }
+    return false;
+}
+
+static int run(const scenario_t *scn, int trials, int verbose) {
+    int failed = 0;
+    uint64_t probes = 0;
+    double time_us = 0, max_time_us = 0;
+    uint32_t picked = 0;
+
+    for (int t = 0; t < trials; t++) {
+        spi_clock_t sc;
+        panel_t p = { .sc = scn, .limit_hz = scn->limit_hz, .hz = SPI_CLOCK_SAFE_HZ };
+        spi_clock_bus_t bus = { sim_set_clock, sim_write, sim_read, &p };
+
+        spi_clock_init(&sc, scn->cached_hz);
+        uint32_t hz = spi_clock_calibrate(&sc, &bus);
+        double cal_us = p.time_us;
+        bool ok = hz == expected_hz(scn, scn->limit_hz) && p.hz == sc.hz;
+        if (ok && hz != 0) {
+            ok = verify(&p);
+        }
+        if (ok && hz == 0) {
+            ok = sc.hz == SPI_CLOCK_SAFE_HZ;
+        }
+        if (ok && scn->drift_hz != 0) {
+            ok = drift(&sc, &p, &bus);
+        }
+        if (verbose && t == 0) {
+            spi_clock_print(&sc);
+        }
+        failed += !ok;
+        probes += sc.probes;
+        time_us += cal_us;
+        if (cal_us > max_time_us) {
+            max_time_us = cal_us;
+        }
+        picked = hz;
+    }
+
+    printf("%-20s %8.2f %8.2f %7.1f %8.0f %8.0f %6d %s\n", scn->name, scn->limit_hz / 1e6, picked / 1e6,
+           (double)probes / trials, time_us / trials, max_time_us, failed, failed ? "FAIL" : "ok");
+    return failed == 0;
+}
+
+int main(int argc, char **argv) {
+    int verbose = 0, trials = 200;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = strtoull(argv[++i], NULL, 0) | 1;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            trials = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else {
+            fprintf(stderr, "usage: spi_clock_sim [-s seed] [-n trials] [-v]\n");
+            return 2;
+        }
+    }
+
+    printf("%d trials per scenario, %d px test window, read at %.1f MHz\n", trials, SPI_CLOCK_TEST_PIXELS,
+           SPI_CLOCK_READ_HZ / 1e6);
+    printf("%-20s %8s %8s %7s %8s %8s %6s\n", "scenario", "limit", "picked", "probes", "avg us", "max us", "failed");
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        failed += !run(&scenarios[i], trials, verbose);
+    }
+    return failed ? 1 : 0;
+}
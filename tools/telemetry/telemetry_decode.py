@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Decoder for the binary telemetry stream (components/telemetry).
+
+Reads from a serial port (needs pyserial), a pseudo-terminal or a capture
+file, resynchronises on the sync bytes and checks every record's CRC.
+
+    telemetry_decode.py /dev/ttyUSB0              # print snapshots
+    telemetry_decode.py /dev/ttyUSB0 --stats 5    # throughput every 5 s
+    telemetry_decode.py capture.bin               # decode a raw capture
+"""
+import argparse
+import os
+import struct
+import sys
+import time
+
+SYNC = b"\xD2\x7A"
+RECORD = struct.Struct("<2sBBHBBIIB3s5HH")
+VERSION = 1
+REC_SNAPSHOT = 1
+HERO_IDLE = 0xFFFF
+
+CAUSES = {
+    0: "periodic", 1: "key", 2: "match_start", 3: "match_end", 4: "pause",
+    5: "resume", 6: "clock_adjust", 7: "hero_start", 8: "hero_end",
+    9: "hero_expired", 10: "tick", 11: "undo", 12: "rewind", 13: "sync",
+}
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class Decoder:
+    """Incremental decoder, feed() any chunking of the byte stream."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.records = 0
+        self.crc_errors = 0
+        self.seq_gaps = 0
+        self.bytes_in = 0
+        self.last_seq = None
+
+    def feed(self, data):
+        self.bytes_in += len(data)
+        self.buf += data
+        out = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                del self.buf[:-1]
+                return out
+            if start:
+                del self.buf[:start]
+            if len(self.buf) < RECORD.size:
+                return out
+            raw = bytes(self.buf[:RECORD.size])
+            fields = RECORD.unpack(raw)
+            if fields[1] != VERSION or crc16_ccitt(raw[2:-2]) != fields[-1]:
+                self.crc_errors += 1
+                del self.buf[:1]  # False sync, search again one byte later
+                continue
+            del self.buf[:RECORD.size]
+            out.append(self._record(fields))
+
+    def _record(self, f):
+        _, version, rtype, seq, length, cause, time_ms, game_secs, flags, _, *rest = f
+        heroes, _crc = rest[:5], rest[5]
+        if self.last_seq is not None and seq != (self.last_seq + 1) & 0xFFFF:
+            self.seq_gaps += 1
+        self.last_seq = seq
+        self.records += 1
+        return {
+            "type": rtype, "seq": seq, "cause": CAUSES.get(cause, str(cause)),
+            "time_ms": time_ms, "game_seconds": game_secs,
+            "match": bool(flags & 1), "running": bool(flags & 2),
+            "heroes": [None if h == HERO_IDLE else h for h in heroes],
+        }
+
+
+def fmt_clock(secs):
+    return "%02d:%02d" % (secs // 60, secs % 60)
+
+
+def format_record(r):
+    heroes = ",".join("--" if h is None else fmt_clock(h) for h in r["heroes"])
+    state = ("running" if r["running"] else "paused") if r["match"] else "no match"
+    return "%8d seq=%5d %-12s game=%s %-8s heroes=%s" % (
+        r["time_ms"], r["seq"], r["cause"], fmt_clock(r["game_seconds"]), state, heroes)
+
+
+def open_source(path, baud):
+    if os.path.isfile(path):
+        f = open(path, "rb")
+        return lambda: f.read(4096)
+    try:
+        import serial
+        port = serial.Serial(path, baud, timeout=0.2)
+        return lambda: port.read(4096)
+    except ImportError:
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)  # Raw pty / device without pyserial
+        return lambda: os.read(fd, 4096)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="serial port, pty or capture file")
+    ap.add_argument("--baud", type=int, default=921600)
+    ap.add_argument("--stats", type=float, metavar="SECONDS",
+                    help="print throughput instead of records")
+    args = ap.parse_args()
+
+    read = open_source(args.source, args.baud)
+    dec = Decoder()
+    t0 = last = time.monotonic()
+    last_records = last_bytes = 0
+    try:
+        while True:
+            data = read()
+            if not data and os.path.isfile(args.source):
+                break
+            for rec in dec.feed(data):
+                if not args.stats:
+                    print(format_record(rec))
+            now = time.monotonic()
+            if args.stats and now - last >= args.stats:
+                dt = now - last
+                print("%.0f records/s  %.0f B/s  crc errors %d  seq gaps %d" % (
+                    (dec.records - last_records) / dt, (dec.bytes_in - last_bytes) / dt,
+                    dec.crc_errors, dec.seq_gaps))
+                last, last_records, last_bytes = now, dec.records, dec.bytes_in
+    except KeyboardInterrupt:
+        pass
+    dt = max(time.monotonic() - t0, 1e-9)
+    print("total: %d records, %d bytes, %d crc errors, %d seq gaps, %.0f records/s" % (
+        dec.records, dec.bytes_in, dec.crc_errors, dec.seq_gaps, dec.records / dt), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
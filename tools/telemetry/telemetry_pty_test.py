@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""End-to-end check of the telemetry stream over a pty pair.
+
+telemetry_sim writes what the real encoder sends to the UART into one end,
+with every n-th record corrupted, and telemetry_decode.py's Decoder reads
+the other end in whatever chunks the pty delivers. The decoder must find
+every intact record, reject every corrupted one on its CRC and see a
+sequence gap after each corrupted record.
+
+    telemetry_pty_test.py path/to/telemetry_sim [-m matches] [-c every]
+"""
+import argparse
+import os
+import re
+import select
+import subprocess
+import sys
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry_decode import Decoder  # noqa: E402
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("sim", help="telemetry_sim executable")
+    ap.add_argument("-m", "--matches", type=int, default=10)
+    ap.add_argument("-c", "--corrupt-every", type=int, default=97)
+    args = ap.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+    sim = subprocess.Popen([args.sim, "-m", str(args.matches), "-c", str(args.corrupt_every),
+                            os.ttyname(slave)], stdout=subprocess.PIPE, text=True)
+
+    dec = Decoder()
+    idle = 0.0
+    while True:
+        ready, _, _ = select.select([master], [], [], 0.1)
+        if ready:
+            dec.feed(os.read(master, 4096))
+            idle = 0.0
+        elif sim.poll() is not None:
+            break  # Exited and everything it wrote was read
+        else:
+            idle += 0.1
+            if idle >= 10:
+                print("telemetry_pty_test: no data for 10 s", file=sys.stderr)
+                sim.kill()
+                return 1
+    out, _ = sim.communicate()
+    os.close(slave)
+    os.close(master)
+
+    m = re.search(r"records (\d+) corrupted (\d+) dropped (\d+)", out)
+    if sim.returncode != 0 or m is None:
+        print("telemetry_pty_test: telemetry_sim failed (%s): %s" % (sim.returncode, out.strip()), file=sys.stderr)
+        return 1
+    sent, corrupted, _dropped = map(int, m.groups())
+    print("sent %d records, %d corrupted; decoded %d, %d crc errors, %d seq gaps, %d bytes" % (
+        sent, corrupted, dec.records, dec.crc_errors, dec.seq_gaps, dec.bytes_in))
+
+    failed = []
+    if dec.bytes_in != sent * 32:
+        failed.append("%d bytes read, %d written" % (dec.bytes_in, sent * 32))
+    if dec.records != sent - corrupted:
+        failed.append("%d records decoded, %d intact sent" % (dec.records, sent - corrupted))
+    if dec.crc_errors < corrupted:
+        failed.append("%d crc errors for %d corrupted records" % (dec.crc_errors, corrupted))
+    if not corrupted - 1 <= dec.seq_gaps <= corrupted:  # A corrupted last record leaves no gap behind it
+        failed.append("%d seq gaps for %d corrupted records" % (dec.seq_gaps, corrupted))
+    for f in failed:
+        print("telemetry_pty_test: " + f, file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,207 @@
+/* Host harness for the telemetry encoder (components/telemetry/telemetry.c)
+ *
+ * Runs the real telemetry_task on a virtual clock and writes its UART output
+ * to a tty, normally one end of a pty pair read by telemetry_decode.py (see
+ * telemetry_pty_test.py). Random matches are played through main/time_tracker.c
+ * while telemetry_task waits for a notification, as the other tasks would do
+ * while it blocks; every state change and the periodic snapshot become records.
+ *
+ * -c corrupts one byte of every n-th record on its way to the tty, so the
+ * decoder has CRC failures to find. The summary line on stdout gives what
+ * the decoder must report:
+ *   records <sent> corrupted <corrupted> dropped <ring full>
+ *
+ * Build:
+ *   cc -O2 -Itools/bench/stubs -o telemetry_sim tools/telemetry/telemetry_sim.c \
+ *      components/telemetry/telemetry.c main/time_tracker.c
+ *
+ * Usage:
+ *   telemetry_sim [-m matches] [-c every] [-s seed] tty
+ *
+ * Exits with 1 if the ring overflowed or a write to the tty failed.
+ */
+#define _GNU_SOURCE     // cfmakeraw() with glibc
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "../../components/telemetry/telemetry.h"
+
+#define STEP_MS             250     // Workload played per wait of telemetry_task
+#define MATCH_SECONDS_MIN   (20 * 60)
+#define MATCH_SECONDS_MAX   (45 * 60)
+#define CORRUPT_OFFSET      offsetof(telemetry_record_t, game_seconds)
+
+static int tty = -1;
+static int64_t now_us;
+static uint32_t notified;
+static uint32_t corrupt_every;
+static uint32_t records_out;
+static uint32_t corrupted;
+static int write_failed;
+
+static int matches = 10;
+static int match_no;
+static uint32_t match_left;     // Seconds, 0 between matches
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+int64_t esp_timer_get_time(void) {
+    return now_us;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return (TaskHandle_t)&notified;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    notified++;
+    return pdTRUE;
+}
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_buf, int tx_buf, int queue_size, QueueHandle_t *queue, int flags) {
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t *config) {
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t port, int tx, int rx, int rts, int cts) {
+    return ESP_OK;
+}
+
+static void write_all(const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(tty, data, len);
+        if (n <= 0) {
+            perror("write");
+            write_failed = 1;
+            return;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
+/* @brief The UART driver: records go to the tty, every corrupt_every-th one with a flipped byte
+ * @note telemetry_drain() only writes whole records
+ */
+int uart_write_bytes(uart_port_t port, const void *src, size_t size) {
+    const uint8_t *in = src;
+    for (size_t off = 0; off + sizeof(telemetry_record_t) <= size; off += sizeof(telemetry_record_t)) {
+        uint8_t rec[sizeof(telemetry_record_t)];
+        memcpy(rec, in + off, sizeof(rec));
+        records_out++;
+        if (corrupt_every && records_out % corrupt_every == 0) {
+            rec[CORRUPT_OFFSET] ^= 0x5A;
+            corrupted++;
+        }
+        write_all(rec, sizeof(rec));
+    }
+    return (int)size;
+}
+
+static void finish(void) {
+    telemetry_stats_t s;
+    telemetry_get_stats(&s);
+    close(tty);
+    printf("records %lu corrupted %lu dropped %lu\n", (unsigned long)records_out,
+           (unsigned long)corrupted, (unsigned long)s.records_dropped);
+    exit(s.records_dropped || write_failed ? 1 : 0);
+}
+
+/* @brief One second of a match: the tick, now and then a hero key, a pause or a clock fix */
+static void play_second(void) {
+    if (match_left == 0) {
+        if (match_no == matches) {
+            finish();
+        }
+        match_no++;
+        match_left = MATCH_SECONDS_MIN + rng() % (MATCH_SECONDS_MAX - MATCH_SECONDS_MIN);
+        process_key(1, 4);                      // K10
+    }
+    if (rng() % 30 == 0) {
+        process_key(0, rng() % HERO_COUNT);     // K1 - K5
+    }
+    if (rng() % 400 == 0) {
+        process_key(1, 2);                      // K8 pause, a clock fix, K8 resume
+        process_key(1, rng() % 2 ? 1 : 3);
+        process_key(1, 2);
+    }
+    time_tracker_tick();
+    if (--match_left == 0) {
+        process_key(1, 0);                      // K6
+    }
+}
+
+/* @brief telemetry_task's wait: the rest of the system runs meanwhile
+ * @param ticks Longest wait, the periodic snapshot is due after it
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    uint32_t waited = 0;
+    while (notified == 0 && waited < ticks) {
+        uint32_t step = ticks - waited < STEP_MS ? ticks - waited : STEP_MS;
+        int64_t before = now_us / 1000000;
+        now_us += step * 1000LL;
+        waited += step;
+        if (now_us / 1000000 != before) {
+            play_second();
+        }
+    }
+    uint32_t count = notified;
+    notified = clear ? 0 : (count ? count - 1 : 0);
+    return count;
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            matches = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            corrupt_every = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = (uint32_t)strtoul(argv[++i], NULL, 0) | 1;
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL || matches < 1) {
+        fprintf(stderr, "usage: telemetry_sim [-m matches] [-c every] [-s seed] tty\n");
+        return 2;
+    }
+
+    tty = open(path, O_WRONLY | O_NOCTTY);
+    if (tty < 0) {
+        perror(path);
+        return 2;
+    }
+    struct termios tio;
+    if (tcgetattr(tty, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(tty, TCSANOW, &tio);
+    }
+
+    telemetry_init();
+    time_tracker_add_listener(telemetry_listener);
+    telemetry_task(NULL);   // Returns through finish()
+    return 1;
+}
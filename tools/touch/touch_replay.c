@@ -0,0 +1,281 @@
+/* Host replay of the touch input path (components/touch)
+ *
+ * Plays a touch trace through the trace source and the coalescer the way
+ * the device does: every controller report raises TP_INT, the reader task
+ * drains the queued interrupts and does one I2C burst read, and LVGL takes
+ * one coalesced state per read period. Reports the number of samples merged
+ * per input event, interrupt-to-event latency, I2C bus occupancy, and checks
+ * that no tap is lost and every press is released again.
+ *
+ * Build:
+ *   cc -O2 -o touch_replay tools/touch/touch_replay.c components/touch/touch_coalesce.c components/touch/touch_trace.c
+ *
+ * Usage:
+ *   touch_replay [-g gestures] [-s seed] [-p lvgl_period_ms] [-w out_trace] [trace_file]
+ *
+ * Without a trace file, random taps and drags are generated (-w saves them
+ * as a trace). Exits with 1 if a tap is lost or a press is never released.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../components/touch/touch_coalesce.h"
+#include "../../components/touch/touch_trace.h"
+
+#define STEP_US         10
+#define REPORT_US       10000   // FT6336 report period while touched
+#define WAKE_US         40      // Interrupt to reader task running
+#define I2C_FREQ_HZ     400000
+#define READ_BYTES      8       // addr+reg, addr, 5 data bytes
+#define READ_OVERHEAD_US 30     // Driver setup per transaction
+#define MAX_SAMPLES     400000
+#define MAX_GESTURES    20000
+#define MAX_EVENTS      400000
+
+typedef struct {
+    int64_t down_us;
+    int64_t up_us;
+    bool seen_pressed;
+    bool seen_release;
+} gesture_t;
+
+static touch_sample_t samples[MAX_SAMPLES];
+static size_t sample_count;
+static gesture_t gestures[MAX_GESTURES];
+static size_t gesture_count;
+static uint32_t latencies[MAX_EVENTS];
+static size_t latency_count;
+
+static uint64_t rng_state;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(rng_state >> 33);
+}
+
+static int32_t rng_range(int32_t min, int32_t max) {
+    return min + (int32_t)(rng() % (uint32_t)(max - min + 1));
+}
+
+static void add_sample(int64_t t, int x, int y, bool pressed) {
+    if (sample_count < MAX_SAMPLES) {
+        samples[sample_count++] = (touch_sample_t){ t, (uint16_t)x, (uint16_t)y, pressed };
+    }
+}
+
+/* Taps (some shorter than a frame) and drags, reported every REPORT_US while down */
+static void generate(int count) {
+    int64_t t = 100000;
+    for (int g = 0; g < count; g++) {
+        bool drag = rng() % 10 < 4;
+        int32_t duration = drag ? rng_range(150000, 600000) : rng_range(5000, 120000);
+        int x = rng_range(0, 479), y = rng_range(0, 319);
+        int dx = drag ? rng_range(-3, 3) : 0, dy = drag ? rng_range(-2, 2) : 0;
+        for (int32_t d = 0; d < duration; d += REPORT_US) {
+            add_sample(t + d, x, y, true);
+            x = (x + dx + 480) % 480;
+            y = (y + dy + 320) % 320;
+        }
+        add_sample(t + duration, x, y, false);
+        t += duration + rng_range(80000, 700000);
+    }
+}
+
+static void write_trace(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    for (size_t i = 0; i < sample_count; i++) {
+        if (samples[i].pressed) {
+            fprintf(f, "%lld down %u %u\n", (long long)(samples[i].time_us / 1000), samples[i].x, samples[i].y);
+        } else {
+            fprintf(f, "%lld up\n", (long long)(samples[i].time_us / 1000));
+        }
+    }
+    fclose(f);
+}
+
+static void load_trace(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *text = malloc(len + 1);
+    text[fread(text, 1, len, f)] = '\0';
+    fclose(f);
+    sample_count = touch_trace_parse(text, samples, MAX_SAMPLES);
+    free(text);
+}
+
+static void find_gestures(void) {
+    bool down = false;
+    for (size_t i = 0; i < sample_count && gesture_count < MAX_GESTURES; i++) {
+        if (samples[i].pressed && !down) {
+            gestures[gesture_count].down_us = samples[i].time_us;
+            gestures[gesture_count].up_us = INT64_MAX;
+            down = true;
+        } else if (!samples[i].pressed && down) {
+            gestures[gesture_count++].up_us = samples[i].time_us;
+            down = false;
+        }
+    }
+    if (down) {
+        gesture_count++;
+    }
+}
+
+/* Gesture a reported sample belongs to, by the time of its interrupt */
+static gesture_t *gesture_at(int64_t t) {
+    size_t lo = 0, hi = gesture_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (gestures[mid].down_us <= t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo > 0 ? &gestures[lo - 1] : NULL;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    int count = 1000;
+    int period_ms = 33;
+    const char *out_path = NULL;
+    const char *in_path = NULL;
+    rng_state = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            rng_state = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            period_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (argv[i][0] != '-') {
+            in_path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-g gestures] [-s seed] [-p lvgl_period_ms] [-w out_trace] [trace_file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (in_path != NULL) {
+        load_trace(in_path);
+    } else {
+        generate(count);
+    }
+    if (out_path != NULL) {
+        write_trace(out_path);
+    }
+    if (sample_count == 0) {
+        fprintf(stderr, "empty trace\n");
+        return 2;
+    }
+    find_gestures();
+
+    touch_trace_t trace;
+    touch_source_t source;
+    touch_coalescer_t coalescer;
+    touch_sample_t state;
+    touch_trace_init(&trace, samples, sample_count, false);
+    touch_trace_source(&trace, &source);
+    source.init(source.ctx);
+    source.read(source.ctx, 0, &state);     // Starts the trace clock at 0
+    touch_coalesce_reset(&coalescer);
+
+    const int64_t read_us = READ_OVERHEAD_US + (int64_t)READ_BYTES * 9 * 1000000 / I2C_FREQ_HZ;
+    const int64_t end_us = samples[sample_count - 1].time_us + 500000;
+    size_t next_irq = 0;            // Every trace sample is one controller report
+    int64_t pending_oldest = -1;    // Oldest queued interrupt
+    int64_t read_start = -1, read_irq = 0;
+    int64_t busy_us = 0;
+    int64_t next_frame = period_ms * 1000;
+    uint32_t irqs = 0, reads = 0, frames = 0, events = 0;
+    bool reported_pressed = false;
+
+    for (int64_t t = 0; t <= end_us; t += STEP_US) {
+        while (next_irq < sample_count && samples[next_irq].time_us <= t) {
+            if (pending_oldest < 0) {
+                pending_oldest = samples[next_irq].time_us;
+            }
+            next_irq++;
+            irqs++;
+        }
+        // Reader task: wake, drain the queue, one burst read
+        if (read_start < 0 && pending_oldest >= 0 && t >= pending_oldest + WAKE_US) {
+            read_start = t;
+            read_irq = pending_oldest;
+            pending_oldest = -1;
+            source.read(source.ctx, t, &state);
+        }
+        if (read_start >= 0 && t >= read_start + read_us) {
+            state.time_us = read_irq;
+            touch_coalesce_push(&coalescer, &state);
+            busy_us += read_us;
+            reads++;
+            read_start = -1;
+        }
+        // LVGL read
+        if (t >= next_frame) {
+            touch_sample_t out;
+            int64_t oldest = 0;
+            next_frame += period_ms * 1000;
+            frames++;
+            if (touch_coalesce_take(&coalescer, &out, &oldest)) {
+                events++;
+                if (latency_count < MAX_EVENTS) {
+                    latencies[latency_count++] = (uint32_t)(t - oldest);
+                }
+                gesture_t *g = gesture_at(out.time_us);
+                if (out.pressed && g != NULL && out.time_us < g->up_us) {
+                    g->seen_pressed = true;
+                } else if (!out.pressed && reported_pressed) {
+                    g = gesture_at(out.time_us - 1);
+                    if (g != NULL) {
+                        g->seen_release = true;
+                    }
+                }
+                reported_pressed = out.pressed;
+            }
+        }
+    }
+
+    uint32_t lost = 0, stuck = 0, short_taps = 0;
+    for (size_t i = 0; i < gesture_count; i++) {
+        if (gestures[i].up_us - gestures[i].down_us < period_ms * 1000) {
+            short_taps++;
+        }
+        lost += !gestures[i].seen_pressed;
+        stuck += gestures[i].seen_pressed && !gestures[i].seen_release;
+    }
+    qsort(latencies, latency_count, sizeof(latencies[0]), cmp_u32);
+    uint32_t p50 = latency_count ? latencies[latency_count / 2] : 0;
+    uint32_t p99 = latency_count ? latencies[latency_count * 99 / 100] : 0;
+    uint32_t max = latency_count ? latencies[latency_count - 1] : 0;
+
+    printf("gestures      %zu (%u shorter than a %d ms frame)\n", gesture_count, short_taps, period_ms);
+    printf("reports       %u interrupts, %u I2C reads, %u samples\n", irqs, reads, coalescer.samples);
+    printf("events        %u over %u LVGL reads, %.2f samples/event (%u coalesced)\n",
+           events, frames, events ? (double)coalescer.samples / events : 0.0, coalescer.coalesced);
+    printf("latency       irq->event p50 %u us, p99 %u us, max %u us\n", p50, p99, max);
+    printf("i2c           %lld us/read, busy %.3f%% of %.1f s\n", (long long)read_us,
+           100.0 * busy_us / end_us, end_us / 1e6);
+    printf("lost taps     %u\n", lost);
+    printf("stuck presses %u\n", stuck);
+    return (lost || stuck) ? 1 : 0;
+}